@@ -0,0 +1,1014 @@
+/**
+ * \file batch.cpp
+ * \brief Implementation of commands run without graphical interface.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include "batch.hpp"
+#include "worldfile.hpp"
+#include "referencepoints.hpp"
+#include "warp.hpp"
+#include "mapprojection.hpp"
+#include "numberreader.hpp"
+#include "sample.hpp"
+#include "datafile.hpp"
+#include "vectorexport.hpp"
+#include "gridder.hpp"
+
+namespace {
+  namespace po = boost::program_options;
+  namespace fs = boost::filesystem;
+
+  /// \brief Name of the command converting points.
+  const char* const transformCommand = "transform";
+
+  /// \brief Name of the command geo-referencing map sheets.
+  const char* const georeferenceCommand = "georeference";
+
+  /// \brief Name of the command exporting data as lines.
+  const char* const exportCommand = "export";
+
+  /// \brief Name of the command interpolating data on a grid.
+  const char* const gridCommand = "grid";
+
+  /// \brief Extensions of image files, in lower case.
+  const char* const imageExtensions [] = {
+    ".bmp", ".gif", ".jpg", ".jpeg", ".png", ".pbm", ".pgm", ".ppm", ".tiff",
+    ".tif", ".xbm", ".xpm", ".jp2", ".j2k", ".jpf", ".jpx", ".jpm", ".mj2"
+  };
+
+  /// \brief Size of the buffers used on files.
+  const std::size_t bufferSize = 1 << 16;
+
+  /// \brief Number of points converted at once.
+  const std::size_t chunkSize = 4096;
+
+  /// \brief Default number of cells of warp grids along each axis.
+  const std::size_t defaultCells = 256;
+
+  /**
+   * \brief Convert points read in a stream.
+   * \param transform The conversion, either a referential change or a
+   * class providing a method apply(x, y, u, v).
+   * \param in Stream containing one point "x y" per line.
+   * \param out Stream where lines "x y u v" are written.
+   * \param projection Map projection of the plane the conversion leads to,
+   * null for geographical coordinates.
+   * \param inverse Whether points read are geographical, to be projected
+   * before the conversion, instead of converted points being projected
+   * back.
+   * \return Number of points converted.
+   * \exception std::runtime_error A line cannot be read or a point cannot
+   * be projected.
+   *
+   * The conversion is a template parameter, so that the loop of
+   * Projection::transformPoints() is compiled for it.
+   */
+  template <class Transform>
+  std::size_t convert (const Transform &transform, std::istream &in,
+                       std::ostream &out,
+                       const Projection::MapProjection* projection = 0,
+                       bool inverse = false) {
+    out.precision(std::numeric_limits<double>::digits10);
+
+    /* Abscissae of points read. */
+    std::vector<double> x (chunkSize);
+    /* Ordinates of points read. */
+    std::vector<double> y (chunkSize);
+    /* Abscissae of converted points. */
+    std::vector<double> u (chunkSize);
+    /* Ordinates of converted points. */
+    std::vector<double> v (chunkSize);
+
+    /* Reader of numbers in the input. */
+    Text::NumberReader reader (in);
+    /* Number of points converted. */
+    std::size_t count = 0;
+    /* Number of points in the current chunk. */
+    std::size_t n;
+    do {
+      n = 0;
+      try {
+        while ((n < chunkSize) && !reader.atEnd()) {
+          x[n] = reader.number();
+          y[n] = reader.number();
+          reader.skipLine();
+          ++n;
+        }
+      }
+      catch (const Text::ParseError &error) {
+        /* Message describing the error. */
+        std::ostringstream message;
+        message << "Cannot read point number " << count + n + 1 << ": "
+                << error.what();
+        throw std::runtime_error(message.str());
+      }
+
+      if (projection && inverse) {
+        projection->forward(&x[0], &y[0], &u[0], &v[0], n);
+        Projection::transformPoints(transform, &u[0], &v[0], &u[0], &v[0],
+                                    n);
+      }
+      else {
+        Projection::transformPoints(transform, &x[0], &y[0], &u[0], &v[0],
+                                    n);
+        if (projection) projection->inverse(&u[0], &v[0], &u[0], &v[0], n);
+      }
+      for (std::size_t i = 0; i < n; ++i)
+        if (!std::isfinite(u[i]) || !std::isfinite(v[i])) {
+          /* Message describing the error. */
+          std::ostringstream message;
+          message << "Point number " << count + i + 1 << " cannot be "
+                  << "projected.";
+          throw std::runtime_error(message.str());
+        }
+      for (std::size_t i = 0; i < n; ++i)
+        out << x[i] << ' ' << y[i] << ' ' << u[i] << ' ' << v[i] << '\n';
+      count += n;
+    } while (n == chunkSize);
+
+    out.flush();
+    return count;
+  }
+
+  /**
+   * \brief Conversion through a warp grid inside its extent, and through
+   * the exact conversion outside, where the grid would only extrapolate.
+   *
+   * Outside the grid of an inverse conversion, the extrapolated point is
+   * refined by Newton's method on the exact forward conversion.
+   */
+  template <class Transform>
+  class GuardedGrid {
+    public:
+      /// \brief Greatest number of Newton iterations for a point.
+      static const int maximumIterations = 20;
+
+      /**
+       * \brief Construct the conversion.
+       * \param _exact The exact forward conversion, providing a method
+       * apply(x, y, u, v).
+       * \param _grid The grid, sampling the conversion or its inverse.
+       * \param _inverse Whether the grid samples the inverse conversion.
+       * \param _step Step of finite differences, in image coordinates.
+       */
+      GuardedGrid (const Transform &_exact, const Projection::WarpGrid &_grid,
+                   bool _inverse, double _step):
+        exact (_exact), grid (_grid), inverse (_inverse), step (_step),
+        outside (0) {}
+
+      /**
+       * \brief Convert a point.
+       * \param x Abscissa of the point.
+       * \param y Ordinate of the point.
+       * \param u Where to store the converted abscissa.
+       * \param v Where to store the converted ordinate.
+       */
+      void apply (double x, double y, double &u, double &v) const {
+        grid.apply(x, y, u, v);
+        if (grid.contains(x, y)) return;
+        ++outside;
+        if (!inverse) {
+          exact.apply(x, y, u, v);
+          return;
+        }
+        for (int iteration = 0; iteration < maximumIterations; ++iteration) {
+          /* Current conversion. */
+          double a, b;
+          exact.apply(u, v, a, b);
+          /* Conversions shifted along abscissae and ordinates. */
+          double ax, bx, ay, by;
+          exact.apply(u + step, v, ax, bx);
+          exact.apply(u, v + step, ay, by);
+          /* Jacobian matrix, by finite differences. */
+          const double dadu = (ax - a) / step, dadv = (ay - a) / step,
+                       dbdu = (bx - b) / step, dbdv = (by - b) / step;
+          /* Determinant of the Jacobian matrix. */
+          const double determinant = dadu * dbdv - dadv * dbdu;
+          if (determinant == 0.) break;
+          /* Correction of the abscissa. */
+          const double du = (dbdv * (a - x) - dadv * (b - y)) / determinant;
+          /* Correction of the ordinate. */
+          const double dv = (dadu * (b - y) - dbdu * (a - x)) / determinant;
+          u -= du;
+          v -= dv;
+          if (std::abs(du) + std::abs(dv) < 1e-6 * step) break;
+        }
+      }
+
+      /// \brief Number of points converted outside the grid.
+      std::size_t outsideCount () const {return outside;}
+
+    private:
+      /// \brief The exact forward conversion.
+      const Transform &exact;
+
+      /// \brief The grid.
+      const Projection::WarpGrid &grid;
+
+      /// \brief Whether the grid samples the inverse conversion.
+      const bool inverse;
+
+      /// \brief Step of finite differences.
+      const double step;
+
+      /// \brief Number of points converted outside the grid.
+      mutable std::size_t outside;
+  };
+
+  template <class Transform>
+  const int GuardedGrid<Transform>::maximumIterations;
+
+  /**
+   * \brief Convert points through a warp grid sampling a conversion over
+   * the extent of reference points, points outside this extent being
+   * converted exactly and counted on the standard error.
+   * \param transform The conversion, providing a method apply(x, y, u, v).
+   * \param r1 Reference points in image coordinates.
+   * \param cells Number of cells of grids along each axis.
+   * \param projection Map projection of the plane the conversion leads to,
+   * null for geographical coordinates.
+   * \param inverse Whether to convert geographical coordinates to image
+   * coordinates instead.
+   * \param in Stream containing one point "x y" per line.
+   * \param out Stream where lines "x y u v" are written.
+   * \return Number of points converted.
+   * \exception std::runtime_error A line cannot be read.
+   * \exception std::domain_error Reference points have no extent.
+   */
+  template <class Transform>
+  std::size_t convertOnGrid (const Transform &transform,
+                             const std::vector<Projection::Point2D> &r1,
+                             std::size_t cells,
+                             const Projection::MapProjection* projection,
+                             bool inverse, std::istream &in,
+                             std::ostream &out) {
+    /* Smallest abscissa. */
+    double xMin = r1[0].x();
+    /* Greatest abscissa. */
+    double xMax = xMin;
+    /* Smallest ordinate. */
+    double yMin = r1[0].y();
+    /* Greatest ordinate. */
+    double yMax = yMin;
+    for (std::size_t i = 1; i < r1.size(); ++i) {
+      xMin = std::min(xMin, r1[i].x());
+      xMax = std::max(xMax, r1[i].x());
+      yMin = std::min(yMin, r1[i].y());
+      yMax = std::max(yMax, r1[i].y());
+    }
+    /* Conversion sampled over reference points. */
+    const Projection::WarpGrid grid (transform, xMin, yMin, xMax, yMax,
+                                     cells, cells);
+    /* Step of finite differences, a thousandth of a cell. */
+    const double step = 1e-3 * std::max(xMax - xMin, yMax - yMin)
+      / static_cast<double>(cells);
+    /* Number of points converted. */
+    std::size_t count;
+    /* Number of points outside the grid. */
+    std::size_t outside;
+    if (inverse) {
+      /* Grid of the inverse conversion. */
+      const Projection::WarpGrid inverseGrid = grid.inverse(cells, cells);
+      /* The guarded conversion. */
+      const GuardedGrid<Transform> guarded (transform, inverseGrid, true,
+                                            step);
+      count = convert(guarded, in, out, projection, true);
+      outside = guarded.outsideCount();
+    }
+    else {
+      /* The guarded conversion. */
+      const GuardedGrid<Transform> guarded (transform, grid, false, step);
+      count = convert(guarded, in, out, projection);
+      outside = guarded.outsideCount();
+    }
+    if (outside > 0)
+      std::cerr << outside << " points outside the extent of reference "
+                << "points, converted exactly.\n";
+    return count;
+  }
+
+  /**
+   * \brief Convert points with a model fitted on reference points.
+   * \param model Name of the model.
+   * \param points Reference points.
+   * \param cells Number of cells of warp grids along each axis.
+   * \param inverse Whether to convert geographical coordinates to image
+   * coordinates instead.
+   * \param in Stream containing one point "x y" per line.
+   * \param out Stream where lines "x y u v" are written.
+   * \return Number of points converted.
+   * \exception std::runtime_error A line cannot be read or the model is
+   * unknown.
+   * \exception std::domain_error Reference points do not define the model.
+   *
+   * Polynomials are evaluated directly, thin-plate splines on a warp grid.
+   * Inverse conversions always go through a warp grid. Models are fitted in
+   * the plane of the map projection of reference points.
+   */
+  std::size_t convertWithModel (const std::string &model,
+                                const Projection::ReferencePoints &points,
+                                std::size_t cells, bool inverse,
+                                std::istream &in, std::ostream &out) {
+    /* Map projection of reference points. */
+    const Projection::MapProjection* projection = points.projection().get();
+    if (model == "affine")
+      return Batch::transform(points.change(), in, out, inverse, projection);
+
+    /* Reference points in image coordinates. */
+    std::vector<Projection::Point2D> r1;
+    /* Reference points in the plane of the projection. */
+    std::vector<Projection::Point2D> r2;
+    r1.reserve(points.size());
+    r2.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      r1.push_back(points.points()[i].first);
+      r2.push_back(projection?
+                   projection->forwardPoint(points.points()[i].second):
+                   points.points()[i].second);
+    }
+
+    if (model == "polynomial2") {
+      /* Fitted polynomials. */
+      const Projection::PolynomialTransform<2> polynomial (r1, r2);
+      return inverse? convertOnGrid(polynomial, r1, cells, projection, true,
+                                    in, out):
+        convert(polynomial, in, out, projection);
+    }
+    if (model == "polynomial3") {
+      /* Fitted polynomials. */
+      const Projection::PolynomialTransform<3> polynomial (r1, r2);
+      return inverse? convertOnGrid(polynomial, r1, cells, projection, true,
+                                    in, out):
+        convert(polynomial, in, out, projection);
+    }
+    if (model == "spline") {
+      /* Fitted spline. */
+      const Projection::ThinPlateSpline spline (r1, r2);
+      return convertOnGrid(spline, r1, cells, projection, inverse, in,
+                           out);
+    }
+    throw std::runtime_error("Unknown model \"" + model + "\".");
+  }
+
+  /**
+   * \brief Tell whether a file is an image, from its extension.
+   * \param file Path of the file.
+   */
+  bool isImage (const fs::path &file) {
+    /* Extension of the file, in lower case. */
+    std::string extension = file.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [] (char c) {
+                     return static_cast<char>(std::tolower(
+                       static_cast<unsigned char>(c)));
+                   });
+    return std::find(std::begin(imageExtensions), std::end(imageExtensions),
+                     extension) != std::end(imageExtensions);
+  }
+
+  /**
+   * \brief Find map sheets given on the command line.
+   * \param argument Image file, or directory whose images are taken.
+   * \param recursive Whether to look for images in sub-directories.
+   * \param pointsExtension Extension of files of reference points.
+   * \param sheets Where sheets found are added, sorted by name.
+   * \exception std::runtime_error The argument does not exist.
+   */
+  void findSheets (const std::string &argument, bool recursive,
+                   const std::string &pointsExtension,
+                   std::vector<Batch::Sheet> &sheets) {
+    /* Path given. */
+    const fs::path given (argument);
+    /* Images found. */
+    std::vector<fs::path> images;
+    if (fs::is_directory(given)) {
+      if (recursive) {
+        for (fs::recursive_directory_iterator i (given), end; i != end; ++i)
+          if (fs::is_regular_file(i->status()) && isImage(i->path()))
+            images.push_back(i->path());
+      }
+      else {
+        for (fs::directory_iterator i (given), end; i != end; ++i)
+          if (fs::is_regular_file(i->status()) && isImage(i->path()))
+            images.push_back(i->path());
+      }
+      std::sort(images.begin(), images.end());
+    }
+    else if (fs::exists(given)) {
+      images.push_back(given);
+    }
+    else {
+      throw std::runtime_error("\"" + argument + "\" does not exist.");
+    }
+
+    for (std::size_t i = 0; i < images.size(); ++i) {
+      /* The sheet. */
+      Batch::Sheet sheet;
+      sheet.image = images[i].string();
+      sheet.points = fs::path (images[i]).replace_extension(pointsExtension)
+                       .string();
+      sheet.count = 0;
+      sheet.rms = sheet.maximumResidual =
+        std::numeric_limits<double>::quiet_NaN();
+      sheets.push_back(sheet);
+    }
+  }
+
+  /**
+   * \brief Geo-reference a single map sheet.
+   * \param sheet The sheet, where results are put.
+   * \param write Whether or not to write the world file.
+   * \param projection Map projection the world file leads to, null for
+   * geographical coordinates.
+   */
+  void georeferenceSheet (Batch::Sheet &sheet, bool write,
+                          const Projection::MapProjectionPointer
+                            &projection) {
+    try {
+      if (!fs::exists(sheet.points))
+        throw std::runtime_error("No reference point file \""
+                                 + sheet.points + "\".");
+      /* Reference points of the sheet. */
+      Projection::ReferencePoints points;
+      points.setProjection(projection);
+      points.read(sheet.points);
+      sheet.count = points.size();
+      /* Referential change fitted on reference points. */
+      const Projection::ChangeMatrix change = points.change();
+      sheet.rms = points.fit().rms();
+      /* Residual of each reference point. */
+      const std::vector<double> residuals = points.residuals(change);
+      sheet.maximumResidual = *std::max_element(residuals.begin(),
+                                                residuals.end());
+      /* Name of the world file. */
+      const std::string world = Projection::worldFileName(sheet.image);
+      if (write) Projection::writeWorldFile(world, change);
+      sheet.world = world;
+    }
+    catch (const std::exception &e) {
+      sheet.world.clear();
+      sheet.error = e.what();
+    }
+  }
+
+  /**
+   * \brief Command converting a file of points from image coordinates to
+   * geographical coordinates.
+   * \param argc Count of arguments of the command.
+   * \param argv Values of arguments of the command.
+   * \return Program return value.
+   */
+  int transformMain (int argc, char** argv) {
+    /* Declaring supported options. */
+    po::options_description desc("Options of command \"transform\"");
+    desc.add_options()
+      ("help,h", "Display this help message.")
+      ("world,w", po::value<std::string>(),
+       "World file describing the referential change.")
+      ("reference,r", po::value<std::string>(),
+       "File of reference points \"x y longitude latitude\" the "
+       "conversion is fitted on, instead of a world file.")
+      ("model,m", po::value<std::string>()->default_value("affine"),
+       "Conversion fitted on reference points: affine, polynomial2, "
+       "polynomial3 or spline.")
+      ("grid,g", po::value<std::size_t>()->default_value(defaultCells),
+       "Number of cells along each axis of warp grids, used by splines and "
+       "inverse conversions.")
+      ("projection,P", po::value<std::string>()->default_value("geographic"),
+       "Map projection the world file leads to, or reference points are "
+       "fitted in: geographic, mercator[:latitude of true scale[:central "
+       "meridian]], utm:<zone><n|s>, tm:<central meridian>:<scale>[:<false "
+       "easting>:<false northing>], lambert:<parallel 1>:<parallel "
+       "2>:<latitude>:<longitude>[:<false easting>:<false northing>] or "
+       "lambert93, optionally followed by @wgs84, @grs80, @clarke1866 or "
+       "@international1924.")
+      ("inverse,i", "Convert geographical coordinates to image coordinates.");
+    /* Options not displayed in help message. */
+    po::options_description hidden;
+    hidden.add_options()
+      ("input", po::value<std::string>()->default_value("-"),
+       "File containing points.")
+      ("output", po::value<std::string>()->default_value("-"),
+       "File where converted points are written.");
+    /* Command line. */
+    po::options_description cmd;
+    cmd.add(desc).add(hidden);
+    /* Positional options. */
+    po::positional_options_description positional;
+    positional.add("input", 1).add("output", 1);
+
+    /* Options map. */
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+    options(cmd).positional(positional).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+      std::cout << "Convert points \"x y\" in image coordinates to "
+                << "\"x y longitude latitude,\" or points \"longitude "
+                << "latitude\"\nto \"longitude latitude x y\" with option "
+                << "--inverse.\n\n"
+                << "Command : \n\n"
+                << "\tgeodesk transform --world <world file> "
+                << "[input file] [output file]\n"
+                << "\tgeodesk transform --reference <reference points> "
+                << "--model <model> [input file] [output file]\n\n"
+                << "A file named \"-\" or a missing file name stands for "
+                << "standard input or output.\n\n"
+                << desc << '\n';
+      return EXIT_SUCCESS;
+    }
+
+    if (vm.count("world") == vm.count("reference")) {
+      std::cerr << "Either a world file should be given with option "
+                << "--world, or reference points with option --reference.\n";
+      return EXIT_FAILURE;
+    }
+    if (vm["grid"].as<std::size_t>() == 0) {
+      std::cerr << "Warp grids should have at least one cell.\n";
+      return EXIT_FAILURE;
+    }
+
+    /* Map projection. */
+    const Projection::MapProjectionPointer projection =
+      Projection::makeProjection(vm["projection"].as<std::string>());
+    /* Reference points, if given. */
+    Projection::ReferencePoints points;
+    points.setProjection(projection);
+    if (vm.count("reference"))
+      points.read(vm["reference"].as<std::string>());
+
+    /* Name of the input file. */
+    const std::string inputName = vm["input"].as<std::string>();
+    /* Name of the output file. */
+    const std::string outputName = vm["output"].as<std::string>();
+
+    /* Buffer for the input file. */
+    std::vector<char> inputBuffer (bufferSize);
+    /* Buffer for the output file. */
+    std::vector<char> outputBuffer (bufferSize);
+    /* Input file, when not reading standard input. */
+    std::ifstream inputFile;
+    /* Output file, when not writing to standard output. */
+    std::ofstream outputFile;
+
+    if (inputName != "-") {
+      inputFile.rdbuf()->pubsetbuf(&inputBuffer[0], inputBuffer.size());
+      inputFile.open(inputName.c_str());
+      if (!inputFile) {
+        std::cerr << "File named \"" << inputName
+                  << "\" cannot be opened.\n";
+        return EXIT_FAILURE;
+      }
+    }
+    if (outputName != "-") {
+      outputFile.rdbuf()->pubsetbuf(&outputBuffer[0], outputBuffer.size());
+      outputFile.open(outputName.c_str(), std::ios::out | std::ios::trunc);
+      if (!outputFile) {
+        std::cerr << "File named \"" << outputName
+                  << "\" cannot be opened.\n";
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::ios::sync_with_stdio(false);
+    /* Stream where points are read. */
+    std::istream &in = (inputName != "-")? inputFile: std::cin;
+    /* Stream where converted points are written. */
+    std::ostream &out = (outputName != "-")? outputFile: std::cout;
+    if (vm.count("world"))
+      Batch::transform(Projection::readWorldFile(vm["world"]
+                                                   .as<std::string>()),
+                       in, out, vm.count("inverse") > 0, projection.get());
+    else
+      convertWithModel(vm["model"].as<std::string>(), points,
+                       vm["grid"].as<std::size_t>(), vm.count("inverse") > 0,
+                       in, out);
+
+    return EXIT_SUCCESS;
+  }
+
+  /**
+   * \brief Command geo-referencing map sheets from their reference points.
+   * \param argc Count of arguments of the command.
+   * \param argv Values of arguments of the command.
+   * \return Program return value, failure if a sheet cannot be
+   * geo-referenced.
+   */
+  int georeferenceMain (int argc, char** argv) {
+    /* Declaring supported options. */
+    po::options_description desc("Options of command \"georeference\"");
+    desc.add_options()
+      ("help,h", "Display this help message.")
+      ("points,p", po::value<std::string>()->default_value(".txt"),
+       "Extension of files of reference points, next to images.")
+      ("report,o", po::value<std::string>()->default_value("-"),
+       "File where the report is written.")
+      ("jobs,j", po::value<unsigned>()->default_value(
+         std::max(std::thread::hardware_concurrency(), 1u)),
+       "Number of sheets processed at once.")
+      ("recursive,R", "Look for images in sub-directories.")
+      ("projection,P", po::value<std::string>()->default_value("geographic"),
+       "Map projection world files lead to, as for command \"transform.\"")
+      ("dry-run,n", "Report residuals without writing world files.");
+    /* Options not displayed in help message. */
+    po::options_description hidden;
+    hidden.add_options()
+      ("sheets", po::value< std::vector<std::string> >(),
+       "Images or directories of images.");
+    /* Command line. */
+    po::options_description cmd;
+    cmd.add(desc).add(hidden);
+    /* Positional options. */
+    po::positional_options_description positional;
+    positional.add("sheets", -1);
+
+    /* Options map. */
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+    options(cmd).positional(positional).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("sheets")) {
+      std::cout << "Fit the world file of each map sheet on its reference "
+                << "points, written as\nthe graphical interface saves them "
+                << "in a file next to the image. World\nfiles are named "
+                << "after images, such as \"sheet.tfw\" for "
+                << "\"sheet.tif.\"\n\n"
+                << "Command : \n\n"
+                << "\tgeodesk georeference [options] <images or "
+                << "directories>\n\n"
+                << desc << '\n';
+      return vm.count("help")? EXIT_SUCCESS: EXIT_FAILURE;
+    }
+
+    /* Map projection. */
+    const Projection::MapProjectionPointer projection =
+      Projection::makeProjection(vm["projection"].as<std::string>());
+    /* Map sheets. */
+    std::vector<Batch::Sheet> sheets;
+    /* Images or directories given. */
+    const std::vector<std::string> &given =
+      vm["sheets"].as< std::vector<std::string> >();
+    for (std::size_t i = 0; i < given.size(); ++i)
+      findSheets(given[i], vm.count("recursive") > 0,
+                 vm["points"].as<std::string>(), sheets);
+
+    Batch::georeference(sheets, vm["jobs"].as<unsigned>(),
+                        vm.count("dry-run") == 0, projection);
+
+    /* Name of the report file. */
+    const std::string reportName = vm["report"].as<std::string>();
+    /* Number of sheets which cannot be geo-referenced. */
+    std::size_t failures;
+    if (reportName == "-") {
+      failures = Batch::writeReport(std::cout, sheets);
+    }
+    else {
+      /* Report file. */
+      std::ofstream report (reportName.c_str(),
+                            std::ios::out | std::ios::trunc);
+      if (!report) {
+        std::cerr << "File named \"" << reportName
+                  << "\" cannot be opened.\n";
+        return EXIT_FAILURE;
+      }
+      failures = Batch::writeReport(report, sheets);
+      std::cout << sheets.size() - failures << " sheets geo-referenced, "
+                << failures << " failed.\n";
+    }
+    return (failures == 0)? EXIT_SUCCESS: EXIT_FAILURE;
+  }
+
+  /**
+   * \brief Read every sample of a text data file.
+   * \param fileName Name of the file.
+   * \param samples Where to add samples.
+   * \return Whether or not the file can be opened.
+   * \exception Text::ParseError A line does not begin with five numbers.
+   */
+  bool readSamples (const std::string &fileName,
+                    std::vector<Data::Sample> &samples) {
+    /* Buffer for the data file. */
+    std::vector<char> buffer (bufferSize);
+    /* Text data file. */
+    std::ifstream file;
+    file.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+    file.open(fileName.c_str());
+    if (!file) return false;
+    /* Reader of the file. */
+    Text::NumberReader reader (file);
+    while (!reader.atEnd()) {
+      /* Sample on the line. */
+      Data::Sample sample;
+      Data::readSample(reader, sample);
+      reader.endLine();
+      samples.push_back(sample);
+    }
+    return true;
+  }
+
+  /**
+   * \brief Command exporting a data file as lines, to GeoJSON, CSV or
+   * Shapefile.
+   * \param argc Count of arguments of the command.
+   * \param argv Values of arguments of the command.
+   * \return Program return value.
+   */
+  int exportMain (int argc, char** argv) {
+    /* Declaring supported options. */
+    po::options_description desc("Options of command \"export\"");
+    desc.add_options()
+      ("help,h", "Display this help message.")
+      ("gap,g", po::value<double>()->default_value(0.),
+       "Greatest distance between two successive samples of a line, in "
+       "pixels of the image; lines are only cut where values change when "
+       "not positive.");
+    /* Options not displayed in help message. */
+    po::options_description hidden;
+    hidden.add_options()
+      ("input", po::value<std::string>(), "Data file, text or binary.")
+      ("output", po::value<std::string>(), "File where lines are written.");
+    /* Command line. */
+    po::options_description cmd;
+    cmd.add(desc).add(hidden);
+    /* Positional options. */
+    po::positional_options_description positional;
+    positional.add("input", 1).add("output", 1);
+
+    /* Options map. */
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+    options(cmd).positional(positional).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("input") || !vm.count("output")) {
+      std::cout << "Write samples of a data file as lines, successive "
+                << "samples of the same value\nforming a line. The format "
+                << "is given by the extension of the output file:\n"
+                << "\".geojson\" or \".json\" for GeoJSON, \".csv\" for "
+                << "comma-separated values, \".shp\"\nfor a Shapefile, "
+                << "whose \".shx\" and \".dbf\" files are written next "
+                << "to it.\n\n"
+                << "Command : \n\n"
+                << "\tgeodesk export [--gap <pixels>] <data file> "
+                << "<output file>\n\n"
+                << desc << '\n';
+      return vm.count("help")? EXIT_SUCCESS: EXIT_FAILURE;
+    }
+
+    /* Name of the data file. */
+    const std::string inputName = vm["input"].as<std::string>();
+    /* Name of the output file. */
+    const std::string outputName = vm["output"].as<std::string>();
+    /* Format of the output file. */
+    const Data::VectorFormat format = Data::vectorFormat(outputName);
+    /* Greatest distance between two samples of a line. */
+    const double gap = vm["gap"].as<double>();
+    /* Number of lines written. */
+    std::size_t lines;
+    if (Data::isBinaryFile(inputName)) {
+      /* Binary data file, read in place. */
+      const Data::BinaryFile file (inputName);
+      lines = Data::VectorExporter (file, gap)
+        .write(outputName, format, [] (int) {return true;});
+    }
+    else {
+      /* Samples of the text data file. */
+      std::vector<Data::Sample> samples;
+      if (!readSamples(inputName, samples)) {
+        std::cerr << "File named \"" << inputName
+                  << "\" cannot be opened.\n";
+        return EXIT_FAILURE;
+      }
+      lines = Data::VectorExporter (samples, gap)
+        .write(outputName, format, [] (int) {return true;});
+    }
+    std::cout << lines << " lines written.\n";
+    return EXIT_SUCCESS;
+  }
+
+  /**
+   * \brief Command interpolating a data file on a regular grid, written as
+   * a GeoTIFF.
+   * \param argc Count of arguments of the command.
+   * \param argv Values of arguments of the command.
+   * \return Program return value.
+   */
+  int gridMain (int argc, char** argv) {
+    /* Declaring supported options. */
+    po::options_description desc("Options of command \"grid\"");
+    desc.add_options()
+      ("help,h", "Display this help message.")
+      ("resolution,r", po::value<double>(),
+       "Side of cells, in degrees.")
+      ("method,m", po::value<std::string>()->default_value("tin"),
+       "Interpolation method: \"tin\", linear in the Delaunay "
+       "triangulation, or \"idw\", inverse distance weighting of the "
+       "nearest samples.")
+      ("radius", po::value<double>()->default_value(16.),
+       "Greatest distance of samples weighted by inverse distance "
+       "weighting, in cells; no limit when not positive.")
+      ("jobs,j", po::value<unsigned>()->default_value(
+         std::max(std::thread::hardware_concurrency(), 1u)),
+       "Number of threads computing the grid.");
+    /* Options not displayed in help message. */
+    po::options_description hidden;
+    hidden.add_options()
+      ("input", po::value<std::string>(), "Data file, text or binary.")
+      ("output", po::value<std::string>(), "GeoTIFF file written.");
+    /* Command line. */
+    po::options_description cmd;
+    cmd.add(desc).add(hidden);
+    /* Positional options. */
+    po::positional_options_description positional;
+    positional.add("input", 1).add("output", 1);
+
+    /* Options map. */
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+    options(cmd).positional(positional).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("input") || !vm.count("output")
+        || !vm.count("resolution")) {
+      std::cout << "Interpolate samples of a data file on a regular grid "
+                << "in longitude and\nlatitude, written as a GeoTIFF of "
+                << "32-bit floats along with its world file.\nCells where "
+                << "nothing is interpolated are set to -9999.\n\n"
+                << "Command : \n\n"
+                << "\tgeodesk grid --resolution <degrees> [options] "
+                << "<data file> <output.tif>\n\n"
+                << desc << '\n';
+      return vm.count("help")? EXIT_SUCCESS: EXIT_FAILURE;
+    }
+
+    /* Name of the data file. */
+    const std::string inputName = vm["input"].as<std::string>();
+    /* Interpolation method. */
+    Data::Gridder::Method method;
+    if (vm["method"].as<std::string>() == "tin")
+      method = Data::Gridder::tinMethod;
+    else if (vm["method"].as<std::string>() == "idw")
+      method = Data::Gridder::idwMethod;
+    else
+      throw std::runtime_error("Interpolation method should be \"tin\" or "
+                               "\"idw\".");
+    /* Side of cells. */
+    const double resolution = vm["resolution"].as<double>();
+    /* The gridder. */
+    std::unique_ptr<Data::Gridder> gridder;
+    if (Data::isBinaryFile(inputName)) {
+      gridder.reset(new Data::Gridder (Data::BinaryFile (inputName)));
+    }
+    else {
+      /* Samples of the text data file. */
+      std::vector<Data::Sample> samples;
+      if (!readSamples(inputName, samples)) {
+        std::cerr << "File named \"" << inputName
+                  << "\" cannot be opened.\n";
+        return EXIT_FAILURE;
+      }
+      gridder.reset(new Data::Gridder (samples));
+    }
+    gridder->write(vm["output"].as<std::string>(), method, resolution,
+                   vm["radius"].as<double>() * resolution,
+                   vm["jobs"].as<unsigned>(), [] (int) {return true;});
+    std::cout << gridder->size() << " samples gridded.\n";
+    return EXIT_SUCCESS;
+  }
+}
+
+/* -- Convert points between image and geographical coordinates. ---------- */
+std::size_t Batch::transform (const Projection::ChangeMatrix &change,
+                              std::istream &in, std::ostream &out,
+                              bool inverse,
+                              const Projection::MapProjection* projection) {
+  return convert(inverse? Projection::inverseChange(change): change,
+                 in, out, projection, inverse);
+}
+
+/* -- Geo-reference map sheets. ------------------------------------------- */
+void Batch::georeference (std::vector<Sheet> &sheets, unsigned jobs,
+                          bool write,
+                          const Projection::MapProjectionPointer
+                            &projection) {
+  /* Index of the next sheet to be processed. */
+  std::atomic<std::size_t> next (0);
+  /* Process sheets until there is none left. */
+  const auto work = [&sheets, &next, write, &projection] () {
+    for (std::size_t i = next++; i < sheets.size(); i = next++)
+      georeferenceSheet(sheets[i], write, projection);
+  };
+
+  /* Number of threads besides the calling one. */
+  const std::size_t helpers =
+    std::min<std::size_t>(std::max(jobs, 1u), sheets.size()) - 1;
+  /* Threads helping the calling one. */
+  std::vector<std::thread> threads;
+  threads.reserve(helpers);
+  for (std::size_t i = 0; i < helpers; ++i)
+    threads.push_back(std::thread (work));
+  work();
+  for (std::size_t i = 0; i < threads.size(); ++i) threads[i].join();
+}
+
+/* -- Write the report of sheets geo-referenced. -------------------------- */
+std::size_t Batch::writeReport (std::ostream &out,
+                                const std::vector<Sheet> &sheets) {
+  /* Previous precision of the stream. */
+  const std::streamsize precision = out.precision(6);
+  /* Number of failures. */
+  std::size_t failures = 0;
+  /* Sheet with the greatest RMS, if any. */
+  const Sheet* worst = 0;
+  out << "# image\tpoints\trms\tmaximum\tworld file or error\n";
+  for (std::size_t i = 0; i < sheets.size(); ++i) {
+    /* The sheet. */
+    const Sheet &sheet = sheets[i];
+    out << sheet.image << '\t' << sheet.count << '\t';
+    if (sheet.error.empty()) {
+      out << sheet.rms << '\t' << sheet.maximumResidual << '\t'
+          << sheet.world << '\n';
+      if (!worst || sheet.rms > worst->rms) worst = &sheet;
+    }
+    else {
+      out << "-\t-\terror: " << sheet.error << '\n';
+      ++failures;
+    }
+  }
+  out << "# " << sheets.size() << " sheets, "
+      << sheets.size() - failures << " geo-referenced, " << failures
+      << " failed.\n";
+  if (worst)
+    out << "# Greatest RMS: " << worst->rms << " (" << worst->image
+        << ").\n";
+  out.precision(precision);
+  return failures;
+}
+
+/* -- Run a command. ------------------------------------------------------ */
+int Batch::run (int argc, char** argv) {
+  /* Name of the command. */
+  const std::string command = argv[1];
+
+  try {
+    if (command == transformCommand)
+      return transformMain(argc - 1, argv + 1);
+    if (command == georeferenceCommand)
+      return georeferenceMain(argc - 1, argv + 1);
+    if (command == exportCommand)
+      return exportMain(argc - 1, argv + 1);
+    if (command == gridCommand)
+      return gridMain(argc - 1, argv + 1);
+  }
+  catch (const std::exception &e) {
+    std::cerr << argv[0] << ' ' << command << ": " << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  std::cerr << "Unknown command \"" << command << "\".\n";
+  return EXIT_FAILURE;
+}
+
+/* -- Check a command name. ----------------------------------------------- */
+bool Batch::isCommand (const std::string &argument) {
+  return argument == transformCommand || argument == georeferenceCommand
+    || argument == exportCommand || argument == gridCommand;
+}
+
+/* -- Describe commands. -------------------------------------------------- */
+std::string Batch::commandsDescription () {
+  return "Supported commands (use \"<command> --help\" for details):\n"
+         "  transform             Convert points from image coordinates to "
+         "geographical\n"
+         "                        coordinates using a world file or "
+         "reference points.\n"
+         "  georeference          Fit world files of map sheets on their "
+         "reference points,\n"
+         "                        in parallel, and report residuals.\n"
+         "  export                Write samples of a data file as lines, "
+         "to GeoJSON, CSV\n"
+         "                        or Shapefile.\n"
+         "  grid                  Interpolate samples of a data file on a "
+         "regular grid,\n"
+         "                        written as a GeoTIFF.\n";
+}
@@ -0,0 +1,127 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+/**
+ * \file batch.hpp
+ * \brief Commands run from the command line, without graphical interface.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "projection.hpp"
+#include "mapprojection.hpp"
+
+/// \brief Namespace for commands run without graphical interface.
+namespace Batch {
+  /**
+   * \brief Convert points from image coordinates to geographical coordinates.
+   * \param change Matrix of referential change.
+   * \param in Stream containing one point "x y" per line.
+   * \param out Stream where lines "x y longitude latitude" are written.
+   * \param inverse Whether to convert geographical coordinates to image
+   * coordinates instead.
+   * \param projection Map projection of the plane the referential change
+   * leads to, null for geographical coordinates.
+   * \return Number of points converted.
+   * \exception std::runtime_error A line cannot be read.
+   * \exception std::domain_error The referential change cannot be inverted.
+   *
+   * Points are converted by chunks, using Projection::transformPoints() and
+   * the batched conversions of the map projection.
+   */
+  std::size_t transform (const Projection::ChangeMatrix &change,
+                         std::istream &in, std::ostream &out,
+                         bool inverse = false,
+                         const Projection::MapProjection* projection = 0);
+
+  /// \brief A map sheet to be geo-referenced, and the result.
+  struct Sheet {
+    /// \brief Name of the image file.
+    std::string image;
+
+    /// \brief Name of the file of reference points.
+    std::string points;
+
+    /// \brief Name of the world file written, empty on failure.
+    std::string world;
+
+    /// \brief Number of reference points.
+    std::size_t count;
+
+    /**
+     * \brief Root mean square of residuals, in units of the plane of the
+     * map projection.
+     */
+    double rms;
+
+    /// \brief Greatest residual, in units of the plane of the projection.
+    double maximumResidual;
+
+    /// \brief Why the sheet cannot be geo-referenced, empty on success.
+    std::string error;
+  };
+
+  /**
+   * \brief Geo-reference map sheets from their reference points, writing
+   * their world files.
+   * \param sheets Sheets whose image and reference points are given, where
+   * results are put.
+   * \param jobs Number of sheets processed at once.
+   * \param write Whether or not to write world files.
+   * \param projection Map projection world files lead to, null for
+   * geographical coordinates.
+   *
+   * Failures are reported in each sheet, they do not stop other sheets.
+   */
+  void georeference (std::vector<Sheet> &sheets, unsigned jobs,
+                     bool write = true,
+                     const Projection::MapProjectionPointer &projection =
+                       Projection::MapProjectionPointer ());
+
+  /**
+   * \brief Write the report of sheets geo-referenced.
+   * \param out Stream where the report is written.
+   * \param sheets Sheets geo-referenced.
+   * \return Number of sheets which could not be geo-referenced.
+   *
+   * Each sheet is described by a line "image points RMS maximum world,"
+   * separated by tabulations, the world file being replaced by the error
+   * on failure. A summary follows, in lines beginning with '#'.
+   */
+  std::size_t writeReport (std::ostream &out,
+                           const std::vector<Sheet> &sheets);
+
+  /**
+   * \brief Run a command given on the command line.
+   * \param argc Count of arguments transmitted to the program.
+   * \param argv Values of arguments transmitted to the program.
+   * \return Program return value.
+   *
+   * The first argument is the name of the command, which is followed by its
+   * own options.
+   */
+  int run (int argc, char** argv);
+
+  /**
+   * \brief Tell whether an argument is the name of a known command.
+   * \param argument Argument given on the command line.
+   * \return True if a command bears this name.
+   */
+  bool isCommand (const std::string &argument);
+
+  /**
+   * \brief Describe commands, to be displayed in help message.
+   * \return Description of every known command.
+   */
+  std::string commandsDescription ();
+}
+
+#endif  // #ifndef BATCH_HPP
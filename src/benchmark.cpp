@@ -0,0 +1,758 @@
+/**
+ * \file benchmark.cpp
+ * \brief Benchmark of core kernels, on fixed synthetic inputs.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ *
+ * Each kernel is run several times and the best time is kept. Results are
+ * written in JSON. When a file of thresholds is given, the program fails if
+ * a kernel is slower than its threshold, so that it can be run by "ctest".
+ * Thresholds are scaled by the time of a calibration kernel, sorting
+ * numbers, relative to its time on the computer where they were set: a
+ * slower or loaded computer is thus given more time.
+ *
+ * Command:
+ *
+ *      geodesk_benchmark [--output results.json] [--thresholds file]
+ *
+ * The file of thresholds contains lines "name seconds", lines beginning
+ * with '#' being comments. Line "calibration seconds" gives the time of the
+ * calibration kernel where thresholds were set, thresholds being used as
+ * they are without it.
+ */
+
+#include <config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <boost/program_options.hpp>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QPoint>
+#include <QThread>
+
+#include "projection.hpp"
+#include "mapprojection.hpp"
+#include "worldfile.hpp"
+#include "numberreader.hpp"
+#include "batch.hpp"
+#include "sample.hpp"
+#include "journal.hpp"
+#include "datafile.hpp"
+#include "vectorexport.hpp"
+#include "gridder.hpp"
+#include "raster.hpp"
+#include "imagepyramid.hpp"
+#include "layerextractor.hpp"
+
+namespace {
+  /// \brief Result of a benchmark.
+  struct Result {
+    /// \brief Name of the kernel.
+    std::string name;
+
+    /// \brief Number of items processed by a run.
+    std::size_t items;
+
+    /// \brief Best time of a run, in seconds.
+    double seconds;
+  };
+
+  /// \brief Number of runs of each kernel, the best one being kept.
+  const int runs = 5;
+
+  /// \brief Number of points in synthetic inputs.
+  const std::size_t pointCount = 1 << 20;
+
+  /// \brief Number of lines in synthetic text files.
+  const std::size_t lineCount = 100000;
+
+  /// \brief Size of the synthetic image.
+  const int imageSize = 4096;
+
+  /// \brief Name of the kernel calibrating thresholds.
+  const char* const calibrationName = "calibration";
+
+  /// \brief Keeps results alive, so that computations are not removed.
+  volatile double sink;
+
+  /**
+   * \brief Run a kernel several times.
+   * \param name Name of the kernel.
+   * \param items Number of items processed by a run.
+   * \param kernel The kernel.
+   * \return Best time of a run.
+   */
+  Result measure (const std::string &name, std::size_t items,
+                  const std::function<void ()> &kernel) {
+    /* Best time of a run. */
+    double best = std::numeric_limits<double>::infinity();
+    kernel();
+    for (int run = 0; run < runs; ++run) {
+      /* Beginning of the run. */
+      const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+      kernel();
+      /* Duration of the run. */
+      const std::chrono::duration<double> duration =
+        std::chrono::steady_clock::now() - start;
+      best = std::min(best, duration.count());
+    }
+    std::clog << name << ": " << best << " s" << std::endl;
+    const Result result = {name, items, best};
+    return result;
+  }
+
+  /**
+   * \brief Pseudo-random number, identical on every platform.
+   * \param state State of the generator, updated.
+   * \return Number in [0, 1).
+   */
+  double uniform (std::uint64_t &state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<double>(state >> 11) / 9007199254740992.;
+  }
+
+  /**
+   * \brief Referential change used by benchmarks.
+   * \return Change of a 4096 pixels wide map of Brittany.
+   */
+  Projection::ChangeMatrix referenceChange () {
+    /* The matrix. */
+    Projection::ChangeMatrix change;
+    change << 2.5e-4, 1.e-6, -5.2,
+              1.e-6, -1.8e-4, 48.9;
+    return change;
+  }
+
+  /**
+   * \brief Synthetic samples.
+   * \param count Number of samples.
+   * \return Samples along a spiral isobath.
+   */
+  std::vector<Data::Sample> syntheticSamples (std::size_t count) {
+    /* Referential change. */
+    const Projection::ChangeMatrix change = referenceChange();
+    /* Samples. */
+    std::vector<Data::Sample> samples (count);
+    for (std::size_t i = 0; i < count; ++i) {
+      /* Angle along the spiral. */
+      const double angle = 1.e-3 * i;
+      /* Position in the image. */
+      const Projection::Point2D image (2048. + 1.e-3 * i * std::cos(angle),
+                                       2048. + 1.e-3 * i * std::sin(angle));
+      /* Position on the map. */
+      const Projection::Point2D geographic =
+        Projection::transformPoint(change, image);
+      samples[i].x = image.x();
+      samples[i].y = image.y();
+      samples[i].longitude = geographic.x();
+      samples[i].latitude = geographic.y();
+      samples[i].value = 5. * (i % 40);
+    }
+    return samples;
+  }
+
+  /**
+   * \brief Benchmark geo-reference computation and conversion of points.
+   * \param results Where to add results.
+   */
+  void benchmarkProjection (std::vector<Result> &results) {
+    /* Referential change. */
+    const Projection::ChangeMatrix change = referenceChange();
+    /* State of the generator. */
+    std::uint64_t state = 1;
+
+    /* Reference points in the image. */
+    std::vector<Projection::Point2D> image;
+    /* Reference points on the map. */
+    std::vector<Projection::Point2D> geographic;
+    for (int i = 0; i < 1000; ++i) {
+      image.push_back(Projection::Point2D (imageSize * uniform(state),
+                                           imageSize * uniform(state)));
+      geographic.push_back(Projection::transformPoint(change, image.back()));
+    }
+    /* First three reference points in the image. */
+    const std::vector<Projection::Point2D> image3 (image.begin(),
+                                                   image.begin() + 3);
+    /* First three reference points on the map. */
+    const std::vector<Projection::Point2D> geographic3 (geographic.begin(),
+                                                        geographic.begin()
+                                                        + 3);
+    results.push_back(measure("compute_coefficients_3", 100000, [&] {
+      for (int i = 0; i < 100000; ++i)
+        sink = Projection::computeCoefficients(image3, geographic3)(0, 0);
+    }));
+    results.push_back(measure("compute_coefficients_1000", 100 * 1000, [&] {
+      for (int i = 0; i < 100; ++i)
+        sink = Projection::computeCoefficients(image, geographic)(0, 0);
+    }));
+
+    /* Abscissae of points. */
+    std::vector<double> x (pointCount);
+    /* Ordinates of points. */
+    std::vector<double> y (pointCount);
+    for (std::size_t i = 0; i < pointCount; ++i) {
+      x[i] = imageSize * uniform(state);
+      y[i] = imageSize * uniform(state);
+    }
+    /* Converted abscissae. */
+    std::vector<double> u (pointCount);
+    /* Converted ordinates. */
+    std::vector<double> v (pointCount);
+    results.push_back(measure("transform_points", pointCount, [&] {
+      Projection::transformPoints(change, x.data(), y.data(), u.data(),
+                                  v.data(), pointCount);
+      sink = u[pointCount / 2];
+    }));
+    results.push_back(measure("inverse_transform_points", pointCount, [&] {
+      Projection::inverseTransformPoints(change, u.data(), v.data(),
+                                         x.data(), y.data(), pointCount);
+      sink = x[pointCount / 2];
+    }));
+
+    /* Universal Transverse Mercator, zone 31 north. */
+    const Projection::MapProjectionPointer utm =
+      Projection::makeProjection("utm:31n");
+    for (std::size_t i = 0; i < pointCount; ++i) {
+      u[i] = 6. * uniform(state);
+      v[i] = 40. + 20. * uniform(state);
+    }
+    results.push_back(measure("utm_forward", pointCount, [&] {
+      utm->forward(u.data(), v.data(), x.data(), y.data(), pointCount);
+      sink = x[pointCount / 2];
+    }));
+    results.push_back(measure("utm_inverse", pointCount, [&] {
+      utm->inverse(x.data(), y.data(), u.data(), v.data(), pointCount);
+      sink = u[pointCount / 2];
+    }));
+    for (std::size_t i = 0; i < pointCount; ++i) {
+      x[i] = imageSize * uniform(state);
+      y[i] = imageSize * uniform(state);
+    }
+
+    /* Text of points converted by the command. */
+    std::ostringstream points;
+    for (std::size_t i = 0; i < lineCount; ++i)
+      points << x[i] << ' ' << y[i] << '\n';
+    /* The text. */
+    const std::string pointText = points.str();
+    results.push_back(measure("transform_command", lineCount, [&] {
+      /* Input of the command. */
+      std::istringstream in (pointText);
+      /* Output of the command. */
+      std::ostringstream out;
+      sink = static_cast<double>(Batch::transform(change, in, out));
+    }));
+
+    /* Positions of the mouse in the widget. */
+    std::vector<QPoint> positions (pointCount);
+    for (std::size_t i = 0; i < pointCount; ++i)
+      positions[i] = QPoint (static_cast<int>(1920 * uniform(state)),
+                             static_cast<int>(1080 * uniform(state)));
+    /* Scale of the displayed image. */
+    const double scale = 0.8;
+    /*
+     * Positions are converted one at a time as the mouse moves, by
+     * ImageView::toImage() then MainBoard::toGeographic(); mapping the
+     * position from the main window to the view is left to Qt and is not
+     * measured.
+     */
+    results.push_back(measure("mouse_position", pointCount, [&] {
+      /* Sum of converted positions. */
+      double sum = 0.;
+      for (std::size_t i = 0; i < pointCount; ++i) {
+        /* Position in the image. */
+        const Projection::Point2D image =
+          Projection::viewToImage(positions[i].x(), positions[i].y(), scale);
+        /* Abscissa, then longitude. */
+        double x = image.x();
+        /* Ordinate, then latitude. */
+        double y = image.y();
+        Projection::imageToGeographic(change, 0, &x, &y, &x, &y, 1);
+        sum += x + y;
+      }
+      sink = sum;
+    }));
+  }
+
+  /**
+   * \brief Benchmark reading and writing text and binary files.
+   * \param results Where to add results.
+   * \param directory Directory for temporary files.
+   */
+  void benchmarkFiles (std::vector<Result> &results,
+                       const std::string &directory) {
+    /* Referential change. */
+    const Projection::ChangeMatrix change = referenceChange();
+    /* Text of a world file. */
+    std::ostringstream world;
+    Projection::writeWorldFile(world, change);
+    /* The text. */
+    const std::string worldText = world.str();
+    results.push_back(measure("world_file_read", 10000, [&] {
+      for (int i = 0; i < 10000; ++i) {
+        /* Stream on the world file. */
+        std::istringstream stream (worldText);
+        sink = Projection::readWorldFile(stream)(0, 2);
+      }
+    }));
+    results.push_back(measure("world_file_write", 10000, [&] {
+      for (int i = 0; i < 10000; ++i) {
+        /* Stream on the world file. */
+        std::ostringstream stream;
+        Projection::writeWorldFile(stream, change);
+        sink = static_cast<double>(stream.tellp());
+      }
+    }));
+
+    /* Synthetic samples. */
+    const std::vector<Data::Sample> samples = syntheticSamples(lineCount);
+    /* Text of a reference point file. */
+    std::ostringstream reference;
+    reference.precision(std::numeric_limits<double>::digits10);
+    for (const Data::Sample &sample: samples)
+      reference << sample.x << ' ' << sample.y << ' ' << sample.longitude
+                << ' ' << sample.latitude << '\n';
+    /* The text. */
+    const std::string referenceText = reference.str();
+    results.push_back(measure("reference_file_read", lineCount, [&] {
+      /* Stream on the file. */
+      std::istringstream stream (referenceText);
+      /* Reader of the file. */
+      Text::NumberReader reader (stream);
+      /* Sum of numbers read. */
+      double sum = 0.;
+      while (!reader.atEnd()) {
+        for (int i = 0; i < 4; ++i) sum += reader.number();
+        reader.endLine();
+      }
+      sink = sum;
+    }));
+
+    /* Text of a data file. */
+    std::string dataText;
+    results.push_back(measure("data_text_write", lineCount, [&] {
+      /* Stream on the file. */
+      std::ostringstream stream;
+      for (const Data::Sample &sample: samples)
+        Data::writeSample(stream, sample);
+      dataText = stream.str();
+    }));
+    results.push_back(measure("data_text_read", lineCount, [&] {
+      /* Stream on the file. */
+      std::istringstream stream (dataText);
+      /* Reader of the file. */
+      Text::NumberReader reader (stream);
+      /* Sample read. */
+      Data::Sample sample = Data::Sample ();
+      while (!reader.atEnd()) {
+        Data::readSample(reader, sample);
+        reader.endLine();
+      }
+      sink = sample.value;
+    }));
+
+    /* Name of the binary data file. */
+    const std::string binaryName = directory + "/benchmark.gdd";
+    /* Quantization used by the graphical interface. */
+    const Data::Steps steps = {{1e-3, 1e-3, 1e-7, 1e-7, 1e-3}};
+    results.push_back(measure("data_binary_write", lineCount, [&] {
+      Data::writeBinaryFile(binaryName, samples, steps, &change);
+    }));
+    results.push_back(measure("data_binary_read", lineCount, [&] {
+      /* The file. */
+      const Data::BinaryFile file (binaryName);
+      /* Samples read. */
+      std::vector<Data::Sample> read;
+      file.read(read);
+      sink = read.back().value;
+    }));
+    std::remove(binaryName.c_str());
+
+    /* Samples along isobaths of a thousand samples. */
+    std::vector<Data::Sample> isobaths = samples;
+    for (std::size_t i = 0; i < isobaths.size(); ++i)
+      isobaths[i].value = 5. * (i / 1000 % 40);
+    /* The exporter. */
+    const Data::VectorExporter exporter (isobaths, 0.);
+    /* Name of the GeoJSON file. */
+    const std::string geoJsonName = directory + "/benchmark.geojson";
+    results.push_back(measure("export_geojson", lineCount, [&] {
+      sink = static_cast<double>(exporter.write(geoJsonName,
+                                                Data::geoJsonFormat,
+                                                [] (int) {return true;}));
+    }));
+    std::remove(geoJsonName.c_str());
+    /* Name of the Shapefile. */
+    const std::string shapeName = directory + "/benchmark.shp";
+    results.push_back(measure("export_shapefile", lineCount, [&] {
+      sink = static_cast<double>(exporter.write(shapeName,
+                                                Data::shapefileFormat,
+                                                [] (int) {return true;}));
+    }));
+    std::remove(shapeName.c_str());
+    std::remove((directory + "/benchmark.shx").c_str());
+    std::remove((directory + "/benchmark.dbf").c_str());
+
+    /* Name of the grid. */
+    const std::string gridName = directory + "/benchmark.tif";
+    /* Side of cells, about 2 pixels of the image. */
+    const double resolution = 5.e-4;
+    /* Number of threads. */
+    const unsigned threads =
+      static_cast<unsigned>(std::max(QThread::idealThreadCount(), 1));
+    results.push_back(measure("grid_tin", lineCount, [&] {
+      /* The gridder, triangulating samples again. */
+      Data::Gridder gridder (isobaths);
+      sink = gridder.write(gridName, Data::Gridder::tinMethod, resolution,
+                           0., threads, [] (int) {return true;});
+    }));
+    results.push_back(measure("grid_idw", lineCount, [&] {
+      /* The gridder, sorting samples again. */
+      Data::Gridder gridder (isobaths);
+      sink = gridder.write(gridName, Data::Gridder::idwMethod, resolution,
+                           16. * resolution, threads,
+                           [] (int) {return true;});
+    }));
+    std::remove(gridName.c_str());
+    std::remove((directory + "/benchmark.tfw").c_str());
+
+    /* Name of the journal. */
+    const std::string journalName = directory + "/benchmark.journal";
+    results.push_back(measure("journal_append", lineCount, [&] {
+      std::remove(journalName.c_str());
+      /* The journal. */
+      Data::Journal journal (journalName);
+      for (const Data::Sample &sample: samples) journal.append(sample);
+      journal.flush();
+    }));
+    std::remove(journalName.c_str());
+    std::remove((journalName + ".lock").c_str());
+  }
+
+  /**
+   * \brief Benchmark opening and zooming an image.
+   * \param results Where to add results.
+   * \param directory Directory for temporary files.
+   */
+  void benchmarkImage (std::vector<Result> &results,
+                       const QString &directory) {
+    /* Name of the synthetic image. */
+    const QString fileName = directory + "/benchmark.bmp";
+    /* Name of the synthetic image, compressed. */
+    const QString jpegName = directory + "/benchmark.jpg";
+    /* Whether or not the compressed image has been written. */
+    bool compressed;
+    {
+      /* The image, a smooth gradient with a grid. */
+      QImage image (imageSize, imageSize, QImage::Format_RGB32);
+      for (int y = 0; y < imageSize; ++y) {
+        /* Pixels of the row. */
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < imageSize; ++x) {
+          line[x] = ((x % 64 == 0) || (y % 64 == 0))? qRgb(0, 0, 0):
+            qRgb(x / 16, y / 16, (x + y) / 32);
+        }
+      }
+      if (!image.save(fileName, "BMP")) {
+        std::cerr << "Cannot write the synthetic image." << std::endl;
+        return;
+      }
+      compressed = image.save(jpegName, "JPG", 90);
+    }
+
+    /* Number of pixels of the image. */
+    const std::size_t pixels =
+      static_cast<std::size_t>(imageSize) * imageSize;
+    /* Levels kept in memory. */
+    GUI::ImagePyramid::Levels levels;
+    /* The image, opened. */
+    Raster::SourcePointer source;
+    results.push_back(measure("image_open", pixels, [&] {
+      source = Raster::open(fileName);
+      /* Pyramid of the image. */
+      const GUI::ImagePyramid pyramid (source);
+      levels = pyramid.buildLevels(Raster::Progress ());
+    }));
+
+    /* Size of the viewport. */
+    const QSize viewport (1920, 1080);
+    results.push_back(measure("image_zoom", 4, [&] {
+      /* Pyramid of the image. */
+      GUI::ImagePyramid pyramid (source);
+      /* Copy of levels, sharing pixels. */
+      GUI::ImagePyramid::Levels copy = levels;
+      pyramid.setLevels(copy);
+      /* Number of tiles drawn. */
+      int drawn = 0;
+      for (double scale = 1.; scale > 0.1; scale /= 2.) {
+        /* Level displayed. */
+        const int level = pyramid.levelForScale(scale);
+        /* Size of a level pixel on screen. */
+        const double pixel = scale * (1 << level);
+        /* Size of the level. */
+        const QSize size = pyramid.levelSize(level);
+        /* Width of the viewport in pixels of the level. */
+        const int width = static_cast<int>(viewport.width() / pixel);
+        /* Height of the viewport in pixels of the level. */
+        const int height = static_cast<int>(viewport.height() / pixel);
+        /* Viewport in pixels of the level, at the center of the image. */
+        const QRect area =
+          QRect ((size.width() - width) / 2, (size.height() - height) / 2,
+                 width, height).intersected(QRect (QPoint (0, 0), size));
+        for (int row = area.top() / GUI::ImagePyramid::tileSize;
+             row <= area.bottom() / GUI::ImagePyramid::tileSize; ++row) {
+          for (int column = area.left() / GUI::ImagePyramid::tileSize;
+               column <= area.right() / GUI::ImagePyramid::tileSize;
+               ++column) {
+            drawn += pyramid.tile(level, column, row).width() > 0;
+          }
+        }
+      }
+      sink = drawn;
+    }));
+
+    if (compressed) {
+      results.push_back(measure("image_preview", pixels, [&] {
+        /* Size of the image at full resolution. */
+        QSize size;
+        sink = Raster::readPreview(jpegName, QSize (1024, 1024), size)
+          .width();
+      }));
+      QFile::remove(jpegName);
+    }
+    else {
+      std::cerr << "Cannot write the compressed synthetic image."
+                << std::endl;
+    }
+
+    source.reset();
+    QFile::remove(fileName);
+  }
+
+  /**
+   * \brief Benchmark extracting a layer from an image.
+   * \param results Where to add results.
+   */
+  void benchmarkLayer (std::vector<Result> &results) {
+    /* Number of pixels of the image. */
+    const std::size_t pixels =
+      static_cast<std::size_t>(imageSize) * imageSize;
+    /* The image, concentric circles three pixels wide, with noise. */
+    std::vector<std::uint32_t> image (pixels, 0xffffffffu);
+    /* State of the generator. */
+    std::uint64_t state = 42;
+    for (int y = 0; y < imageSize; ++y)
+      for (int x = 0; x < imageSize; ++x) {
+        /* Distance to the centre. */
+        const double r = std::hypot(x - imageSize / 2., y - imageSize / 2.);
+        /* Pixel of the image. */
+        std::uint32_t &pixel =
+          image[static_cast<std::size_t>(y) * imageSize + x];
+        if (std::fmod(r, 128.) < 3.) pixel = 0xff1060c0u;
+        else if (uniform(state) < .001) pixel = 0xff1060c0u;
+      }
+
+    /* Reader of rows of the image. */
+    const GUI::LayerExtractor::BandReader reader =
+      [&image] (int top, int count, std::uint32_t* out) {
+        std::copy(image.begin() + static_cast<std::size_t>(top) * imageSize,
+                  image.begin() + static_cast<std::size_t>(top + count)
+                                  * imageSize, out);
+      };
+    /* The extractor. */
+    const GUI::LayerExtractor extractor (reader, imageSize, imageSize,
+                                         0xff1060c0u, 40, 10., 200);
+    /* Number of threads. */
+    const unsigned threads =
+      static_cast<unsigned>(std::max(QThread::idealThreadCount(), 1));
+    results.push_back(measure("layer_extract", pixels, [&] {
+      sink = static_cast<double>(extractor.extract(threads,
+                                                   [] (int) {return true;})
+                                   .size());
+    }));
+  }
+
+  /**
+   * \brief Measure the speed of the computer, by sorting numbers.
+   * \param results Where to add the result.
+   */
+  void calibrate (std::vector<Result> &results) {
+    /* State of the generator. */
+    std::uint64_t state = 1;
+    /* Numbers to be sorted. */
+    std::vector<double> numbers (pointCount);
+    for (double &number: numbers) number = uniform(state);
+    results.push_back(measure(calibrationName, pointCount, [&] {
+      /* Numbers sorted. */
+      std::vector<double> sorted (numbers);
+      std::sort(sorted.begin(), sorted.end());
+      sink = sorted[pointCount / 2];
+    }));
+  }
+
+  /**
+   * \brief Write results in JSON.
+   * \param stream Where to write.
+   * \param results Results of benchmarks.
+   */
+  void writeJson (std::ostream &stream, const std::vector<Result> &results) {
+    stream.precision(6);
+    stream << "{\n  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      stream << ((i > 0)? ",\n": "\n")
+             << "    {\"name\": \"" << results[i].name
+             << "\", \"items\": " << results[i].items
+             << ", \"seconds\": " << results[i].seconds
+             << ", \"items_per_second\": "
+             << results[i].items / results[i].seconds << '}';
+    }
+    stream << "\n  ]\n}\n";
+  }
+
+  /**
+   * \brief Read thresholds.
+   * \param fileName Name of the file of thresholds.
+   * \return Maximum time of each kernel, in seconds.
+   * \exception std::runtime_error The file cannot be read.
+   */
+  std::map<std::string, double> readThresholds (const std::string &fileName) {
+    /* The file. */
+    std::ifstream file (fileName.c_str());
+    if (!file)
+      throw std::runtime_error("File of thresholds \"" + fileName
+                               + "\" cannot be opened.");
+    /* Thresholds read. */
+    std::map<std::string, double> thresholds;
+    /* Line of the file. */
+    std::string line;
+    while (std::getline(file, line)) {
+      /* Stream on the line. */
+      std::istringstream lineStream (line);
+      /* Name of the kernel. */
+      std::string name;
+      /* Threshold of the kernel. */
+      double seconds;
+      if (!(lineStream >> name) || name[0] == '#') continue;
+      if (!(lineStream >> seconds))
+        throw std::runtime_error("Invalid threshold for \"" + name + "\".");
+      thresholds[name] = seconds;
+    }
+    return thresholds;
+  }
+
+  /**
+   * \brief Run benchmarks.
+   * \param argc Count of arguments transmitted to the program.
+   * \param argv Values of arguments transmitted to the program.
+   * \return Program return value.
+   */
+  int benchmarkMain (int argc, char** argv) {
+    namespace po = boost::program_options;
+
+    /* Declaring supported options. */
+    po::options_description desc("Options");
+    desc.add_options()
+      ("help,h", "Display this help message.")
+      ("output,o", po::value<std::string>(),
+       "File where results are written in JSON, standard output by default.")
+      ("thresholds,t", po::value<std::string>(),
+       "File giving the maximum time of kernels.");
+    /* Map of options. */
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return 0;
+    }
+
+    /* Images need Qt to be initialised. */
+    const QCoreApplication app (argc, argv);
+    /* Directory for temporary files. */
+    const QString directory = QDir::tempPath();
+
+    /* Results of benchmarks. */
+    std::vector<Result> results;
+    calibrate(results);
+    benchmarkProjection(results);
+    benchmarkFiles(results, QFile::encodeName(directory).constData());
+    benchmarkImage(results, directory);
+    benchmarkLayer(results);
+
+    if (vm.count("output")) {
+      /* File of results. */
+      std::ofstream output (vm["output"].as<std::string>().c_str());
+      writeJson(output, results);
+    }
+    else {
+      writeJson(std::cout, results);
+    }
+
+    if (!vm.count("thresholds")) return 0;
+    /* Maximum time of kernels. */
+    const std::map<std::string, double> thresholds =
+      readThresholds(vm["thresholds"].as<std::string>());
+    /* Time of calibration where thresholds were set. */
+    const std::map<std::string, double>::const_iterator calibration =
+      thresholds.find(calibrationName);
+    /* How much slower this computer is. */
+    const double slowdown = (calibration != thresholds.end())?
+      results.front().seconds / calibration->second: 1.;
+    std::clog << "Thresholds scaled by " << slowdown << '.' << std::endl;
+    /* Whether every kernel is fast enough. */
+    bool passed = true;
+    for (const Result &result: results) {
+      /* Threshold of the kernel. */
+      const std::map<std::string, double>::const_iterator threshold =
+        thresholds.find(result.name);
+      if (threshold == thresholds.end() || threshold == calibration)
+        continue;
+      /* Maximum time on this computer. */
+      const double limit = threshold->second * slowdown;
+      if (result.seconds > limit) {
+        std::cerr << result.name << " took " << result.seconds
+                  << " s, threshold is " << limit << " s." << std::endl;
+        passed = false;
+      }
+    }
+    return passed? 0: 1;
+  }
+}
+
+/**
+ * \brief Main function of the benchmark.
+ * \param argc Count of arguments transmitted to the program.
+ * \param argv Values of arguments transmitted to the program.
+ * \return 0 if every kernel is faster than its threshold, 1 if a kernel is
+ * too slow, 2 on error.
+ *
+ * The Boost execution monitor is not used, so that nothing but results is
+ * written on the standard output.
+ */
+int main (int argc, char** argv) {
+  try {
+    return benchmarkMain(argc, argv);
+  }
+  catch (const std::exception &error) {
+    std::cerr << argv[0] << ": " << error.what() << std::endl;
+    return 2;
+  }
+}
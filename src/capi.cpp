@@ -0,0 +1,299 @@
+/**
+ * \file capi.cpp
+ * \brief Implementation of the C interface of the GeoDesk core library.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <new>
+#include <vector>
+#include <stdexcept>
+
+#include "geodesk.h"
+#include "projection.hpp"
+#include "worldfile.hpp"
+#include "referencepoints.hpp"
+#include "datafile.hpp"
+
+/// \brief Referential change given to C callers.
+struct geodesk_change {
+  /// \brief Matrix of referential change.
+  Projection::ChangeMatrix forward;
+
+  /// \brief Matrix of the inverse referential change, when it exists.
+  Projection::ChangeMatrix inverse;
+
+  /// \brief Whether or not the inverse referential change exists.
+  bool invertible;
+};
+
+/// \brief Binary data file given to C callers.
+struct geodesk_data_file {
+  /**
+   * \brief Map the file.
+   * \param fileName Name of the file.
+   */
+  explicit geodesk_data_file (const char* fileName): file (fileName) {}
+
+  /// \brief The file itself.
+  Data::BinaryFile file;
+};
+
+namespace {
+  /**
+   * \brief Run an operation, translating exceptions into a status.
+   * \param operation The operation.
+   * \return Status of the operation.
+   *
+   * Domain errors come from degenerated reference points, other runtime
+   * errors from files.
+   */
+  template <typename Operation>
+  geodesk_status guard (Operation operation) {
+    try {
+      operation();
+      return GEODESK_OK;
+    }
+    catch (const std::bad_alloc &) {
+      return GEODESK_OUT_OF_MEMORY;
+    }
+    catch (const std::domain_error &) {
+      return GEODESK_DEGENERATE;
+    }
+    catch (const std::exception &) {
+      return GEODESK_FILE_ERROR;
+    }
+    catch (...) {
+      return GEODESK_FILE_ERROR;
+    }
+  }
+
+  /**
+   * \brief Create a referential change given to C callers.
+   * \param matrix Matrix of referential change.
+   * \return The new referential change.
+   * \exception std::bad_alloc Memory cannot be allocated.
+   */
+  geodesk_change* newChange (const Projection::ChangeMatrix &matrix) {
+    /* The new referential change. */
+    geodesk_change* change = new geodesk_change;
+    change->forward = matrix;
+    try {
+      change->inverse = Projection::inverseChange(matrix);
+      change->invertible = true;
+    }
+    catch (const std::domain_error &) {
+      change->invertible = false;
+    }
+    return change;
+  }
+
+  /**
+   * \brief Apply a referential change to interleaved coordinates, in place.
+   * \param change Matrix of referential change.
+   * \param xy Abscissa then ordinate of each point.
+   * \param n Number of points.
+   */
+  void transformInterleaved (const Projection::ChangeMatrix &change,
+                             double* xy, std::size_t n) {
+    /* Coefficients of the referential change, kept in registers. */
+    const double a = change(0, 0);
+    const double b = change(0, 1);
+    const double c = change(0, 2);
+    const double d = change(1, 0);
+    const double e = change(1, 1);
+    const double f = change(1, 2);
+
+    for (std::size_t i = 0; i < n; ++i) {
+      /* Abscissa of the current point. */
+      const double x = xy[2 * i];
+      /* Ordinate of the current point. */
+      const double y = xy[2 * i + 1];
+      xy[2 * i] = a * x + b * y + c;
+      xy[2 * i + 1] = d * x + e * y + f;
+    }
+  }
+}
+
+/* -- Version of the library. --------------------------------------------- */
+int geodesk_api_version () {
+  return GEODESK_API_VERSION;
+}
+
+/* -- Description of a status. -------------------------------------------- */
+const char* geodesk_status_string (geodesk_status status) {
+  switch (status) {
+    case GEODESK_OK:
+      return "Success.";
+    case GEODESK_INVALID_ARGUMENT:
+      return "Invalid argument.";
+    case GEODESK_FILE_ERROR:
+      return "File cannot be opened, read or written, or is invalid.";
+    case GEODESK_DEGENERATE:
+      return "Reference points do not define an affine transformation.";
+    case GEODESK_NOT_INVERTIBLE:
+      return "Referential change cannot be inverted.";
+    case GEODESK_OUT_OF_MEMORY:
+      return "Memory cannot be allocated.";
+  }
+  return "Unknown status.";
+}
+
+/* -- Create a referential change from its coefficients. ------------------ */
+geodesk_status geodesk_change_create (const double coefficients [6],
+                                      geodesk_change** change) {
+  if (!coefficients || !change) return GEODESK_INVALID_ARGUMENT;
+  return guard([&] () {
+      /* Matrix of referential change. */
+      Projection::ChangeMatrix matrix;
+      for (int i = 0; i < 6; ++i) matrix(i % 2, i / 2) = coefficients[i];
+      *change = newChange(matrix);
+    });
+}
+
+/* -- Create a referential change from a world file. ---------------------- */
+geodesk_status geodesk_change_read_world_file (const char* file_name,
+                                               geodesk_change** change) {
+  if (!file_name || !change) return GEODESK_INVALID_ARGUMENT;
+  return guard([&] () {
+      *change = newChange(Projection::readWorldFile(std::string(file_name)));
+    });
+}
+
+/* -- Fit a referential change on reference points. ----------------------- */
+geodesk_status geodesk_change_fit (const double* x, const double* y,
+                                   const double* longitude,
+                                   const double* latitude, size_t n,
+                                   geodesk_change** change, double* rms) {
+  if (!x || !y || !longitude || !latitude || !change)
+    return GEODESK_INVALID_ARGUMENT;
+  return guard([&] () {
+      /* Fit on given points. */
+      Projection::AffineFit fit;
+      for (size_t i = 0; i < n; ++i)
+        fit.add(Projection::Point2D (x[i], y[i]),
+                Projection::Point2D (longitude[i], latitude[i]));
+      /* Matrix of referential change. */
+      const Projection::ChangeMatrix matrix = fit.coefficients().transpose();
+      if (rms) *rms = fit.rms();
+      *change = newChange(matrix);
+    });
+}
+
+/* -- Fit a referential change on a reference point file. ----------------- */
+geodesk_status geodesk_change_read_reference_points (const char* file_name,
+                                                     geodesk_change** change,
+                                                     double* rms) {
+  if (!file_name || !change) return GEODESK_INVALID_ARGUMENT;
+  return guard([&] () {
+      /* Reference points in the file. */
+      Projection::ReferencePoints points;
+      points.read(file_name);
+      /* Matrix of referential change. */
+      const Projection::ChangeMatrix matrix = points.change();
+      if (rms) *rms = points.fit().rms();
+      *change = newChange(matrix);
+    });
+}
+
+/* -- Write a referential change as a world file. ------------------------- */
+geodesk_status geodesk_change_write_world_file (const geodesk_change* change,
+                                                const char* file_name) {
+  if (!change || !file_name) return GEODESK_INVALID_ARGUMENT;
+  return guard([&] () {
+      Projection::writeWorldFile(std::string(file_name), change->forward);
+    });
+}
+
+/* -- Coefficients of a referential change. ------------------------------- */
+geodesk_status geodesk_change_coefficients (const geodesk_change* change,
+                                            double coefficients [6]) {
+  if (!change || !coefficients) return GEODESK_INVALID_ARGUMENT;
+  for (int i = 0; i < 6; ++i) coefficients[i] = change->forward(i % 2, i / 2);
+  return GEODESK_OK;
+}
+
+/* -- Release a referential change. --------------------------------------- */
+void geodesk_change_free (geodesk_change* change) {
+  delete change;
+}
+
+/* -- Convert image coordinates into geographical coordinates. ------------ */
+geodesk_status geodesk_transform (const geodesk_change* change,
+                                  double* x, double* y, size_t n) {
+  if (!change || (n > 0 && (!x || !y))) return GEODESK_INVALID_ARGUMENT;
+  Projection::transformPoints(change->forward, x, y, x, y, n);
+  return GEODESK_OK;
+}
+
+/* -- Convert geographical coordinates into image coordinates. ------------ */
+geodesk_status geodesk_inverse_transform (const geodesk_change* change,
+                                          double* x, double* y, size_t n) {
+  if (!change || (n > 0 && (!x || !y))) return GEODESK_INVALID_ARGUMENT;
+  if (!change->invertible) return GEODESK_NOT_INVERTIBLE;
+  Projection::transformPoints(change->inverse, x, y, x, y, n);
+  return GEODESK_OK;
+}
+
+/* -- Convert interleaved image coordinates. ------------------------------ */
+geodesk_status geodesk_transform_interleaved (const geodesk_change* change,
+                                              double* xy, size_t n) {
+  if (!change || (n > 0 && !xy)) return GEODESK_INVALID_ARGUMENT;
+  transformInterleaved(change->forward, xy, n);
+  return GEODESK_OK;
+}
+
+/* -- Convert interleaved geographical coordinates. ----------------------- */
+geodesk_status
+geodesk_inverse_transform_interleaved (const geodesk_change* change,
+                                       double* xy, size_t n) {
+  if (!change || (n > 0 && !xy)) return GEODESK_INVALID_ARGUMENT;
+  if (!change->invertible) return GEODESK_NOT_INVERTIBLE;
+  transformInterleaved(change->inverse, xy, n);
+  return GEODESK_OK;
+}
+
+/* -- Map a binary data file. --------------------------------------------- */
+geodesk_status geodesk_data_file_open (const char* file_name,
+                                       geodesk_data_file** file) {
+  if (!file_name || !file) return GEODESK_INVALID_ARGUMENT;
+  return guard([&] () {*file = new geodesk_data_file (file_name);});
+}
+
+/* -- Number of samples of a binary data file. ---------------------------- */
+size_t geodesk_data_file_size (const geodesk_data_file* file) {
+  return file? file->file.size(): 0;
+}
+
+/* -- Referential change given by a binary data file. --------------------- */
+geodesk_status geodesk_data_file_change (const geodesk_data_file* file,
+                                         geodesk_change** change) {
+  if (!file || !change) return GEODESK_INVALID_ARGUMENT;
+  if (!file->file.hasChange()) return GEODESK_FILE_ERROR;
+  return guard([&] () {*change = newChange(file->file.change());});
+}
+
+/* -- Values of a column stored as doubles. ------------------------------- */
+const double* geodesk_data_file_values (const geodesk_data_file* file,
+                                        geodesk_column column) {
+  if (!file || column < GEODESK_X || column > GEODESK_VALUE) return 0;
+  return file->file.values(static_cast<Data::Column>(column));
+}
+
+/* -- Read values of a column. -------------------------------------------- */
+geodesk_status geodesk_data_file_read (const geodesk_data_file* file,
+                                       geodesk_column column, size_t first,
+                                       size_t n, double* destination) {
+  if (!file || column < GEODESK_X || column > GEODESK_VALUE
+      || first > file->file.size() || n > file->file.size() - first
+      || (n > 0 && !destination))
+    return GEODESK_INVALID_ARGUMENT;
+  file->file.read(static_cast<Data::Column>(column), first, n, destination);
+  return GEODESK_OK;
+}
+
+/* -- Unmap a binary data file. ------------------------------------------- */
+void geodesk_data_file_close (geodesk_data_file* file) {
+  delete file;
+}
@@ -0,0 +1,425 @@
+/**
+ * \file datafile.cpp
+ * \brief Implementation of binary columnar data files.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <stdexcept>
+
+#include "datafile.hpp"
+
+namespace {
+  /// \brief First bytes of binary data files.
+  const char magic [8] = {'G', 'E', 'O', 'D', 'E', 'S', 'K', 'D'};
+
+  /// \brief Version of the format.
+  const std::uint32_t formatVersion = 1;
+
+  /// \brief Flag telling the referential change is known.
+  const std::uint32_t changeFlag = 1;
+
+  /// \brief Header of binary data files.
+  struct FileHeader {
+    /// \brief First bytes of the file.
+    char magic [8];
+
+    /// \brief Version of the format.
+    std::uint32_t version;
+
+    /// \brief Flags.
+    std::uint32_t flags;
+
+    /// \brief Number of samples.
+    std::uint64_t count;
+
+    /// \brief Referential change, in world file order.
+    double change [6];
+  };
+
+  /// \brief Description of a column in binary data files.
+  struct ColumnHeader {
+    /// \brief How the column is stored.
+    std::uint32_t encoding;
+
+    /// \brief Unused, zero.
+    std::uint32_t reserved;
+
+    /// \brief Quantization step.
+    double step;
+
+    /// \brief Value corresponding to quantized value 0.
+    double origin;
+
+    /// \brief Position of the column in the file.
+    std::uint64_t offset;
+
+    /// \brief Size of the column in bytes.
+    std::uint64_t size;
+  };
+
+  /// \brief Size of headers.
+  const std::size_t headerSize =
+    sizeof(FileHeader) + Data::columnCount * sizeof(ColumnHeader);
+
+  /// \brief Member of samples corresponding to each column.
+  double Data::Sample::* const members [Data::columnCount] = {
+    &Data::Sample::x, &Data::Sample::y, &Data::Sample::longitude,
+    &Data::Sample::latitude, &Data::Sample::value
+  };
+
+  /// \brief Whether the host stores numbers in little-endian order.
+  bool littleEndian () {
+    /* A number whose first byte is not zero in little-endian order. */
+    const std::uint16_t one = 1;
+    /* First byte of the number. */
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+  }
+
+  /**
+   * \brief Round a size up to a multiple of 8.
+   * \param size The size.
+   * \return The size rounded.
+   */
+  std::uint64_t align (std::uint64_t size) {
+    return (size + 7) & ~static_cast<std::uint64_t>(7);
+  }
+
+  /**
+   * \brief Number of blocks in a delta column.
+   * \param count Number of values.
+   * \return Number of absolute values.
+   */
+  std::uint64_t blocks (std::uint64_t count) {
+    return (count + Data::blockSize - 1) / Data::blockSize;
+  }
+
+  /**
+   * \brief Size of a column.
+   * \param encoding How the column is stored.
+   * \param count Number of values.
+   * \return Size in bytes.
+   */
+  std::uint64_t columnSize (Data::Encoding encoding, std::uint64_t count) {
+    switch (encoding) {
+      case Data::quantized32: return 4 * count;
+      case Data::delta16: return 4 * blocks(count) + 2 * count;
+      default: return 8 * count;
+    }
+  }
+
+  /**
+   * \brief Choose how a column is stored.
+   * \param samples Samples to be written.
+   * \param member Member of samples in the column.
+   * \param step Quantization step requested.
+   * \return Description of the column, without its position.
+   */
+  ColumnHeader planColumn (const std::vector<Data::Sample> &samples,
+                           double Data::Sample::* member, double step) {
+    /* Description of the column. */
+    ColumnHeader header = ColumnHeader ();
+    header.encoding = Data::float64;
+    header.size = columnSize(Data::float64, samples.size());
+    if (!(step > 0.) || samples.empty()) return header;
+
+    /* Smallest value. */
+    double minimum = samples.front().*member;
+    /* Greatest value. */
+    double maximum = minimum;
+    for (const Data::Sample &sample: samples) {
+      /* Value in the column. */
+      const double value = sample.*member;
+      if (!std::isfinite(value)) return header;
+      minimum = std::min(minimum, value);
+      maximum = std::max(maximum, value);
+    }
+    if (!((maximum - minimum) / step
+          < static_cast<double>(std::numeric_limits<std::int32_t>::max())))
+      return header;
+
+    header.encoding = Data::delta16;
+    header.step = step;
+    header.origin = minimum;
+    /* Previous quantized value. */
+    long long previous = 0;
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+      /* Quantized value. */
+      const long long current =
+        std::llround((samples[i].*member - minimum) / step);
+      if (i % Data::blockSize != 0
+          && std::abs(current - previous)
+             > std::numeric_limits<std::int16_t>::max()) {
+        header.encoding = Data::quantized32;
+        break;
+      }
+      previous = current;
+    }
+    header.size = columnSize(static_cast<Data::Encoding>(header.encoding),
+                             samples.size());
+    return header;
+  }
+
+  /**
+   * \brief Write a column.
+   * \param file Stream on the file.
+   * \param samples Samples to be written.
+   * \param member Member of samples in the column.
+   * \param header Description of the column.
+   */
+  void writeColumn (std::ostream &file,
+                    const std::vector<Data::Sample> &samples,
+                    double Data::Sample::* member,
+                    const ColumnHeader &header) {
+    /* Number of samples. */
+    const std::size_t count = samples.size();
+    if (header.encoding == Data::float64) {
+      /* Values written at once. */
+      std::vector<double> buffer;
+      buffer.reserve(Data::blockSize);
+      for (std::size_t first = 0; first < count; first += Data::blockSize) {
+        buffer.clear();
+        for (std::size_t i = first;
+             i < std::min(first + Data::blockSize, count); ++i)
+          buffer.push_back(samples[i].*member);
+        file.write(reinterpret_cast<const char*>(buffer.data()),
+                   buffer.size() * sizeof(double));
+      }
+      return;
+    }
+
+    /* Quantized value of a sample. */
+    const auto quantize = [&] (std::size_t i) {
+      return static_cast<std::int32_t>(
+        std::llround((samples[i].*member - header.origin) / header.step));
+    };
+    if (header.encoding == Data::quantized32) {
+      /* Values written at once. */
+      std::vector<std::int32_t> buffer;
+      buffer.reserve(Data::blockSize);
+      for (std::size_t first = 0; first < count; first += Data::blockSize) {
+        buffer.clear();
+        for (std::size_t i = first;
+             i < std::min(first + Data::blockSize, count); ++i)
+          buffer.push_back(quantize(i));
+        file.write(reinterpret_cast<const char*>(buffer.data()),
+                   buffer.size() * sizeof(std::int32_t));
+      }
+      return;
+    }
+
+    /* Absolute values beginning blocks. */
+    std::vector<std::int32_t> starts;
+    starts.reserve(blocks(count));
+    for (std::size_t first = 0; first < count; first += Data::blockSize)
+      starts.push_back(quantize(first));
+    file.write(reinterpret_cast<const char*>(starts.data()),
+               starts.size() * sizeof(std::int32_t));
+    /* Differences written at once. */
+    std::vector<std::int16_t> buffer;
+    buffer.reserve(Data::blockSize);
+    for (std::size_t first = 0; first < count; first += Data::blockSize) {
+      buffer.clear();
+      buffer.push_back(0);
+      /* Previous quantized value. */
+      std::int32_t previous = starts[first / Data::blockSize];
+      for (std::size_t i = first + 1;
+           i < std::min(first + Data::blockSize, count); ++i) {
+        /* Quantized value. */
+        const std::int32_t current = quantize(i);
+        buffer.push_back(static_cast<std::int16_t>(current - previous));
+        previous = current;
+      }
+      file.write(reinterpret_cast<const char*>(buffer.data()),
+                 buffer.size() * sizeof(std::int16_t));
+    }
+  }
+}
+
+/* -- Tell whether a file is a binary data file. -------------------------- */
+bool Data::isBinaryFile (const std::string &fileName) {
+  /* The file. */
+  std::ifstream file (fileName.c_str(), std::ios_base::binary);
+  /* First bytes of the file. */
+  char first [sizeof(magic)];
+  return file.read(first, sizeof(first))
+    && std::memcmp(first, magic, sizeof(magic)) == 0;
+}
+
+/* -- Write a binary data file. ------------------------------------------- */
+void Data::writeBinaryFile (const std::string &fileName,
+                            const std::vector<Sample> &samples,
+                            const Steps &steps,
+                            const Projection::ChangeMatrix* change) {
+  if (!littleEndian())
+    throw std::runtime_error("Binary data files cannot be written on this "
+                             "computer.");
+
+  /* Header of the file. */
+  FileHeader header = FileHeader ();
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = formatVersion;
+  header.count = samples.size();
+  if (change) {
+    header.flags |= changeFlag;
+    header.change[0] = (*change)(0, 0);
+    header.change[1] = (*change)(1, 0);
+    header.change[2] = (*change)(0, 1);
+    header.change[3] = (*change)(1, 1);
+    header.change[4] = (*change)(0, 2);
+    header.change[5] = (*change)(1, 2);
+  }
+
+  /* Description of columns. */
+  ColumnHeader columns [columnCount];
+  /* Position of the next column. */
+  std::uint64_t offset = align(headerSize);
+  for (int column = 0; column < columnCount; ++column) {
+    columns[column] = planColumn(samples, members[column], steps[column]);
+    columns[column].offset = offset;
+    offset = align(offset + columns[column].size);
+  }
+
+  /* The file. */
+  std::ofstream file (fileName.c_str(),
+                      std::ios_base::binary | std::ios_base::trunc);
+  if (!file)
+    throw std::runtime_error("Data file \"" + fileName
+                             + "\" cannot be opened.");
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(columns), sizeof(columns));
+  /* Zeros aligning columns. */
+  const char padding [8] = {};
+  for (int column = 0; column < columnCount; ++column) {
+    file.write(padding, columns[column].offset - file.tellp());
+    writeColumn(file, samples, members[column], columns[column]);
+  }
+  file.write(padding, offset - file.tellp());
+  file.close();
+  if (!file)
+    throw std::runtime_error("Data file \"" + fileName
+                             + "\" cannot be written.");
+}
+
+/* -- Map a binary data file. --------------------------------------------- */
+Data::BinaryFile::BinaryFile (const std::string &fileName):
+  count (0), changeKnown (false), matrix (Projection::ChangeMatrix::Zero()) {
+  /* Error message for invalid files. */
+  const std::string invalid = "File \"" + fileName
+    + "\" is not a valid binary data file.";
+  if (!littleEndian())
+    throw std::runtime_error("Binary data files cannot be read on this "
+                             "computer.");
+  try {
+    file.open(fileName);
+  }
+  catch (const std::exception &) {
+    throw std::runtime_error("Data file \"" + fileName
+                             + "\" cannot be mapped.");
+  }
+  if (file.size() < headerSize) throw std::runtime_error(invalid);
+
+  /* Header of the file. */
+  FileHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+      || header.version != formatVersion
+      || header.count > file.size())
+    throw std::runtime_error(invalid);
+  count = header.count;
+  changeKnown = (header.flags & changeFlag) != 0;
+  if (changeKnown) {
+    matrix << header.change[0], header.change[2], header.change[4],
+              header.change[1], header.change[3], header.change[5];
+  }
+
+  for (int column = 0; column < columnCount; ++column) {
+    /* Description of the column in the file. */
+    ColumnHeader stored;
+    std::memcpy(&stored,
+                file.data() + sizeof(header) + column * sizeof(stored),
+                sizeof(stored));
+    if (stored.encoding > delta16 || stored.offset % 8 != 0
+        || stored.offset > file.size()
+        || stored.size != columnSize(static_cast<Encoding>(stored.encoding),
+                                     count)
+        || stored.size > file.size() - stored.offset)
+      throw std::runtime_error(invalid);
+    columns[column].encoding = static_cast<Encoding>(stored.encoding);
+    columns[column].step = stored.step;
+    columns[column].origin = stored.origin;
+    columns[column].data = file.data() + stored.offset;
+  }
+}
+
+/* -- Read values of a column. -------------------------------------------- */
+void Data::BinaryFile::read (Column column, std::size_t first,
+                             std::size_t number, double* destination) const {
+  /* Description of the column. */
+  const ColumnInfo &info = columns[column];
+  switch (info.encoding) {
+    case float64:
+      std::memcpy(destination,
+                  reinterpret_cast<const double*>(info.data) + first,
+                  number * sizeof(double));
+      break;
+
+    case quantized32: {
+      /* Quantized values. */
+      const std::int32_t* quantized =
+        reinterpret_cast<const std::int32_t*>(info.data) + first;
+      for (std::size_t i = 0; i < number; ++i)
+        destination[i] = info.origin + info.step * quantized[i];
+      break;
+    }
+
+    case delta16: {
+      /* Absolute values beginning blocks. */
+      const std::int32_t* starts =
+        reinterpret_cast<const std::int32_t*>(info.data);
+      /* Differences between successive values. */
+      const std::int16_t* deltas =
+        reinterpret_cast<const std::int16_t*>(info.data
+                                              + 4 * blocks(count));
+      /* Current quantized value. */
+      long long current = 0;
+      for (std::size_t i = first; i < first + number; ++i) {
+        if (i % blockSize == 0 || i == first) {
+          current = starts[i / blockSize];
+          for (std::size_t j = i - i % blockSize + 1; j <= i; ++j)
+            current += deltas[j];
+        }
+        else {
+          current += deltas[i];
+        }
+        destination[i - first] = info.origin + info.step * current;
+      }
+      break;
+    }
+  }
+}
+
+/* -- Read every sample. -------------------------------------------------- */
+void Data::BinaryFile::read (std::vector<Sample> &samples) const {
+  samples.resize(count);
+  /* Values read at once. */
+  double buffer [blockSize];
+  for (int column = 0; column < columnCount; ++column) {
+    for (std::size_t first = 0; first < count; first += blockSize) {
+      /* Number of values read. */
+      const std::size_t number = std::min(blockSize, count - first);
+      read(static_cast<Column>(column), first, number, buffer);
+      for (std::size_t i = 0; i < number; ++i)
+        samples[first + i].*members[column] = buffer[i];
+    }
+  }
+}
@@ -0,0 +1,176 @@
+#ifndef DATAFILE_HPP
+#define DATAFILE_HPP
+
+/**
+ * \file datafile.hpp
+ * \brief Binary columnar data files, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ *
+ * A binary data file begins with a header giving the number of samples, the
+ * referential change of the image when known, and the description of five
+ * columns: image abscissa, image ordinate, longitude, latitude and value.
+ * Each column follows, aligned on 8 bytes, either as doubles or as
+ * integers quantized with a given step. Quantized columns whose successive
+ * values are close are stored as 16-bit differences, restarting every
+ * blockSize values from an absolute 32-bit value so that any range of
+ * samples can be read without decoding the previous ones. Numbers are
+ * stored in little-endian order.
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "projection.hpp"
+#include "sample.hpp"
+
+/// \brief Namespace for geo-referenced data.
+namespace Data {
+  /// \brief Columns of data files.
+  enum Column {xColumn, yColumn, longitudeColumn, latitudeColumn, valueColumn,
+               columnCount};
+
+  /// \brief How a column is stored.
+  enum Encoding {
+    /// \brief Doubles, readable in place.
+    float64,
+    /// \brief 32-bit integers, multiplied by the step.
+    quantized32,
+    /// \brief 16-bit differences between quantized values.
+    delta16
+  };
+
+  /**
+   * \brief Quantization step of each column, 0 to store doubles.
+   *
+   * Columns whose range cannot be quantized with the step on 32 bits are
+   * stored as doubles.
+   */
+  typedef std::array<double, columnCount> Steps;
+
+  /// \brief Number of values between two absolute values in delta columns.
+  const std::size_t blockSize = 4096;
+
+  /// \brief Extension of binary data files.
+  const char* const binaryExtension = ".gdd";
+
+  /**
+   * \brief Tell whether a file is a binary data file.
+   * \param fileName Name of the file.
+   * \return True if the file begins as a binary data file.
+   */
+  bool isBinaryFile (const std::string &fileName);
+
+  /**
+   * \brief Write samples in a binary data file.
+   * \param fileName Name of the file.
+   * \param samples Samples to be written.
+   * \param steps Quantization step of each column.
+   * \param change Referential change of the image, null if unknown.
+   * \exception std::runtime_error The file cannot be written.
+   */
+  void writeBinaryFile (const std::string &fileName,
+                        const std::vector<Sample> &samples,
+                        const Steps &steps,
+                        const Projection::ChangeMatrix* change = 0);
+
+  /**
+   * \brief Binary data file, mapped in memory.
+   *
+   * Columns of doubles are used where they are mapped, other columns are
+   * decoded when read.
+   */
+  class BinaryFile {
+    public:
+      /**
+       * \brief Map a binary data file.
+       * \param fileName Name of the file.
+       * \exception std::runtime_error The file cannot be mapped or is not
+       * a valid binary data file.
+       */
+      explicit BinaryFile (const std::string &fileName);
+
+      /// \brief Number of samples.
+      std::size_t size () const {return count;}
+
+      /// \brief Whether the file gives the referential change of the image.
+      bool hasChange () const {return changeKnown;}
+
+      /// \brief Referential change of the image, when known.
+      const Projection::ChangeMatrix &change () const {return matrix;}
+
+      /**
+       * \brief How a column is stored.
+       * \param column The column.
+       */
+      Encoding encoding (Column column) const {
+        return columns[column].encoding;
+      }
+
+      /**
+       * \brief Values of a column stored as doubles, read in place.
+       * \param column The column.
+       * \return Pointer on values, null if the column is not stored as
+       * doubles.
+       */
+      const double* values (Column column) const {
+        return (columns[column].encoding == float64)?
+          reinterpret_cast<const double*>(columns[column].data): 0;
+      }
+
+      /**
+       * \brief Read values of a column.
+       * \param column The column.
+       * \param first Index of the first sample read.
+       * \param number Number of samples read.
+       * \param destination Where to put values.
+       */
+      void read (Column column, std::size_t first, std::size_t number,
+                 double* destination) const;
+
+      /**
+       * \brief Read every sample.
+       * \param samples Where to put samples.
+       */
+      void read (std::vector<Sample> &samples) const;
+
+    private:
+      /// \brief Description of a column.
+      struct ColumnInfo {
+        /// \brief How the column is stored.
+        Encoding encoding;
+
+        /// \brief Quantization step.
+        double step;
+
+        /// \brief Value corresponding to quantized value 0.
+        double origin;
+
+        /// \brief Beginning of the column in the mapped file.
+        const char* data;
+      };
+
+      /// \brief The file, mapped in memory.
+      boost::iostreams::mapped_file_source file;
+
+      /// \brief Number of samples.
+      std::size_t count;
+
+      /// \brief Whether the referential change is known.
+      bool changeKnown;
+
+      /// \brief Referential change of the image.
+      Projection::ChangeMatrix matrix;
+
+      /// \brief Description of columns.
+      ColumnInfo columns [columnCount];
+  };
+}
+
+#endif  // #ifndef DATAFILE_HPP
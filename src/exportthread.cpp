@@ -0,0 +1,27 @@
+/**
+ * \file exportthread.cpp
+ * \brief Implementation of data exported in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <stdexcept>
+
+#include "exportthread.hpp"
+
+/* -- Write the file. ----------------------------------------------------- */
+void GUI::ExportThread::run () {
+  /* The exporter. */
+  const Data::VectorExporter exporter (*samples, gap);
+  try {
+    lineCount = exporter.write(fileName, format, [this] (int percent) {
+                                 emit progress(percent);
+                                 return !isCancelled();
+                               });
+  }
+  catch (const std::runtime_error &e) {
+    error = e.what();
+  }
+  if (!isCancelled()) emit exported();
+}
@@ -0,0 +1,107 @@
+#ifndef EXPORTTHREAD_HPP
+#define EXPORTTHREAD_HPP
+
+/**
+ * \file exportthread.hpp
+ * \brief Exporting data as lines in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <QThread>
+#include <QAtomicInt>
+
+#include "sample.hpp"
+#include "vectorexport.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Thread writing samples as lines to GeoJSON, CSV or Shapefile.
+   *
+   * Samples are given as a copy, so that data can still be set while
+   * exporting. The thread can be cancelled at any time, it then stops as
+   * soon as possible and removes files partly written.
+   */
+  class ExportThread: public QThread {
+      Q_OBJECT
+
+    public:
+      /**
+       * \brief Construct the thread, which should then be started.
+       * \param _samples Samples exported.
+       * \param _fileName Name of the file written, as known by the system.
+       * \param _format Format of the file.
+       * \param _gap Greatest distance between two successive samples of a
+       * line, in pixels.
+       * \param parent Parent object.
+       */
+      ExportThread (const std::shared_ptr<const std::vector<Data::Sample> >
+                      &_samples,
+                    const std::string &_fileName, Data::VectorFormat _format,
+                    double _gap, QObject* parent = 0):
+        QThread (parent), samples (_samples), fileName (_fileName),
+        format (_format), gap (_gap), cancelled (0), lineCount (0) {}
+
+      /// \brief Ask the thread to stop.
+      void cancel () {cancelled.fetchAndStoreOrdered(1);}
+
+      /// \brief Whether or not the thread has been cancelled.
+      bool isCancelled () const {
+        return cancelled.fetchAndAddOrdered(0) != 0;
+      }
+
+      /// \brief Number of lines written, once signal exported() is emitted.
+      std::size_t lines () const {return lineCount;}
+
+      /**
+       * \brief Why the file cannot be written, once signal exported() is
+       * emitted, empty on success.
+       */
+      const std::string &failure () const {return error;}
+
+    signals:
+      /**
+       * \brief Emitted as samples are written.
+       * \param percent Percentage of samples written.
+       */
+      void progress (int percent);
+
+      /// \brief Emitted when exporting is over, unless cancelled.
+      void exported ();
+
+    protected:
+      /// \brief Write the file.
+      virtual void run ();
+
+    private:
+      /// \brief Samples exported.
+      const std::shared_ptr<const std::vector<Data::Sample> > samples;
+
+      /// \brief Name of the file written.
+      const std::string fileName;
+
+      /// \brief Format of the file.
+      const Data::VectorFormat format;
+
+      /// \brief Greatest distance between two samples of a line.
+      const double gap;
+
+      /// \brief Non-zero when the thread has been cancelled.
+      mutable QAtomicInt cancelled;
+
+      /// \brief Number of lines written.
+      std::size_t lineCount;
+
+      /// \brief Why the file cannot be written.
+      std::string error;
+  };
+}
+
+#endif  // #ifndef EXPORTTHREAD_HPP
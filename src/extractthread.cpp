@@ -0,0 +1,61 @@
+/**
+ * \file extractthread.cpp
+ * \brief Implementation of layer extraction in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <QImage>
+
+#include "extractthread.hpp"
+
+/* -- Extract the layer. -------------------------------------------------- */
+void GUI::ExtractThread::run () {
+  /* Side of tiles. */
+  const int side = ImagePyramid::tileSize;
+  /* Size of the image. */
+  const QSize size = pyramid->size();
+  /* Width of the image. */
+  const int width = size.width();
+
+  /* Rows are assembled from the tiles they cross, at full resolution. */
+  const LayerExtractor::BandReader reader =
+    [this, side, width] (int top, int count, std::uint32_t* pixels) {
+      for (int row = top / side; row <= (top + count - 1) / side; ++row)
+        for (int column = 0; column < pyramid->columns(0); ++column) {
+          /* The tile. */
+          const QImage tile = pyramid->tile(0, column, row);
+          /* Area of the tile read. */
+          const QRect area =
+            pyramid->tileRect(0, column, row)
+              .intersected(QRect (0, top, width, count));
+          for (int y = area.top(); y <= area.bottom(); ++y) {
+            /* Row of the band. */
+            std::uint32_t* out = pixels
+              + static_cast<std::size_t>(y - top) * width + area.left();
+            if (tile.isNull()) {
+              std::fill(out, out + area.width(), 0xffffffffu);
+              continue;
+            }
+            /* Row of the tile. */
+            const QRgb* line =
+              reinterpret_cast<const QRgb*>(tile.constScanLine(y
+                                                               - row * side));
+            std::copy(line, line + area.width(), out);
+          }
+        }
+    };
+  /* The extractor. */
+  const LayerExtractor extractor (reader, width, size.height(), colour,
+                                  tolerance, spacing, minimumSize);
+  /* Number of threads, one per core. */
+  const int threads = std::max(QThread::idealThreadCount(), 1);
+  result = extractor.extract(static_cast<unsigned>(threads),
+                             [this] (int percent) {
+                               emit progress(percent);
+                               return !isCancelled();
+                             });
+  if (!isCancelled()) emit extracted();
+}
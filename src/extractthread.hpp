@@ -0,0 +1,106 @@
+#ifndef EXTRACTTHREAD_HPP
+#define EXTRACTTHREAD_HPP
+
+/**
+ * \file extractthread.hpp
+ * \brief Extracting a layer of an image in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <QThread>
+#include <QAtomicInt>
+
+#include "imagepyramid.hpp"
+#include "layerextractor.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Thread extracting every line of a colour from an image.
+   *
+   * The image is read from tiles of the pyramid at full resolution, bands
+   * of the image being processed by as many threads as there are cores.
+   * The thread can be cancelled at any time, it then stops as soon as
+   * possible without giving any result.
+   */
+  class ExtractThread: public QThread {
+      Q_OBJECT
+
+    public:
+      /**
+       * \brief Construct the thread, which should then be started.
+       * \param _pyramid Pyramid of the image, whose levels are set.
+       * \param _colour Colour of the layer, as 0xffRRGGBB.
+       * \param _spacing Distance between points of lines, in pixels.
+       * \param _tolerance Greatest difference of a colour component between
+       * the layer and its pixels.
+       * \param _minimumSize Smallest length of a connected part of the layer
+       * kept, in pixels.
+       * \param parent Parent object.
+       */
+      ExtractThread (const std::shared_ptr<ImagePyramid> &_pyramid,
+                     std::uint32_t _colour, double _spacing, int _tolerance,
+                     std::size_t _minimumSize, QObject* parent = 0):
+        QThread (parent), pyramid (_pyramid), colour (_colour),
+        spacing (_spacing), tolerance (_tolerance),
+        minimumSize (_minimumSize), cancelled (0) {}
+
+      /// \brief Ask the thread to stop.
+      void cancel () {cancelled.fetchAndStoreOrdered(1);}
+
+      /// \brief Whether or not the thread has been cancelled.
+      bool isCancelled () const {
+        return cancelled.fetchAndAddOrdered(0) != 0;
+      }
+
+      /// \brief Lines of the layer, once signal extracted() has been emitted.
+      const std::vector<LayerExtractor::Line> &lines () const {
+        return result;
+      }
+
+    signals:
+      /**
+       * \brief Emitted as bands of the image are processed.
+       * \param percent Percentage of the image processed.
+       */
+      void progress (int percent);
+
+      /// \brief Emitted when the layer has been extracted.
+      void extracted ();
+
+    protected:
+      /// \brief Extract the layer.
+      virtual void run ();
+
+    private:
+      /// \brief Pyramid of the image.
+      const std::shared_ptr<ImagePyramid> pyramid;
+
+      /// \brief Colour of the layer.
+      const std::uint32_t colour;
+
+      /// \brief Distance between points of lines.
+      const double spacing;
+
+      /// \brief Greatest difference of a colour component.
+      const int tolerance;
+
+      /// \brief Smallest length of a connected part of the layer kept.
+      const std::size_t minimumSize;
+
+      /// \brief Non-zero when the thread has been cancelled.
+      mutable QAtomicInt cancelled;
+
+      /// \brief Lines of the layer.
+      std::vector<LayerExtractor::Line> result;
+  };
+}
+
+#endif  // #ifndef EXTRACTTHREAD_HPP
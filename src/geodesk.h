@@ -0,0 +1,264 @@
+#ifndef GEODESK_H
+#define GEODESK_H
+
+/**
+ * \file geodesk.h
+ * \brief C interface of the GeoDesk core library.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ *
+ * Referential changes are opaque handles. Coordinates are exchanged through
+ * arrays owned by the caller and converted in place, without copy nor
+ * conversion to text. Functions never throw: failures are reported by a
+ * status code.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \brief Version of this interface, changed when it becomes incompatible. */
+#define GEODESK_API_VERSION 1
+
+/** \brief Status returned by functions. */
+typedef enum geodesk_status {
+  /** \brief Success. */
+  GEODESK_OK = 0,
+
+  /** \brief A pointer argument is null or a size is invalid. */
+  GEODESK_INVALID_ARGUMENT = 1,
+
+  /** \brief A file cannot be opened, read or written, or is invalid. */
+  GEODESK_FILE_ERROR = 2,
+
+  /** \brief Reference points do not define an affine transformation. */
+  GEODESK_DEGENERATE = 3,
+
+  /** \brief The referential change cannot be inverted. */
+  GEODESK_NOT_INVERTIBLE = 4,
+
+  /** \brief Memory cannot be allocated. */
+  GEODESK_OUT_OF_MEMORY = 5
+} geodesk_status;
+
+/**
+ * \brief Referential change, from image coordinates to geographical
+ * coordinates.
+ */
+typedef struct geodesk_change geodesk_change;
+
+/** \brief Binary data file, mapped in memory. */
+typedef struct geodesk_data_file geodesk_data_file;
+
+/** \brief Columns of data files. */
+typedef enum geodesk_column {
+  /** \brief Abscissa in the image. */
+  GEODESK_X = 0,
+
+  /** \brief Ordinate in the image. */
+  GEODESK_Y = 1,
+
+  /** \brief Longitude in decimal degrees east. */
+  GEODESK_LONGITUDE = 2,
+
+  /** \brief Latitude in decimal degrees north. */
+  GEODESK_LATITUDE = 3,
+
+  /** \brief Value at the location, in meters. */
+  GEODESK_VALUE = 4
+} geodesk_column;
+
+/**
+ * \brief Version of the library.
+ * \return GEODESK_API_VERSION of the library actually linked.
+ */
+int geodesk_api_version (void);
+
+/**
+ * \brief Description of a status.
+ * \param status The status.
+ * \return Static string describing the status.
+ */
+const char* geodesk_status_string (geodesk_status status);
+
+/**
+ * \brief Create a referential change from its coefficients.
+ * \param coefficients Six coefficients, in world file order.
+ * \param change Where to put the new referential change.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_change_create (const double coefficients [6],
+                                      geodesk_change** change);
+
+/**
+ * \brief Create a referential change from a world file.
+ * \param file_name Name of the world file.
+ * \param change Where to put the new referential change.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_change_read_world_file (const char* file_name,
+                                               geodesk_change** change);
+
+/**
+ * \brief Fit a referential change on reference points, in the least-squares
+ * sense.
+ * \param x Abscissae of reference points in the image.
+ * \param y Ordinates of reference points in the image.
+ * \param longitude Longitudes of reference points.
+ * \param latitude Latitudes of reference points.
+ * \param n Number of reference points, at least three.
+ * \param change Where to put the new referential change.
+ * \param rms Where to put the root mean square of residuals, may be null.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_change_fit (const double* x, const double* y,
+                                   const double* longitude,
+                                   const double* latitude, size_t n,
+                                   geodesk_change** change, double* rms);
+
+/**
+ * \brief Fit a referential change on the points of a reference point file.
+ * \param file_name Name of the reference point file.
+ * \param change Where to put the new referential change.
+ * \param rms Where to put the root mean square of residuals, may be null.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_change_read_reference_points (const char* file_name,
+                                                     geodesk_change** change,
+                                                     double* rms);
+
+/**
+ * \brief Write a referential change as a world file.
+ * \param change The referential change.
+ * \param file_name Name of the world file.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_change_write_world_file (const geodesk_change* change,
+                                                const char* file_name);
+
+/**
+ * \brief Coefficients of a referential change.
+ * \param change The referential change.
+ * \param coefficients Where to put the six coefficients, in world file
+ * order.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_change_coefficients (const geodesk_change* change,
+                                            double coefficients [6]);
+
+/**
+ * \brief Release a referential change.
+ * \param change The referential change, may be null.
+ */
+void geodesk_change_free (geodesk_change* change);
+
+/**
+ * \brief Convert image coordinates into geographical coordinates, in place.
+ * \param change The referential change.
+ * \param x Abscissae, replaced by longitudes.
+ * \param y Ordinates, replaced by latitudes.
+ * \param n Number of points.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_transform (const geodesk_change* change,
+                                  double* x, double* y, size_t n);
+
+/**
+ * \brief Convert geographical coordinates into image coordinates, in place.
+ * \param change The referential change.
+ * \param x Longitudes, replaced by abscissae.
+ * \param y Latitudes, replaced by ordinates.
+ * \param n Number of points.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_inverse_transform (const geodesk_change* change,
+                                          double* x, double* y, size_t n);
+
+/**
+ * \brief Convert image coordinates into geographical coordinates, in place,
+ * for points stored as interleaved pairs.
+ * \param change The referential change.
+ * \param xy Abscissa then ordinate of each point, replaced by longitude
+ * then latitude.
+ * \param n Number of points.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_transform_interleaved (const geodesk_change* change,
+                                              double* xy, size_t n);
+
+/**
+ * \brief Convert geographical coordinates into image coordinates, in place,
+ * for points stored as interleaved pairs.
+ * \param change The referential change.
+ * \param xy Longitude then latitude of each point, replaced by abscissa
+ * then ordinate.
+ * \param n Number of points.
+ * \return Status of the operation.
+ */
+geodesk_status
+geodesk_inverse_transform_interleaved (const geodesk_change* change,
+                                       double* xy, size_t n);
+
+/**
+ * \brief Map a binary data file.
+ * \param file_name Name of the file.
+ * \param file Where to put the mapped file.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_data_file_open (const char* file_name,
+                                       geodesk_data_file** file);
+
+/**
+ * \brief Number of samples of a binary data file.
+ * \param file The file.
+ * \return Number of samples, 0 if the file is null.
+ */
+size_t geodesk_data_file_size (const geodesk_data_file* file);
+
+/**
+ * \brief Referential change given by a binary data file.
+ * \param file The file.
+ * \param change Where to put the new referential change.
+ * \return Status of the operation, GEODESK_FILE_ERROR if the file does not
+ * give it.
+ */
+geodesk_status geodesk_data_file_change (const geodesk_data_file* file,
+                                         geodesk_change** change);
+
+/**
+ * \brief Values of a column stored as doubles, read in place.
+ * \param file The file.
+ * \param column The column.
+ * \return Pointer on values, valid until the file is closed, null if the
+ * column is not stored as doubles.
+ */
+const double* geodesk_data_file_values (const geodesk_data_file* file,
+                                        geodesk_column column);
+
+/**
+ * \brief Read values of a column.
+ * \param file The file.
+ * \param column The column.
+ * \param first Index of the first sample read.
+ * \param n Number of samples read.
+ * \param destination Where to put values.
+ * \return Status of the operation.
+ */
+geodesk_status geodesk_data_file_read (const geodesk_data_file* file,
+                                       geodesk_column column, size_t first,
+                                       size_t n, double* destination);
+
+/**
+ * \brief Unmap a binary data file.
+ * \param file The file, may be null.
+ */
+void geodesk_data_file_close (geodesk_data_file* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef GEODESK_H */
@@ -0,0 +1,622 @@
+/**
+ * \file gridder.cpp
+ * \brief Implementation of data interpolated on a regular grid.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <fstream>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "gridder.hpp"
+#include "worldfile.hpp"
+#include "profiler.hpp"
+
+const int Data::Gridder::tileSize;
+const int Data::Gridder::maximumSide;
+const int Data::Gridder::neighbours;
+const std::size_t Data::Gridder::chunkSize;
+const std::size_t Data::Gridder::leafSize;
+const float Data::Gridder::noData = -9999.f;
+
+namespace {
+  /// \brief Value of pi.
+  const double pi = 3.14159265358979323846;
+
+  /// \brief Types of values of TIFF tags.
+  enum TagType {asciiType = 2, shortType = 3, longType = 4, doubleType = 12,
+                long8Type = 16};
+
+  /// \brief Text of the value of cells where nothing is interpolated.
+  const char* const noDataText = "-9999";
+
+  /// \brief Size of the buffer of the GeoTIFF file.
+  const std::size_t bufferSize = 1 << 16;
+
+  /**
+   * \brief Put a number in little-endian order.
+   * \param out Where to put the number.
+   * \param value The number.
+   * \param size Number of bytes.
+   */
+  void putLittle (char* out, std::uint64_t value, int size) {
+    for (int i = 0; i < size; ++i)
+      out[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+
+  /**
+   * \brief Bits of a double.
+   * \param value The double.
+   */
+  std::uint64_t bits (double value) {
+    /* Bits of the number. */
+    std::uint64_t result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+  }
+
+  /// \brief Tag of a TIFF directory.
+  struct Tag {
+    /// \brief Identifier of the tag.
+    std::uint16_t id;
+
+    /// \brief Type of values.
+    std::uint16_t type;
+
+    /// \brief Number of values.
+    std::uint64_t count;
+
+    /// \brief Values, in little-endian order.
+    std::vector<char> data;
+  };
+
+  /**
+   * \brief Make a tag of integers.
+   * \param id Identifier of the tag.
+   * \param type Type of values.
+   * \param values Values.
+   * \return The tag.
+   */
+  Tag integerTag (std::uint16_t id, TagType type,
+                  const std::vector<std::uint64_t> &values) {
+    /* Size of a value. */
+    const int size = (type == shortType)? 2: (type == longType)? 4: 8;
+    /* The tag. */
+    Tag tag = {id, static_cast<std::uint16_t>(type), values.size(),
+               std::vector<char> (values.size() * size)};
+    for (std::size_t i = 0; i < values.size(); ++i)
+      putLittle(&tag.data[i * size], values[i], size);
+    return tag;
+  }
+
+  /**
+   * \brief Make a tag of doubles.
+   * \param id Identifier of the tag.
+   * \param values Values.
+   * \return The tag.
+   */
+  Tag doubleTag (std::uint16_t id, const std::vector<double> &values) {
+    /* The tag. */
+    Tag tag = {id, doubleType, values.size(),
+               std::vector<char> (values.size() * 8)};
+    for (std::size_t i = 0; i < values.size(); ++i)
+      putLittle(&tag.data[i * 8], bits(values[i]), 8);
+    return tag;
+  }
+
+  /**
+   * \brief GeoTIFF file of 32-bit floats, written tile by tile.
+   *
+   * Tiles are written in any order, the directory being written after
+   * them. The file is a BigTIFF when it could not be addressed on 32 bits.
+   */
+  class TiledTiff {
+    public:
+      /**
+       * \brief Begin the file.
+       * \param _name Name of the file.
+       * \param _width Number of columns.
+       * \param _height Number of rows.
+       * \param _left Longitude of the left side.
+       * \param _top Latitude of the top side.
+       * \param _resolution Side of cells, in degrees.
+       * \exception std::runtime_error The file cannot be opened.
+       */
+      TiledTiff (const std::string &_name, int _width, int _height,
+                 double _left, double _top, double _resolution):
+        name (_name), width (_width), height (_height), left (_left),
+        top (_top), resolution (_resolution),
+        columns ((_width + side - 1) / side),
+        rows ((_height + side - 1) / side),
+        offsets (static_cast<std::size_t>(columns) * rows),
+        bytes (tileBytes), buffer (bufferSize) {
+        big = static_cast<std::uint64_t>(offsets.size()) * (tileBytes + 16)
+          + 4096 > std::numeric_limits<std::uint32_t>::max();
+        stream.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+        stream.open(name.c_str(), std::ios_base::binary
+                                  | std::ios_base::trunc);
+        if (!stream)
+          throw std::runtime_error("File \"" + name
+                                   + "\" cannot be opened.");
+        /* Header, the directory being given later. */
+        char header [16] = {'I', 'I'};
+        putLittle(header + 2, big? 43: 42, 2);
+        if (big) putLittle(header + 4, 8, 2);
+        position = big? 16: 8;
+        stream.write(header, position);
+      }
+
+      /**
+       * \brief Write a tile.
+       * \param index Index of the tile, row by row.
+       * \param cells Values of cells, row by row.
+       */
+      void write (std::size_t index, const float* cells) {
+        for (int i = 0; i < side * side; ++i) {
+          /* Bits of the value. */
+          std::uint32_t value;
+          std::memcpy(&value, cells + i, sizeof(value));
+          putLittle(&bytes[4 * i], value, 4);
+        }
+        offsets[index] = position;
+        stream.write(&bytes[0], bytes.size());
+        position += bytes.size();
+      }
+
+      /**
+       * \brief Write the directory and close the file.
+       * \exception std::runtime_error The file cannot be written.
+       */
+      void finish () {
+        /* Type of offsets. */
+        const TagType offsetType = big? long8Type: longType;
+        /* Tags, by increasing identifier. */
+        std::vector<Tag> tags;
+        tags.push_back(integerTag(256, longType, {std::uint64_t (width)}));
+        tags.push_back(integerTag(257, longType, {std::uint64_t (height)}));
+        tags.push_back(integerTag(258, shortType, {32}));
+        tags.push_back(integerTag(259, shortType, {1}));
+        tags.push_back(integerTag(262, shortType, {1}));
+        tags.push_back(integerTag(277, shortType, {1}));
+        tags.push_back(integerTag(284, shortType, {1}));
+        tags.push_back(integerTag(322, shortType, {std::uint64_t (side)}));
+        tags.push_back(integerTag(323, shortType, {std::uint64_t (side)}));
+        tags.push_back(integerTag(324, offsetType, offsets));
+        tags.push_back(integerTag(325, offsetType,
+                                  std::vector<std::uint64_t> (
+                                    offsets.size(), tileBytes)));
+        tags.push_back(integerTag(339, shortType, {3}));
+        tags.push_back(doubleTag(33550, {resolution, resolution, 0.}));
+        tags.push_back(doubleTag(33922, {0., 0., 0., left, top, 0.}));
+        /* Geographic model, pixels as areas, WGS 84. */
+        tags.push_back(integerTag(34735, shortType,
+                                  {1, 1, 0, 3, 1024, 0, 1, 2, 1025, 0, 1, 1,
+                                   2048, 0, 1, 4326}));
+        /* Value of cells where nothing is interpolated, for GDAL. */
+        Tag noDataTag = {42113, asciiType, std::strlen(noDataText) + 1,
+                         std::vector<char> (noDataText, noDataText
+                                            + std::strlen(noDataText) + 1)};
+        tags.push_back(noDataTag);
+
+        /* Size of an entry. */
+        const std::size_t entrySize = big? 20: 12;
+        /* Size of values held in entries. */
+        const std::size_t inlineSize = big? 8: 4;
+        /* Size of counts and offsets. */
+        const int wordSize = big? 8: 4;
+        /* Position of the directory, aligned on 8 bytes. */
+        const std::uint64_t directory = (position + 7) & ~std::uint64_t (7);
+        /* The directory. */
+        std::vector<char> entries ((big? 8: 2) + tags.size() * entrySize
+                                   + wordSize);
+        putLittle(&entries[0], tags.size(), big? 8: 2);
+        /* Values not held in entries. */
+        std::vector<char> values;
+        for (std::size_t i = 0; i < tags.size(); ++i) {
+          /* Entry of the tag. */
+          char* entry = &entries[(big? 8: 2) + i * entrySize];
+          putLittle(entry, tags[i].id, 2);
+          putLittle(entry + 2, tags[i].type, 2);
+          putLittle(entry + 4, tags[i].count, wordSize);
+          if (tags[i].data.size() <= inlineSize) {
+            std::copy(tags[i].data.begin(), tags[i].data.end(),
+                      entry + 4 + wordSize);
+            continue;
+          }
+          putLittle(entry + 4 + wordSize,
+                    directory + entries.size() + values.size(), wordSize);
+          values.insert(values.end(), tags[i].data.begin(),
+                        tags[i].data.end());
+          if (values.size() % 2 != 0) values.push_back(0);
+        }
+        /* Zeros aligning the directory. */
+        const char padding [8] = {};
+        stream.write(padding, directory - position);
+        stream.write(&entries[0], entries.size());
+        stream.write(values.data(), values.size());
+        /* Position of the directory in the header. */
+        char header [8];
+        putLittle(header, directory, wordSize);
+        stream.seekp(big? 8: 4);
+        stream.write(header, wordSize);
+        stream.close();
+        if (!stream)
+          throw std::runtime_error("File \"" + name
+                                   + "\" cannot be written.");
+      }
+
+    private:
+      /// \brief Side of tiles.
+      static const int side = Data::Gridder::tileSize;
+
+      /// \brief Size of tiles, in bytes.
+      static const std::size_t tileBytes = 4 * side * side;
+
+      /// \brief Name of the file.
+      const std::string name;
+
+      /// \brief Number of columns.
+      const int width;
+
+      /// \brief Number of rows.
+      const int height;
+
+      /// \brief Longitude of the left side.
+      const double left;
+
+      /// \brief Latitude of the top side.
+      const double top;
+
+      /// \brief Side of cells.
+      const double resolution;
+
+      /// \brief Number of columns of tiles.
+      const int columns;
+
+      /// \brief Number of rows of tiles.
+      const int rows;
+
+      /// \brief Whether or not the file is a BigTIFF.
+      bool big;
+
+      /// \brief Position of each tile in the file.
+      std::vector<std::uint64_t> offsets;
+
+      /// \brief Size of the file written.
+      std::uint64_t position;
+
+      /// \brief Values of a tile, in little-endian order.
+      std::vector<char> bytes;
+
+      /// \brief Buffer of the stream, which should outlive it.
+      std::vector<char> buffer;
+
+      /// \brief Stream on the file.
+      std::ofstream stream;
+  };
+
+  const int TiledTiff::side;
+  const std::size_t TiledTiff::tileBytes;
+}
+
+/* -- Take samples. ------------------------------------------------------- */
+Data::Gridder::Gridder (const SampleReader &reader, std::size_t count):
+  longitude (0.), latitude (0.), shrink (1.), west (0.), south (0.),
+  east (0.), north (0.), sorted (false), triangulated (false) {
+  vertices.reserve(count);
+  /* Samples read at once. */
+  std::vector<Sample> chunk (std::min(chunkSize, count));
+  for (std::size_t first = 0; first < count; first += chunkSize) {
+    /* Number of samples read. */
+    const std::size_t number = std::min(chunkSize, count - first);
+    reader(first, number, chunk.data());
+    add(chunk.data(), number);
+  }
+  project();
+}
+
+/* -- Take samples of a list. --------------------------------------------- */
+Data::Gridder::Gridder (const std::vector<Sample> &samples):
+  longitude (0.), latitude (0.), shrink (1.), west (0.), south (0.),
+  east (0.), north (0.), sorted (false), triangulated (false) {
+  vertices.reserve(samples.size());
+  add(samples.data(), samples.size());
+  project();
+}
+
+/* -- Take samples of a binary data file. --------------------------------- */
+Data::Gridder::Gridder (const BinaryFile &file):
+  longitude (0.), latitude (0.), shrink (1.), west (0.), south (0.),
+  east (0.), north (0.), sorted (false), triangulated (false) {
+  vertices.reserve(file.size());
+  /* Samples read at once, only positions and values being set. */
+  std::vector<Sample> chunk (std::min(chunkSize, file.size()));
+  /* Values of a column. */
+  std::vector<double> values (chunk.size());
+  for (std::size_t first = 0; first < file.size(); first += chunkSize) {
+    /* Number of samples read. */
+    const std::size_t number = std::min(chunkSize, file.size() - first);
+    file.read(longitudeColumn, first, number, values.data());
+    for (std::size_t i = 0; i < number; ++i)
+      chunk[i].longitude = values[i];
+    file.read(latitudeColumn, first, number, values.data());
+    for (std::size_t i = 0; i < number; ++i) chunk[i].latitude = values[i];
+    file.read(valueColumn, first, number, values.data());
+    for (std::size_t i = 0; i < number; ++i) chunk[i].value = values[i];
+    add(chunk.data(), number);
+  }
+  project();
+}
+
+/* -- Add samples. -------------------------------------------------------- */
+void Data::Gridder::add (const Sample* samples, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i)
+    if (std::isfinite(samples[i].longitude)
+        && std::isfinite(samples[i].latitude)
+        && std::isfinite(samples[i].value)) {
+      const Triangulation::Vertex vertex = {samples[i].longitude,
+                                            samples[i].latitude,
+                                            samples[i].value};
+      vertices.push_back(vertex);
+    }
+}
+
+/* -- Compute the plane. -------------------------------------------------- */
+void Data::Gridder::project () {
+  if (vertices.empty()) return;
+  west = east = vertices[0].x;
+  south = north = vertices[0].y;
+  for (const Triangulation::Vertex &vertex: vertices) {
+    west = std::min(west, vertex.x);
+    east = std::max(east, vertex.x);
+    south = std::min(south, vertex.y);
+    north = std::max(north, vertex.y);
+  }
+  longitude = .5 * (west + east);
+  latitude = .5 * (south + north);
+  shrink = std::cos(latitude * pi / 180.);
+  for (Triangulation::Vertex &vertex: vertices) {
+    vertex.x = (vertex.x - longitude) * shrink;
+    vertex.y -= latitude;
+  }
+}
+
+/* -- Sort samples of a subtree. ------------------------------------------ */
+void Data::Gridder::sortTree (std::size_t first, std::size_t last,
+                              int depth, unsigned threads) {
+  if (last - first <= leafSize) return;
+  /* Sample splitting the subtree. */
+  const std::size_t middle = first + (last - first) / 2;
+  if (depth % 2 == 0)
+    std::nth_element(vertices.begin() + first, vertices.begin() + middle,
+                     vertices.begin() + last,
+                     [] (const Triangulation::Vertex &a,
+                         const Triangulation::Vertex &b) {
+                       return a.x < b.x;
+                     });
+  else
+    std::nth_element(vertices.begin() + first, vertices.begin() + middle,
+                     vertices.begin() + last,
+                     [] (const Triangulation::Vertex &a,
+                         const Triangulation::Vertex &b) {
+                       return a.y < b.y;
+                     });
+
+  if (threads > 1) {
+    /* Thread sorting the first half. */
+    std::thread helper ([this, first, middle, depth, threads] () {
+                          sortTree(first, middle, depth + 1, threads / 2);
+                        });
+    sortTree(middle + 1, last, depth + 1, threads - threads / 2);
+    helper.join();
+  }
+  else {
+    sortTree(first, middle, depth + 1, 1);
+    sortTree(middle + 1, last, depth + 1, 1);
+  }
+}
+
+/* -- Find the nearest samples. ------------------------------------------- */
+void Data::Gridder::search (std::size_t first, std::size_t last, int depth,
+                            double x, double y, Nearest &found) const {
+  if (last - first <= leafSize) {
+    for (std::size_t i = first; i < last; ++i) {
+      /* Offset of the sample. */
+      const double dx = vertices[i].x - x, dy = vertices[i].y - y;
+      found.add(dx * dx + dy * dy, vertices[i].value);
+    }
+    return;
+  }
+  /* Sample splitting the subtree. */
+  const std::size_t middle = first + (last - first) / 2;
+  /* The sample. */
+  const Triangulation::Vertex &split = vertices[middle];
+  /* Offset of the sample. */
+  const double dx = split.x - x, dy = split.y - y;
+  found.add(dx * dx + dy * dy, split.value);
+  /* Distance to the line splitting the subtree, negative before it. */
+  const double delta = (depth % 2 == 0)? -dx: -dy;
+  if (delta < 0.) {
+    search(first, middle, depth + 1, x, y, found);
+    if (delta * delta < found.worst())
+      search(middle + 1, last, depth + 1, x, y, found);
+  }
+  else {
+    search(middle + 1, last, depth + 1, x, y, found);
+    if (delta * delta < found.worst())
+      search(first, middle, depth + 1, x, y, found);
+  }
+}
+
+/* -- Interpolate by inverse distance weighting. -------------------------- */
+float Data::Gridder::weigh (double x, double y, double limit) const {
+  /* Nearest samples. */
+  Nearest found;
+  found.count = 0;
+  found.limit = limit;
+  search(0, vertices.size(), 0, x, y, found);
+  if (found.count == 0) return noData;
+  if (found.distance[0] == 0.) return static_cast<float>(found.value[0]);
+  /* Sum of weighted values. */
+  double sum = 0.;
+  /* Sum of weights. */
+  double weights = 0.;
+  for (int i = 0; i < found.count; ++i) {
+    sum += found.value[i] / found.distance[i];
+    weights += 1. / found.distance[i];
+  }
+  return static_cast<float>(sum / weights);
+}
+
+/* -- Interpolate the cells of a tile. ------------------------------------ */
+void Data::Gridder::interpolate (Method method, double left, double top,
+                                 double resolution, double limit,
+                                 int column, int row, float* cells) const {
+  /* Triangle of the first cell of the previous row. */
+  Triangulation::Index start = Triangulation::none;
+  for (int r = 0; r < tileSize; ++r) {
+    /* Ordinate of the centre of cells, in the plane. */
+    const double y = top - (row * tileSize + r + .5) * resolution - latitude;
+    /* Triangle of the previous cell. */
+    Triangulation::Index hint = start;
+    for (int c = 0; c < tileSize; ++c) {
+      /* Abscissa of the centre of the cell, in the plane. */
+      const double x =
+        (left + (column * tileSize + c + .5) * resolution - longitude)
+        * shrink;
+      /* Value of the cell. */
+      float &cell = cells[r * tileSize + c];
+      if (method == idwMethod) {
+        cell = weigh(x, y, limit);
+        continue;
+      }
+      /* Value interpolated. */
+      double value;
+      cell = triangulation.interpolate(x, y, hint, value)?
+        static_cast<float>(value): noData;
+      if (c == 0) start = hint;
+    }
+  }
+}
+
+/* -- Interpolate the grid and write it. ---------------------------------- */
+bool Data::Gridder::write (const std::string &fileName, Method method,
+                           double resolution, double radius,
+                           unsigned threads,
+                           const std::function<bool (int)> &carryOn) {
+  GEODESK_TIME("Gridder::write");
+  if (vertices.empty())
+    throw std::runtime_error("There is no data to be gridded.");
+  if (!(resolution > 0.) || !std::isfinite(resolution))
+    throw std::runtime_error("Resolution of the grid should be positive.");
+  /* Longitude of the left side of the grid. */
+  const double left = std::floor(west / resolution) * resolution;
+  /* Latitude of the top side of the grid. */
+  const double top = std::ceil(north / resolution) * resolution;
+  /* Number of columns. */
+  const double width = std::floor((east - left) / resolution) + 1.;
+  /* Number of rows. */
+  const double height = std::floor((top - south) / resolution) + 1.;
+  if (width > maximumSide || height > maximumSide)
+    throw std::runtime_error("The grid would be too large, its resolution "
+                             "should be coarser.");
+  /* Name of the world file. */
+  std::string worldName;
+  try {
+    worldName = Projection::worldFileName(fileName);
+  }
+  catch (const std::domain_error &e) {
+    throw std::runtime_error(e.what());
+  }
+  threads = std::max(threads, 1u);
+
+  if (!sorted) {
+    sortTree(0, vertices.size(), 0, threads);
+    sorted = true;
+  }
+  /* Percentage of progress given to the triangulation. */
+  const int share = (method == tinMethod && !triangulated)? 50: 0;
+  if (method == tinMethod && !triangulated) {
+    if (!triangulation.build(vertices, [&carryOn, share] (int percent) {
+                               return carryOn(percent * share / 100);
+                             }))
+      return false;
+    triangulated = true;
+  }
+
+  /* Number of columns of tiles. */
+  const int columns = (static_cast<int>(width) + tileSize - 1) / tileSize;
+  /* Number of tiles. */
+  const int tiles =
+    columns * ((static_cast<int>(height) + tileSize - 1) / tileSize);
+  /* Greatest squared distance of samples weighted. */
+  const double limit = (radius > 0.)? radius * radius:
+    std::numeric_limits<double>::infinity();
+  /* Whether every tile has been written. */
+  bool complete = false;
+  try {
+    /* The file. */
+    TiledTiff file (fileName, static_cast<int>(width),
+                    static_cast<int>(height), left, top, resolution);
+    /* Index of the next tile to be computed. */
+    std::atomic<int> next (0);
+    /* Whether gridding has been interrupted. */
+    std::atomic<bool> stopped (false);
+    /* Number of tiles written. */
+    int written = 0;
+    /* Protects the file and progress. */
+    std::mutex mutex;
+    /* Compute tiles until there is none left. */
+    const auto work = [&] () {
+      /* Values of cells of the tile. */
+      std::vector<float> cells (tileSize * tileSize);
+      for (int i = next++; i < tiles && !stopped; i = next++) {
+        interpolate(method, left, top, resolution, limit, i % columns,
+                    i / columns, cells.data());
+        /* Lock on the file. */
+        const std::lock_guard<std::mutex> lock (mutex);
+        file.write(static_cast<std::size_t>(i), cells.data());
+        ++written;
+        if (!carryOn(share + (100 - share) * written / tiles))
+          stopped = true;
+      }
+    };
+    /* Threads helping the calling one. */
+    std::vector<std::thread> helpers;
+    for (unsigned i = 1; i < std::min<unsigned>(threads, tiles); ++i)
+      helpers.push_back(std::thread (work));
+    work();
+    for (std::size_t i = 0; i < helpers.size(); ++i) helpers[i].join();
+    if (!stopped) {
+      file.finish();
+      complete = true;
+    }
+  }
+  catch (const std::runtime_error &) {
+    std::remove(fileName.c_str());
+    throw;
+  }
+  if (!complete) {
+    std::remove(fileName.c_str());
+    return false;
+  }
+
+  /* Referential change from cells to geographical coordinates. */
+  Projection::ChangeMatrix change;
+  change << resolution, 0., left + .5 * resolution,
+            0., -resolution, top - .5 * resolution;
+  Projection::writeWorldFile(worldName, change);
+  GEODESK_COUNT("cells gridded",
+                static_cast<long long>(width * height));
+  return true;
+}
@@ -0,0 +1,251 @@
+#ifndef GRIDDER_HPP
+#define GRIDDER_HPP
+
+/**
+ * \file gridder.hpp
+ * \brief Interpolating geo-referenced data on a regular grid, independently
+ * from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "sample.hpp"
+#include "datafile.hpp"
+#include "triangulation.hpp"
+
+/// \brief Namespace for geo-referenced data.
+namespace Data {
+  /**
+   * \brief Interpolation of values of samples on a regular grid in
+   * longitude and latitude, such as depths given along isobaths and by
+   * soundings.
+   *
+   * Values are interpolated either linearly in the Delaunay triangulation
+   * of samples, or by inverse distance weighting of the nearest samples,
+   * found in a kd-tree. Distances are measured in a plane tangent at the
+   * centre of samples, degrees of longitude being shortened by the cosine
+   * of the latitude.
+   *
+   * The kd-tree is implicit: samples are only sorted, taking 24 bytes per
+   * sample, and the order of the tree is kept for the triangulation, whose
+   * points are thus inserted close to each other. The grid is computed by
+   * tiles in parallel, each tile being written in a tiled GeoTIFF of
+   * 32-bit floats as soon as it is computed, along with a world file.
+   */
+  class Gridder {
+    public:
+      /// \brief Interpolation methods.
+      enum Method {
+        /// \brief Linear interpolation in the Delaunay triangulation.
+        tinMethod,
+        /// \brief Inverse distance weighting of the nearest samples.
+        idwMethod
+      };
+
+      /**
+       * \brief Function reading samples: given the index of the first
+       * sample and the number of samples, it puts them in order.
+       */
+      typedef std::function<void (std::size_t, std::size_t, Sample*)>
+        SampleReader;
+
+      /// \brief Side of tiles of the grid, in cells.
+      static const int tileSize = 256;
+
+      /// \brief Greatest number of cells along each side of the grid.
+      static const int maximumSide = 1 << 18;
+
+      /// \brief Number of samples weighted by inverse distance weighting.
+      static const int neighbours = 12;
+
+      /// \brief Number of samples read at once.
+      static const std::size_t chunkSize = 4096;
+
+      /// \brief Value of cells where nothing is interpolated.
+      static const float noData;
+
+      /**
+       * \brief Take positions and values of samples.
+       * \param reader Function reading samples.
+       * \param count Number of samples.
+       */
+      Gridder (const SampleReader &reader, std::size_t count);
+
+      /**
+       * \brief Take positions and values of samples of a list.
+       * \param samples The samples.
+       */
+      explicit Gridder (const std::vector<Sample> &samples);
+
+      /**
+       * \brief Take positions and values of samples of a binary data file,
+       * reading only the columns needed.
+       * \param file The file.
+       */
+      explicit Gridder (const BinaryFile &file);
+
+      /// \brief Number of samples.
+      std::size_t size () const {return vertices.size();}
+
+      /**
+       * \brief Interpolate the grid and write it.
+       * \param fileName Name of the GeoTIFF file, whose world file is named
+       * after it.
+       * \param method Interpolation method.
+       * \param resolution Side of cells, in degrees.
+       * \param radius Greatest distance of samples weighted by inverse
+       * distance weighting, in degrees of latitude, no limit when not
+       * positive.
+       * \param threads Number of threads computing tiles.
+       * \param carryOn Function called as the grid is computed with the
+       * percentage done, which interrupts gridding when returning false.
+       * Calls come from any thread, one at a time.
+       * \return Whether or not the grid has been written, files being
+       * removed when interrupted.
+       * \exception std::runtime_error There is no sample, the resolution is
+       * not valid or a file cannot be written.
+       */
+      bool write (const std::string &fileName, Method method,
+                  double resolution, double radius, unsigned threads,
+                  const std::function<bool (int)> &carryOn);
+
+    private:
+      /// \brief Greatest number of samples in leaves of the kd-tree.
+      static const std::size_t leafSize = 8;
+
+      /// \brief Samples, in the plane, sorted as a kd-tree once sorted.
+      std::vector<Triangulation::Vertex> vertices;
+
+      /// \brief Longitude of the centre of samples.
+      double longitude;
+
+      /// \brief Latitude of the centre of samples.
+      double latitude;
+
+      /// \brief Length of a degree of longitude in degrees of latitude.
+      double shrink;
+
+      /// \brief Smallest longitude.
+      double west;
+
+      /// \brief Smallest latitude.
+      double south;
+
+      /// \brief Greatest longitude.
+      double east;
+
+      /// \brief Greatest latitude.
+      double north;
+
+      /// \brief Whether or not samples are sorted as a kd-tree.
+      bool sorted;
+
+      /// \brief Whether or not samples are triangulated.
+      bool triangulated;
+
+      /// \brief Triangulation of samples.
+      Triangulation triangulation;
+
+      /**
+       * \brief Add samples.
+       * \param samples Samples read.
+       * \param count Number of samples.
+       */
+      void add (const Sample* samples, std::size_t count);
+
+      /// \brief Compute the plane, once samples are added.
+      void project ();
+
+      /**
+       * \brief Sort samples of a subtree of the kd-tree.
+       * \param first Index of the first sample.
+       * \param last Index after the last sample.
+       * \param depth Depth of the subtree, telling the axis split.
+       * \param threads Number of threads sorting the subtree.
+       */
+      void sortTree (std::size_t first, std::size_t last, int depth,
+                     unsigned threads);
+
+      /// \brief Nearest samples found.
+      struct Nearest {
+        /// \brief Number of samples found.
+        int count;
+
+        /// \brief Greatest squared distance of samples looked for.
+        double limit;
+
+        /// \brief Squared distances of samples, increasing.
+        double distance [neighbours];
+
+        /// \brief Values of samples.
+        double value [neighbours];
+
+        /// \brief Greatest squared distance of samples still looked for.
+        double worst () const {
+          return (count < neighbours)? limit: distance[neighbours - 1];
+        }
+
+        /**
+         * \brief Keep a sample, if it is closer than the ones found.
+         * \param squared Squared distance of the sample.
+         * \param sample Value of the sample.
+         */
+        void add (double squared, double sample) {
+          if (!(squared < worst())) return;
+          /* Position of the sample in the list. */
+          int i = (count < neighbours)? count++: neighbours - 1;
+          for (; i > 0 && distance[i - 1] > squared; --i) {
+            distance[i] = distance[i - 1];
+            value[i] = value[i - 1];
+          }
+          distance[i] = squared;
+          value[i] = sample;
+        }
+      };
+
+      /**
+       * \brief Find the nearest samples in a subtree of the kd-tree.
+       * \param first Index of the first sample.
+       * \param last Index after the last sample.
+       * \param depth Depth of the subtree.
+       * \param x Abscissa of the position, in the plane.
+       * \param y Ordinate of the position, in the plane.
+       * \param found Samples found, where samples closer are added.
+       */
+      void search (std::size_t first, std::size_t last, int depth, double x,
+                   double y, Nearest &found) const;
+
+      /**
+       * \brief Interpolate by inverse distance weighting.
+       * \param x Abscissa of the position, in the plane.
+       * \param y Ordinate of the position, in the plane.
+       * \param limit Greatest squared distance of samples weighted.
+       * \return The value, noData if no sample is close enough.
+       */
+      float weigh (double x, double y, double limit) const;
+
+      /**
+       * \brief Interpolate the cells of a tile.
+       * \param method Interpolation method.
+       * \param left Longitude of the left side of the grid.
+       * \param top Latitude of the top side of the grid.
+       * \param resolution Side of cells.
+       * \param limit Greatest squared distance of samples weighted.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       * \param cells Where to put the values, row by row.
+       */
+      void interpolate (Method method, double left, double top,
+                        double resolution, double limit, int column,
+                        int row, float* cells) const;
+  };
+}
+
+#endif  // #ifndef GRIDDER_HPP
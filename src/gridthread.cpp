@@ -0,0 +1,35 @@
+/**
+ * \file gridthread.cpp
+ * \brief Implementation of data interpolated in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+#include "gridthread.hpp"
+
+/* -- Interpolate and write the grid. ------------------------------------- */
+void GUI::GridThread::run () {
+  /* Number of threads, one per core. */
+  const int threads = std::max(QThread::idealThreadCount(), 1);
+  try {
+    /* The gridder. */
+    Data::Gridder gridder (*samples);
+    gridder.write(fileName, method, resolution, radius,
+                  static_cast<unsigned>(threads), [this] (int percent) {
+                    emit progress(percent);
+                    return !isCancelled();
+                  });
+  }
+  catch (const std::runtime_error &e) {
+    error = e.what();
+  }
+  catch (const std::bad_alloc &) {
+    error = "There is not enough memory to grid data.";
+  }
+  if (!isCancelled()) emit gridded();
+}
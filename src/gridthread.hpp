@@ -0,0 +1,107 @@
+#ifndef GRIDTHREAD_HPP
+#define GRIDTHREAD_HPP
+
+/**
+ * \file gridthread.hpp
+ * \brief Interpolating data on a regular grid in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include <QThread>
+#include <QAtomicInt>
+
+#include "sample.hpp"
+#include "gridder.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Thread interpolating samples on a regular grid written as a
+   * GeoTIFF with its world file.
+   *
+   * Samples are given as a copy, so that data can still be set while
+   * gridding. Tiles of the grid are computed by as many threads as cores.
+   * The thread can be cancelled at any time, it then stops as soon as
+   * possible and removes the file partly written.
+   */
+  class GridThread: public QThread {
+      Q_OBJECT
+
+    public:
+      /**
+       * \brief Construct the thread, which should then be started.
+       * \param _samples Samples interpolated.
+       * \param _fileName Name of the GeoTIFF file, as known by the system.
+       * \param _method Interpolation method.
+       * \param _resolution Side of cells, in degrees.
+       * \param _radius Greatest distance of samples weighted by inverse
+       * distance weighting, in degrees of latitude.
+       * \param parent Parent object.
+       */
+      GridThread (const std::shared_ptr<const std::vector<Data::Sample> >
+                    &_samples,
+                  const std::string &_fileName, Data::Gridder::Method _method,
+                  double _resolution, double _radius, QObject* parent = 0):
+        QThread (parent), samples (_samples), fileName (_fileName),
+        method (_method), resolution (_resolution), radius (_radius),
+        cancelled (0) {}
+
+      /// \brief Ask the thread to stop.
+      void cancel () {cancelled.fetchAndStoreOrdered(1);}
+
+      /// \brief Whether or not the thread has been cancelled.
+      bool isCancelled () const {
+        return cancelled.fetchAndAddOrdered(0) != 0;
+      }
+
+      /**
+       * \brief Why the grid cannot be written, once signal gridded() is
+       * emitted, empty on success.
+       */
+      const std::string &failure () const {return error;}
+
+    signals:
+      /**
+       * \brief Emitted as the grid is computed.
+       * \param percent Percentage done.
+       */
+      void progress (int percent);
+
+      /// \brief Emitted when gridding is over, unless cancelled.
+      void gridded ();
+
+    protected:
+      /// \brief Interpolate and write the grid.
+      virtual void run ();
+
+    private:
+      /// \brief Samples interpolated.
+      const std::shared_ptr<const std::vector<Data::Sample> > samples;
+
+      /// \brief Name of the file written.
+      const std::string fileName;
+
+      /// \brief Interpolation method.
+      const Data::Gridder::Method method;
+
+      /// \brief Side of cells.
+      const double resolution;
+
+      /// \brief Greatest distance of samples weighted.
+      const double radius;
+
+      /// \brief Non-zero when the thread has been cancelled.
+      mutable QAtomicInt cancelled;
+
+      /// \brief Why the grid cannot be written.
+      std::string error;
+  };
+}
+
+#endif  // #ifndef GRIDTHREAD_HPP
@@ -0,0 +1,130 @@
+/**
+ * \file imageloader.cpp
+ * \brief Implementation of image loading in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <QFile>
+
+#include "imageloader.hpp"
+#include "rasterdecoder.hpp"
+#include "profiler.hpp"
+
+/* -- Load the image. ----------------------------------------------------- */
+void GUI::ImageLoader::run () {
+  /* Bound of the preview. */
+  const QSize bound (previewSize, previewSize);
+  /* Function informed of progress. */
+  const Raster::Progress progressFunction =
+    [this] (qint64 done, qint64 total) {return report(done, total);};
+
+  /* Size of the image at full resolution. */
+  QSize size;
+  /* Whether or not pixels have been decoded in a previous session. */
+  const bool decoded =
+    !session.isNull() && QFile::exists(session.pixelsFile());
+  /* Whether or not pixels of the reduced image are averaged. */
+  bool averaged = false;
+  /* The image at reduced resolution, to be shown at once. */
+  QImage reduced;
+  if (!decoded) {
+    GEODESK_TIME("ImageLoader::reduced");
+    reduced = Raster::readReduced(fileName, Raster::maximumReduction, size,
+                                  averaged);
+  }
+  /*
+   * Formats which can be decoded at low resolution are shown at once,
+   * unless pixels have already been decoded in a previous session.
+   */
+  QImage preview;
+  if (!decoded) {
+    /* Size of the preview. */
+    const QSize scaled =
+      size.scaled(bound, Qt::KeepAspectRatio).boundedTo(size);
+    if (!reduced.isNull() && (reduced.width() >= scaled.width())
+        && (reduced.height() >= scaled.height()))
+      preview = reduced.scaled(scaled, Qt::KeepAspectRatio,
+                               Qt::SmoothTransformation);
+    else
+      preview = Raster::readPreview(fileName, bound, size);
+  }
+  if (isCancelled()) return;
+  if (!preview.isNull()) emit previewReady(preview, size);
+
+  /* Level of the pyramid of the reduced image. */
+  int level = 0;
+  for (int r = Raster::maximumReduction; r > 1; r /= 2) ++level;
+  /* Pyramid built before pixels at full resolution are decoded. */
+  std::shared_ptr<ImagePyramid> early;
+  if (averaged) {
+    early.reset(new ImagePyramid (size));
+    if (early->firstResident() >= level) {
+      GEODESK_TIME("ImageLoader::levels");
+      levels = early->buildLevels(reduced, level);
+    }
+    if (levels.empty()) {
+      early.reset();
+    }
+    else {
+      if (!session.isNull())
+        ImagePyramid::writeLevels(session.levelsFile(), levels);
+      result = early;
+      emit pyramidReady();
+      emit levelsReady();
+    }
+  }
+  reduced = QImage ();
+
+  percent = -1;
+  /* The image, which may be decoded into a cache file. */
+  Raster::SourcePointer source;
+  {
+    GEODESK_TIME("ImageLoader::decode");
+    source = Raster::open(fileName, progressFunction,
+                          session.isNull()? QString (): session.pixelsFile());
+  }
+  if (isCancelled()) return;
+  if (!source) {
+    emit failed();
+    return;
+  }
+  if (early) {
+    if (source->size() != early->size()) {
+      emit failed();
+      return;
+    }
+    early->setSource(source);
+    emit sourceReady();
+    return;
+  }
+  if (preview.isNull())
+    emit previewReady(source->preview(bound), source->size());
+
+  result.reset(new ImagePyramid (source));
+  emit pyramidReady();
+
+  GEODESK_TIME("ImageLoader::levels");
+  if (!session.isNull()) levels = result->readLevels(session.levelsFile());
+  if (levels.empty()) {
+    percent = -1;
+    levels = result->buildLevels(progressFunction);
+    if (isCancelled() || levels.empty()) return;
+    if (!session.isNull())
+      ImagePyramid::writeLevels(session.levelsFile(), levels);
+  }
+  if (isCancelled()) return;
+  emit levelsReady();
+}
+
+/* -- Report progress. ---------------------------------------------------- */
+bool GUI::ImageLoader::report (qint64 done, qint64 total) {
+  /* Percentage done. */
+  const int current = (total > 0)? static_cast<int>(100 * done / total): 0;
+  if (current != percent) {
+    percent = current;
+    emit progress(percent);
+  }
+  return !isCancelled();
+}
@@ -0,0 +1,145 @@
+#ifndef IMAGELOADER_HPP
+#define IMAGELOADER_HPP
+
+/**
+ * \file imageloader.hpp
+ * \brief Loading images in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <memory>
+#include <QThread>
+#include <QString>
+#include <QImage>
+#include <QSize>
+#include <QAtomicInt>
+
+#include "imagepyramid.hpp"
+#include "session.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Thread loading an image progressively.
+   *
+   * The loader first gives a preview of the image at low resolution, then
+   * the pyramid of the image, whose tiles at full resolution are already
+   * readable, and finally levels of the pyramid kept in memory. The loader
+   * can be cancelled at any time, it then stops as soon as possible without
+   * giving any further result.
+   *
+   * When the image can be decoded averaged at reduced resolution (JPEG),
+   * levels kept in memory are built from it: the pyramid and its levels are
+   * then given before pixels at full resolution are decoded, which is
+   * reported by signal sourceReady().
+   *
+   * Decoded pixels and levels kept in memory are taken from the files of
+   * the session of the image when they exist, and written there otherwise.
+   */
+  class ImageLoader: public QThread {
+      Q_OBJECT
+
+    public:
+      /// \brief Maximum size of the preview.
+      static const int previewSize = 1024;
+
+      /**
+       * \brief Construct the loader, which should then be started.
+       * \param _fileName Name of the image file.
+       * \param _session Session of the image, null to keep nothing.
+       * \param parent Parent object.
+       */
+      ImageLoader (const QString &_fileName, const Session &_session,
+                   QObject* parent = 0):
+        QThread (parent), fileName (_fileName), session (_session),
+        cancelled (0) {}
+
+      /// \brief Ask the loader to stop.
+      void cancel () {cancelled.fetchAndStoreOrdered(1);}
+
+      /// \brief Whether or not the loader has been cancelled.
+      bool isCancelled () const {
+        return cancelled.fetchAndAddOrdered(0) != 0;
+      }
+
+      /**
+       * \brief The pyramid of the image, once signal pyramidReady() has been
+       * emitted.
+       */
+      std::shared_ptr<ImagePyramid> pyramid () const {return result;}
+
+      /**
+       * \brief Take levels kept in memory, once signal levelsReady() has been
+       * emitted.
+       * \param destination Where to put levels.
+       */
+      void takeLevels (ImagePyramid::Levels &destination) {
+        destination.swap(levels);
+      }
+
+    signals:
+      /**
+       * \brief Emitted when a preview of the image is available.
+       * \param preview The image at low resolution.
+       * \param size Size of the image at full resolution.
+       */
+      void previewReady (const QImage &preview, const QSize &size);
+
+      /// \brief Emitted when the pyramid of the image is available.
+      void pyramidReady ();
+
+      /// \brief Emitted when levels kept in memory are available.
+      void levelsReady ();
+
+      /**
+       * \brief Emitted when pixels at full resolution are readable, after
+       * levels kept in memory have been given without them.
+       */
+      void sourceReady ();
+
+      /**
+       * \brief Emitted while loading.
+       * \param percent Percentage of the current stage done.
+       */
+      void progress (int percent);
+
+      /// \brief Emitted when the image cannot be loaded.
+      void failed ();
+
+    protected:
+      /// \brief Load the image.
+      virtual void run ();
+
+    private:
+      /// \brief Name of the image file.
+      const QString fileName;
+
+      /// \brief Session of the image.
+      const Session session;
+
+      /// \brief Non-zero when the loader has been cancelled.
+      mutable QAtomicInt cancelled;
+
+      /// \brief The pyramid of the image.
+      std::shared_ptr<ImagePyramid> result;
+
+      /// \brief Levels of the pyramid kept in memory.
+      ImagePyramid::Levels levels;
+
+      /// \brief Last percentage emitted.
+      int percent;
+
+      /**
+       * \brief Report progress, emitting signal progress() when needed.
+       * \param done Amount of work done.
+       * \param total Total amount of work.
+       * \return Whether or not loading should go on.
+       */
+      bool report (qint64 done, qint64 total);
+  };
+}
+
+#endif  // #ifndef IMAGELOADER_HPP
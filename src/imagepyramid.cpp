@@ -0,0 +1,330 @@
+/**
+ * \file imagepyramid.cpp
+ * \brief Implementation of multi-resolution tiled images.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <QFile>
+
+#include "imagepyramid.hpp"
+
+namespace {
+  /**
+   * \brief Copy an image into another one.
+   * \param destination Image where to copy.
+   * \param source Image to be copied, in the same format as destination.
+   * \param x Abscissa where to copy in destination.
+   * \param y Ordinate where to copy in destination.
+   */
+  void blit (QImage &destination, const QImage &source, int x, int y) {
+    for (int j = 0; j < source.height(); ++j)
+      std::memcpy(destination.scanLine(y + j) + 4 * x,
+                  source.scanLine(j),
+                  4 * static_cast<std::size_t>(source.width()));
+  }
+
+  /// \brief Magic number at the beginning of files of levels.
+  const char levelsMagic [] = "GDLevels";
+}
+
+/* -- Build the pyramid of an image. -------------------------------------- */
+GUI::ImagePyramid::ImagePyramid (const Raster::SourcePointer &_source):
+  source (_source), resident (0), cache (cacheBudget) {
+  if (source) layout(source->size());
+}
+
+/* -- Build the pyramid of an image not readable yet. --------------------- */
+GUI::ImagePyramid::ImagePyramid (const QSize &size):
+  resident (0), cache (cacheBudget) {
+  layout(size);
+}
+
+/* -- Compute sizes of levels. -------------------------------------------- */
+void GUI::ImagePyramid::layout (const QSize &size) {
+  if (size.isEmpty()) return;
+
+  sizes.push_back(size);
+  while ((sizes.back().width() > tileSize)
+         || (sizes.back().height() > tileSize))
+    sizes.push_back(QSize ((sizes.back().width() + 1) / 2,
+                           (sizes.back().height() + 1) / 2));
+  tiles.resize(sizes.size());
+
+  /* Memory needed by levels kept in memory. */
+  qint64 memory = 0;
+  resident = levels();
+  while (resident > 0) {
+    memory += 4 * static_cast<qint64>(sizes[resident - 1].width())
+      * sizes[resident - 1].height();
+    if (memory > residentBudget) break;
+    --resident;
+  }
+  if (resident == levels()) resident = levels() - 1;
+}
+
+/* -- Build levels kept in memory. ---------------------------------------- */
+GUI::ImagePyramid::Levels
+GUI::ImagePyramid::buildLevels (const Raster::Progress &progress) const {
+  /* Half of the tile size. */
+  const int half = tileSize / 2;
+  /* Levels built. */
+  Levels result (tiles.size());
+
+  for (int level = resident; level < levels(); ++level) {
+    result[level].reserve(static_cast<std::size_t>(columns(level)
+                                                   * rows(level)));
+    for (int row = 0; row < rows(level); ++row) {
+      for (int column = 0; column < columns(level); ++column) {
+        if (level == resident) {
+          result[level].push_back(compose(level, column, row, false));
+          continue;
+        }
+
+        /* The tile, built from the previous level. */
+        QImage tile (tileRect(level, column, row).size(),
+                     QImage::Format_RGB32);
+        for (int dy = 0; dy < 2; ++dy) {
+          for (int dx = 0; dx < 2; ++dx) {
+            /* Column of the tile in the previous level. */
+            const int childColumn = 2 * column + dx;
+            /* Row of the tile in the previous level. */
+            const int childRow = 2 * row + dy;
+            if ((childColumn < columns(level - 1))
+                && (childRow < rows(level - 1)))
+              blit(tile,
+                   halve(result[level - 1][static_cast<std::size_t>(
+                     childRow * columns(level - 1) + childColumn)]),
+                   dx * half, dy * half);
+          }
+        }
+        result[level].push_back(tile);
+      }
+
+      if ((level == resident) && progress
+          && !progress(row + 1, rows(level)))
+        return Levels ();
+    }
+  }
+
+  return result;
+}
+
+/* -- Build levels kept in memory from a lower resolution. ---------------- */
+GUI::ImagePyramid::Levels
+GUI::ImagePyramid::buildLevels (const QImage &image, int level) const {
+  if ((level < 0) || (level > resident) || (image.size() != sizes[level]))
+    return Levels ();
+
+  /* Levels built. */
+  Levels result (tiles.size());
+  /* The image at the current level. */
+  QImage current = (image.format() == QImage::Format_RGB32)?
+    image: image.convertToFormat(QImage::Format_RGB32);
+  for (int l = level; l < levels(); ++l) {
+    if (l > level) current = halve(current);
+    if (l < resident) continue;
+    result[l].reserve(static_cast<std::size_t>(columns(l) * rows(l)));
+    for (int row = 0; row < rows(l); ++row)
+      for (int column = 0; column < columns(l); ++column)
+        result[l].push_back(current.copy(tileRect(l, column, row)));
+  }
+  return result;
+}
+
+/* -- Read levels kept in memory. ----------------------------------------- */
+GUI::ImagePyramid::Levels
+GUI::ImagePyramid::readLevels (const QString &fileName) const {
+  /* The file. */
+  QFile file (fileName);
+  if (!file.open(QIODevice::ReadOnly) || (file.read(8) != levelsMagic))
+    return Levels ();
+  /* Number of levels in the file. */
+  qint32 count;
+  if ((file.read(reinterpret_cast<char*>(&count), 4) != 4)
+      || (count != levels()))
+    return Levels ();
+
+  /* Levels read. */
+  Levels result (tiles.size());
+  for (int level = 0; level < levels(); ++level) {
+    /* Number of tiles of the level. */
+    qint32 tileCount;
+    if (file.read(reinterpret_cast<char*>(&tileCount), 4) != 4)
+      return Levels ();
+    if (tileCount == 0) continue;
+    if ((level < resident) || (tileCount != columns(level) * rows(level)))
+      return Levels ();
+    result[level].reserve(static_cast<std::size_t>(tileCount));
+    for (int row = 0; row < rows(level); ++row) {
+      for (int column = 0; column < columns(level); ++column) {
+        /* The tile. */
+        QImage tile (tileRect(level, column, row).size(),
+                     QImage::Format_RGB32);
+        /* Number of bytes of a row of the tile. */
+        const qint64 bytes = 4 * static_cast<qint64>(tile.width());
+        for (int y = 0; y < tile.height(); ++y)
+          if (file.read(reinterpret_cast<char*>(tile.scanLine(y)), bytes)
+              != bytes)
+            return Levels ();
+        result[level].push_back(tile);
+      }
+    }
+  }
+  if (!file.atEnd() || result[resident].empty()) return Levels ();
+  return result;
+}
+
+/* -- Write levels kept in memory. ---------------------------------------- */
+bool GUI::ImagePyramid::writeLevels (const QString &fileName,
+                                     const Levels &levels) {
+  /* The file, named once complete. */
+  QFile file (fileName + ".part");
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+  /* Number of levels. */
+  const qint32 count = static_cast<qint32>(levels.size());
+  /* Whether or not writing has succeeded. */
+  bool good = (file.write(levelsMagic, 8) == 8)
+    && (file.write(reinterpret_cast<const char*>(&count), 4) == 4);
+  for (std::size_t level = 0; good && (level < levels.size()); ++level) {
+    /* Number of tiles of the level. */
+    const qint32 tileCount = static_cast<qint32>(levels[level].size());
+    good = file.write(reinterpret_cast<const char*>(&tileCount), 4) == 4;
+    for (std::size_t i = 0; good && (i < levels[level].size()); ++i) {
+      /* The tile. */
+      const QImage &tile = levels[level][i];
+      /* Number of bytes of a row of the tile. */
+      const qint64 bytes = 4 * static_cast<qint64>(tile.width());
+      for (int y = 0; good && (y < tile.height()); ++y)
+        good = file.write(reinterpret_cast<const char*>(tile.scanLine(y)),
+                          bytes) == bytes;
+    }
+  }
+  file.close();
+  QFile::remove(fileName);
+  if (!good || !file.rename(fileName)) {
+    file.remove();
+    return false;
+  }
+  return true;
+}
+
+/* -- Choose level for a scale. ------------------------------------------- */
+int GUI::ImagePyramid::levelForScale (double scale) const {
+  /* Chosen level. */
+  int level = 0;
+  /* Scale at which the next level is at full resolution. */
+  double levelScale = 0.5;
+  while ((level + 1 < levels()) && (scale <= levelScale)) {
+    ++level;
+    levelScale /= 2.;
+  }
+  return level;
+}
+
+/* -- Halve the resolution of an image. ----------------------------------- */
+QImage GUI::ImagePyramid::halve (const QImage &image) {
+  /* Width of the image. */
+  const int width = image.width();
+  /* Height of the image. */
+  const int height = image.height();
+  /* Resulting image. */
+  QImage result ((width + 1) / 2, (height + 1) / 2, image.format());
+
+  for (int y = 0; y < result.height(); ++y) {
+    /* First row of the image being averaged. */
+    const quint32* row0 =
+      reinterpret_cast<const quint32*>(image.scanLine(2 * y));
+    /* Second row of the image being averaged. */
+    const quint32* row1 = reinterpret_cast<const quint32*>(
+      image.scanLine(std::min(2 * y + 1, height - 1)));
+    /* Row being computed. */
+    quint32* line = reinterpret_cast<quint32*>(result.scanLine(y));
+
+    for (int x = 0; x < result.width(); ++x) {
+      /* First column being averaged. */
+      const int x0 = 2 * x;
+      /* Second column being averaged. */
+      const int x1 = std::min(2 * x + 1, width - 1);
+      /* Channels 0 and 2 of the four pixels, summed in 16 bits lanes. */
+      const quint32 low = (row0[x0] & 0x00ff00ffu) + (row0[x1] & 0x00ff00ffu)
+        + (row1[x0] & 0x00ff00ffu) + (row1[x1] & 0x00ff00ffu) + 0x00020002u;
+      /* Channels 1 and 3 of the four pixels, summed in 16 bits lanes. */
+      const quint32 high = ((row0[x0] >> 8) & 0x00ff00ffu)
+        + ((row0[x1] >> 8) & 0x00ff00ffu) + ((row1[x0] >> 8) & 0x00ff00ffu)
+        + ((row1[x1] >> 8) & 0x00ff00ffu) + 0x00020002u;
+      line[x] =
+        ((low >> 2) & 0x00ff00ffu) | (((high >> 2) & 0x00ff00ffu) << 8);
+    }
+  }
+
+  return result;
+}
+
+/* -- Get a tile. --------------------------------------------------------- */
+QImage GUI::ImagePyramid::compose (int level, int column, int row,
+                                   bool cached) const {
+  if (!tiles[level].empty())
+    return tiles[level][static_cast<std::size_t>(row * columns(level)
+                                                 + column)];
+  if (cached && (level >= resident)) return QImage ();
+
+  /* Key of the tile in the cache. */
+  const quint64 key = (static_cast<quint64>(level) << 48)
+    | (static_cast<quint64>(row) << 24) | static_cast<quint64>(column);
+  if (cached) {
+    /* Lock on the cache. */
+    const QMutexLocker locker (&mutex);
+    /* Tile in the cache. */
+    const QImage* found = cache.object(key);
+    if (found) return *found;
+  }
+
+  /* The tile itself. */
+  QImage result;
+  if (level == 0) {
+    /* Image cut into tiles, which may not be set yet. */
+    Raster::SourcePointer image;
+    {
+      /* Lock on the source. */
+      const QMutexLocker locker (&mutex);
+      image = source;
+    }
+    if (!image) return QImage ();
+    result = image->read(tileRect(0, column, row));
+  }
+  else {
+    /* Half of the tile size. */
+    const int half = tileSize / 2;
+    result = QImage (tileRect(level, column, row).size(),
+                     QImage::Format_RGB32);
+
+    for (int dy = 0; dy < 2; ++dy) {
+      for (int dx = 0; dx < 2; ++dx) {
+        /* Column of the tile in the previous level. */
+        const int childColumn = 2 * column + dx;
+        /* Row of the tile in the previous level. */
+        const int childRow = 2 * row + dy;
+        if ((childColumn < columns(level - 1))
+            && (childRow < rows(level - 1))) {
+          /* Tile of the previous level. */
+          const QImage child =
+            compose(level - 1, childColumn, childRow, cached);
+          if (child.isNull()) return QImage ();
+          blit(result, halve(child), dx * half, dy * half);
+        }
+      }
+    }
+  }
+
+  if (cached) {
+    /* Lock on the cache. */
+    const QMutexLocker locker (&mutex);
+    cache.insert(key, new QImage (result),
+                 std::max(result.byteCount() / 1024, 1));
+  }
+  return result;
+}
@@ -0,0 +1,277 @@
+#ifndef IMAGEPYRAMID_HPP
+#define IMAGEPYRAMID_HPP
+
+/**
+ * \file imagepyramid.hpp
+ * \brief Multi-resolution tiled representation of an image.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <vector>
+#include <QImage>
+#include <QSize>
+#include <QRect>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "raster.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Image cut into tiles, at several resolutions.
+   *
+   * Level 0 is the image at full resolution, each following level halves
+   * the resolution of the previous one, until the image fits in a single
+   * tile. Tiles of a level are stored row by row.
+   *
+   * Only the coarsest levels, which fit in a memory budget, are kept in
+   * memory. Tiles of finer levels are computed from the image source when
+   * needed, and kept in a cache of bounded size.
+   *
+   * Levels kept in memory are built apart, possibly in another thread,
+   * through buildLevels(), then given to the pyramid with setLevels(). Until
+   * then, their tiles are null images.
+   *
+   * A pyramid can be built before the pixels of its image are readable, its
+   * levels kept in memory being built from the image decoded at reduced
+   * resolution. Tiles of other levels are then null images until the image
+   * source is given by setSource().
+   */
+  class ImagePyramid {
+    public:
+      /// \brief Width and height of tiles, in pixels.
+      static const int tileSize = 256;
+
+      /// \brief Memory budget for levels kept in memory, in bytes.
+      static const qint64 residentBudget = 64 << 20;
+
+      /// \brief Memory budget for the cache of tiles, in kilobytes.
+      static const int cacheBudget = 256 << 10;
+
+      /// \brief Type for tiles of each level.
+      typedef std::vector< std::vector<QImage> > Levels;
+
+      /// \brief Construct an empty pyramid.
+      ImagePyramid (): resident (0) {}
+
+      /**
+       * \brief Construct the pyramid of an image, without levels kept in
+       * memory.
+       * \param _source Image to be cut into tiles.
+       */
+      explicit ImagePyramid (const Raster::SourcePointer &_source);
+
+      /**
+       * \brief Construct the pyramid of an image whose pixels are not
+       * readable yet.
+       * \param size Size of the image.
+       */
+      explicit ImagePyramid (const QSize &size);
+
+      /**
+       * \brief Set the image cut into tiles, when the pyramid has been
+       * constructed without it.
+       * \param _source The image, whose size is the one of the pyramid.
+       *
+       * This can be done while tiles are accessed from other threads.
+       */
+      void setSource (const Raster::SourcePointer &_source) {
+        /* Lock on the source. */
+        const QMutexLocker locker (&mutex);
+        source = _source;
+      }
+
+      /// \brief Whether or not pixels at full resolution are readable.
+      bool hasSource () const {
+        /* Lock on the source. */
+        const QMutexLocker locker (&mutex);
+        return static_cast<bool>(source);
+      }
+
+      /**
+       * \brief Build levels kept in memory.
+       * \param progress Function called after each row of tiles, which
+       * interrupts building when returning false.
+       * \return Tiles of each level, empty for levels not kept in memory, or
+       * no level at all if building has been interrupted.
+       *
+       * The whole image is read once. This can be done in another thread than
+       * the one using the pyramid.
+       */
+      Levels buildLevels (const Raster::Progress &progress) const;
+
+      /**
+       * \brief Build levels kept in memory from the image at a lower
+       * resolution.
+       * \param image The image at a level not coarser than the first one
+       * kept in memory.
+       * \param level Level of image, whose size is the one of the level.
+       * \return Tiles of each level, as given by buildLevels(), or no level
+       * at all if image does not match the level.
+       */
+      Levels buildLevels (const QImage &image, int level) const;
+
+      /**
+       * \brief Read levels kept in memory, written by a previous session.
+       * \param fileName Name of the file.
+       * \return Tiles of each level, as given by buildLevels(), or no level
+       * at all if the file does not exist or does not match the pyramid.
+       */
+      Levels readLevels (const QString &fileName) const;
+
+      /**
+       * \brief Write levels kept in memory, to be read by a next session.
+       * \param fileName Name of the file.
+       * \param levels Levels built by buildLevels().
+       * \return Whether or not the file has been written.
+       */
+      static bool writeLevels (const QString &fileName,
+                               const Levels &levels);
+
+      /**
+       * \brief Set levels kept in memory.
+       * \param levels Levels built by buildLevels(), which are taken.
+       */
+      void setLevels (Levels &levels) {
+        if (levels.size() == tiles.size()) tiles.swap(levels);
+      }
+
+      /**
+       * \brief Whether or not levels kept in memory are set and pixels at
+       * full resolution are readable.
+       */
+      bool isComplete () const {
+        return !isNull() && !tiles.back().empty() && hasSource();
+      }
+
+      /// \brief Whether or not the pyramid contains an image.
+      bool isNull () const {return sizes.empty();}
+
+      /// \brief Size of the image at full resolution.
+      QSize size () const {return isNull()? QSize (): sizes.front();}
+
+      /// \brief Number of levels.
+      int levels () const {return static_cast<int>(sizes.size());}
+
+      /**
+       * \brief Size of the image at a given level.
+       * \param level Level of the pyramid.
+       * \return Size of the image at this level.
+       */
+      QSize levelSize (int level) const {return sizes[level];}
+
+      /**
+       * \brief Number of tile columns at a given level.
+       * \param level Level of the pyramid.
+       * \return Number of columns.
+       */
+      int columns (int level) const {
+        return (sizes[level].width() + tileSize - 1) / tileSize;
+      }
+
+      /**
+       * \brief Number of tile rows at a given level.
+       * \param level Level of the pyramid.
+       * \return Number of rows.
+       */
+      int rows (int level) const {
+        return (sizes[level].height() + tileSize - 1) / tileSize;
+      }
+
+      /**
+       * \brief Access to a tile, computing it if needed.
+       * \param level Level of the pyramid.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       * \return The tile, in format QImage::Format_RGB32, or a null image
+       * if its level should be kept in memory but is not set yet, or if
+       * the image source is not set yet.
+       *
+       * Tiles can be accessed from several threads at once.
+       */
+      QImage tile (int level, int column, int row) const {
+        return compose(level, column, row, true);
+      }
+
+      /// \brief Finest level kept in memory.
+      int firstResident () const {return resident;}
+
+      /**
+       * \brief Area covered by a tile, in pixels of its level.
+       * \param level Level of the pyramid.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       * \return Rectangle covered by the tile.
+       */
+      QRect tileRect (int level, int column, int row) const {
+        return QRect (column * tileSize, row * tileSize, tileSize,
+                      tileSize).intersected(QRect (QPoint (0, 0),
+                                                   sizes[level]));
+      }
+
+      /**
+       * \brief Choose the level to be displayed at a given scale.
+       * \param scale Scale factor of the display.
+       * \return Coarsest level whose resolution is not lower than the one
+       * displayed.
+       */
+      int levelForScale (double scale) const;
+
+      /**
+       * \brief Halve the resolution of an image, averaging 2x2 blocks.
+       * \param image Image in 32 bits format.
+       * \return Image whose size is half the one of image, rounded up.
+       */
+      static QImage halve (const QImage &image);
+
+    private:
+      /// \brief Image cut into tiles.
+      Raster::SourcePointer source;
+
+      /// \brief Tiles of each level, empty for levels not kept in memory.
+      std::vector< std::vector<QImage> > tiles;
+
+      /// \brief Size of the image at each level.
+      std::vector<QSize> sizes;
+
+      /// \brief Finest level kept in memory.
+      int resident;
+
+      /// \brief Protects the cache of tiles and the source.
+      mutable QMutex mutex;
+
+      /// \brief Cache of tiles of levels not kept in memory.
+      mutable QCache<quint64, QImage> cache;
+
+      /**
+       * \brief Get a tile, from memory or computed from finer levels.
+       * \param level Level of the pyramid.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       * \param cached Whether or not to use the cache of tiles.
+       * \return The tile.
+       */
+      QImage compose (int level, int column, int row, bool cached) const;
+
+      /**
+       * \brief Compute the size of each level and the first level kept in
+       * memory.
+       * \param size Size of the image.
+       */
+      void layout (const QSize &size);
+
+      /// \brief Copy is forbidden.
+      ImagePyramid (const ImagePyramid &);
+
+      /// \brief Copy is forbidden.
+      ImagePyramid &operator = (const ImagePyramid &);
+  };
+}
+
+#endif  // #ifndef IMAGEPYRAMID_HPP
@@ -0,0 +1,357 @@
+/**
+ * \file imageview.cpp
+ * \brief Implementation of the widget displaying images.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <QPainter>
+#include <QRegion>
+#include <QPaintEvent>
+#include <QRectF>
+#include <QPen>
+
+#include "imageview.hpp"
+#include "profiler.hpp"
+
+const int GUI::ImageView::sampleSpacing;
+const int GUI::ImageView::referenceSize;
+
+/* -- Construct the view. ------------------------------------------------- */
+GUI::ImageView::ImageView (QWidget* parent): QWidget (parent),
+                                             zoomIn (1.), zoomOut (1.),
+                                             scaleFactor (1.),
+                                             selected (false) {
+  setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+/* -- Remove the image. --------------------------------------------------- */
+void GUI::ImageView::clear () {
+  zoom.reset();
+  pyramid.reset();
+  previewImage = QImage ();
+  fullSize = QSize ();
+  selected = false;
+  traceList.clear();
+  setScale(scaleFactor);
+}
+
+/* -- Display a preview. -------------------------------------------------- */
+void GUI::ImageView::setPreview (const QImage &preview, const QSize &size) {
+  zoom.reset();
+  pyramid.reset();
+  previewImage = preview;
+  fullSize = size;
+  setScale(scaleFactor);
+}
+
+/* -- Display tiles. ------------------------------------------------------ */
+void GUI::ImageView::setPyramid (const std::shared_ptr<ImagePyramid>
+                                   &_pyramid) {
+  pyramid = _pyramid;
+  fullSize = pyramid->size();
+  zoom.reset(new ZoomCache (pyramid));
+  connect(zoom.get(), SIGNAL(rendered(double, const QRect&)),
+          this, SLOT(tileRendered(double, const QRect&)));
+  setScale(scaleFactor);
+}
+
+/* -- Set levels kept in memory. ------------------------------------------ */
+void GUI::ImageView::setLevels (ImagePyramid::Levels &levels) {
+  if (!pyramid) return;
+  pyramid->setLevels(levels);
+  if (pyramid->isComplete()) previewImage = QImage ();
+  update();
+}
+
+/* -- Pixels at full resolution are readable. ----------------------------- */
+void GUI::ImageView::sourceLoaded () {
+  if (!pyramid) return;
+  if (pyramid->isComplete()) previewImage = QImage ();
+  update();
+}
+
+/* -- Replace samples drawn. ---------------------------------------------- */
+void GUI::ImageView::setSamples (const std::vector<Data::Sample> &samples,
+                                 const Projection::ChangeMatrix* change,
+                                 const Projection::MapProjection*
+                                   projection) {
+  /* Abscissae of samples in the image. */
+  std::vector<double> x (samples.size());
+  /* Ordinates of samples in the image. */
+  std::vector<double> y (samples.size());
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    x[i] = change? samples[i].longitude: samples[i].x;
+    y[i] = change? samples[i].latitude: samples[i].y;
+  }
+  if (change && !samples.empty()) {
+    try {
+      Projection::geographicToImage(*change, projection, &x[0], &y[0],
+                                    &x[0], &y[0], x.size());
+    }
+    catch (const std::domain_error &) {
+      for (std::size_t i = 0; i < samples.size(); ++i) {
+        x[i] = samples[i].x;
+        y[i] = samples[i].y;
+      }
+    }
+  }
+  sampleLayer.assign(x.empty()? 0: &x[0], y.empty()? 0: &y[0], x.size());
+  update();
+}
+
+/* -- Add a sample drawn. ------------------------------------------------- */
+void GUI::ImageView::addSample (const Projection::Point2D &position) {
+  sampleLayer.add(position.x(), position.y());
+  update(static_cast<int>(position.x() * scaleFactor) - sampleSpacing,
+         static_cast<int>(position.y() * scaleFactor) - sampleSpacing,
+         2 * sampleSpacing + 1, 2 * sampleSpacing + 1);
+}
+
+/* -- Replace reference points drawn. ------------------------------------- */
+void GUI::ImageView::setReferencePoints (const std::vector<Projection::
+                                         ReferencePoints::Point> &points) {
+  referenceList.resize(points.size());
+  for (std::size_t i = 0; i < points.size(); ++i)
+    referenceList[i] = points[i].first;
+  update();
+}
+
+/* -- Highlight a sample. ------------------------------------------------- */
+void GUI::ImageView::setSelection (const Projection::Point2D &position) {
+  if (selected) update(selectionRect());
+  selection = position;
+  selected = true;
+  update(selectionRect());
+}
+
+/* -- Remove the highlight. ----------------------------------------------- */
+void GUI::ImageView::clearSelection () {
+  if (!selected) return;
+  selected = false;
+  update(selectionRect());
+}
+
+/* -- Draw a line traced. ------------------------------------------------- */
+void GUI::ImageView::setTrace (const std::vector<Projection::Point2D>
+                                 &points) {
+  traceList = points;
+  update();
+}
+
+/* -- Area of the selection. ---------------------------------------------- */
+QRect GUI::ImageView::selectionRect () const {
+  return QRect (static_cast<int>(selection.x() * scaleFactor)
+                - 2 * referenceSize,
+                static_cast<int>(selection.y() * scaleFactor)
+                - 2 * referenceSize,
+                4 * referenceSize + 1, 4 * referenceSize + 1);
+}
+
+/* -- Change scale. ------------------------------------------------------- */
+void GUI::ImageView::setScale (double factor) {
+  scaleFactor = factor;
+  if (zoom)
+    zoom->setWanted(QList<double> () << scaleFactor << scaleFactor * zoomIn
+                    << scaleFactor * zoomOut);
+  resize(imageSize() * scaleFactor);
+  update();
+}
+
+/* -- Set zoom steps. ----------------------------------------------------- */
+void GUI::ImageView::setZoomSteps (double in, double out) {
+  zoomIn = in;
+  zoomOut = out;
+  setScale(scaleFactor);
+}
+
+/* -- Redraw a rendered tile. --------------------------------------------- */
+void GUI::ImageView::tileRendered (double scale, const QRect &area) {
+  if (sender() == zoom.get() && scale == scaleFactor) update(area);
+}
+
+/* -- Paint visible tiles. ------------------------------------------------ */
+void GUI::ImageView::paintEvent (QPaintEvent* event) {
+  GEODESK_TIME("ImageView::paintEvent");
+  /* Painter on the widget. */
+  QPainter painter (this);
+  painter.fillRect(event->rect(), palette().dark());
+  if (isEmpty()) return;
+  if (!pyramid) {
+    drawPreview(painter, event->rect());
+    drawOverlay(painter, event->rect());
+    return;
+  }
+
+  if (!zoom || !ZoomCache::resamples(scaleFactor))
+    drawLevel(painter, event->rect());
+  else {
+    /* Area of the widget whose resampled tiles are not rendered yet. */
+    QRegion missing;
+    /* Area to be painted. */
+    const QRect area = event->rect().intersected(rect());
+    for (int row = area.top() / ZoomCache::tileSize;
+         row <= area.bottom() / ZoomCache::tileSize; ++row)
+      for (int column = area.left() / ZoomCache::tileSize;
+           column <= area.right() / ZoomCache::tileSize; ++column) {
+        /* The tile, which may not be rendered yet. */
+        const QImage tile = zoom->tile(scaleFactor, column, row);
+        /* Where the tile is drawn. */
+        const QRect target = zoom->tileRect(scaleFactor, column, row);
+        if (tile.isNull())
+          missing += target.intersected(area);
+        else
+          painter.drawImage(target.topLeft(), tile);
+      }
+    if (!missing.isEmpty()) {
+      painter.setClipRegion(missing);
+      drawLevel(painter, missing.boundingRect());
+      painter.setClipping(false);
+    }
+    prefetch();
+  }
+  drawOverlay(painter, event->rect());
+}
+
+/* -- Draw from the pyramid. ---------------------------------------------- */
+void GUI::ImageView::drawLevel (QPainter &painter, const QRect &target) {
+  /* Level displayed. */
+  const int level = pyramid->levelForScale(scaleFactor);
+  /* Size of a level pixel on screen. */
+  const double pixel = scaleFactor * static_cast<double>(1 << level);
+  /* Area to be drawn, in pixels of the level. */
+  const QRectF area (target.x() / pixel, target.y() / pixel,
+                     target.width() / pixel, target.height() / pixel);
+  /* First column of visible tiles. */
+  const int firstColumn =
+    std::max(static_cast<int>(area.left()) / ImagePyramid::tileSize, 0);
+  /* Last column of visible tiles. */
+  const int lastColumn =
+    std::min(static_cast<int>(area.right()) / ImagePyramid::tileSize,
+             pyramid->columns(level) - 1);
+  /* First row of visible tiles. */
+  const int firstRow =
+    std::max(static_cast<int>(area.top()) / ImagePyramid::tileSize, 0);
+  /* Last row of visible tiles. */
+  const int lastRow =
+    std::min(static_cast<int>(area.bottom()) / ImagePyramid::tileSize,
+             pyramid->rows(level) - 1);
+
+  painter.setRenderHint(QPainter::SmoothPixmapTransform, pixel < 1.);
+  for (int row = firstRow; row <= lastRow; ++row) {
+    for (int column = firstColumn; column <= lastColumn; ++column) {
+      /* Area covered by the tile, in pixels of the level. */
+      const QRect tileArea = pyramid->tileRect(level, column, row);
+      /* Where the tile is drawn in the widget. */
+      const QRectF tileTarget (tileArea.x() * pixel, tileArea.y() * pixel,
+                               tileArea.width() * pixel,
+                               tileArea.height() * pixel);
+      /* The tile, which may not be available yet. */
+      const QImage tile = pyramid->tile(level, column, row);
+      if (tile.isNull())
+        drawPreview(painter, tileTarget.intersected(target));
+      else
+        painter.drawImage(tileTarget, tile);
+    }
+  }
+}
+
+/* -- Prefetch tiles of next zoom steps. ---------------------------------- */
+void GUI::ImageView::prefetch () {
+  /* Visible area of the widget. */
+  const QRect visible = visibleRegion().boundingRect();
+  if (visible.isEmpty()) return;
+  /* Factors applied when zooming. */
+  const double steps [] = {zoomIn, zoomOut};
+  for (int i = 0; i < 2; ++i) {
+    if (steps[i] == 1.) continue;
+    /* Centre of the visible area at the next scale. */
+    const QPoint centre (static_cast<int>(visible.center().x() * steps[i]),
+                         static_cast<int>(visible.center().y() * steps[i]));
+    /* Area visible at the next scale, keeping its centre. */
+    QRect area (QPoint (0, 0), visible.size());
+    area.moveCenter(centre);
+    zoom->prefetch(scaleFactor * steps[i], area);
+  }
+}
+
+/* -- Draw the preview. --------------------------------------------------- */
+void GUI::ImageView::drawPreview (QPainter &painter, const QRectF &target) {
+  if (previewImage.isNull() || target.isEmpty()) return;
+
+  /* Size of a preview pixel on screen, horizontally. */
+  const double horizontal =
+    static_cast<double>(width()) / previewImage.width();
+  /* Size of a preview pixel on screen, vertically. */
+  const double vertical =
+    static_cast<double>(height()) / previewImage.height();
+  painter.drawImage(target, previewImage,
+                    QRectF (target.x() / horizontal, target.y() / vertical,
+                            target.width() / horizontal,
+                            target.height() / vertical));
+}
+
+/* -- Draw samples and reference points. ---------------------------------- */
+void GUI::ImageView::drawOverlay (QPainter &painter, const QRect &target) {
+  /* Margin around the area, so that marks partly in it are drawn. */
+  const double margin = referenceSize / scaleFactor;
+  /* Left side of the area, in the image. */
+  const double xMin = target.left() / scaleFactor - margin;
+  /* Top side of the area, in the image. */
+  const double yMin = target.top() / scaleFactor - margin;
+  /* Right side of the area, in the image. */
+  const double xMax = (target.right() + 1) / scaleFactor + margin;
+  /* Bottom side of the area, in the image. */
+  const double yMax = (target.bottom() + 1) / scaleFactor + margin;
+  /* Scale factor, captured by the visitor. */
+  const double scale = scaleFactor;
+  /* Marks of samples, captured by the visitor. */
+  QVector<QPointF> &marks = sampleMarks;
+
+  marks.clear();
+  sampleLayer.visit(xMin, yMin, xMax, yMax, sampleSpacing / scaleFactor,
+                    [scale, &marks] (double x, double y) {
+                      marks.append(QPointF (x * scale, y * scale));
+                    });
+  painter.setRenderHint(QPainter::Antialiasing, false);
+  if (!marks.isEmpty()) {
+    painter.setPen(QPen (Qt::red, 3));
+    painter.drawPoints(marks.constData(), marks.size());
+  }
+
+  painter.setPen(QPen (Qt::blue, 2));
+  for (std::size_t i = 0; i < referenceList.size(); ++i) {
+    /* Reference point. */
+    const Projection::Point2D &point = referenceList[i];
+    if (point.x() < xMin || point.x() > xMax || point.y() < yMin
+        || point.y() > yMax)
+      continue;
+    /* Position in the widget. */
+    const QPointF centre (point.x() * scaleFactor, point.y() * scaleFactor);
+    painter.drawLine(centre - QPointF (referenceSize, 0.),
+                     centre + QPointF (referenceSize, 0.));
+    painter.drawLine(centre - QPointF (0., referenceSize),
+                     centre + QPointF (0., referenceSize));
+  }
+
+  if (traceList.size() > 1) {
+    /* Points of the line in the widget. */
+    QVector<QPointF> line (static_cast<int>(traceList.size()));
+    for (std::size_t i = 0; i < traceList.size(); ++i)
+      line[static_cast<int>(i)] = QPointF (traceList[i].x() * scaleFactor,
+                                           traceList[i].y() * scaleFactor);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(QPen (Qt::green, 2));
+    painter.drawPolyline(line.constData(), line.size());
+  }
+
+  if (selected) {
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(QPen (Qt::green, 2));
+    painter.drawEllipse(QPointF (selection.x() * scaleFactor,
+                                 selection.y() * scaleFactor),
+                        referenceSize, referenceSize);
+  }
+}
@@ -0,0 +1,260 @@
+#ifndef IMAGEVIEW_HPP
+#define IMAGEVIEW_HPP
+
+/**
+ * \file imageview.hpp
+ * \brief Widget displaying an image through its tile pyramid.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <memory>
+#include <vector>
+#include <QWidget>
+#include <QImage>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QRectF>
+#include <QPainter>
+#include <QPointF>
+#include <QVector>
+
+#include "imagepyramid.hpp"
+#include "zoomcache.hpp"
+#include "raster.hpp"
+#include "projection.hpp"
+#include "referencepoints.hpp"
+#include "mapprojection.hpp"
+#include "pointlayer.hpp"
+#include "sample.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Widget displaying an image at a given scale.
+   *
+   * The widget has the size of the scaled image, it is meant to be put in a
+   * scroll area. Only tiles intersecting the area to be painted are drawn,
+   * taken from the pyramid level closest to the displayed resolution.
+   * When zoomed out, tiles resampled at the exact scale are drawn instead
+   * as soon as they have been rendered in the background, along with those
+   * of the next zoom steps.
+   *
+   * While the image is being loaded, a preview at low resolution is drawn
+   * where tiles are not available yet.
+   *
+   * Samples and reference points are drawn over the image. Only those in
+   * the area to be painted are considered, and samples are thinned when
+   * zoomed out, so that the cost of painting depends on the size of the
+   * view rather than on the number of samples.
+   */
+  class ImageView: public QWidget {
+      Q_OBJECT
+
+    public:
+      /**
+       * \brief Construct an empty view.
+       * \param parent Parent widget.
+       */
+      explicit ImageView (QWidget* parent = 0);
+
+      /// \brief Remove the displayed image.
+      void clear ();
+
+      /**
+       * \brief Display a preview of a new image.
+       * \param preview The image at low resolution.
+       * \param size Size of the image at full resolution.
+       */
+      void setPreview (const QImage &preview, const QSize &size);
+
+      /**
+       * \brief Display tiles of the image.
+       * \param _pyramid Pyramid of the image whose preview is displayed.
+       */
+      void setPyramid (const std::shared_ptr<ImagePyramid> &_pyramid);
+
+      /**
+       * \brief Set levels of the pyramid kept in memory, the preview being
+       * no more needed.
+       * \param levels Levels built from the pyramid, which are taken.
+       */
+      void setLevels (ImagePyramid::Levels &levels);
+
+      /**
+       * \brief Draw tiles at full resolution, once pixels of the pyramid are
+       * readable, the preview being no more needed.
+       */
+      void sourceLoaded ();
+
+      /// \brief Whether or not an image is displayed.
+      bool isEmpty () const {return fullSize.isEmpty();}
+
+      /// \brief Size of the image at full resolution.
+      QSize imageSize () const {return fullSize;}
+
+      /// \brief Current scale factor.
+      double scale () const {return scaleFactor;}
+
+      /// \brief Pyramid of the displayed image, null while loading.
+      std::shared_ptr<ImagePyramid> imagePyramid () const {return pyramid;}
+
+      /**
+       * \brief Change the scale factor, resizing the widget.
+       * \param factor New scale factor.
+       */
+      void setScale (double factor);
+
+      /**
+       * \brief Set factors applied to the scale when zooming, whose tiles
+       * are rendered in advance.
+       * \param in Factor applied when zooming in.
+       * \param out Factor applied when zooming out.
+       */
+      void setZoomSteps (double in, double out);
+
+      /**
+       * \brief Replace samples drawn over the image.
+       * \param samples The samples.
+       * \param change Referential change of the image, null to use image
+       * coordinates of samples instead of their geographical coordinates.
+       * \param projection Map projection the referential change leads to,
+       * null for geographical coordinates.
+       */
+      void setSamples (const std::vector<Data::Sample> &samples,
+                       const Projection::ChangeMatrix* change,
+                       const Projection::MapProjection* projection = 0);
+
+      /**
+       * \brief Add a sample drawn over the image.
+       * \param position Position of the sample in the image.
+       */
+      void addSample (const Projection::Point2D &position);
+
+      /**
+       * \brief Replace reference points drawn over the image.
+       * \param points The reference points.
+       */
+      void setReferencePoints (const std::vector<Projection::ReferencePoints
+                                                  ::Point> &points);
+
+      /**
+       * \brief Highlight a selected sample.
+       * \param position Position of the sample in the image.
+       */
+      void setSelection (const Projection::Point2D &position);
+
+      /// \brief Remove the highlight of the selected sample.
+      void clearSelection ();
+
+      /**
+       * \brief Draw a line traced over the image, waiting for confirmation.
+       * \param points Points of the line in the image, none to remove it.
+       */
+      void setTrace (const std::vector<Projection::Point2D> &points);
+
+      /**
+       * \brief Convert a position in the widget to image coordinates.
+       * \param position Position in the widget.
+       * \return Coordinates in the image at full resolution.
+       */
+      Projection::Point2D toImage (const QPoint &position) const {
+        return Projection::viewToImage(position.x(), position.y(),
+                                       scaleFactor);
+      }
+
+    protected:
+      /**
+       * \brief Draw visible tiles.
+       * \param event The event indicating what should be painted.
+       */
+      virtual void paintEvent (QPaintEvent* event);
+
+    private slots:
+      /**
+       * \brief Redraw a tile rendered at a zoom level.
+       * \param scale Scale factor of the tile.
+       * \param area Area covered by the tile in the widget.
+       */
+      void tileRendered (double scale, const QRect &area);
+
+    private:
+      /**
+       * \brief Draw a part of the image from the pyramid level closest to
+       * the displayed resolution.
+       * \param painter Painter on the widget.
+       * \param target Part of the widget to be drawn.
+       */
+      void drawLevel (QPainter &painter, const QRect &target);
+
+      /// \brief Ask for tiles of the next zoom steps around the visible area.
+      void prefetch ();
+
+      /**
+       * \brief Draw a part of the preview.
+       * \param painter Painter on the widget.
+       * \param target Part of the widget to be drawn.
+       */
+      void drawPreview (QPainter &painter, const QRectF &target);
+
+      /**
+       * \brief Draw samples and reference points in an area.
+       * \param painter Painter on the widget.
+       * \param target Part of the widget to be drawn.
+       */
+      void drawOverlay (QPainter &painter, const QRect &target);
+
+      /// \brief Distance between samples drawn, in screen pixels.
+      static const int sampleSpacing = 6;
+
+      /// \brief Size of marks of reference points, in screen pixels.
+      static const int referenceSize = 6;
+
+      /// \brief Tiles of the displayed image.
+      std::shared_ptr<ImagePyramid> pyramid;
+
+      /// \brief Tiles resampled at reduced scales.
+      std::unique_ptr<ZoomCache> zoom;
+
+      /// \brief Factor applied to the scale when zooming in.
+      double zoomIn;
+
+      /// \brief Factor applied to the scale when zooming out.
+      double zoomOut;
+
+      /// \brief Image at low resolution, drawn while loading.
+      QImage previewImage;
+
+      /// \brief Size of the image at full resolution.
+      QSize fullSize;
+
+      /// \brief Scale factor.
+      double scaleFactor;
+
+      /// \brief Samples drawn over the image.
+      PointLayer sampleLayer;
+
+      /// \brief Reference points drawn over the image.
+      std::vector<Projection::Point2D> referenceList;
+
+      /// \brief Positions of samples being drawn, kept between paintings.
+      QVector<QPointF> sampleMarks;
+
+      /// \brief Position of the selected sample in the image.
+      Projection::Point2D selection;
+
+      /// \brief Whether or not a sample is selected.
+      bool selected;
+
+      /// \brief Line traced, in image coordinates.
+      std::vector<Projection::Point2D> traceList;
+
+      /// \brief Area of the widget where the selection is drawn.
+      QRect selectionRect () const;
+  };
+}
+
+#endif  // #ifndef IMAGEVIEW_HPP
@@ -0,0 +1,449 @@
+/**
+ * \file journal.cpp
+ * \brief Implementation of the journal of geo-referenced data.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <chrono>
+#include <boost/filesystem.hpp>
+
+#include "journal.hpp"
+
+namespace {
+  /**
+   * \brief Read samples of a data file, text or binary.
+   * \param dataFileName Name of the data file.
+   * \param samples Where to put samples.
+   * \exception std::runtime_error The file cannot be read.
+   */
+  void readDataFile (const std::string &dataFileName,
+                     std::vector<Data::Sample> &samples) {
+    if (Data::isBinaryFile(dataFileName)) {
+      Data::BinaryFile (dataFileName).read(samples);
+      return;
+    }
+
+    /* The data file. */
+    std::ifstream file (dataFileName.c_str());
+    if (!file)
+      throw std::runtime_error("Data file \"" + dataFileName
+                               + "\" cannot be opened.");
+    /* Reader of the file. */
+    Text::NumberReader reader (file);
+    try {
+      while (!reader.atEnd()) {
+        /* Sample on the line. */
+        Data::Sample sample;
+        Data::readSample(reader, sample);
+        reader.endLine();
+        samples.push_back(sample);
+      }
+    }
+    catch (const Text::ParseError &error) {
+      throw std::runtime_error("Data file \"" + dataFileName + "\": "
+                               + error.what());
+    }
+  }
+}
+
+const std::size_t Data::Journal::bufferSize;
+const int Data::Journal::delay;
+const int Data::Journal::maximumFiles;
+
+/* -- Open the journal. --------------------------------------------------- */
+Data::Journal::Journal (const std::string &baseName):
+  loadedCount (0), unsavedCount (0), editRecords (false), headerBytes (0),
+  appendedBytes (0), writtenBytes (0), urgent (false), stopping (false),
+  failure (false) {
+  lock(baseName);
+  recover();
+  writer = std::thread (&Journal::write, this);
+}
+
+/* -- Close the journal. -------------------------------------------------- */
+Data::Journal::~Journal () {
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    stopping = true;
+  }
+  requested.notify_one();
+  writer.join();
+}
+
+/* -- Add a sample. ------------------------------------------------------- */
+void Data::Journal::append (const Sample &sample) {
+  /* Line describing the sample. */
+  std::ostringstream line;
+  writeSample(line, sample);
+  push(line.str());
+  list.push_back(sample);
+  ++unsavedCount;
+}
+
+/* -- Remove a sample. ---------------------------------------------------- */
+void Data::Journal::remove (std::size_t index) {
+  push(std::to_string(index) + '\n');
+  list.erase(list.begin() + index);
+  editRecords = true;
+  ++unsavedCount;
+}
+
+/* -- Replace a sample. --------------------------------------------------- */
+void Data::Journal::replace (std::size_t index, const Sample &sample) {
+  /* Record of the replacement. */
+  std::ostringstream line;
+  line << index << ' ';
+  writeSample(line, sample);
+  push(line.str());
+  list[index] = sample;
+  editRecords = true;
+  ++unsavedCount;
+}
+
+/* -- Write every sample. ------------------------------------------------- */
+void Data::Journal::flush () {
+  if (!wait())
+    throw std::runtime_error("Journal file \"" + fileName
+                             + "\" cannot be written.");
+}
+
+/* -- Remove every sample. ------------------------------------------------ */
+void Data::Journal::clear () {
+  wait();
+  open(std::ios_base::trunc);
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    appendedBytes = 0;
+    writtenBytes = 0;
+    failure = false;
+  }
+  list.clear();
+  loadedCount = 0;
+  savedFileName.clear();
+  unsavedCount = 0;
+  editRecords = false;
+  headerBytes = 0;
+}
+
+/* -- Replace samples by the ones of a data file. ------------------------- */
+void Data::Journal::load (const std::string &dataFileName) {
+  /* Samples in the file. */
+  std::vector<Sample> samples;
+  readDataFile(dataFileName, samples);
+  clear();
+  list.swap(samples);
+  rebase(dataFileName);
+}
+
+/* -- Replace samples by samples already saved. --------------------------- */
+void Data::Journal::assign (std::vector<Sample> &samples,
+                            const std::string &dataFileName) {
+  clear();
+  if (dataFileName.empty()) {
+    for (const Sample &sample: samples) append(sample);
+  }
+  else {
+    list.swap(samples);
+    rebase(dataFileName);
+  }
+}
+
+/* -- Save samples in a data file. ---------------------------------------- */
+void Data::Journal::save (const std::string &dataFileName) {
+  flush();
+
+  /* Whether samples are appended to the file where they have been saved. */
+  const bool appending = dataFileName == savedFileName && !editRecords
+    && !isBinaryFile(dataFileName);
+  /* The journal, read back after the line naming the data file. */
+  std::ifstream journal (fileName.c_str(), std::ios_base::binary);
+  journal.seekg(headerBytes);
+  /* The data file. */
+  std::ofstream file (dataFileName.c_str(),
+                      std::ios_base::binary | (appending? std::ios_base::app:
+                                               std::ios_base::trunc));
+  if (!journal || !file)
+    throw std::runtime_error("Data file \"" + dataFileName
+                             + "\" cannot be opened.");
+  if (!appending) {
+    /* Samples loaded, or every sample, written as in the journal. */
+    std::ostringstream lines;
+    for (std::size_t i = 0; i < (editRecords? list.size(): loadedCount); ++i)
+      writeSample(lines, list[i]);
+    file << lines.str();
+  }
+
+  /* Buffer for copying. */
+  std::vector<char> buffer (bufferSize);
+  /* Number of bytes remaining to be copied. */
+  std::size_t remaining = editRecords? 0: appendedBytes - headerBytes;
+  while (remaining > 0 && journal) {
+    /* Number of bytes copied at once. */
+    const std::size_t count = std::min(remaining, buffer.size());
+    journal.read(buffer.data(), count);
+    file.write(buffer.data(), journal.gcount());
+    remaining -= journal.gcount();
+  }
+  file.close();
+  if (remaining > 0 || !file)
+    throw std::runtime_error("Data file \"" + dataFileName
+                             + "\" cannot be written.");
+  journal.close();
+  rebase(dataFileName);
+}
+
+/* -- Save samples in a binary data file. --------------------------------- */
+void Data::Journal::saveBinary (const std::string &dataFileName,
+                                const Steps &steps,
+                                const Projection::ChangeMatrix* change) {
+  writeBinaryFile(dataFileName, list, steps, change);
+  rebase(dataFileName);
+}
+
+/* -- Choose the journal file. -------------------------------------------- */
+void Data::Journal::lock (const std::string &baseName) {
+  for (int i = 0; i < maximumFiles; ++i) {
+    /* Name of the journal file. */
+    const std::string name =
+      (i == 0)? baseName: baseName + '.' + std::to_string(i);
+    /* The journal file, if it exists. */
+    std::ifstream journal (name.c_str(),
+                           std::ios_base::binary | std::ios_base::ate);
+    /* Whether samples have been left in the journal file. */
+    const bool left = journal.is_open() && journal.tellg() > 0;
+    /* Journal files are numbered without gaps. */
+    if (!journal.is_open() && !fileName.empty()) return;
+    journal.close();
+
+    /* Name of the lock file. */
+    const std::string lockName = name + ".lock";
+    std::ofstream (lockName.c_str(), std::ios_base::app);
+    /* Lock on the journal file. */
+    boost::interprocess::file_lock slot;
+    try {
+      boost::interprocess::file_lock (lockName.c_str()).swap(slot);
+      if (!slot.try_lock()) continue;
+    }
+    catch (const boost::interprocess::interprocess_exception &) {
+      continue;
+    }
+    if (fileName.empty() || left) {
+      /* The lock on an empty journal file taken before is released. */
+      fileLock.swap(slot);
+      fileName = name;
+    }
+    if (left) return;
+  }
+  if (fileName.empty())
+    throw std::runtime_error("Journal files \"" + baseName
+                             + "\" are all used.");
+}
+
+/* -- Read the journal file. ---------------------------------------------- */
+void Data::Journal::recover () {
+  /* Journal left by a previous session. */
+  std::ifstream previous (fileName.c_str(), std::ios_base::binary);
+  /* Whether records follow the data file the journal begins with. */
+  bool based = true;
+  if (previous.peek() == '#') {
+    /* Line naming the data file. */
+    std::string header;
+    std::getline(previous, header);
+    /* Number of samples in the data file. */
+    std::size_t count = 0;
+    /* Parser of the line. */
+    std::istringstream line (header.substr(1));
+    line >> count;
+    if (!previous.eof() && line.get() == ' ') {
+      headerBytes = header.size() + 1;
+      savedFileName = header.substr(1 + line.tellg());
+      try {
+        readDataFile(savedFileName, list);
+      }
+      catch (const std::runtime_error &) {}
+    }
+    /* Indices of records are wrong without samples of the data file. */
+    based = headerBytes > 0 && list.size() == count;
+    if (!based) {
+      list.clear();
+      savedFileName.clear();
+    }
+    previous.clear();
+    previous.seekg(headerBytes);
+  }
+  loadedCount = list.size();
+
+  /* Reader of the journal. */
+  Text::NumberReader reader (previous);
+  /* Size of records completely written. */
+  std::size_t complete = 0;
+  /* Number of records read. */
+  std::size_t records = 0;
+  /* Whether the journal ends with a record partially written. */
+  bool damaged = false;
+  try {
+    while (!damaged && !reader.atEnd()) {
+      /* Numbers on the line. */
+      double numbers [6];
+      /* Number of numbers on the line. */
+      int count = 0;
+      while (count < 6 && !reader.lineEnd())
+        numbers[count++] = reader.number();
+      if (!reader.endLine()) {
+        damaged = true;
+      }
+      else if (count == 5) {
+        /* Sample appended. */
+        const Sample sample = {numbers[0], numbers[1], numbers[2],
+                               numbers[3], numbers[4]};
+        list.push_back(sample);
+      }
+      else if ((count == 1 || count == 6) && based && numbers[0] >= 0.
+               && numbers[0] < list.size()
+               && numbers[0] == std::floor(numbers[0])) {
+        /* Index of the sample edited. */
+        const std::size_t index = static_cast<std::size_t>(numbers[0]);
+        if (count == 1) {
+          list.erase(list.begin() + index);
+        }
+        else {
+          /* Sample replacing the previous one. */
+          const Sample sample = {numbers[1], numbers[2], numbers[3],
+                                 numbers[4], numbers[5]};
+          list[index] = sample;
+        }
+        editRecords = true;
+      }
+      else {
+        damaged = true;
+      }
+      if (!damaged) {
+        complete = reader.position();
+        ++records;
+      }
+    }
+  }
+  catch (const Text::ParseError &) {
+    damaged = true;
+  }
+  if (!damaged) complete = reader.position();
+  previous.close();
+
+  if (!based) {
+    /* Samples recovered, written without the data file they followed. */
+    std::ostringstream samples;
+    for (const Sample &sample: list) writeSample(samples, sample);
+    open(std::ios_base::trunc);
+    stream << samples.str() << std::flush;
+    headerBytes = 0;
+    appendedBytes = samples.str().size();
+    unsavedCount = list.size();
+  }
+  else {
+    if (damaged)
+      boost::filesystem::resize_file(fileName, headerBytes + complete);
+    open(std::ios_base::app);
+    appendedBytes = headerBytes + complete;
+    unsavedCount = records;
+  }
+  writtenBytes = appendedBytes;
+}
+
+/* -- Follow samples saved in a data file. -------------------------------- */
+void Data::Journal::rebase (const std::string &dataFileName) {
+  wait();
+  /* Line naming the data file. */
+  std::ostringstream header;
+  header << '#' << list.size() << ' '
+         << boost::filesystem::absolute(dataFileName).string() << '\n';
+  open(std::ios_base::trunc);
+  stream << header.str() << std::flush;
+  if (!stream)
+    throw std::runtime_error("Journal file \"" + fileName
+                             + "\" cannot be written.");
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    appendedBytes = header.str().size();
+    writtenBytes = appendedBytes;
+    failure = false;
+  }
+  headerBytes = appendedBytes;
+  loadedCount = list.size();
+  savedFileName = dataFileName;
+  unsavedCount = 0;
+  editRecords = false;
+}
+
+/* -- Write pending bytes. ------------------------------------------------ */
+void Data::Journal::write () {
+  /* Lock on shared data, released while writing. */
+  std::unique_lock<std::mutex> lock (mutex);
+  for (;;) {
+    requested.wait(lock, [this] {return stopping || !pending.empty();});
+    /* Samples given in a short time are written together. */
+    requested.wait_for(lock, std::chrono::milliseconds (delay), [this] {
+      return stopping || urgent || pending.size() >= bufferSize;
+    });
+    if (pending.empty()) {
+      if (stopping) return;
+      continue;
+    }
+
+    /* Bytes written at once. */
+    std::string bytes;
+    bytes.swap(pending);
+    urgent = false;
+    lock.unlock();
+    stream.write(bytes.data(), bytes.size());
+    stream.flush();
+    /* Whether or not writing has succeeded. */
+    const bool good = stream.good();
+    lock.lock();
+    failure = failure || !good;
+    writtenBytes += bytes.size();
+    written.notify_all();
+  }
+}
+
+/* -- Wait until bytes are written. --------------------------------------- */
+bool Data::Journal::wait () {
+  /* Lock on shared data. */
+  std::unique_lock<std::mutex> lock (mutex);
+  urgent = true;
+  requested.notify_one();
+  written.wait(lock, [this] {return writtenBytes == appendedBytes;});
+  urgent = false;
+  return !failure;
+}
+
+/* -- Open the journal file. ---------------------------------------------- */
+void Data::Journal::open (std::ios_base::openmode mode) {
+  stream.close();
+  stream.clear();
+  stream.open(fileName.c_str(),
+              std::ios_base::out | std::ios_base::binary | mode);
+  if (!stream)
+    throw std::runtime_error("Journal file \"" + fileName
+                             + "\" cannot be opened.");
+}
+
+/* -- Give bytes to be written. ------------------------------------------- */
+void Data::Journal::push (const std::string &bytes) {
+  /* Lock on shared data. */
+  std::lock_guard<std::mutex> lock (mutex);
+  if (failure)
+    throw std::runtime_error("Journal file \"" + fileName
+                             + "\" cannot be written.");
+  /* Whether the writing thread is waiting for bytes. */
+  const bool idle = pending.empty();
+  pending += bytes;
+  appendedBytes += bytes.size();
+  /* Otherwise the thread is already waiting for a full buffer. */
+  if (idle || pending.size() >= bufferSize) requested.notify_one();
+}
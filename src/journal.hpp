@@ -0,0 +1,274 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+/**
+ * \file journal.hpp
+ * \brief Append-only journal of geo-referenced data, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <boost/interprocess/sync/file_lock.hpp>
+
+#include "sample.hpp"
+#include "datafile.hpp"
+
+/// \brief Namespace for geo-referenced data.
+namespace Data {
+  /**
+   * \brief Samples set by the user, journaled on disk as they are given.
+   *
+   * Every sample is appended to the journal file, in the format of text
+   * data files, by a background thread which writes in batches. Samples not
+   * saved yet survive a crash: they are read back when the journal is
+   * opened again. Saving to the text data file samples have been loaded
+   * from or saved to only appends samples given since.
+   *
+   * Removing or replacing a sample appends a record to the journal file: a
+   * line with the index of the sample, followed by the new sample when it
+   * is replaced. Once samples are edited, saving rewrites the whole data
+   * file.
+   *
+   * Samples loaded from or saved in a data file are not copied in the
+   * journal file: once they are, the journal file is rewritten as a line
+   * "#count name" giving the number of samples and the name of the data
+   * file, which is read again when samples are recovered. Indices of
+   * records count these samples.
+   *
+   * Each process uses its own journal file, locked while it is open, so
+   * that several instances do not mix their samples. Journal files left by
+   * instances which have stopped are recovered first.
+   */
+  class Journal {
+    public:
+      /// \brief Number of bytes waiting before they are written at once.
+      static const std::size_t bufferSize = 1 << 16;
+
+      /// \brief Time samples may wait before being written, in milliseconds.
+      static const int delay = 200;
+
+      /// \brief Greatest number of journal files used at once.
+      static const int maximumFiles = 64;
+
+      /**
+       * \brief Open a journal, recovering samples it already contains.
+       * \param baseName Name of the journal file, followed by a number when
+       * the file is used by another process.
+       * \exception std::runtime_error The journal cannot be opened.
+       */
+      explicit Journal (const std::string &baseName);
+
+      /// \brief Write pending samples and close the journal.
+      ~Journal ();
+
+      /// \brief Samples in the journal.
+      const std::vector<Sample> &samples () const {return list;}
+
+      /// \brief Number of samples in the journal.
+      std::size_t size () const {return list.size();}
+
+      /// \brief Number of samples not saved in a data file.
+      std::size_t unsaved () const {return unsavedCount;}
+
+      /**
+       * \brief Name of the data file samples have been loaded from or saved
+       * to, empty if none.
+       */
+      const std::string &dataFile () const {return savedFileName;}
+
+      /**
+       * \brief Add a sample.
+       * \param sample The sample.
+       * \exception std::runtime_error The journal cannot be written.
+       */
+      void append (const Sample &sample);
+
+      /**
+       * \brief Remove a sample.
+       * \param index Index of the sample.
+       * \exception std::runtime_error The journal cannot be written.
+       */
+      void remove (std::size_t index);
+
+      /**
+       * \brief Replace a sample.
+       * \param index Index of the sample.
+       * \param sample The new sample.
+       * \exception std::runtime_error The journal cannot be written.
+       */
+      void replace (std::size_t index, const Sample &sample);
+
+      /**
+       * \brief Wait until every sample is written in the journal.
+       * \exception std::runtime_error The journal cannot be written.
+       */
+      void flush ();
+
+      /// \brief Remove every sample.
+      void clear ();
+
+      /**
+       * \brief Replace samples by the ones of a data file, text or binary.
+       * \param dataFileName Name of the data file.
+       * \exception std::runtime_error The file cannot be read, or the
+       * journal cannot be written.
+       *
+       * Samples are considered saved in this file.
+       */
+      void load (const std::string &dataFileName);
+
+      /**
+       * \brief Replace samples by samples already saved.
+       * \param samples Samples, which are taken.
+       * \param dataFileName Name of the data file containing them, empty if
+       * they are not saved: they are then journaled.
+       * \exception std::runtime_error The journal cannot be written.
+       */
+      void assign (std::vector<Sample> &samples,
+                   const std::string &dataFileName);
+
+      /**
+       * \brief Save samples in a text data file.
+       * \param dataFileName Name of the data file.
+       * \exception std::runtime_error The file cannot be written.
+       *
+       * When samples have already been saved in this file, only new ones
+       * are appended, otherwise the file is overwritten.
+       */
+      void save (const std::string &dataFileName);
+
+      /**
+       * \brief Save samples in a binary data file.
+       * \param dataFileName Name of the data file.
+       * \param steps Quantization step of each column.
+       * \param change Referential change of the image, null if unknown.
+       * \exception std::runtime_error The file cannot be written.
+       */
+      void saveBinary (const std::string &dataFileName, const Steps &steps,
+                       const Projection::ChangeMatrix* change = 0);
+
+    private:
+      /// \brief Name of the journal file.
+      std::string fileName;
+
+      /// \brief Lock on the journal file, held while it is open.
+      boost::interprocess::file_lock fileLock;
+
+      /// \brief Stream on the journal file, used by the writing thread.
+      std::ofstream stream;
+
+      /// \brief Samples in the journal.
+      std::vector<Sample> list;
+
+      /// \brief Number of samples of the data file, not in the journal file.
+      std::size_t loadedCount;
+
+      /// \brief Name of the data file where samples have been saved.
+      std::string savedFileName;
+
+      /// \brief Number of changes since samples have been saved.
+      std::size_t unsavedCount;
+
+      /// \brief Whether the journal file contains edition records.
+      bool editRecords;
+
+      /// \brief Size of the line naming the data file, before records.
+      std::size_t headerBytes;
+
+      /// \brief Number of bytes given to the journal.
+      std::size_t appendedBytes;
+
+      /// \brief Number of bytes written in the journal file.
+      std::size_t writtenBytes;
+
+      /// \brief Bytes waiting to be written.
+      std::string pending;
+
+      /// \brief Whether pending bytes should be written without delay.
+      bool urgent;
+
+      /// \brief Whether the writing thread should stop.
+      bool stopping;
+
+      /// \brief Whether writing the journal file has failed.
+      bool failure;
+
+      /// \brief Protects data shared with the writing thread.
+      std::mutex mutex;
+
+      /// \brief Signals bytes to be written.
+      std::condition_variable requested;
+
+      /// \brief Signals bytes have been written.
+      std::condition_variable written;
+
+      /// \brief Thread writing the journal file.
+      std::thread writer;
+
+      /**
+       * \brief Choose and lock the journal file of the process.
+       * \param baseName Name of the first journal file.
+       * \exception std::runtime_error Every journal file is used.
+       *
+       * Journal files left with samples are taken before empty ones.
+       */
+      void lock (const std::string &baseName);
+
+      /**
+       * \brief Read samples of the journal file, then open it.
+       * \exception std::runtime_error The journal cannot be opened.
+       *
+       * A record partially written ends the journal file, which is cut
+       * there.
+       */
+      void recover ();
+
+      /**
+       * \brief Make the journal follow samples saved in a data file.
+       * \param dataFileName Name of the data file.
+       * \exception std::runtime_error The journal cannot be written.
+       */
+      void rebase (const std::string &dataFileName);
+
+      /// \brief Write pending bytes until the journal is closed.
+      void write ();
+
+      /**
+       * \brief Wait until every byte given is written.
+       * \return Whether or not writing has succeeded.
+       */
+      bool wait ();
+
+      /**
+       * \brief Open the journal file.
+       * \param mode Opening mode, besides output and binary.
+       * \exception std::runtime_error The journal cannot be opened.
+       *
+       * The writing thread should have nothing to write.
+       */
+      void open (std::ios_base::openmode mode);
+
+      /**
+       * \brief Give bytes to the writing thread.
+       * \param bytes Bytes to be written.
+       */
+      void push (const std::string &bytes);
+
+      /// \brief Copy is forbidden.
+      Journal (const Journal &);
+
+      /// \brief Copy is forbidden.
+      Journal &operator = (const Journal &);
+  };
+}
+
+#endif  // #ifndef JOURNAL_HPP
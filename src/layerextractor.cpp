@@ -0,0 +1,503 @@
+/**
+ * \file layerextractor.cpp
+ * \brief Implementation of the extraction of every line of a colour.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "layerextractor.hpp"
+#include "profiler.hpp"
+
+const int GUI::LayerExtractor::bandHeight;
+const int GUI::LayerExtractor::margin;
+const int GUI::LayerExtractor::thinningPasses;
+
+namespace {
+  /// \brief Index standing for no end of chain.
+  const std::size_t none = static_cast<std::size_t>(-1);
+
+  /**
+   * \brief Greatest difference between components of two colours.
+   * \param a First colour, as 0xffRRGGBB.
+   * \param b Second colour, as 0xffRRGGBB.
+   */
+  int difference (std::uint32_t a, std::uint32_t b) {
+    /* Greatest difference found. */
+    int result = 0;
+    for (int shift = 0; shift < 24; shift += 8)
+      result = std::max(result, std::abs(static_cast<int>((a >> shift) & 0xff)
+                                         - static_cast<int>((b >> shift)
+                                                            & 0xff)));
+    return result;
+  }
+
+  /**
+   * \brief Thin pixels of a mask to lines one pixel wide (Zhang-Suen).
+   * \param mask Pixels, one if set, zero otherwise, surrounded by a frame
+   * of unset pixels.
+   * \param stride Number of pixels of a row, frame included.
+   * \param passes Greatest number of passes.
+   */
+  void thin (std::vector<unsigned char> &mask, std::size_t stride,
+             int passes) {
+    /* Pixels set, the only ones which can be removed. */
+    std::vector<std::size_t> set;
+    for (std::size_t i = 0; i < mask.size(); ++i)
+      if (mask[i]) set.push_back(i);
+    /* Pixels removed by a step. */
+    std::vector<std::size_t> removed;
+
+    for (int pass = 0; pass < passes; ++pass) {
+      /* Whether or not some pixel has been removed. */
+      bool changed = false;
+      for (int step = 0; step < 2; ++step) {
+        removed.clear();
+        for (std::size_t k = 0; k < set.size(); ++k) {
+          /* The pixel. */
+          const unsigned char* p = &mask[set[k]];
+          /* Neighbours, clockwise from the north one. */
+          const int n [8] = {p[-static_cast<std::ptrdiff_t>(stride)],
+                             p[1 - static_cast<std::ptrdiff_t>(stride)],
+                             p[1], p[stride + 1], p[stride],
+                             p[stride - 1], p[-1],
+                             p[-1 - static_cast<std::ptrdiff_t>(stride)]};
+          /* Number of neighbours set. */
+          int count = 0;
+          /* Number of changes from unset to set, around the pixel. */
+          int changes = 0;
+          for (int j = 0; j < 8; ++j) {
+            count += n[j];
+            changes += !n[j] && n[(j + 1) % 8];
+          }
+          if (count < 2 || count > 6 || changes != 1) continue;
+          if (step == 0? (n[0] && n[2] && n[4]) || (n[2] && n[4] && n[6]):
+              (n[0] && n[2] && n[6]) || (n[0] && n[4] && n[6]))
+            continue;
+          removed.push_back(set[k]);
+        }
+        for (std::size_t k = 0; k < removed.size(); ++k)
+          mask[removed[k]] = 0;
+        if (!removed.empty()) {
+          changed = true;
+          set.erase(std::remove_if(set.begin(), set.end(),
+                                   [&mask] (std::size_t i) {
+                                     return mask[i] == 0;
+                                   }),
+                    set.end());
+        }
+      }
+      if (!changed) break;
+    }
+  }
+
+  /**
+   * \brief Find neighbours of a pixel along lines.
+   * \param mask Pixels, non-zero if set, surrounded by a frame.
+   * \param i Index of the pixel.
+   * \param stride Number of pixels of a row, frame included.
+   * \param found Where to put indices of neighbours, eight at most.
+   * \return Number of neighbours.
+   *
+   * A diagonal neighbour counts only when no pixel set is next to both
+   * pixels, so that corners of lines are not taken as junctions.
+   */
+  int neighbours (const std::vector<unsigned char> &mask, std::size_t i,
+                  std::size_t stride, std::size_t* found) {
+    /* Whether the north neighbour is set. */
+    const bool north = mask[i - stride] != 0;
+    /* Whether the east neighbour is set. */
+    const bool east = mask[i + 1] != 0;
+    /* Whether the south neighbour is set. */
+    const bool south = mask[i + stride] != 0;
+    /* Whether the west neighbour is set. */
+    const bool west = mask[i - 1] != 0;
+    /* Number of neighbours. */
+    int count = 0;
+    if (north) found[count++] = i - stride;
+    if (east) found[count++] = i + 1;
+    if (south) found[count++] = i + stride;
+    if (west) found[count++] = i - 1;
+    if (!north && !east && mask[i - stride + 1])
+      found[count++] = i - stride + 1;
+    if (!south && !east && mask[i + stride + 1])
+      found[count++] = i + stride + 1;
+    if (!south && !west && mask[i + stride - 1])
+      found[count++] = i + stride - 1;
+    if (!north && !west && mask[i - stride - 1])
+      found[count++] = i - stride - 1;
+    return count;
+  }
+
+  /**
+   * \brief Find the component a chain belongs to.
+   * \param parent Parent of each chain in its component.
+   * \param i Index of the chain.
+   * \return Index of the chain representing its component.
+   */
+  std::size_t component (std::vector<std::size_t> &parent, std::size_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  }
+
+  /**
+   * \brief Gather the components of two chains.
+   * \param parent Parent of each chain in its component.
+   * \param a Index of the first chain.
+   * \param b Index of the second chain.
+   */
+  void unite (std::vector<std::size_t> &parent, std::size_t a,
+              std::size_t b) {
+    /* Chain representing the component of the first chain. */
+    const std::size_t first = component(parent, a);
+    parent[first] = component(parent, b);
+  }
+}
+
+/* -- Extract lines of the layer. ----------------------------------------- */
+std::vector<GUI::LayerExtractor::Line>
+GUI::LayerExtractor::extract (unsigned threads,
+                              const std::function<bool (int)> &carryOn)
+  const {
+  GEODESK_TIME("LayerExtractor::extract");
+  /* Number of bands. */
+  const int bands = (height + bandHeight - 1) / bandHeight;
+  /* Parts of lines of each band. */
+  std::vector< std::vector<Chain> > found (static_cast<std::size_t>(bands));
+  /* Next band to be processed. */
+  std::atomic<int> next (0);
+  /* Number of bands processed. */
+  int done = 0;
+  /* Whether or not extraction has been interrupted. */
+  std::atomic<bool> stopped (false);
+  /* Protects progress and failure. */
+  std::mutex mutex;
+  /* Exception thrown by a thread, if any. */
+  std::exception_ptr failure;
+
+  /* Work of each thread: bands are taken one at a time, until none is left. */
+  const std::function<void ()> work = [&] () {
+    try {
+      for (int band = next++; band < bands && !stopped; band = next++) {
+        extractBand(band, found[band]);
+        /* Lock on progress. */
+        const std::lock_guard<std::mutex> lock (mutex);
+        ++done;
+        if (!stopped && !carryOn(100 * done / bands)) stopped = true;
+      }
+    }
+    catch (...) {
+      /* Lock on failure. */
+      const std::lock_guard<std::mutex> lock (mutex);
+      if (!failure) failure = std::current_exception();
+      stopped = true;
+    }
+  };
+  /* Threads helping the calling one. */
+  std::vector<std::thread> helpers;
+  for (unsigned i = 1; i < std::max(threads, 1u); ++i)
+    helpers.push_back(std::thread (work));
+  work();
+  for (std::size_t i = 0; i < helpers.size(); ++i) helpers[i].join();
+  if (failure) std::rethrow_exception(failure);
+  if (stopped) return std::vector<Line> ();
+
+  /* Parts of lines of the whole image. */
+  std::vector<Chain> chains;
+  for (std::size_t i = 0; i < found.size(); ++i) {
+    chains.insert(chains.end(), std::make_move_iterator(found[i].begin()),
+                  std::make_move_iterator(found[i].end()));
+    std::vector<Chain> ().swap(found[i]);
+  }
+  /* Lines, as pixels. */
+  const std::vector< std::vector<Pixel> > joined = join(chains);
+  /* Lines, as points. */
+  std::vector<Line> lines;
+  lines.reserve(joined.size());
+  for (std::size_t i = 0; i < joined.size(); ++i)
+    lines.push_back(resample(joined[i]));
+  GEODESK_COUNT("lines extracted", static_cast<long long>(lines.size()));
+  return lines;
+}
+
+/* -- Follow lines of a band. --------------------------------------------- */
+void GUI::LayerExtractor::extractBand (int band, std::vector<Chain> &chains)
+  const {
+  GEODESK_TIME("LayerExtractor::extractBand");
+  /* First row of the band. */
+  const int top = band * bandHeight;
+  /* Row after the band. */
+  const int bottom = std::min(top + bandHeight, height);
+  /* First row read. */
+  const int first = std::max(top - margin, 0);
+  /* Number of rows read. */
+  const int rows = std::min(bottom + margin, height) - first;
+  /* Number of pixels of a row of the mask, with its frame. */
+  const std::size_t stride = static_cast<std::size_t>(width) + 2;
+  /* Pixels of the layer, with a frame of one pixel. */
+  std::vector<unsigned char> mask (static_cast<std::size_t>(rows + 2)
+                                   * stride, 0);
+  {
+    /* Colours of rows read. */
+    std::vector<std::uint32_t> pixels (static_cast<std::size_t>(rows)
+                                       * width);
+    reader(first, rows, &pixels[0]);
+    for (int y = 0; y < rows; ++y) {
+      /* Row read. */
+      const std::uint32_t* line = &pixels[static_cast<std::size_t>(y)
+                                          * width];
+      /* Row of the mask. */
+      unsigned char* out = &mask[(y + 1) * stride + 1];
+      for (int x = 0; x < width; ++x)
+        out[x] = difference(line[x], colour) <= tolerance;
+    }
+  }
+  thin(mask, stride, thinningPasses);
+
+  /* First pixel of the band in the mask. */
+  const std::size_t begin = (top - first + 1) * stride;
+  /* Pixel after the band in the mask. */
+  const std::size_t end = (bottom - first + 1) * stride;
+  /* Position in the image of a pixel of the mask. */
+  const auto position = [stride, first] (std::size_t i) -> Pixel {
+    const Pixel pixel = {static_cast<int>(i % stride) - 1,
+                         static_cast<int>(i / stride) - 1 + first};
+    return pixel;
+  };
+  /* Neighbours of a pixel inside the band, then outside. */
+  const auto around =
+    [&mask, stride, begin, end] (std::size_t i, std::size_t* inside,
+                                 int &insideCount, std::size_t* outside,
+                                 int &outsideCount) {
+      /* Neighbours of the pixel. */
+      std::size_t found [8];
+      /* Number of neighbours. */
+      const int count = neighbours(mask, i, stride, found);
+      insideCount = outsideCount = 0;
+      for (int k = 0; k < count; ++k) {
+        if (found[k] >= begin && found[k] < end)
+          inside[insideCount++] = found[k];
+        else
+          outside[outsideCount++] = found[k];
+      }
+    };
+  /* Neighbours inside the band, of an end then of a pixel followed. */
+  std::size_t inside [2][8];
+  /* Neighbours outside the band, of an end then of a pixel followed. */
+  std::size_t outside [2][8];
+  /* Number of neighbours inside the band. */
+  int insideCount [2];
+  /* Number of neighbours outside the band. */
+  int outsideCount [2];
+
+  /*
+   * Lines are followed from their ends: pixels at the end of a line, at a
+   * junction, or next to another band. Pixels followed are marked with 2.
+   */
+  for (std::size_t i = begin; i < end; ++i) {
+    if (!mask[i]) continue;
+    around(i, inside[0], insideCount[0], outside[0], outsideCount[0]);
+    if (insideCount[0] == 2 && outsideCount[0] == 0) continue;
+    if (insideCount[0] == 0) {
+      if (outsideCount[0] == 0) continue;
+      /* A line crossing the band on a single pixel. */
+      Chain chain;
+      chain.pixels.push_back(position(i));
+      for (int k = 0; k < outsideCount[0]; ++k)
+        chain.exits[outsideCount[0] == 2? k: 0]
+          .push_back(position(outside[0][k]));
+      chain.through[0] = chain.through[1] = outsideCount[0] == 2;
+      chains.push_back(chain);
+      continue;
+    }
+    for (int k = 0; k < insideCount[0]; ++k) {
+      if (mask[inside[0][k]] == 2) continue;
+      /* Part of line followed. */
+      Chain chain;
+      chain.pixels.push_back(position(i));
+      /* Previous pixel. */
+      std::size_t previous = i;
+      /* Pixel reached. */
+      std::size_t current = inside[0][k];
+      for (;;) {
+        around(current, inside[1], insideCount[1], outside[1],
+               outsideCount[1]);
+        if (insideCount[1] != 2 || outsideCount[1] != 0) break;
+        chain.pixels.push_back(position(current));
+        mask[current] = 2;
+        /* Next pixel. */
+        const std::size_t following =
+          inside[1][0] == previous? inside[1][1]: inside[1][0];
+        previous = current;
+        current = following;
+      }
+      /* Two ends next to each other are joined once. */
+      if (chain.pixels.size() == 1 && current < i) continue;
+      chain.pixels.push_back(position(current));
+      for (int side = 0; side < 2; ++side) {
+        for (int l = 0; l < outsideCount[side]; ++l)
+          chain.exits[side].push_back(position(outside[side][l]));
+        chain.through[side] =
+          insideCount[side] == 1 && outsideCount[side] == 1;
+      }
+      chains.push_back(chain);
+    }
+  }
+
+  /* Pixels left belong to closed lines inside the band. */
+  for (std::size_t i = begin; i < end; ++i) {
+    if (mask[i] != 1) continue;
+    around(i, inside[0], insideCount[0], outside[0], outsideCount[0]);
+    if (insideCount[0] != 2 || outsideCount[0] != 0) continue;
+    /* The closed line. */
+    Chain chain;
+    chain.pixels.push_back(position(i));
+    mask[i] = 2;
+    /* Previous pixel. */
+    std::size_t previous = i;
+    /* Pixel reached. */
+    std::size_t current = inside[0][0];
+    while (current != i) {
+      chain.pixels.push_back(position(current));
+      mask[current] = 2;
+      around(current, inside[1], insideCount[1], outside[1],
+             outsideCount[1]);
+      /* Next pixel. */
+      const std::size_t following =
+        inside[1][0] == previous? inside[1][1]: inside[1][0];
+      previous = current;
+      current = following;
+    }
+    chain.pixels.push_back(position(i));
+    chain.through[0] = chain.through[1] = false;
+    chains.push_back(chain);
+  }
+}
+
+/* -- Join parts of lines. ------------------------------------------------ */
+std::vector< std::vector<GUI::LayerExtractor::Pixel> >
+GUI::LayerExtractor::join (std::vector<Chain> &chains) const {
+  GEODESK_TIME("LayerExtractor::join");
+  /* Key of a pixel. */
+  const auto key = [this] (const Pixel &pixel) -> std::uint64_t {
+    return static_cast<std::uint64_t>(pixel.y) * width + pixel.x;
+  };
+  /* Pixel at an end of a chain, ends being numbered 2 * chain + side. */
+  const auto endPixel = [&chains] (std::size_t end) -> const Pixel & {
+    const std::vector<Pixel> &pixels = chains[end / 2].pixels;
+    return end % 2 == 0? pixels.front(): pixels.back();
+  };
+  /* Ends of chains, by pixel. */
+  std::unordered_multimap<std::uint64_t, std::size_t> ends;
+  for (std::size_t i = 0; i < 2 * chains.size(); ++i)
+    ends.insert(std::make_pair(key(endPixel(i)), i));
+
+  /* Parent of each chain in its component. */
+  std::vector<std::size_t> parent (chains.size());
+  for (std::size_t i = 0; i < parent.size(); ++i) parent[i] = i;
+  /* End linked to each end, where the line goes on. */
+  std::vector<std::size_t> link (2 * chains.size(), none);
+  for (std::size_t i = 0; i < link.size(); ++i) {
+    /* Chain of the end. */
+    const Chain &chain = chains[i / 2];
+    /* Ends at the same pixel, then at each exit. */
+    typedef std::unordered_multimap<std::uint64_t, std::size_t>
+      ::const_iterator Iterator;
+    std::pair<Iterator, Iterator> range = ends.equal_range(key(endPixel(i)));
+    for (Iterator j = range.first; j != range.second; ++j)
+      unite(parent, j->second / 2, i / 2);
+    for (std::size_t k = 0; k < chain.exits[i % 2].size(); ++k) {
+      range = ends.equal_range(key(chain.exits[i % 2][k]));
+      for (Iterator j = range.first; j != range.second; ++j) {
+        unite(parent, j->second / 2, i / 2);
+        /* Chain of the other end. */
+        const Chain &other = chains[j->second / 2];
+        if (chain.through[i % 2] && other.through[j->second % 2]
+            && key(other.exits[j->second % 2][0]) == key(endPixel(i)))
+          link[i] = j->second;
+      }
+    }
+  }
+
+  /* Length of each component, in pixels. */
+  std::vector<std::size_t> size (chains.size(), 0);
+  for (std::size_t i = 0; i < chains.size(); ++i)
+    size[component(parent, i)] += chains[i].pixels.size();
+
+  /* Whether or not each chain has been put in a line. */
+  std::vector<bool> used (chains.size(), false);
+  /* Lines found. */
+  std::vector< std::vector<Pixel> > lines;
+  /* Follow a line from an end of a chain. */
+  const auto follow = [&] (std::size_t start, int side) {
+    /* The line. */
+    std::vector<Pixel> line;
+    /* Chain reached. */
+    std::size_t current = start;
+    /* End of the next chain, where the line goes on. */
+    std::size_t next;
+    for (;;) {
+      used[current] = true;
+      /* Pixels of the chain. */
+      const std::vector<Pixel> &pixels = chains[current].pixels;
+      if (side == 0)
+        line.insert(line.end(), pixels.begin(), pixels.end());
+      else
+        line.insert(line.end(), pixels.rbegin(), pixels.rend());
+      next = link[2 * current + 1 - side];
+      if (next == none || used[next / 2]) break;
+      current = next / 2;
+      side = static_cast<int>(next % 2);
+    }
+    if (next != none && next / 2 == start) line.push_back(line.front());
+    if (line.size() >= 2) lines.push_back(line);
+  };
+  for (std::size_t i = 0; i < chains.size(); ++i) {
+    if (used[i] || size[component(parent, i)] < minimumSize) continue;
+    if (link[2 * i] == none)
+      follow(i, 0);
+    else if (link[2 * i + 1] == none)
+      follow(i, 1);
+  }
+  /* Chains left belong to closed lines across bands. */
+  for (std::size_t i = 0; i < chains.size(); ++i)
+    if (!used[i] && size[component(parent, i)] >= minimumSize) follow(i, 0);
+  return lines;
+}
+
+/* -- Put points along a line. -------------------------------------------- */
+GUI::LayerExtractor::Line
+GUI::LayerExtractor::resample (const std::vector<Pixel> &pixels) const {
+  /* Points of the line. */
+  Line line;
+  line.push_back(Projection::Point2D (pixels.front().x + .5,
+                                      pixels.front().y + .5));
+  /* Distance from the last point. */
+  double travelled = 0.;
+  for (std::size_t i = 1; i < pixels.size(); ++i) {
+    travelled += std::sqrt(static_cast<double>
+                           ((pixels[i].x - pixels[i - 1].x)
+                            * (pixels[i].x - pixels[i - 1].x)
+                            + (pixels[i].y - pixels[i - 1].y)
+                            * (pixels[i].y - pixels[i - 1].y)));
+    if (travelled >= spacing || i + 1 == pixels.size()) {
+      line.push_back(Projection::Point2D (pixels[i].x + .5,
+                                          pixels[i].y + .5));
+      travelled = 0.;
+    }
+  }
+  return line;
+}
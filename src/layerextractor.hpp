@@ -0,0 +1,167 @@
+#ifndef LAYEREXTRACTOR_HPP
+#define LAYEREXTRACTOR_HPP
+
+/**
+ * \file layerextractor.hpp
+ * \brief Extracting every line of a colour from a whole image, independently
+ * from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "projection.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Extract as polylines every line of an image drawn in a colour.
+   *
+   * The image is cut into bands of rows, processed in parallel. In each
+   * band, pixels whose colour is close to the one of the layer are kept,
+   * then thinned to lines one pixel wide (Zhang-Suen thinning), and lines
+   * are followed from end to end, a line being cut at each junction. Bands
+   * are read with a margin above and below, so that thinning gives the
+   * same result on both sides of the limit between two bands.
+   *
+   * Lines cut at limits between bands are then joined, and parts of lines
+   * are gathered into connected components: components whose length is
+   * below a minimum, mostly labels and noise drawn in the same colour, are
+   * dropped. Points are given along lines at a fixed spacing.
+   */
+  class LayerExtractor {
+    public:
+      /**
+       * \brief Function reading rows of the image: given the first row and
+       * the number of rows, it puts the colours of their pixels, as
+       * 0xffRRGGBB, row after row.
+       */
+      typedef std::function<void (int, int, std::uint32_t*)> BandReader;
+
+      /// \brief A line extracted, in image coordinates.
+      typedef std::vector<Projection::Point2D> Line;
+
+      /// \brief Number of rows of bands.
+      static const int bandHeight = 256;
+
+      /// \brief Number of rows read above and below each band.
+      static const int margin = 16;
+
+      /**
+       * \brief Greatest number of thinning passes, so that the margin
+       * is not crossed: lines thicker than about twice this number are
+       * not entirely thinned.
+       */
+      static const int thinningPasses = margin / 2 - 1;
+
+      /**
+       * \brief Construct an extractor on an image.
+       * \param _reader Function reading rows of the image, which can be
+       * called from several threads at once.
+       * \param _width Width of the image.
+       * \param _height Height of the image.
+       * \param _colour Colour of the layer, as 0xffRRGGBB.
+       * \param _tolerance Greatest difference of a colour component between
+       * the layer and its pixels.
+       * \param _spacing Distance between points of lines, in pixels.
+       * \param _minimumSize Smallest length of a component kept, in pixels.
+       */
+      LayerExtractor (const BandReader &_reader, int _width, int _height,
+                      std::uint32_t _colour, int _tolerance,
+                      double _spacing, std::size_t _minimumSize):
+        reader (_reader), width (_width), height (_height),
+        colour (_colour), tolerance (_tolerance), spacing (_spacing),
+        minimumSize (_minimumSize) {}
+
+      /**
+       * \brief Extract lines of the layer.
+       * \param threads Number of threads processing bands.
+       * \param carryOn Function called after each band with the percentage
+       * of bands processed, which interrupts extraction when returning
+       * false. Calls come from any thread, one at a time.
+       * \return Lines of the layer, none if extraction has been interrupted.
+       */
+      std::vector<Line> extract (unsigned threads,
+                                 const std::function<bool (int)> &carryOn)
+        const;
+
+    private:
+      /// \brief Position of a pixel.
+      struct Pixel {
+        /// \brief Column.
+        int x;
+
+        /// \brief Row.
+        int y;
+      };
+
+      /// \brief Part of a line followed inside a band, between two ends.
+      struct Chain {
+        /// \brief Pixels, from the first end to the last one.
+        std::vector<Pixel> pixels;
+
+        /**
+         * \brief Pixels of the line in other bands next to each end, where
+         * the line goes on.
+         */
+        std::vector<Pixel> exits [2];
+
+        /**
+         * \brief Whether the line simply goes on in another band at each
+         * end, without any junction.
+         */
+        bool through [2];
+      };
+
+      /// \brief Function reading rows of the image.
+      const BandReader reader;
+
+      /// \brief Width of the image.
+      const int width;
+
+      /// \brief Height of the image.
+      const int height;
+
+      /// \brief Colour of the layer.
+      const std::uint32_t colour;
+
+      /// \brief Greatest difference of a colour component.
+      const int tolerance;
+
+      /// \brief Distance between points of lines.
+      const double spacing;
+
+      /// \brief Smallest length of a component kept.
+      const std::size_t minimumSize;
+
+      /**
+       * \brief Follow lines of a band.
+       * \param band Index of the band.
+       * \param chains Where to add parts of lines of the band.
+       */
+      void extractBand (int band, std::vector<Chain> &chains) const;
+
+      /**
+       * \brief Join parts of lines and drop small components.
+       * \param chains Parts of lines of every band, which are taken.
+       * \return Lines, as pixels.
+       */
+      std::vector< std::vector<Pixel> > join (std::vector<Chain> &chains)
+        const;
+
+      /**
+       * \brief Put points along a line at the spacing.
+       * \param pixels Pixels of the line.
+       * \return Points of the line, at the centre of pixels.
+       */
+      Line resample (const std::vector<Pixel> &pixels) const;
+  };
+}
+
+#endif  // #ifndef LAYEREXTRACTOR_HPP
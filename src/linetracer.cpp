@@ -0,0 +1,326 @@
+/**
+ * \file linetracer.cpp
+ * \brief Implementation of line following.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "linetracer.hpp"
+
+const int GUI::LineTracer::snapRadius;
+const std::size_t GUI::LineTracer::maximumPoints;
+
+namespace {
+  /// \brief Value of pi.
+  const double pi = 3.14159265358979323846;
+
+  /// \brief Angle from the way back within which directions are ignored.
+  const double backward = pi / 4.;
+
+  /**
+   * \brief Greatest difference between components of two colours.
+   * \param a First colour, as 0xffRRGGBB.
+   * \param b Second colour, as 0xffRRGGBB.
+   */
+  int difference (std::uint32_t a, std::uint32_t b) {
+    /* Greatest difference found. */
+    int result = 0;
+    for (int shift = 0; shift < 24; shift += 8)
+      result = std::max(result, std::abs(static_cast<int>((a >> shift) & 0xff)
+                                         - static_cast<int>((b >> shift)
+                                                            & 0xff)));
+    return result;
+  }
+
+  /**
+   * \brief Difference between two angles.
+   * \param a First angle, in radians.
+   * \param b Second angle, in radians.
+   * \return Difference in [0, pi].
+   */
+  double angleBetween (double a, double b) {
+    /* Difference modulo a turn. */
+    const double d = std::fmod(std::abs(a - b), 2. * pi);
+    return d > pi? 2. * pi - d: d;
+  }
+
+  /**
+   * \brief Distance between two points.
+   * \param a First point.
+   * \param b Second point.
+   */
+  double distance (const Projection::Point2D &a,
+                   const Projection::Point2D &b) {
+    return std::sqrt((a.x() - b.x()) * (a.x() - b.x())
+                     + (a.y() - b.y()) * (a.y() - b.y()));
+  }
+}
+
+/* -- Follow the line clicked. -------------------------------------------- */
+GUI::LineTracer::Line GUI::LineTracer::trace (double x, double y,
+                                              const std::function<bool ()>
+                                                &carryOn) {
+  /* The line. */
+  Line line;
+  line.first = line.last = gap;
+  /* Point of the line clicked. */
+  Projection::Point2D start;
+  if (!snap(x, y, start)) return line;
+
+  /* Directions where the line goes from the click. */
+  const std::vector<double> ways = directions(start);
+  if (ways.empty()) {
+    line.points.push_back(start);
+    return line;
+  }
+  /* Direction followed first. */
+  double forward = ways[0];
+  /* Direction followed then, if any. */
+  std::size_t other = ways.size();
+  /* Angle between the most opposite directions found. */
+  double opposite = -1.;
+  for (std::size_t i = 0; i < ways.size(); ++i)
+    for (std::size_t j = i + 1; j < ways.size(); ++j)
+      if (angleBetween(ways[i], ways[j]) > opposite) {
+        opposite = angleBetween(ways[i], ways[j]);
+        forward = ways[i];
+        other = j;
+      }
+
+  /* Points following the click. */
+  std::vector<Projection::Point2D> after;
+  line.last = follow(start, forward, carryOn, after);
+  /* Points preceding the click, in reverse order. */
+  std::vector<Projection::Point2D> before;
+  if (line.last == closed)
+    line.first = closed;
+  else if (line.last != interrupted && other < ways.size())
+    line.first = follow(start, ways[other], carryOn, before);
+
+  line.points.reserve(before.size() + 1 + after.size());
+  line.points.assign(before.rbegin(), before.rend());
+  line.points.push_back(start);
+  line.points.insert(line.points.end(), after.begin(), after.end());
+  return line;
+}
+
+/* -- Whether a pixel belongs to the line. -------------------------------- */
+bool GUI::LineTracer::onLine (double x, double y) const {
+  if (!inside(x, y)) return false;
+  return difference(reader(static_cast<int>(x), static_cast<int>(y)),
+                    reference) <= tolerance;
+}
+
+/* -- Find the line near a click. ----------------------------------------- */
+bool GUI::LineTracer::snap (double x, double y, Projection::Point2D &start) {
+  if (!inside(x, y)) return false;
+  /* Column of the pixel clicked. */
+  const int column = static_cast<int>(x);
+  /* Row of the pixel clicked. */
+  const int row = static_cast<int>(y);
+
+  /* Sum of each component around the click. */
+  long sum[3] = {0, 0, 0};
+  /* Number of pixels around the click. */
+  long count = 0;
+  for (int j = std::max(row - 2 * snapRadius, 0);
+       j <= std::min(row + 2 * snapRadius, height - 1); ++j)
+    for (int i = std::max(column - 2 * snapRadius, 0);
+         i <= std::min(column + 2 * snapRadius, width - 1); ++i) {
+      /* Colour of the pixel. */
+      const std::uint32_t colour = reader(i, j);
+      for (int k = 0; k < 3; ++k) sum[k] += (colour >> (8 * k)) & 0xff;
+      ++count;
+    }
+  /* Mean colour around the click, standing for the background. */
+  std::uint32_t background = 0xff000000u;
+  for (int k = 0; k < 3; ++k)
+    background |= static_cast<std::uint32_t>(sum[k] / count) << (8 * k);
+
+  /* Contrast of the pixel chosen with the background. */
+  int contrast = -1;
+  /* Square of the distance of the pixel chosen to the click. */
+  int nearest = 0;
+  /* Column of the pixel chosen. */
+  int chosenColumn = column;
+  /* Row of the pixel chosen. */
+  int chosenRow = row;
+  for (int j = -snapRadius; j <= snapRadius; ++j)
+    for (int i = -snapRadius; i <= snapRadius; ++i) {
+      if (i * i + j * j > snapRadius * snapRadius
+          || !inside(column + i, row + j))
+        continue;
+      /* Contrast of the pixel. */
+      const int current = difference(reader(column + i, row + j),
+                                     background);
+      if (current > contrast
+          || (current == contrast && i * i + j * j < nearest)) {
+        contrast = current;
+        nearest = i * i + j * j;
+        chosenColumn = column + i;
+        chosenRow = row + j;
+      }
+    }
+  /* A uniform area contains no line. */
+  if (contrast <= tolerance) return false;
+  reference = reader(chosenColumn, chosenRow);
+
+  /* Sum of abscissae of line pixels near the pixel chosen. */
+  double sumX = 0.;
+  /* Sum of ordinates of line pixels near the pixel chosen. */
+  double sumY = 0.;
+  /* Number of line pixels near the pixel chosen. */
+  int found = 0;
+  for (int j = -2; j <= 2; ++j)
+    for (int i = -2; i <= 2; ++i)
+      if (onLine(chosenColumn + i, chosenRow + j)) {
+        sumX += chosenColumn + i + .5;
+        sumY += chosenRow + j + .5;
+        ++found;
+      }
+  start = Projection::Point2D (sumX / found, sumY / found);
+  return true;
+}
+
+/* -- Directions where the line goes. ------------------------------------- */
+std::vector<double> GUI::LineTracer::directions (const Projection::Point2D
+                                                   &centre) const {
+  /* Number of pixels probed, about one per pixel of the circle. */
+  const int n = std::min(std::max(static_cast<int>(std::ceil(2. * pi
+                                                             * spacing)),
+                                  16), 720);
+  /* Whether each pixel probed belongs to the line. */
+  std::vector<char> hit (n);
+  for (int k = 0; k < n; ++k) {
+    /* Angle of the pixel probed. */
+    const double angle = 2. * pi * k / n;
+    hit[k] = onLine(centre.x() + spacing * std::cos(angle),
+                    centre.y() + spacing * std::sin(angle));
+  }
+  /* Single pixels missed inside an arc, from anti-aliasing, are filled. */
+  std::vector<char> filled (hit);
+  for (int k = 0; k < n; ++k)
+    if (!hit[k] && hit[(k + n - 1) % n] && hit[(k + 1) % n]) filled[k] = 1;
+
+  /* Angle of each arc of line pixels. */
+  std::vector<double> result;
+  /* A pixel probed outside the line, where to start looking for arcs. */
+  const int outside = static_cast<int>(std::find(filled.begin(),
+                                                 filled.end(), 0)
+                                       - filled.begin());
+  if (outside == n) {
+    /*
+     * Surrounded by the line, there is no way to tell where it goes: this is
+     * handled as a junction.
+     */
+    result.push_back(0.);
+    result.push_back(pi);
+    return result;
+  }
+  /* First pixel of the current arc, negative outside any arc. */
+  int first = -1;
+  for (int k = outside + 1; k <= outside + n; ++k) {
+    if (filled[k % n]) {
+      if (first < 0) first = k;
+    }
+    else if (first >= 0) {
+      result.push_back(pi * (first + k - 1) / n);
+      first = -1;
+    }
+  }
+  return result;
+}
+
+/* -- Centre a point across the line. ------------------------------------- */
+void GUI::LineTracer::centre (Projection::Point2D &point, double angle)
+  const {
+  /* Abscissa of the direction across the line. */
+  const double nx = -std::sin(angle);
+  /* Ordinate of the direction across the line. */
+  const double ny = std::cos(angle);
+  /* Number of half pixels probed on each side. */
+  const int half = std::max(static_cast<int>(spacing), 4);
+  /* Offset of the start of the run of line pixels nearest to the point. */
+  int bestFirst = 0;
+  /* Offset of the end of this run. */
+  int bestLast = 0;
+  /* Distance of this run to the point. */
+  int bestDistance = half + 1;
+  /* Start of the current run, if any. */
+  int first = 0;
+  /* Whether the current offset is in a run. */
+  bool inRun = false;
+  for (int k = -half; k <= half + 1; ++k) {
+    /* Whether the pixel at the offset belongs to the line. */
+    const bool on = k <= half && onLine(point.x() + .5 * k * nx,
+                                        point.y() + .5 * k * ny);
+    if (on && !inRun) {
+      first = k;
+      inRun = true;
+    }
+    else if (!on && inRun) {
+      inRun = false;
+      /* Distance of the run to the point. */
+      const int d = (first > 0)? first: (k - 1 < 0)? 1 - k: 0;
+      if (d < bestDistance) {
+        bestDistance = d;
+        bestFirst = first;
+        bestLast = k - 1;
+      }
+    }
+  }
+  if (bestDistance > half) return;
+  /* Offset of the middle of the run, in pixels. */
+  const double middle = .25 * (bestFirst + bestLast);
+  point.x() += middle * nx;
+  point.y() += middle * ny;
+}
+
+/* -- Follow the line in one direction. ----------------------------------- */
+GUI::LineTracer::End GUI::LineTracer::follow (const Projection::Point2D
+                                                &start,
+                                              double angle,
+                                              const std::function<bool ()>
+                                                &carryOn,
+                                              std::vector<Projection::Point2D>
+                                                &points) const {
+  /* Current point. */
+  Projection::Point2D current = start;
+  /* Direction to the next point. */
+  double heading = angle;
+  for (;;) {
+    if (!carryOn()) return interrupted;
+    if (points.size() >= maximumPoints) return limit;
+    /* Next point. */
+    Projection::Point2D next (current.x() + spacing * std::cos(heading),
+                              current.y() + spacing * std::sin(heading));
+    if (!inside(next.x(), next.y())) return border;
+    centre(next, heading);
+    if (!inside(next.x(), next.y())) return border;
+    /* Centring may bring the point back onto another line. */
+    if (distance(next, current) < .5 * spacing) return junction;
+    if (points.size() >= 2 && distance(next, start) < spacing)
+      return closed;
+    points.push_back(next);
+    heading = std::atan2(next.y() - current.y(), next.x() - current.x());
+    current = next;
+
+    /* Directions where the line goes, the way back excepted. */
+    const std::vector<double> ways = directions(current);
+    /* Number of directions going forward. */
+    int forward = 0;
+    for (std::size_t i = 0; i < ways.size(); ++i)
+      if (angleBetween(ways[i], heading) < pi - backward) {
+        ++forward;
+        angle = ways[i];
+      }
+    if (forward == 0) return gap;
+    if (forward > 1) return junction;
+    heading = angle;
+  }
+}
@@ -0,0 +1,177 @@
+#ifndef LINETRACER_HPP
+#define LINETRACER_HPP
+
+/**
+ * \file linetracer.hpp
+ * \brief Following lines drawn in an image, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "projection.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Follow a line of an image from a point clicked on it.
+   *
+   * Pixels of the line are those whose colour is close to the one of the
+   * line where it has been clicked. From each point, pixels on a circle
+   * whose radius is the spacing of points are probed: arcs of line pixels
+   * give the directions the line goes to. The line is followed while a
+   * single direction goes forward; each new point is centred across the
+   * line. Following stops on a gap, where no direction goes forward, and on
+   * a junction, where several do.
+   */
+  class LineTracer {
+    public:
+      /**
+       * \brief Function giving the colour of a pixel inside the image, as
+       * 0xffRRGGBB.
+       */
+      typedef std::function<std::uint32_t (int, int)> PixelReader;
+
+      /// \brief Why following a line stopped.
+      enum End {
+        /// \brief The line is interrupted.
+        gap,
+
+        /// \brief The line meets other lines.
+        junction,
+
+        /// \brief The line leaves the image.
+        border,
+
+        /// \brief The line came back to its start.
+        closed,
+
+        /// \brief The greatest number of points has been reached.
+        limit,
+
+        /// \brief Following has been interrupted by the caller.
+        interrupted
+      };
+
+      /// \brief A line followed.
+      struct Line {
+        /// \brief Points of the line, in image coordinates.
+        std::vector<Projection::Point2D> points;
+
+        /// \brief Why following stopped before the first point.
+        End first;
+
+        /// \brief Why following stopped after the last point.
+        End last;
+      };
+
+      /// \brief Greatest distance between the click and the line, in pixels.
+      static const int snapRadius = 4;
+
+      /// \brief Greatest number of points of a line.
+      static const std::size_t maximumPoints = 100000;
+
+      /**
+       * \brief Construct a tracer on an image.
+       * \param _reader Function giving colours of pixels.
+       * \param _width Width of the image.
+       * \param _height Height of the image.
+       * \param _spacing Distance between points of lines, in pixels.
+       * \param _tolerance Greatest difference of a colour component between
+       * the line and its pixels.
+       */
+      LineTracer (const PixelReader &_reader, int _width, int _height,
+                  double _spacing, int _tolerance):
+        reader (_reader), width (_width), height (_height),
+        spacing (_spacing), tolerance (_tolerance), reference (0) {}
+
+      /**
+       * \brief Follow the line clicked, in both directions.
+       * \param x Abscissa of the click.
+       * \param y Ordinate of the click.
+       * \param carryOn Function called at each point, which interrupts
+       * following when returning false.
+       * \return The line, without any point if no line has been clicked.
+       */
+      Line trace (double x, double y, const std::function<bool ()> &carryOn);
+
+    private:
+      /// \brief Function giving colours of pixels.
+      PixelReader reader;
+
+      /// \brief Width of the image.
+      int width;
+
+      /// \brief Height of the image.
+      int height;
+
+      /// \brief Distance between points of lines, in pixels.
+      double spacing;
+
+      /// \brief Greatest difference of a colour component.
+      int tolerance;
+
+      /// \brief Colour of the line followed.
+      std::uint32_t reference;
+
+      /**
+       * \brief Whether a position is inside the image.
+       * \param x Abscissa.
+       * \param y Ordinate.
+       */
+      bool inside (double x, double y) const {
+        return x >= 0. && y >= 0. && x < width && y < height;
+      }
+
+      /**
+       * \brief Whether the pixel at a position belongs to the line.
+       * \param x Abscissa.
+       * \param y Ordinate.
+       */
+      bool onLine (double x, double y) const;
+
+      /**
+       * \brief Find the line near a click, setting its colour.
+       * \param x Abscissa of the click.
+       * \param y Ordinate of the click.
+       * \param start Where to put the point of the line found.
+       * \return Whether a line has been found.
+       */
+      bool snap (double x, double y, Projection::Point2D &start);
+
+      /**
+       * \brief Directions where the line goes from a point.
+       * \param centre The point.
+       * \return Angle of each direction, in radians.
+       */
+      std::vector<double> directions (const Projection::Point2D &centre)
+        const;
+
+      /**
+       * \brief Move a point to the middle of the line, across a direction.
+       * \param point The point.
+       * \param angle Direction of the line, in radians.
+       */
+      void centre (Projection::Point2D &point, double angle) const;
+
+      /**
+       * \brief Follow the line in one direction.
+       * \param start First point, already in the line.
+       * \param angle Direction to go to first, in radians.
+       * \param carryOn Function interrupting following.
+       * \param points Where points are added, start excluded.
+       * \return Why following stopped.
+       */
+      End follow (const Projection::Point2D &start, double angle,
+                  const std::function<bool ()> &carryOn,
+                  std::vector<Projection::Point2D> &points) const;
+  };
+}
+
+#endif  // #ifndef LINETRACER_HPP
@@ -7,6 +7,7 @@
  * \date 2013/07/01
  * \date 2014/02/05
  * \date 2014/02/06
+ * \date 2026/10/17
  */
 
 /**
@@ -16,11 +17,21 @@
  * Command : 
  *
  *      geodesk [Options]
+ *      geodesk <command> [Command options]
  *
  * Supported options:
  *
  *      -h [ --help ]         Display help message.
  *      -v [ --version ]      Display program version.
+ *      --profile arg         Time hot paths, write a summary on the standard
+ *                            error and a Chrome trace in the given file.
+ *
+ * Supported commands, run without graphical interface:
+ *
+ *      transform             Convert points from image coordinates to
+ *                            geographical coordinates using a world file:
+ *
+ *          geodesk transform --world map.jgw in.txt out.txt
  *
  * Wiki (user's guide and coding guidance):
  * <https://github.com/ylebars/GeoDesk/wiki>
@@ -38,6 +49,8 @@
 #include <boost/test/included/prg_exec_monitor.hpp>
 #include <boost/program_options.hpp>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include <QApplication>
 #include <QTranslator>
 #include <QLocale>
@@ -45,6 +58,8 @@
 #include <QString>
 
 #include "mainboard.hpp"
+#include "batch.hpp"
+#include "profiler.hpp"
 
 /**
  * \brief Main function of the program.
@@ -55,6 +70,9 @@
 int cpp_main (int argc, char** argv) {
   namespace po = boost::program_options;
 
+  /* Commands are run without starting Qt. */
+  if ((argc > 1) && Batch::isCommand(argv[1])) return Batch::run(argc, argv);
+
   /* Initialisation of Qt. */
   const QApplication app (argc, argv);
 
@@ -71,7 +89,10 @@ int cpp_main (int argc, char** argv) {
   po::options_description desc("Supported options");
   desc.add_options()
     ("help,h", "Display this help message.")
-    ("version,v", "Display program version.");
+    ("version,v", "Display program version.")
+    ("profile", po::value<std::string>(),
+     "Time hot paths, write a summary on the standard error and a Chrome "
+     "trace in the given file.");
   /* Command line. */
   po::options_description cmd;
   cmd.add(desc);
@@ -90,8 +111,10 @@ int cpp_main (int argc, char** argv) {
     std::cout << "GeoDesk is a tool to get geographical data from "
               << "digitalised maps.\n\n"
               << "Command : \n\n"
-              << '\t' << argv[0] << " [Options]\n\n"
-              << desc << '\n';
+              << '\t' << argv[0] << " [Options]\n"
+              << '\t' << argv[0] << " <command> [Command options]\n\n"
+              << desc << '\n'
+              << Batch::commandsDescription() << '\n';
     stop = true;
   }
 
@@ -106,11 +129,38 @@ int cpp_main (int argc, char** argv) {
 
   if (stop) return 0;
 
+  /* Name of the trace file, empty when not profiling. */
+  const std::string traceFile =
+    vm.count("profile")? vm["profile"].as<std::string>(): std::string ();
+#ifdef GEODESK_PROFILE
+  Profile::Profiler::instance().enable(!traceFile.empty());
+#else
+  if (!traceFile.empty())
+    std::cerr << "Timers are not built in this program, rebuild it with "
+              << "CMake variable \"GEODESK_PROFILE\" set.\n";
+#endif
+
   /* -- Launch main window. -- */
 
-  /* Main board of the program. */
-  GUI::MainBoard mainBoard;
-  mainBoard.show();
+  /* Status returned by Qt. */
+  int status;
+  {
+    /* Main board of the program, saving its session when destroyed. */
+    GUI::MainBoard mainBoard;
+    mainBoard.show();
+    status = app.exec();
+  }
 
-  return app.exec();
+#ifdef GEODESK_PROFILE
+  if (!traceFile.empty()) {
+    Profile::Profiler::instance().writeSummary(std::cerr);
+    try {
+      Profile::Profiler::instance().writeTrace(traceFile);
+    }
+    catch (const std::runtime_error &error) {
+      std::cerr << error.what() << '\n';
+    }
+  }
+#endif
+  return status;
 }
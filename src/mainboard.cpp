@@ -30,6 +30,7 @@
  * \date 2013/11/12
  * \date 2013/11/22
  * \date 2013/11/26
+ * \date 2026/10/17
  */
 
 #include <QFileDialog>
@@ -37,6 +38,7 @@
 #include <QImage>
 #include <QMessageBox>
 #include <cstddef>
+#include <cmath>
 #include <algorithm>
 #include <QInputDialog>
 #include <QMessageBox>
@@ -46,10 +48,14 @@
 #include <QTextStream>
 #include <QMessageBox>
 #include <boost/units/systems/si/io.hpp>
-// #include <gdal_priv.h>
 
 #include "mainboard.hpp"
 
+const int GUI::MainBoard::hitDistance;
+const int GUI::MainBoard::traceTolerance;
+const std::size_t GUI::MainBoard::extractMinimum;
+const int GUI::MainBoard::defaultSpacing;
+
 /* -- Open an image. ------------------------------------------------------ */
 void GUI::MainBoard::on_actionOpen_triggered () {
   ui.statusbar->showMessage(tr("Opening image."));
@@ -75,75 +81,259 @@ void GUI::MainBoard::on_actionOpen_triggered () {
                                                         &selectedFilter);
 
   if (!fileName.isEmpty()) {
-    if (selectedFilter == georeferenced) {
-//       GDALAllRegister();
-// 
-//       /* Pointer to the image */
-//       GDALDataset* poDataset =
-//         static_cast<GDALDataset*>(GDALOpen(fileName.toStdString().c_str(),
-//                                   GA_ReadOnly));
-//       if (poDataset == nullptr) {
-//         QMessageBox::information(this, tr("GeoDesk"),
-//                                  tr("Cannot load %1.").arg(fileName));
-//       }
+    GEODESK_TIME("MainBoard::open");
+    if (loader) {
+      loader->disconnect(this);
+      loader->cancel();
     }
-    else {
-      const QImage image (fileName);
-      if (image.isNull()) {
-        QMessageBox::information(this, tr("GeoDesk"),
-                                 tr("Cannot load %1.").arg(fileName));
-        return;
-      }
-
-      imageLabel->setPixmap(QPixmap::fromImage(image));
-      scaleFactor = 1.0;
+    saveSession();
+    session = Session (fileName);
+    QDir ().mkpath(Session::directory());
+    Session::trim(session);
+    restoredScroll = QPoint ();
+    loader = new ImageLoader (fileName, session, this);
+    connect(loader, SIGNAL(previewReady(const QImage&, const QSize&)),
+            this, SLOT(previewLoaded(const QImage&, const QSize&)));
+    connect(loader, SIGNAL(pyramidReady()), this, SLOT(pyramidLoaded()));
+    connect(loader, SIGNAL(levelsReady()), this, SLOT(levelsLoaded()));
+    connect(loader, SIGNAL(sourceReady()), this, SLOT(sourceLoaded()));
+    connect(loader, SIGNAL(progress(int)), this, SLOT(loadProgress(int)));
+    connect(loader, SIGNAL(failed()), this, SLOT(loadFailed()));
+    connect(loader, SIGNAL(finished()), loader, SLOT(deleteLater()));
+    loadedFileName = fileName;
+    loader->start(QThread::LowPriority);
 
-      imageLabel->adjustSize();
+    imageView->clear();
+    scaleFactor = 1.0;
+    imageView->setScale(scaleFactor);
 
-      ui.actionZoomIn->setEnabled(true);
-      ui.actionZoomOut->setEnabled(true);
-      ui.actionNormalSize->setEnabled(true);
-      ui.actionSetData->setEnabled(false);
-      ui.actionSampleIsobath->setEnabled(false);
-      ui.actionSetData->setChecked(false);
-      ui.actionSampleIsobath->setChecked(false);
+    ui.actionZoomIn->setEnabled(true);
+    ui.actionZoomOut->setEnabled(true);
+    ui.actionNormalSize->setEnabled(true);
+    ui.actionSetData->setEnabled(false);
+    ui.actionSampleIsobath->setEnabled(false);
+    ui.actionEditData->setEnabled(false);
+    ui.actionTraceIsobath->setEnabled(false);
+    ui.actionSetData->setChecked(false);
+    ui.actionSampleIsobath->setChecked(false);
+    ui.actionEditData->setChecked(false);
+    ui.actionTraceIsobath->setChecked(false);
+    if (tracer) {
+      tracer->cancel();
+      tracer = 0;
+    }
+    if (extractor) {
+      extractor->cancel();
+      extractor = 0;
+    }
 
-      /* Information about the image file. */
-      const QFileInfo imageFile (fileName);
-      /* Extension of the image file. */
-      const QString imageExtension = imageFile.suffix();
-      /* Extension for the world file. */
-      const QString worldExtension = '.' + imageExtension.at(0)
-        + imageExtension.at(imageExtension.size() - 1) + 'w';
-      /* Name of the world file. */
+    /* Name of the image file, as known by the system. */
+    const std::string imageName =
+      QFile::encodeName(QFileInfo (fileName).canonicalFilePath())
+        .constData();
+    try {
       worldFileName =
-        imageFile.canonicalPath() + QDir::separator()
-        + imageFile.completeBaseName() + worldExtension;
-      worldExists = false;
-      ui.statusbar->showMessage(geoNotOk);
-      if (QFile::exists(worldFileName)) {
-        loadWorldFile(worldFileName);
-      }
+        QFile::decodeName(Projection::worldFileName(imageName).c_str());
+    }
+    catch (const std::domain_error &) {
+      worldFileName.clear();
+    }
+    worldExists = false;
+    ui.statusbar->showMessage(geoNotOk);
+    if (QFile::exists(worldFileName)) {
+      loadWorldFile(worldFileName);
+    }
+    else {
+      loadGeoTiff(fileName);
+    }
 
-      ui.actionSaveWorldFile->setEnabled(false);
-      ui.actionSaveReferencePoints->setEnabled(false);
-      ui.actionSaveReferencePointsAs->setEnabled(false);
-      data.clear();
+    ui.actionSaveWorldFile->setEnabled(false);
+    ui.actionSaveReferencePoints->setEnabled(false);
+    ui.actionSaveReferencePointsAs->setEnabled(false);
+    if (journal.unsaved() == 0
+        || QMessageBox::question(this, tr("GeoDesk"),
+                                 tr("Discard %1 data not "
+                                    "saved?").arg(journal.unsaved()),
+                                 QMessageBox::Yes | QMessageBox::No)
+           == QMessageBox::Yes) {
+      journal.clear();
       dataFileName.clear();
-      referencePointFileName.clear();
-      referencing = false;
-      setting = false;
-      sampling = false;
-      ui.actionGeoreferenceImage->setEnabled(true);
-      ui.actionSaveDataFile->setEnabled(false);
-      ui.actionSaveDataFileAs->setEnabled(false);
     }
+    referencePoints.clear();
+    referencePointFileName.clear();
+    referencing = false;
+    setting = false;
+    sampling = false;
+    editing = false;
+    tracing = false;
+    if (restoreSession())
+      ui.statusbar->showMessage(tr("Session restored."));
+    ui.actionGeoreferenceImage->setEnabled(true);
+    ui.actionSaveDataFile->setEnabled(journal.size() > 0);
+    ui.actionSaveDataFileAs->setEnabled(journal.size() > 0);
+    ui.actionChangeValues->setEnabled(journal.size() > 0);
+    updateIndex();
+    updateOverlay();
   }
   else {
     ui.statusbar->showMessage(noFile);
   }
 }
 
+/* -- A preview of the image is available. -------------------------------- */
+void GUI::MainBoard::previewLoaded (const QImage &preview,
+                                    const QSize &size) {
+  if (sender() != loader) return;
+  imageView->setPreview(preview, size);
+  if (!restoredScroll.isNull()) {
+    scrollArea->horizontalScrollBar()->setValue(restoredScroll.x());
+    scrollArea->verticalScrollBar()->setValue(restoredScroll.y());
+    restoredScroll = QPoint ();
+  }
+}
+
+/* -- The pyramid of the image is available. ------------------------------ */
+void GUI::MainBoard::pyramidLoaded () {
+  if (sender() != loader) return;
+  imageView->setPyramid(loader->pyramid());
+}
+
+/* -- Levels kept in memory are available. -------------------------------- */
+void GUI::MainBoard::levelsLoaded () {
+  if (sender() != loader) return;
+
+  /* Levels built by the loader. */
+  ImagePyramid::Levels levels;
+  loader->takeLevels(levels);
+  imageView->setLevels(levels);
+  /* Pixels at full resolution may still be decoding. */
+  if (imageView->imagePyramid()
+      && !imageView->imagePyramid()->hasSource())
+    return;
+  loader = 0;
+  ui.statusbar->showMessage(worldExists? geoOk: geoNotOk);
+}
+
+/* -- Pixels at full resolution are readable. ----------------------------- */
+void GUI::MainBoard::sourceLoaded () {
+  if (sender() != loader) return;
+  imageView->sourceLoaded();
+  loader = 0;
+  ui.statusbar->showMessage(worldExists? geoOk: geoNotOk);
+}
+
+/* -- Progress of image loading. ------------------------------------------ */
+void GUI::MainBoard::loadProgress (int percent) {
+  if (sender() != loader) return;
+  ui.statusbar->showMessage(tr("Loading image: %1 %").arg(percent));
+}
+
+/* -- The image cannot be loaded. ----------------------------------------- */
+void GUI::MainBoard::loadFailed () {
+  if (sender() != loader) return;
+  loader = 0;
+  imageView->clear();
+  ui.actionZoomIn->setEnabled(false);
+  ui.actionZoomOut->setEnabled(false);
+  ui.actionNormalSize->setEnabled(false);
+  ui.actionGeoreferenceImage->setEnabled(false);
+  ui.statusbar->showMessage(noFile);
+  QMessageBox::information(this, tr("GeoDesk"),
+                           tr("Cannot load %1.").arg(loadedFileName));
+}
+
+/* -- Save the session of the image. -------------------------------------- */
+void GUI::MainBoard::saveSession () {
+  if (session.isNull() || imageView->isEmpty()) return;
+  GEODESK_TIME("MainBoard::saveSession");
+  /* State of the work on the image. */
+  Session::State state;
+  state.projection =
+    mapProjection? QString::fromStdString(mapProjection->name()):
+    QString ("geographic");
+  state.changeKnown = worldExists;
+  state.change = change;
+  state.scale = scaleFactor;
+  state.scroll = QPoint (scrollArea->horizontalScrollBar()->value(),
+                         scrollArea->verticalScrollBar()->value());
+  state.dataFileName = dataFileName;
+  state.referencePointFileName = referencePointFileName;
+  state.unsaved = static_cast<int>(journal.unsaved());
+  try {
+    session.save(state, referencePoints, journal.samples());
+  }
+  catch (const std::runtime_error &error) {
+    ui.statusbar->showMessage(tr("Session cannot be saved. "
+                                 "%1").arg(error.what()));
+  }
+}
+
+/* -- Restore the session of the image. ----------------------------------- */
+bool GUI::MainBoard::restoreSession () {
+  if (!session.exists()) return false;
+  GEODESK_TIME("MainBoard::restoreSession");
+  /* State of the work on the image. */
+  Session::State state;
+  /* Reference points. */
+  ReferencePoints points;
+  /* Data set on the image. */
+  std::vector<Data::Sample> samples;
+  try {
+    session.restore(state, points, samples);
+  }
+  catch (const std::runtime_error &error) {
+    QMessageBox::critical(this, tr("Error"),
+                          tr("Session cannot be restored. "
+                             "%1").arg(error.what()));
+    return false;
+  }
+
+  mapProjection = points.projection();
+  referencePoints = points;
+  referencePointFileName = state.referencePointFileName;
+  ui.actionSaveReferencePointsAs->setEnabled(!referencePoints.empty());
+  if (!worldExists) {
+    if (state.changeKnown) {
+      change = state.change;
+      worldExists = true;
+      ui.actionSaveWorldFile->setEnabled(true);
+      ui.actionSetData->setEnabled(true);
+      ui.actionSampleIsobath->setEnabled(true);
+      ui.actionEditData->setEnabled(true);
+      ui.actionTraceIsobath->setEnabled(true);
+    }
+    else {
+      updateFit();
+    }
+  }
+
+  /* Data kept from the previous image are not replaced. */
+  if (journal.size() == 0 && !samples.empty()) {
+    /* Data not saved in their file, given last. */
+    std::vector<Data::Sample> unsaved (samples.end() - state.unsaved,
+                                       samples.end());
+    samples.resize(samples.size() - unsaved.size());
+    dataFileName = state.dataFileName;
+    try {
+      journal.assign(samples,
+                     QFile::encodeName(dataFileName).constData());
+      for (std::size_t i = 0; i < unsaved.size(); ++i)
+        journal.append(unsaved[i]);
+    }
+    catch (const std::runtime_error &) {
+      QMessageBox::critical(this, tr("Error"),
+                            tr("Data cannot be journaled."));
+    }
+  }
+
+  scaleFactor = std::min(std::max(state.scale, 0.1), 3.);
+  imageView->setScale(scaleFactor);
+  ui.actionZoomIn->setEnabled(scaleFactor < 3.0);
+  ui.actionZoomOut->setEnabled(scaleFactor > 0.1);
+  restoredScroll = state.scroll;
+  return true;
+}
+
 /* -- Load a world file. -------------------------------------------------- */
 void GUI::MainBoard::on_actionLoadWorldFile_triggered () {
   ui.statusbar->showMessage(tr("Loading world file."));
@@ -170,37 +360,34 @@ void GUI::MainBoard::on_actionLoadWorldFile_triggered () {
 void GUI::MainBoard::on_actionLoadReferencePoints_triggered () {
   ui.statusbar->showMessage(tr("Loading reference points."));
 
-  referencePointList.clear();
+  referencePoints.clear();
   referencePointFileName = QFileDialog::getOpenFileName(this, openFile,
                                                         QDir::currentPath(),
                                                         textOrAny);
 
   if (!referencePointFileName.isEmpty()) {
-    /* The file itself. */
-    QFile file (referencePointFileName);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-      /* Stream on the file. */
-      QTextStream referencePointFileStream (&file);
-
-      while (!referencePointFileStream.atEnd()) {
-        /* Point coordinates in image referential. */
-        Point2D image;
-        /* Point coordinates in geographical referential. */
-        Point2D geographic;
-        referencePointFileStream >> image.x() >> image.y()
-                                 >> geographic.x() >> geographic.y();
-        /* New reference point. */
-        const ReferencePointType referencePoint =
-          std::make_pair(image, geographic);
-        referencePointList.push_back(referencePoint);
-      }
+    GEODESK_TIME("MainBoard::loadReferencePoints");
+    try {
+      referencePoints.read(QFile::encodeName(referencePointFileName)
+                             .constData());
     }
-    else {
+    catch (const std::runtime_error &error) {
       QMessageBox::critical(this, tr("Error"),
-                            tr("File named \"%1\" cannot "
-                               "be opened.").arg(referencePointFileName));
+                            tr("File named \"%1\" cannot be read. "
+                               "%2").arg(referencePointFileName)
+                                    .arg(error.what()));
+    }
+    /* Whether or not reference points define the referential change. */
+    const bool fitted = updateFit();
+    updateOverlay();
+    if (fitted) {
+      ui.statusbar->showMessage(tr("%1 reference points, RMS %2.")
+                                .arg(referencePoints.size())
+                                .arg(referencePoints.fit().rms()));
+    }
+    else {
+      ui.statusbar->showMessage(done);
     }
-    ui.statusbar->showMessage(done);
   }
   else {
     ui.statusbar->showMessage(noFile);
@@ -211,23 +398,59 @@ void GUI::MainBoard::on_actionLoadReferencePoints_triggered () {
 void GUI::MainBoard::on_actionLoadDataFile_triggered () {
   ui.statusbar->showMessage(tr("Loading data file."));
 
-  data.clear();
   /* Name of the file to  be opened. */
-  dataFileName = QFileDialog::getOpenFileName(this, openFile,
-                                              QDir::currentPath(), textOrAny);
+  const QString fileName =
+    QFileDialog::getOpenFileName(this, openFile, QDir::currentPath(),
+                                 dataFiles);
 
-  if (!dataFileName.isEmpty()) {
-    /* The file itself. */
-    QFile file (dataFileName);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-      data = file.readAll();
-      file.close();
+  if (!fileName.isEmpty()) {
+    /* Data recovered or set since last saved would be lost otherwise. */
+    if (journal.unsaved() > 0
+        && QMessageBox::question(this, tr("GeoDesk"),
+                                 tr("Discard %1 data not "
+                                    "saved?").arg(journal.unsaved()),
+                                 QMessageBox::Yes | QMessageBox::No)
+           != QMessageBox::Yes) {
+      ui.statusbar->showMessage(aborted);
+      return;
     }
-    else {
+    GEODESK_TIME("MainBoard::loadDataFile");
+    /* Name of the file, as known by the system. */
+    const std::string name = QFile::encodeName(fileName).constData();
+    try {
+      if (Data::isBinaryFile(name)) {
+        /* Binary file, mapped in memory. */
+        const Data::BinaryFile file (name);
+        /* Samples in the file. */
+        std::vector<Data::Sample> samples;
+        file.read(samples);
+        journal.assign(samples, name);
+        if (file.hasChange() && !worldExists && !mapProjection
+            && !imageView->isEmpty()) {
+          change = file.change();
+          worldExists = true;
+          ui.actionSaveWorldFile->setEnabled(true);
+          ui.actionSetData->setEnabled(true);
+          ui.actionSampleIsobath->setEnabled(true);
+          ui.actionEditData->setEnabled(true);
+          ui.actionTraceIsobath->setEnabled(true);
+        }
+      }
+      else {
+        journal.load(name);
+      }
+      dataFileName = fileName;
+    }
+    catch (const std::runtime_error &error) {
       QMessageBox::critical(this, tr("Error"),
-                            tr("File named \"%1\" cannot "
-                               "be opened.").arg(dataFileName));
+                            tr("File named \"%1\" cannot be read. "
+                               "%2").arg(fileName).arg(error.what()));
     }
+    updateIndex();
+    updateOverlay();
+    ui.actionSaveDataFile->setEnabled(journal.size() > 0);
+    ui.actionSaveDataFileAs->setEnabled(journal.size() > 0);
+    ui.actionChangeValues->setEnabled(journal.size() > 0);
     ui.statusbar->showMessage(done);
   }
   else {
@@ -252,8 +475,8 @@ void GUI::MainBoard::on_actionZoomOut_triggered () {
 /* -- Set image to its normal size. --------------------------------------- */
 void GUI::MainBoard::on_actionNormalSize_triggered () {
   ui.statusbar->showMessage(tr("Back to normal size."));
-  imageLabel->adjustSize();
   scaleFactor = 1.0;
+  imageView->setScale(scaleFactor);
   ui.actionZoomIn->setEnabled(true);
   ui.actionZoomOut->setEnabled(true);
   ui.statusbar->showMessage(done);
@@ -302,21 +525,18 @@ void GUI::MainBoard::on_actionSaveWorldFile_triggered () {
     }
   }
 
-  /* World file itself. */
-  QFile worldFile (worldFileName);
-  worldFile.open(QIODevice::WriteOnly | QIODevice::Text
-                 | QIODevice::Truncate);
-  /* Stream on the world file. */
-  QTextStream worldFileStream (&worldFile);
-
-  worldFileStream << change(0, 0) << '\n'
-                  << change(1, 0) << '\n'
-                  << change(0, 1) << '\n'
-                  << change(1, 1) << '\n'
-                  << change(0, 2) << '\n'
-                  << change(1, 2) << '\n';
-
-  worldFile.close();
+  try {
+    GEODESK_TIME("MainBoard::saveWorldFile");
+    writeWorldFile(std::string(QFile::encodeName(worldFileName).constData()),
+                   change);
+  }
+  catch (const std::runtime_error &error) {
+    QMessageBox::critical(this, tr("Error"),
+                          tr("World file cannot be written. "
+                             "%1").arg(error.what()));
+    ui.statusbar->showMessage(aborted);
+    return;
+  }
 
   ui.actionSaveWorldFile->setEnabled(false);
 
@@ -342,21 +562,247 @@ void GUI::MainBoard::on_actionSaveDataFileAs_triggered () {
 
   dataFileName = QFileDialog::getSaveFileName(this, tr("Save data file as"),
                                               QDir::currentPath(),
-                                              tr("Text files (*.txt);;"
-                                                 "All files (*)"));
+                                              dataFiles);
   saveDataFile();
 }
 
+/* -- Export data as lines. ----------------------------------------------- */
+void GUI::MainBoard::on_actionExportData_triggered () {
+  if (journal.size() == 0) {
+    ui.statusbar->showMessage(tr("No data to be exported."));
+    return;
+  }
+  if (exporter) {
+    ui.statusbar->showMessage(tr("Already exporting data."));
+    return;
+  }
+  /* Name of the file. */
+  const QString fileName =
+    QFileDialog::getSaveFileName(this, tr("Export data"), QDir::currentPath(),
+                                 exportFiles);
+  if (fileName.isEmpty()) {
+    ui.statusbar->showMessage(aborted);
+    return;
+  }
+  /* Name of the file, as known by the system. */
+  const std::string name = QFile::encodeName(fileName).constData();
+  /* Format of the file. */
+  Data::VectorFormat format;
+  try {
+    format = Data::vectorFormat(name);
+  }
+  catch (const std::runtime_error &) {
+    QMessageBox::critical(this, tr("Error"),
+                          tr("File named \"%1\" should end with "
+                             "\".geojson\", \".csv\" or \".shp\".")
+                            .arg(fileName));
+    return;
+  }
+  /* Did the user push "OK" button? */
+  bool ok;
+  /* Greatest distance between two successive samples of a line. */
+  const double gap =
+    QInputDialog::getDouble(this, tr("Export data"),
+                            tr("Greatest distance between two samples of a "
+                               "line, in image pixels (0 for none)"), 0.,
+                            0., 1e6, 1, &ok);
+  if (!ok) {
+    ui.statusbar->showMessage(aborted);
+    return;
+  }
+
+  /* Samples are copied, as data can still be set while exporting. */
+  const std::shared_ptr<const std::vector<Data::Sample> > samples =
+    std::make_shared< std::vector<Data::Sample> >(journal.samples());
+  exporter = new ExportThread (samples, name, format, gap, this);
+  connect(exporter, SIGNAL(progress(int)), this, SLOT(exportProgress(int)));
+  connect(exporter, SIGNAL(exported()), this, SLOT(dataExported()));
+  connect(exporter, SIGNAL(finished()), exporter, SLOT(deleteLater()));
+  exporter->start(QThread::LowPriority);
+  ui.statusbar->showMessage(tr("Exporting data to \"%1\".").arg(fileName));
+}
+
+/* -- Interpolate data on a regular grid. --------------------------------- */
+void GUI::MainBoard::on_actionGridData_triggered () {
+  if (journal.size() == 0) {
+    ui.statusbar->showMessage(tr("No data to be gridded."));
+    return;
+  }
+  if (gridThread) {
+    ui.statusbar->showMessage(tr("Already gridding data."));
+    return;
+  }
+  /* Did the user push "OK" button? */
+  bool ok;
+  /* Side of cells. */
+  const double resolution =
+    QInputDialog::getDouble(this, tr("Grid data"),
+                            tr("Side of cells, in degrees"), 0.001, 0.000001,
+                            1., 6, &ok);
+  if (!ok) return;
+  /* Interpolation methods proposed. */
+  const QStringList methods =
+    QStringList () << tr("Linear in the triangulation (TIN)")
+                   << tr("Inverse distance weighting (IDW)");
+  /* Interpolation method chosen. */
+  const QString chosen =
+    QInputDialog::getItem(this, tr("Grid data"), tr("Interpolation method"),
+                          methods, 0, false, &ok);
+  if (!ok) return;
+  /* Name of the file. */
+  const QString fileName =
+    QFileDialog::getSaveFileName(this, tr("Grid data"), QDir::currentPath(),
+                                 gridFiles);
+  if (fileName.isEmpty()) {
+    ui.statusbar->showMessage(aborted);
+    return;
+  }
+
+  /* Samples are copied, as data can still be set while gridding. */
+  const std::shared_ptr<const std::vector<Data::Sample> > samples =
+    std::make_shared< std::vector<Data::Sample> >(journal.samples());
+  gridThread = new GridThread (samples,
+                               QFile::encodeName(fileName).constData(),
+                               (chosen == methods[0])?
+                                 Data::Gridder::tinMethod:
+                                 Data::Gridder::idwMethod,
+                               resolution, gridRadius * resolution, this);
+  connect(gridThread, SIGNAL(progress(int)), this, SLOT(gridProgress(int)));
+  connect(gridThread, SIGNAL(gridded()), this, SLOT(dataGridded()));
+  connect(gridThread, SIGNAL(finished()), gridThread, SLOT(deleteLater()));
+  gridThread->start(QThread::LowPriority);
+  ui.statusbar->showMessage(tr("Gridding data to \"%1\".").arg(fileName));
+}
+
+/* -- Read the geo-reference of a GeoTIFF image. -------------------------- */
+bool GUI::MainBoard::loadGeoTiff (const QString &fileName) {
+  GEODESK_TIME("MainBoard::loadGeoTiff");
+  /* The image file. */
+  QFile file (fileName);
+  if (!file.open(QIODevice::ReadOnly)) return false;
+  /* Size of the file. */
+  const std::size_t size = static_cast<std::size_t>(file.size());
+  /* Content of the file. */
+  uchar* data = file.map(0, file.size());
+  if (!data) return false;
+  /* The geo-reference. */
+  Tiff::GeoReference reference;
+  /* Whether or not the image is geo-referenced. */
+  bool found = false;
+  try {
+    found = Tiff::isTiff(data, size)
+      && Tiff::readGeoReference(Tiff::Directory (data, size), reference);
+  }
+  catch (const std::runtime_error &) {
+    found = false;
+  }
+  file.unmap(data);
+  if (!found) return false;
+
+  change = reference.change;
+  worldExists = true;
+  ui.actionSaveWorldFile->setEnabled(true);
+  ui.actionSetData->setEnabled(true);
+  ui.actionSampleIsobath->setEnabled(true);
+  ui.actionEditData->setEnabled(true);
+  ui.actionTraceIsobath->setEnabled(true);
+  if (reference.projection.empty()) {
+    ui.statusbar->showMessage(tr("Image geo-referenced in EPSG:%1, unknown "
+                                 "projection: choose it in \"Map "
+                                 "projection\".").arg(reference.epsg));
+  }
+  else {
+    try {
+      mapProjection = makeProjection(reference.projection);
+      referencePoints.setProjection(mapProjection);
+    }
+    catch (const std::runtime_error &) {
+      mapProjection.reset();
+    }
+    ui.statusbar->showMessage(
+      tr("%1 Map projection: %2").arg(geoOk)
+        .arg(QString::fromStdString(reference.projection)));
+  }
+  updateOverlay();
+  return true;
+}
+
+/* -- Choose the map projection of the geo-reference. --------------------- */
+void GUI::MainBoard::on_actionMapProjection_triggered () {
+  /* Description of the current projection. */
+  const QString current =
+    mapProjection? QString::fromStdString(mapProjection->name()):
+    QString ("geographic");
+  /* Projections proposed, the current one first. */
+  QStringList proposed;
+  proposed << current;
+  /* Projections commonly used. */
+  const QStringList common = QStringList () << "geographic" << "utm:31n"
+                                            << "lambert93" << "mercator";
+  for (const QString &item: common)
+    if (item != current) proposed << item;
+  /* Did the user push "OK" button? */
+  bool ok;
+  /* Description of the projection chosen. */
+  const QString chosen =
+    QInputDialog::getItem(this, tr("Map projection"),
+                          tr("Projection of world files and reference "
+                             "points, as \"utm:31n\", \"lambert93\", "
+                             "\"mercator\",\n\"lambert:parallel 1:parallel "
+                             "2:latitude:longitude\", optionally followed by "
+                             "\"@grs80\":"),
+                          proposed, 0, true, &ok);
+  if (!ok) return;
+
+  try {
+    mapProjection = makeProjection(chosen.trimmed().toStdString());
+  }
+  catch (const std::runtime_error &error) {
+    QMessageBox::critical(this, tr("Error"),
+                          tr("Unknown projection. %1").arg(error.what()));
+    return;
+  }
+  referencePoints.setProjection(mapProjection);
+  /*
+   * Reference points are fitted again, whereas a world file loaded is now
+   * read in the new projection.
+   */
+  if (!referencePoints.empty()) updateFit();
+  updateOverlay();
+  ui.statusbar->showMessage(tr("Map projection: %1").arg(chosen.trimmed()));
+}
+
 /* -- Give reference point for image geo-reference. ----------------------- */
 void GUI::MainBoard::on_actionGeoreferenceImage_triggered () {
-  ui.statusbar->showMessage(
-    tr("Referencing: point 1 / %1").arg(requiredReference));
+  if (referencing) {
+    referencing = false;
+    if (!worldExists) {
+      ui.statusbar->showMessage(geoNotOk);
+      return;
+    }
+
+    /* Residual of each reference point. */
+    const std::vector<double> residual = referencePoints.residuals(change);
+    /* Report on residuals. */
+    QString report = tr("RMS: %1\n\nResidual of each reference point:\n")
+                       .arg(referencePoints.fit().rms());
+    for (size_t i = 0; i < residual.size(); ++i)
+      report += tr("Point %1: %2\n").arg(i + 1).arg(residual[i]);
+    if (residual.size() > requiredReference)
+      QMessageBox::information(this, tr("Geo-reference"), report);
+    ui.statusbar->showMessage(geoOk);
+    return;
+  }
 
   worldExists = false;
   referencing = true;
   setting = false;
   sampling = false;
-  numberReferencePoints = 0;
+  editing = false;
+  tracing = false;
+  selected = Data::SampleIndex::none;
+  imageView->clearSelection();
+  updateReferencing();
 }
 
 /* -- Enable setting geo-referenced data. --------------------------------- */
@@ -364,11 +810,15 @@ void GUI::MainBoard::on_actionSetData_triggered () {
   if (setting) {
     setting = false;
     ui.actionSampleIsobath->setEnabled(true);
+    ui.actionEditData->setEnabled(true);
+    ui.actionTraceIsobath->setEnabled(true);
     ui.statusbar->showMessage(tr("Stop setting geo-referenced data."));
   }
   else {
     setting = true;
     ui.actionSampleIsobath->setEnabled(false);
+    ui.actionEditData->setEnabled(false);
+    ui.actionTraceIsobath->setEnabled(false);
     ui.statusbar->showMessage(tr("Setting geo-referenced data."));
   }
 }
@@ -378,6 +828,8 @@ void GUI::MainBoard::on_actionSampleIsobath_triggered () {
   if (sampling) {
     sampling = false;
     ui.actionSetData->setEnabled(true);
+    ui.actionEditData->setEnabled(true);
+    ui.actionTraceIsobath->setEnabled(true);
     ui.statusbar->showMessage(tr("Stop sampling isobath."));
   }
   else {
@@ -396,6 +848,8 @@ void GUI::MainBoard::on_actionSampleIsobath_triggered () {
       sampling = true;
       value = isobath;
       ui.actionSetData->setEnabled(false);
+      ui.actionEditData->setEnabled(false);
+      ui.actionTraceIsobath->setEnabled(false);
       ui.statusbar->showMessage(tr("Sampling isobath"));
     }
     else {
@@ -404,65 +858,447 @@ void GUI::MainBoard::on_actionSampleIsobath_triggered () {
   }
 }
 
+/* -- Enable editing geo-referenced data. --------------------------------- */
+void GUI::MainBoard::on_actionEditData_triggered () {
+  if (editing) {
+    editing = false;
+    selected = Data::SampleIndex::none;
+    imageView->clearSelection();
+    ui.actionSetData->setEnabled(true);
+    ui.actionSampleIsobath->setEnabled(true);
+    ui.actionTraceIsobath->setEnabled(true);
+    ui.statusbar->showMessage(tr("Stop editing geo-referenced data."));
+  }
+  else {
+    editing = true;
+    ui.actionSetData->setEnabled(false);
+    ui.actionSampleIsobath->setEnabled(false);
+    ui.actionTraceIsobath->setEnabled(false);
+    ui.statusbar->showMessage(tr("Editing geo-referenced data: click to "
+                                 "select, click elsewhere to move, "
+                                 "Ctrl+click to change value, right click "
+                                 "to remove."));
+  }
+}
+
+/* -- Trace isobaths. ----------------------------------------------------- */
+void GUI::MainBoard::on_actionTraceIsobath_triggered () {
+  if (tracing) {
+    tracing = false;
+    if (tracer) {
+      tracer->cancel();
+      tracer = 0;
+    }
+    if (extractor) {
+      extractor->cancel();
+      extractor = 0;
+    }
+    imageView->setTrace(std::vector<Point2D> ());
+    ui.actionSetData->setEnabled(true);
+    ui.actionSampleIsobath->setEnabled(true);
+    ui.actionEditData->setEnabled(true);
+    ui.statusbar->showMessage(tr("Stop tracing isobaths."));
+    return;
+  }
+
+  /* Did the user push "OK" button? */
+  bool ok;
+  /* Isobath value. */
+  const double isobath =
+    QInputDialog::getDouble(this, tr("Isobath value"),
+                            tr("Enter isobath value in meter"), 0., 0.,
+                            15000., 2, &ok);
+  /* Distance between samples. */
+  const int spacing =
+    ok? QInputDialog::getInt(this, tr("Sample spacing"),
+                             tr("Distance between samples, in image "
+                                "pixels"), defaultSpacing, 2, 200, 1,
+                             &ok): 0;
+  if (!ok) {
+    ui.actionTraceIsobath->setChecked(false);
+    return;
+  }
+  tracing = true;
+  value = isobath;
+  traceSpacing = spacing;
+  ui.actionSetData->setEnabled(false);
+  ui.actionSampleIsobath->setEnabled(false);
+  ui.actionEditData->setEnabled(false);
+  ui.statusbar->showMessage(tr("Tracing isobath: click on the line, "
+                               "Shift+click on it or on the legend to "
+                               "extract every line of its colour."));
+}
+
+/* -- Confirm the isobath traced. ----------------------------------------- */
+void GUI::MainBoard::lineTraced () {
+  if (sender() != tracer) return;
+  /* The isobath traced. */
+  const LineTracer::Line line = tracer->line();
+  tracer = 0;
+  if (line.points.size() < 2) {
+    ui.statusbar->showMessage(tr("No line found there."));
+    return;
+  }
+
+  imageView->setTrace(line.points);
+  /* Whether the isobath has been traced without stopping on the way. */
+  const bool whole = line.first == LineTracer::closed
+    || (line.first == LineTracer::border && line.last == LineTracer::border);
+  /* Whether samples are added. */
+  const bool accepted =
+    whole || QMessageBox::question(this, tr("Trace isobath"),
+                                   tr("Tracing stopped %1 and %2, after %3 "
+                                      "samples. Add them?")
+                                     .arg(describe(line.first))
+                                     .arg(describe(line.last))
+                                     .arg(line.points.size()),
+                                   QMessageBox::Yes | QMessageBox::No)
+               == QMessageBox::Yes;
+  imageView->setTrace(std::vector<Point2D> ());
+  if (!accepted) {
+    ui.statusbar->showMessage(aborted);
+    return;
+  }
+
+  /* Number of samples. */
+  const std::size_t n = line.points.size();
+  /* Abscissae, then longitudes. */
+  std::vector<double> x (n);
+  /* Ordinates, then latitudes. */
+  std::vector<double> y (n);
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = line.points[i].x();
+    y[i] = line.points[i].y();
+  }
+  imageToGeographic(change, mapProjection.get(), &x[0], &y[0], &x[0], &y[0],
+                    n);
+  for (std::size_t i = 0; i < n; ++i) {
+    /* Sample of the isobath. */
+    const Data::Sample sample = {line.points[i].x(), line.points[i].y(),
+                                 x[i], y[i], value};
+    appendData(sample);
+  }
+  ui.statusbar->showMessage(tr("Isobath %1 m: %2 samples, tracing stopped "
+                               "%3 and %4.").arg(value).arg(n)
+                              .arg(describe(line.first))
+                              .arg(describe(line.last)));
+}
+
+/* -- Extract every line of the colour clicked. --------------------------- */
+void GUI::MainBoard::extractLayer (const Point2D &pos) {
+  /* Pyramid of the image. */
+  const std::shared_ptr<ImagePyramid> pyramid = imageView->imagePyramid();
+  /* Column of the pixel clicked. */
+  const int x = static_cast<int>(pos.x());
+  /* Row of the pixel clicked. */
+  const int y = static_cast<int>(pos.y());
+  if (!QRect (QPoint (0, 0), pyramid->size()).contains(x, y)) return;
+  /* Side of tiles. */
+  const int side = ImagePyramid::tileSize;
+  /* Tile clicked. */
+  const QImage tile = pyramid->tile(0, x / side, y / side);
+  if (tile.isNull()) return;
+  /* Colour of the layer. */
+  const QRgb colour = tile.pixel(x % side, y % side);
+
+  extractor = new ExtractThread (pyramid, colour, traceSpacing,
+                                 traceTolerance, extractMinimum, this);
+  connect(extractor, SIGNAL(progress(int)), this,
+          SLOT(extractProgress(int)));
+  connect(extractor, SIGNAL(extracted()), this, SLOT(layerExtracted()));
+  connect(extractor, SIGNAL(finished()), extractor, SLOT(deleteLater()));
+  extractor->start(QThread::LowPriority);
+  ui.statusbar->showMessage(tr("Extracting every line of colour %1.")
+                              .arg(QColor (colour).name()));
+}
+
+/* -- Show progress of layer extraction. ---------------------------------- */
+void GUI::MainBoard::extractProgress (int percent) {
+  if (sender() != extractor) return;
+  ui.statusbar->showMessage(tr("Extracting layer: %1 %").arg(percent));
+}
+
+/* -- Confirm the lines of the layer. ------------------------------------- */
+void GUI::MainBoard::layerExtracted () {
+  if (sender() != extractor) return;
+  /* Lines of the layer. */
+  const std::vector<LayerExtractor::Line> lines = extractor->lines();
+  extractor = 0;
+  /* Number of samples. */
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < lines.size(); ++i) n += lines[i].size();
+  if (n == 0) {
+    ui.statusbar->showMessage(tr("No line of this colour found."));
+    return;
+  }
+  if (QMessageBox::question(this, tr("Extract layer"),
+                            tr("%1 lines found, with %2 samples. Add them "
+                               "as isobath %3 m?").arg(lines.size())
+                              .arg(n).arg(value),
+                            QMessageBox::Yes | QMessageBox::No)
+      != QMessageBox::Yes) {
+    ui.statusbar->showMessage(aborted);
+    return;
+  }
+
+  GEODESK_TIME("MainBoard::layerExtracted");
+  /* Abscissae, then longitudes. */
+  std::vector<double> x;
+  /* Ordinates, then latitudes. */
+  std::vector<double> y;
+  x.reserve(n);
+  y.reserve(n);
+  for (std::size_t i = 0; i < lines.size(); ++i)
+    for (std::size_t j = 0; j < lines[i].size(); ++j) {
+      x.push_back(lines[i][j].x());
+      y.push_back(lines[i][j].y());
+    }
+  imageToGeographic(change, mapProjection.get(), &x[0], &y[0], &x[0], &y[0],
+                    n);
+  /* Index of the sample. */
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < lines.size(); ++i)
+    for (std::size_t j = 0; j < lines[i].size(); ++j, ++k) {
+      /* Sample of the isobath. */
+      const Data::Sample sample = {lines[i][j].x(), lines[i][j].y(), x[k],
+                                   y[k], value};
+      appendData(sample);
+    }
+  ui.statusbar->showMessage(tr("Isobath %1 m: %2 lines, %3 samples.")
+                              .arg(value).arg(lines.size()).arg(n));
+}
+
+/* -- Show progress of data export. --------------------------------------- */
+void GUI::MainBoard::exportProgress (int percent) {
+  if (sender() != exporter) return;
+  ui.statusbar->showMessage(tr("Exporting data: %1 %").arg(percent));
+}
+
+/* -- Tell data have been exported. --------------------------------------- */
+void GUI::MainBoard::dataExported () {
+  if (sender() != exporter) return;
+  /* Why the file cannot be written, empty on success. */
+  const std::string failure = exporter->failure();
+  /* Number of lines written. */
+  const std::size_t lines = exporter->lines();
+  exporter = 0;
+  if (!failure.empty()) {
+    QMessageBox::critical(this, tr("Error"),
+                          QString::fromLocal8Bit(failure.c_str()));
+    ui.statusbar->showMessage(aborted);
+    return;
+  }
+  ui.statusbar->showMessage(tr("%1 lines exported.").arg(lines));
+}
+
+/* -- Show progress of data gridding. ------------------------------------- */
+void GUI::MainBoard::gridProgress (int percent) {
+  if (sender() != gridThread) return;
+  ui.statusbar->showMessage(tr("Gridding data: %1 %").arg(percent));
+}
+
+/* -- Tell data have been gridded. ---------------------------------------- */
+void GUI::MainBoard::dataGridded () {
+  if (sender() != gridThread) return;
+  /* Why the grid cannot be written, empty on success. */
+  const std::string failure = gridThread->failure();
+  gridThread = 0;
+  if (!failure.empty()) {
+    QMessageBox::critical(this, tr("Error"),
+                          QString::fromLocal8Bit(failure.c_str()));
+    ui.statusbar->showMessage(aborted);
+    return;
+  }
+  ui.statusbar->showMessage(done);
+}
+
+/* -- Change values of data in a range. ----------------------------------- */
+void GUI::MainBoard::on_actionChangeValues_triggered () {
+  /* Did the user push "OK" button? */
+  bool ok;
+  /* Smallest value changed. */
+  const double minimum =
+    QInputDialog::getDouble(this, tr("Change values"),
+                            tr("Smallest value changed, in meter"), 0.,
+                            0., 15000., 2, &ok);
+  if (!ok) return;
+  /* Greatest value changed. */
+  const double maximum =
+    QInputDialog::getDouble(this, tr("Change values"),
+                            tr("Greatest value changed, in meter"), minimum,
+                            minimum, 15000., 2, &ok);
+  if (!ok) return;
+  /* Data whose value is in the range. */
+  const std::vector<std::size_t> found = sampleIndex.inRange(minimum,
+                                                             maximum);
+  if (found.empty()) {
+    ui.statusbar->showMessage(tr("No data in this range."));
+    return;
+  }
+  /* New value. */
+  const double newValue =
+    QInputDialog::getDouble(this, tr("Change values"),
+                            tr("New value of %1 data, in "
+                               "meter").arg(found.size()),
+                            minimum, 0., 15000., 2, &ok);
+  if (!ok) return;
+
+  /* Number of values changed. */
+  std::size_t changed = 0;
+  for (; changed < found.size(); ++changed) {
+    /* Data with the new value. */
+    Data::Sample sample = journal.samples()[found[changed]];
+    sample.value = newValue;
+    if (!replaceData(found[changed], sample)) break;
+  }
+  ui.statusbar->showMessage(tr("%1 values changed.").arg(changed));
+}
+
+/* -- Edit data under the mouse. ------------------------------------------ */
+void GUI::MainBoard::editData (QMouseEvent* event) {
+  GEODESK_TIME("MainBoard::editData");
+  /* Coordinate of the point being clicked. */
+  const Point2D pos = getMousePosition(event->pos());
+  /* Coordinates in geographical referential. */
+  const Point2D b = toGeographic(pos);
+  /* Distance within which data are hit, in pixels of the image. */
+  const double reach = hitDistance / scaleFactor;
+  /* Point at this distance along abscissae, in geographical referential. */
+  const Point2D bx = toGeographic(Point2D (pos.x() + reach, pos.y()));
+  /* Point at this distance along ordinates, in geographical referential. */
+  const Point2D by = toGeographic(Point2D (pos.x(), pos.y() + reach));
+  /* Distance within which data are hit, in degrees. */
+  const double tolerance = std::max(std::hypot(bx.x() - b.x(),
+                                               bx.y() - b.y()),
+                                    std::hypot(by.x() - b.x(),
+                                               by.y() - b.y()));
+  /* Data hit by the click. */
+  const std::size_t hit =
+    sampleIndex.nearest(Data::SampleIndex::geographicSpace, b.x(), b.y(),
+                        tolerance);
+
+  if (event->button() == Qt::RightButton) {
+    if (hit == Data::SampleIndex::none) return;
+    try {
+      journal.remove(hit);
+    }
+    catch (const std::runtime_error &) {
+      QMessageBox::critical(this, tr("Error"),
+                            tr("Data cannot be journaled."));
+      return;
+    }
+    /* Indices of following data have changed. */
+    updateIndex();
+    updateOverlay();
+    ui.actionSaveDataFile->setEnabled(true);
+    ui.actionSaveDataFileAs->setEnabled(true);
+    ui.statusbar->showMessage(tr("Data removed."));
+    return;
+  }
+  if (event->button() != Qt::LeftButton) return;
+
+  if (hit != Data::SampleIndex::none) {
+    /* Data hit. */
+    Data::Sample sample = journal.samples()[hit];
+    selected = hit;
+    imageView->setSelection(samplePosition(sample));
+    if (event->modifiers() & Qt::ControlModifier) {
+      /* Did the user push "OK" button? */
+      bool ok;
+      sample.value = QInputDialog::getDouble(this, tr("Change value"),
+                                             tr("Value in meter"),
+                                             sample.value, 0., 15000., 2,
+                                             &ok);
+      if (!ok || !replaceData(hit, sample)) return;
+    }
+    ui.statusbar->showMessage(tr("%1%2 E, %3%4 N: %5 m")
+                                .arg(sample.longitude).arg(QChar (0x00B0))
+                                .arg(sample.latitude).arg(QChar (0x00B0))
+                                .arg(sample.value));
+  }
+  else if (selected != Data::SampleIndex::none) {
+    /* Selected data, moved to the clicked localisation. */
+    Data::Sample sample = journal.samples()[selected];
+    sample.x = pos.x();
+    sample.y = pos.y();
+    sample.longitude = b.x();
+    sample.latitude = b.y();
+    if (!replaceData(selected, sample)) return;
+    updateOverlay();
+    imageView->setSelection(pos);
+    ui.statusbar->showMessage(tr("Data moved."));
+  }
+}
+
 /* -- When mouse is left-clicked. ----------------------------------------- */
 void GUI::MainBoard::mousePressEvent (QMouseEvent* event) {
   /* Degree character. */
   const QChar degree = 0x00B0;
 
   QWidget::mousePressEvent(event);
-  if (!imageLabel->pixmap()) return;
+  if (imageView->isEmpty()) return;
+  if (!imageView->rect().contains(imageView->mapFrom(this, event->pos())))
+    return;
+
+  if (editing) {
+    editData(event);
+    return;
+  }
+
+  /* Right click removes the last reference point. */
+  if (referencing && (event->button() == Qt::RightButton)) {
+    if (!referencePoints.empty()) {
+      referencePoints.removeLast();
+      ui.actionSaveReferencePoints->setEnabled(true);
+      ui.actionSaveReferencePointsAs->setEnabled(true);
+      worldExists = false;
+      ui.actionSaveWorldFile->setEnabled(false);
+      updateReferencing();
+    }
+    return;
+  }
+
   if (event->button() != Qt::LeftButton) return;
+  /* Modes asking for values are timed after dialogs, in appendData(). */
+  GEODESK_COUNT("clicks", 1);
 
   /* Coordinate of the point being clicked. */
   const Point2D pos = getMousePosition(event->pos());
 
   if (referencing) {
-    /* Reference points in image coordinates. */
-    static std::vector<Point2D> r1 (requiredReference);
-
-    /* \brief Reference points in geographical coordinates. */
-    static std::vector<Point2D> r2 (requiredReference);
-
-    r1[numberReferencePoints] = pos;
+    /* Point coordinates in geographical referential. */
+    Point2D geographic;
     /* Did the user push "OK" button? */
     bool ok;
-    r2[numberReferencePoints].x() =
+    geographic.x() =
       QInputDialog::getDouble(this, tr("Longitude"),
                               tr("Longitude in decimal degrees east"),
                               0., -180., 180., 4, &ok);
     if (!ok) return;
-    r2[numberReferencePoints].y() =
+    geographic.y() =
       QInputDialog::getDouble(this, tr("Latitude"),
                               tr("Latitude in decimal degrees north"),
                               0., -90., 90., 4, &ok);
-    if (ok) {
-      referencePointList.push_back(std::make_pair(pos,
-                                                  r2[numberReferencePoints]));
-      ui.actionSaveReferencePoints->setEnabled(true);
-      ui.actionSaveReferencePointsAs->setEnabled(true);
-      ++numberReferencePoints;
+    if (!ok) return;
+    if (mapProjection
+        && !std::isfinite(mapProjection->forwardPoint(geographic).y())) {
+      QMessageBox::critical(this, tr("Error"),
+                            tr("This point cannot be projected."));
+      return;
     }
-    ui.statusbar->showMessage(
-      tr("Referencing: point %1 / %2").arg(numberReferencePoints
-                                           + 1).arg(requiredReference));
 
-    if (numberReferencePoints == requiredReference) {
-      change = computeCoefficients(r1, r2).transpose();
-      ui.actionSaveWorldFile->setEnabled(true);
-      ui.actionSetData->setEnabled(true);
-      worldExists = true;
-      referencing = false;
-      ui.statusbar->showMessage(geoOk);
-    }
+    referencePoints.add(pos, geographic);
+    ui.actionSaveReferencePoints->setEnabled(true);
+    ui.actionSaveReferencePointsAs->setEnabled(true);
+
+    updateReferencing();
   }
   else if (setting) {
-    /* Vector for referential change. */
-    const Eigen::Vector3d x (pos.x(), pos.y(), 1.);
     /* Coordinates in geographical referential. */
-    const Eigen::Vector2d b = change * x;
+    const Point2D b = toGeographic(pos);
     /* Message to be outputted. */
-    const QString message = QString::number(b(0)) + degree + tr(" E, ")
-      + QString::number(b(1)) + degree + tr(" N");
+    const QString message = QString::number(b.x()) + degree + tr(" E, ")
+      + QString::number(b.y()) + degree + tr(" N");
     /* Did the user push "OK" button? */
     bool ok;
     /* Value associated to the clicked localisation. */
@@ -470,27 +1306,42 @@ void GUI::MainBoard::mousePressEvent (QMouseEvent* event) {
       (QInputDialog::getDouble(this, tr("Enter value"),
                                message, 0., 0., 15000., 2, &ok) * meter);
     if (ok) {
-      /* Stream on the QString which contains data. */
-      QTextStream dataStream (&data);
-      dataStream << pos.x() << ' ' << pos.y() << ' ' << b(0) << ' ' << b(1)
-                 << ' ' << value.value() << '\n';
-      ui.actionSaveDataFile->setEnabled(true);
-      ui.actionSaveDataFileAs->setEnabled(true);
+      /* Sample at the clicked localisation. */
+      const Data::Sample sample = {pos.x(), pos.y(), b.x(), b.y(),
+                                   value.value()};
+      appendData(sample);
     }
   }
+  else if (tracing) {
+    if (tracer || extractor) {
+      ui.statusbar->showMessage(tr("Already tracing an isobath."));
+      return;
+    }
+    if (loader || !imageView->imagePyramid()) {
+      ui.statusbar->showMessage(tr("Image is still loading."));
+      return;
+    }
+    if (event->modifiers() & Qt::ShiftModifier) {
+      extractLayer(pos);
+      return;
+    }
+    tracer = new TraceThread (imageView->imagePyramid(), pos, traceSpacing,
+                              traceTolerance, this);
+    connect(tracer, SIGNAL(traced()), this, SLOT(lineTraced()));
+    connect(tracer, SIGNAL(finished()), tracer, SLOT(deleteLater()));
+    tracer->start();
+    ui.statusbar->showMessage(tr("Tracing isobath."));
+  }
   else if (sampling) {
-    /* Vector for referential change. */
-    const Eigen::Vector3d x (pos.x(), pos.y(), 1.);
+    GEODESK_TIME("MainBoard::mousePressEvent");
     /* Coordinates in geographical referential. */
-    const Eigen::Vector2d b = change * x;
-    /* Stream on the QString which contains data. */
-    QTextStream dataStream (&data);
-    dataStream << pos.x() << ' ' << pos.y() << ' ' << b(0) << ' ' << b(1)
-               << ' ' << value << '\n';
-    ui.statusbar->showMessage(tr("Isobath ") + value + tr(" m, ")
-                              + QString::number(b(0)) + degree + tr(" E,")
-                              + QString::number(b(1)) + degree + tr(" N"));
-    ui.actionSaveDataFile->setEnabled(true);
-    ui.actionSaveDataFileAs->setEnabled(true);
+    const Point2D b = toGeographic(pos);
+    /* Sample at the clicked localisation. */
+    const Data::Sample sample = {pos.x(), pos.y(), b.x(), b.y(), value};
+    appendData(sample);
+    ui.statusbar->showMessage(tr("Isobath ") + QString::number(value)
+                              + tr(" m, ")
+                              + QString::number(b.x()) + degree + tr(" E,")
+                              + QString::number(b.y()) + degree + tr(" N"));
   }
 }
@@ -34,6 +34,7 @@
  * \date 2013/11/06
  * \date 2013/11/12
  * \date 2013/11/22
+ * \date 2026/10/17
  */
 
 #include <boost/concept_check.hpp>
@@ -48,13 +49,26 @@
 #include <QPoint>
 #include <utility>
 #include <vector>
-#include <list>
 #include <boost/units/systems/si/length.hpp>
 #include <boost/units/static_constant.hpp>
 #include <boost/units/conversion.hpp>
 
 #include "ui_mainboard.h"
 #include "projection.hpp"
+#include "worldfile.hpp"
+#include "tiff.hpp"
+#include "referencepoints.hpp"
+#include "mapprojection.hpp"
+#include "imageview.hpp"
+#include "imageloader.hpp"
+#include "session.hpp"
+#include "tracethread.hpp"
+#include "extractthread.hpp"
+#include "exportthread.hpp"
+#include "gridthread.hpp"
+#include "journal.hpp"
+#include "sampleindex.hpp"
+#include "profiler.hpp"
 
 // /// \brief Namespace for library Boost.
 // namespace boost{
@@ -99,30 +113,82 @@ namespace GUI {
 
     public:
       /// \brief Default constructor.
-      explicit MainBoard (): QMainWindow () {
+      explicit MainBoard ():
+        QMainWindow (),
+        journal (QFile::encodeName(QDir::homePath()
+                                   + "/.geodesk.journal").constData()),
+        loader (0), editing (false), selected (Data::SampleIndex::none),
+        tracing (false), traceSpacing (defaultSpacing), tracer (0),
+        extractor (0), exporter (0), gridThread (0) {
         ui.setupUi(this);
 
         /**
-         * \todo Initialising "imageLabel" should be done in file
+         * \todo Initialising "imageView" should be done in file
          * "mainboard.ui" (using Qt Designer).
          */
-        imageLabel = new QLabel;
-        imageLabel->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
-        imageLabel->setScaledContents(true);
+        imageView = new ImageView;
+        imageView->setZoomSteps(1.25, 0.8);
 
         /**
          * \todo Initialising "scrollArea" should be done in file
          * "mainboard.ui" (using Qt Designer).
          */
         scrollArea = new QScrollArea;
-        scrollArea->setWidget(imageLabel);
+        scrollArea->setWidget(imageView);
         setCentralWidget(scrollArea);
+
+        sampleIndex.assign(journal.samples());
+        if (journal.size() > 0) {
+          dataFileName = QFile::decodeName(journal.dataFile().c_str());
+          ui.actionSaveDataFile->setEnabled(true);
+          ui.actionSaveDataFileAs->setEnabled(true);
+          ui.actionChangeValues->setEnabled(true);
+          ui.statusbar->showMessage(tr("%1 data recovered from previous "
+                                       "session.").arg(journal.size()));
+        }
       }
 
       /// \brief Destructor.
       virtual ~MainBoard () {
-        delete imageLabel;
+        /* Loaders possibly still running. */
+        const QList<ImageLoader*> loaders = findChildren<ImageLoader*>();
+        for (ImageLoader* running: loaders) {
+          running->cancel();
+          running->wait();
+        }
+        /* Tracers possibly still running. */
+        const QList<TraceThread*> tracers = findChildren<TraceThread*>();
+        for (TraceThread* running: tracers) {
+          running->cancel();
+          running->wait();
+        }
+        /* Extractors possibly still running. */
+        const QList<ExtractThread*> extractors =
+          findChildren<ExtractThread*>();
+        for (ExtractThread* running: extractors) {
+          running->cancel();
+          running->wait();
+        }
+        /* Exports possibly still running, whose files are removed. */
+        const QList<ExportThread*> exports = findChildren<ExportThread*>();
+        for (ExportThread* running: exports) {
+          running->cancel();
+          running->wait();
+        }
+        /* Grids possibly still computed, whose files are removed. */
+        const QList<GridThread*> grids = findChildren<GridThread*>();
+        for (GridThread* running: grids) {
+          running->cancel();
+          running->wait();
+        }
+        saveSession();
+        delete imageView;
         delete scrollArea;
+        /* Data not saved are kept, to be recovered at next start. */
+        try {
+          if (journal.unsaved() == 0) journal.clear();
+        }
+        catch (const std::runtime_error &) {}
       }
 
     protected slots:
@@ -167,6 +233,15 @@ namespace GUI {
       /// \brief Save data in a new file.
       void on_actionSaveDataFileAs_triggered ();
 
+      /// \brief Export data as lines to GeoJSON, CSV or Shapefile.
+      void on_actionExportData_triggered ();
+
+      /// \brief Interpolate data on a regular grid written as a GeoTIFF.
+      void on_actionGridData_triggered ();
+
+      /// \brief Choose the map projection of the geo-reference.
+      void on_actionMapProjection_triggered ();
+
       /// \brief Give reference points for image geo-reference.
       void on_actionGeoreferenceImage_triggered ();
 
@@ -176,6 +251,15 @@ namespace GUI {
       /// \brief Sampling an isobath.
       void on_actionSampleIsobath_triggered ();
 
+      /// \brief Enable editing of geo-referenced data.
+      void on_actionEditData_triggered ();
+
+      /// \brief Change values of data in a range.
+      void on_actionChangeValues_triggered ();
+
+      /// \brief Trace isobaths from a click on them.
+      void on_actionTraceIsobath_triggered ();
+
     protected:
       /**
        * \brief What to do when mouse is clicked.
@@ -183,13 +267,63 @@ namespace GUI {
        */
       virtual void mousePressEvent (QMouseEvent *event);
 
-    private:
-      /// \brief Type for a reference point.
-      typedef std::pair<Point2D, Point2D> ReferencePointType;
+    private slots:
+      /**
+       * \brief Display the preview of the image being loaded.
+       * \param preview The image at low resolution.
+       * \param size Size of the image at full resolution.
+       */
+      void previewLoaded (const QImage &preview, const QSize &size);
 
-      /// \brief Type for list containing reference points.
-      typedef std::list<ReferencePointType> ReferencePointListType;
+      /// \brief Display tiles of the image being loaded.
+      void pyramidLoaded ();
 
+      /// \brief Display levels of the image kept in memory.
+      void levelsLoaded ();
+
+      /// \brief Display tiles at full resolution, once decoded.
+      void sourceLoaded ();
+
+      /**
+       * \brief Show progress of image loading.
+       * \param percent Percentage of the current stage done.
+       */
+      void loadProgress (int percent);
+
+      /// \brief Tell the image cannot be loaded.
+      void loadFailed ();
+
+      /// \brief Confirm the isobath traced and add its samples.
+      void lineTraced ();
+
+      /**
+       * \brief Show progress of layer extraction.
+       * \param percent Percentage of the image processed.
+       */
+      void extractProgress (int percent);
+
+      /// \brief Confirm the lines of the layer and add their samples.
+      void layerExtracted ();
+
+      /**
+       * \brief Show progress of data export.
+       * \param percent Percentage of samples written.
+       */
+      void exportProgress (int percent);
+
+      /// \brief Tell data have been exported.
+      void dataExported ();
+
+      /**
+       * \brief Show progress of data gridding.
+       * \param percent Percentage done.
+       */
+      void gridProgress (int percent);
+
+      /// \brief Tell data have been gridded.
+      void dataGridded ();
+
+    private:
       /// \brief String indicating operation complete.
       const QString done = tr("Done.");
 
@@ -211,14 +345,57 @@ namespace GUI {
       /// \brief String for opening text files or any file.
       const QString textOrAny = tr("Text files (*.txt);;All files (*)");
 
-      /// \brief Number of reference points required.
-      const size_t requiredReference = 3;
+      /// \brief String for opening data files.
+      const QString dataFiles = tr("Text files (*.txt);;"
+                                   "Binary data files (*.gdd);;"
+                                   "All files (*)");
+
+      /// \brief String for exporting data.
+      const QString exportFiles = tr("GeoJSON files (*.geojson *.json);;"
+                                     "CSV files (*.csv);;"
+                                     "Shapefiles (*.shp)");
+
+      /// \brief String for writing grids.
+      const QString gridFiles = tr("GeoTIFF files (*.tif *.tiff)");
+
+      /// \brief Distance within which a click hits a sample, in screen pixels.
+      static const int hitDistance = 8;
+
+      /**
+       * \brief Greatest difference of a colour component between an isobath
+       * and its pixels.
+       */
+      static const int traceTolerance = 40;
+
+      /**
+       * \brief Smallest connected part of a layer extracted, in pixels:
+       * smaller ones are mostly labels and noise.
+       */
+      static const std::size_t extractMinimum = 200;
+
+      /// \brief Distance between samples of isobaths traced, proposed first.
+      static const int defaultSpacing = 10;
+
+      /**
+       * \brief Greatest distance of samples weighted by inverse distance
+       * weighting, in cells of the grid.
+       */
+      static const int gridRadius = 16;
+
+      /// \brief Minimum number of reference points required.
+      const size_t requiredReference = AffineFit::minimumPoints;
 
-      /// \brief Matrix to compute referential change.
+      /**
+       * \brief Matrix to compute referential change, from the image to the
+       * plane of the map projection.
+       */
       Eigen::Matrix<double, 2, 3> change;
 
-      /// \brief List of reference points.
-      ReferencePointListType referencePointList;
+      /// \brief Map projection, null for geographical coordinates.
+      MapProjectionPointer mapProjection;
+
+      /// \brief Reference points and the fit they define.
+      ReferencePoints referencePoints;
 
       /// \brief Image scale factor.
       double scaleFactor;
@@ -235,11 +412,26 @@ namespace GUI {
       /// \brief Name of the file containing reference points.
       QString referencePointFileName;
 
-      /// \brief Data to be stored.
-      QString data;
+      /// \brief Data set by the user, journaled on disk.
+      Data::Journal journal;
+
+      /// \brief Index of data, to find them by position or value.
+      Data::SampleIndex sampleIndex;
+
+      /// \brief Widget displaying the image.
+      ImageView* imageView;
+
+      /// \brief Thread loading the image, null when not loading.
+      ImageLoader* loader;
+
+      /// \brief Name of the image file being loaded.
+      QString loadedFileName;
+
+      /// \brief Session of the image, kept when another one is opened.
+      Session session;
 
-      /// \brief Label for image manipulation.
-      QLabel* imageLabel;
+      /// \brief Position of scroll bars restored, once the image is sized.
+      QPoint restoredScroll;
 
       /// \brief Allows to scroll in the image.
       QScrollArea* scrollArea;
@@ -247,9 +439,6 @@ namespace GUI {
       /// \brief Get the GUI description.
       Ui::MainBoard ui;
 
-      /// \brief Number of given reference points.
-      size_t numberReferencePoints;
-
       /// \brief Whether or not the world file exists.
       bool worldExists;
 
@@ -262,47 +451,240 @@ namespace GUI {
       /// \brief Whether or not being sampling an isobath.
       bool sampling;
 
+      /// \brief Whether or not being editing geo-referenced data.
+      bool editing;
+
+      /// \brief Index of the data selected while editing, if any.
+      std::size_t selected;
+
+      /// \brief Whether or not being tracing isobaths.
+      bool tracing;
+
+      /// \brief Distance between samples of isobaths traced, in pixels.
+      int traceSpacing;
+
+      /// \brief Thread tracing an isobath, null when not tracing.
+      TraceThread* tracer;
+
+      /// \brief Thread extracting a layer, null when not extracting.
+      ExtractThread* extractor;
+
+      /// \brief Thread exporting data, null when not exporting.
+      ExportThread* exporter;
+
+      /// \brief Thread gridding data, null when not gridding.
+      GridThread* gridThread;
+
+      /**
+       * \brief Extract every line of the colour clicked, as the isobath
+       * being traced.
+       * \param pos Position clicked, in image coordinates.
+       */
+      void extractLayer (const Point2D &pos);
+
+      /**
+       * \brief Describe why tracing stopped.
+       * \param end Why tracing stopped.
+       */
+      QString describe (LineTracer::End end) const {
+        switch (end) {
+          case LineTracer::gap: return tr("at a gap");
+          case LineTracer::junction: return tr("at a junction");
+          case LineTracer::border: return tr("at the border");
+          case LineTracer::closed: return tr("on a closed line");
+          case LineTracer::limit: return tr("after too many points");
+          default: return tr("when interrupted");
+        }
+      }
+
       /**
        * \brief Actually load world file.
        * \param fileName Name of the world file.
        */
       void loadWorldFile (const QString &fileName) {
-        /* The world file itself. */
-        QFile worldFile (fileName);
-        if (worldFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-          /* Stream on the file. */
-          QTextStream worldFileStream (&worldFile);
-          worldFileStream >> change(0, 0) >> change(1, 0) >> change(0, 1)
-                          >> change(1, 1) >> change(0, 2) >> change(1, 2);
-          worldFile.close();
+        GEODESK_TIME("MainBoard::loadWorldFile");
+        try {
+          change = readWorldFile(std::string(QFile::encodeName(fileName)
+                                               .constData()));
           worldExists = true;
+          updateOverlay();
           ui.statusbar->showMessage(geoOk);
           ui.actionSaveWorldFile->setEnabled(false);
           ui.actionSetData->setEnabled(true);
           ui.actionSampleIsobath->setEnabled(true);
+          ui.actionEditData->setEnabled(true);
+          ui.actionTraceIsobath->setEnabled(true);
         }
-        else {
+        catch (const std::runtime_error &error) {
           QMessageBox::critical(this, tr("Error"),
-                                tr("World file cannot be opened."));
+                                tr("World file cannot be read. "
+                                   "%1").arg(error.what()));
+        }
+      }
+
+      /**
+       * \brief Read the geo-reference stored in a GeoTIFF image.
+       * \param fileName Name of the image file.
+       * \return Whether or not the image has a geo-reference.
+       */
+      bool loadGeoTiff (const QString &fileName);
+
+      /// \brief Save the state of the work on the image in its session.
+      void saveSession ();
+
+      /**
+       * \brief Restore the state of the work on the image from its session.
+       * \return Whether or not a state has been restored.
+       */
+      bool restoreSession ();
+
+      /**
+       * \brief Update referential change from reference points.
+       * \return Whether or not the referential change could be computed.
+       */
+      bool updateFit () {
+        if (!referencePoints.fit().enough()) return false;
+        try {
+          change = referencePoints.change();
         }
+        catch (const std::domain_error &) {
+          return false;
+        }
+        worldExists = true;
+        ui.actionSaveWorldFile->setEnabled(true);
+        ui.actionSetData->setEnabled(true);
+        ui.actionSampleIsobath->setEnabled(true);
+        ui.actionEditData->setEnabled(true);
+        ui.actionTraceIsobath->setEnabled(true);
+        return true;
+      }
+
+      /**
+       * \brief Draw samples and reference points over the image.
+       *
+       * Samples are placed from their geographical coordinates when the
+       * image is geo-referenced, from their image coordinates otherwise.
+       */
+      void updateOverlay () {
+        imageView->setSamples(journal.samples(), worldExists? &change: 0,
+                              mapProjection.get());
+        imageView->setReferencePoints(referencePoints.points());
+      }
+
+      /// \brief Index data again, after they have been replaced or removed.
+      void updateIndex () {
+        sampleIndex.assign(journal.samples());
+        selected = Data::SampleIndex::none;
+        imageView->clearSelection();
+      }
+
+      /**
+       * \brief Position where data are drawn over the image.
+       * \param sample The data.
+       * \return Position in the image.
+       */
+      Point2D samplePosition (const Data::Sample &sample) const {
+        if (!worldExists) return Point2D (sample.x, sample.y);
+        /* Abscissa in the image. */
+        double x = sample.longitude;
+        /* Ordinate in the image. */
+        double y = sample.latitude;
+        try {
+          geographicToImage(change, mapProjection.get(), &x, &y, &x, &y, 1);
+        }
+        catch (const std::domain_error &) {
+          return Point2D (sample.x, sample.y);
+        }
+        return Point2D (x, y);
+      }
+
+      /**
+       * \brief Geographical coordinates of a point of the image.
+       * \param pos Position in the image.
+       */
+      Point2D toGeographic (const Point2D &pos) const {
+        /* Abscissa, then longitude. */
+        double x = pos.x();
+        /* Ordinate, then latitude. */
+        double y = pos.y();
+        imageToGeographic(change, mapProjection.get(), &x, &y, &x, &y, 1);
+        return Point2D (x, y);
+      }
+
+      /**
+       * \brief Replace data set by the user.
+       * \param index Index of the data.
+       * \param sample The new data.
+       * \return Whether or not data have been replaced.
+       */
+      bool replaceData (std::size_t index, const Data::Sample &sample) {
+        /* Data before being replaced. */
+        const Data::Sample previous = journal.samples()[index];
+        try {
+          journal.replace(index, sample);
+        }
+        catch (const std::runtime_error &) {
+          QMessageBox::critical(this, tr("Error"),
+                                tr("Data cannot be journaled."));
+          return false;
+        }
+        sampleIndex.replace(index, previous, sample);
+        ui.actionSaveDataFile->setEnabled(true);
+        ui.actionSaveDataFileAs->setEnabled(true);
+        return true;
+      }
+
+      /**
+       * \brief Edit data under the mouse.
+       * \param event The event that indicates mouse button is clicked.
+       */
+      void editData (QMouseEvent* event);
+
+      /// \brief Update referential change while referencing and show progress.
+      void updateReferencing () {
+        if (updateFit()) {
+          ui.statusbar->showMessage(
+            tr("Referencing: %1 points, RMS %2.")
+              .arg(referencePoints.size())
+              .arg(referencePoints.fit().rms()));
+        }
+        else {
+          ui.statusbar->showMessage(
+            tr("Referencing: point %1 / %2")
+              .arg(referencePoints.size() + 1).arg(requiredReference));
+        }
+        updateOverlay();
       }
 
       /// \brief Actually save data file.
       void saveDataFile () {
         if (!dataFileName.isEmpty()) {
-          /* Data file itself. */
-          QFile dataFile (dataFileName);
-          if (dataFile.open(QIODevice::WriteOnly | QIODevice::Text |
-                            QIODevice::Truncate)) {
-              /* Stream on the data file. */
-              QTextStream dataFileStream (&dataFile);
-              dataFileStream << data;
-              dataFile.close();
+          /* Name of the file, as known by the system. */
+          const std::string name = QFile::encodeName(dataFileName).constData();
+          /*
+           * Quantization of binary files: thousandth of pixel, about one
+           * centimeter on the ground and one millimeter for values.
+           */
+          const Data::Steps steps = {{1e-3, 1e-3, 1e-7, 1e-7, 1e-3}};
+          /*
+           * Binary files keep referential changes to geographical
+           * coordinates only.
+           */
+          const bool keepChange = worldExists && !mapProjection;
+          GEODESK_TIME("MainBoard::saveDataFile");
+          try {
+            if (dataFileName.endsWith(Data::binaryExtension,
+                                      Qt::CaseInsensitive))
+              journal.saveBinary(name, steps, keepChange? &change: 0);
+            else
+              journal.save(name);
           }
-          else {
+          catch (const std::runtime_error &) {
             QMessageBox::critical(this, tr("Error"),
                                   tr("File named \"%1\" cannot "
-                                     "be opened.").arg(dataFileName));
+                                     "be written.").arg(dataFileName));
+            ui.statusbar->showMessage(aborted);
+            return;
           }
           ui.statusbar->showMessage(done);
         }
@@ -311,32 +693,42 @@ namespace GUI {
         }
       }
 
+      /**
+       * \brief Add data set by the user.
+       * \param sample The data.
+       */
+      void appendData (const Data::Sample &sample) {
+        GEODESK_TIME("MainBoard::appendData");
+        GEODESK_COUNT("samples recorded", 1);
+        try {
+          journal.append(sample);
+        }
+        catch (const std::runtime_error &) {
+          QMessageBox::critical(this, tr("Error"),
+                                tr("Data cannot be journaled."));
+          return;
+        }
+        sampleIndex.add(sample);
+        imageView->addSample(Point2D (sample.x, sample.y));
+        ui.actionSaveDataFile->setEnabled(true);
+        ui.actionSaveDataFileAs->setEnabled(true);
+        ui.actionChangeValues->setEnabled(true);
+      }
+
       /// \brief Actually save reference points.
       void saveReferencePointFile () {
         if (!referencePointFileName.isEmpty()) {
-          /* File containing reference points. */
-          QFile referencePointFile (referencePointFileName);
-          if (referencePointFile.open(QIODevice::WriteOnly | QIODevice::Text
-                                      | QIODevice::Truncate)) {
-            /* Stream on the file. */
-            QTextStream referencePointFileStream (&referencePointFile);
-
-            for (ReferencePointListType::iterator point =
-                   referencePointList.begin();
-                 point != referencePointList.end(); ++point)
-              referencePointFileStream << point->first.x() << ' '
-                                       << point->first.y() << ' '
-                                       << point->second.x() << ' '
-                                       << point->second.y() << '\n';
-
-            referencePointFile.close();
+          GEODESK_TIME("MainBoard::saveReferencePoints");
+          try {
+            referencePoints.write(QFile::encodeName(referencePointFileName)
+                                    .constData());
             ui.actionSaveReferencePoints->setEnabled(false);
             ui.actionSaveReferencePointsAs->setEnabled(false);
           }
-          else {
+          catch (const std::runtime_error &) {
             QMessageBox::critical(this, tr("Error"),
-                                  tr("File named \"%1\" cannot "
-                                     "be opened.").arg(dataFileName));
+                                  tr("File named \"%1\" cannot be "
+                                     "opened.").arg(referencePointFileName));
           }
           ui.statusbar->showMessage(done);
         }
@@ -357,9 +749,10 @@ namespace GUI {
 
       /// \brief Change scale of an image.
       void scaleImage (double factor) {
-        Q_ASSERT(imageLabel->pixmap());
+        GEODESK_TIME("MainBoard::scaleImage");
+        Q_ASSERT(!imageView->isEmpty());
         scaleFactor *= factor;
-        imageLabel->resize(scaleFactor * imageLabel->pixmap()->size());
+        imageView->setScale(scaleFactor);
 
         adjustScrollBar(scrollArea->horizontalScrollBar(), factor);
         adjustScrollBar(scrollArea->verticalScrollBar(), factor);
@@ -375,53 +768,8 @@ namespace GUI {
        * clicked.
        */
       Point2D getMousePosition (const QPoint &pos) {
-        /* Minimum of horizontal scroll bar. */
-        const double horizontalMinimum =
-          static_cast<double>(scrollArea->horizontalScrollBar()->minimum());
-        /* Maximum of horizontal scroll bar. */
-        const double horizontalMaximum =
-          static_cast<double>(scrollArea->horizontalScrollBar()->maximum());
-        /* Minimum of vertical scroll bar. */
-        const double verticalMinimum =
-          static_cast<double>(scrollArea->verticalScrollBar()->minimum());
-        /* Maximum of vertical scroll bar. */
-        const double verticalMaximum =
-          static_cast<double>(scrollArea->verticalScrollBar()->maximum());
-        /* Quantity of pixel not shown according horizontal orientation. */
-        const double horizontalRemaining =
-          std::max((imageLabel->pixmap()->width() * scaleFactor)
-                   - imageLabel->width(), 0.);
-        /* Quantity of pixel not shown according vertical orientation. */
-        const double verticalRemaining =
-          std::max((imageLabel->pixmap()->height() * scaleFactor)
-                   - imageLabel->height(), 0.);
-        /* How much horizontally scrolled. */
-        const double horizontalPercentage =
-          (horizontalMaximum > horizontalMinimum)?
-            (static_cast<double>(scrollArea->horizontalScrollBar()->value())
-             - horizontalMinimum)
-            / (horizontalMaximum - horizontalMinimum): 0. ;
-        /* How much vertically scrolled. */
-        const double verticalPercentage =
-          (verticalMaximum > verticalMinimum)?
-            (static_cast<double>(scrollArea->verticalScrollBar()->value())
-             - verticalMinimum)
-            / (verticalMaximum - verticalMinimum): 0. ;
-        /* Localisation where clicked in the frame. */
-        const QPoint localisation =
-          pos - imageLabel->pos() - scrollArea->pos();
-        /* Abscissa of the point clicked in the image. */
-        const double x =
-          (static_cast<double>(localisation.x())
-            + (horizontalRemaining * horizontalPercentage))
-           / scaleFactor;
-        /* Ordinate of the point clicked in the image. */
-        const double y =
-          (static_cast<double>(localisation.y())
-            + (verticalRemaining * verticalPercentage))
-           / scaleFactor;
-
-        return Point2D (x, y);
+        GEODESK_TIME("MainBoard::getMousePosition");
+        return imageView->toImage(imageView->mapFrom(this, pos));
       }
   };
 }
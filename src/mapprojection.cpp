@@ -0,0 +1,178 @@
+/**
+ * \file mapprojection.cpp
+ * \brief Implementation of map projections built at run time.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "mapprojection.hpp"
+
+namespace {
+  /**
+   * \brief Exception telling a description of projection is invalid.
+   * \param description The description.
+   * \param reason Why it is invalid.
+   */
+  std::runtime_error invalid (const std::string &description,
+                              const std::string &reason) {
+    return std::runtime_error("Projection \"" + description + "\": "
+                              + reason);
+  }
+
+  /**
+   * \brief Split a description into fields separated by colons.
+   * \param text The description, without the ellipsoid.
+   */
+  std::vector<std::string> split (const std::string &text) {
+    /* Fields found. */
+    std::vector<std::string> fields;
+    /* Stream on the description. */
+    std::istringstream stream (text);
+    /* Current field. */
+    std::string field;
+    while (std::getline(stream, field, ':')) fields.push_back(field);
+    return fields;
+  }
+
+  /**
+   * \brief Convert a field into a number.
+   * \param description The whole description, for error messages.
+   * \param field The field.
+   * \exception std::runtime_error The field is not a number.
+   */
+  double number (const std::string &description, const std::string &field) {
+    /* Where conversion stopped. */
+    char* end = 0;
+    /* The number. */
+    const double result = std::strtod(field.c_str(), &end);
+    if (field.empty() || *end != '\0')
+      throw invalid(description, "\"" + field + "\" is not a number.");
+    return result;
+  }
+
+  /**
+   * \brief Build a projection on a given ellipsoid.
+   * \tparam Ellipsoid The ellipsoid.
+   * \param description The whole description.
+   * \param fields Fields of the description, the ellipsoid excepted, in
+   * lower case.
+   * \exception std::runtime_error The description is invalid.
+   */
+  template <class Ellipsoid>
+  Projection::MapProjectionPointer
+  build (const std::string &description,
+         const std::vector<std::string> &fields) {
+    /* Name of the projection. */
+    const std::string &name = fields[0];
+    /* Numerical parameters. */
+    std::vector<double> p;
+    if (name != "utm")
+      for (std::size_t i = 1; i < fields.size(); ++i)
+        p.push_back(number(description, fields[i]));
+
+    if (name == "mercator") {
+      if (p.size() > 2)
+        throw invalid(description, "too many parameters.");
+      p.resize(2, 0.);
+      return std::make_shared<Projection::KernelProjection<
+        Projection::Mercator<Ellipsoid> > >
+        (description, Projection::Mercator<Ellipsoid> (p[0], p[1]));
+    }
+    if (name == "utm") {
+      if (fields.size() != 2 || fields[1].size() < 2)
+        throw invalid(description, "zone expected, as \"31n\".");
+      /* Hemisphere of the zone. */
+      const char hemisphere = fields[1][fields[1].size() - 1];
+      /* Number of the zone. */
+      const double zone =
+        number(description, fields[1].substr(0, fields[1].size() - 1));
+      if ((hemisphere != 'n' && hemisphere != 's') || zone < 1.
+          || zone > 60. || zone != std::floor(zone))
+        throw invalid(description, "zone expected, as \"31n\".");
+      return std::make_shared<Projection::KernelProjection<
+        Projection::TransverseMercator<Ellipsoid> > >
+        (description,
+         Projection::TransverseMercator<Ellipsoid> (6. * zone - 183., .9996,
+                                                    500000.,
+                                                    hemisphere == 's'?
+                                                    10000000.: 0.));
+    }
+    if (name == "tm") {
+      if (p.size() != 2 && p.size() != 4)
+        throw invalid(description, "2 or 4 parameters expected.");
+      p.resize(4, 0.);
+      return std::make_shared<Projection::KernelProjection<
+        Projection::TransverseMercator<Ellipsoid> > >
+        (description,
+         Projection::TransverseMercator<Ellipsoid> (p[0], p[1], p[2], p[3]));
+    }
+    if (name == "lambert") {
+      if (p.size() != 4 && p.size() != 6)
+        throw invalid(description, "4 or 6 parameters expected.");
+      p.resize(6, 0.);
+      try {
+        return std::make_shared<Projection::KernelProjection<
+          Projection::LambertConformalConic<Ellipsoid> > >
+          (description,
+           Projection::LambertConformalConic<Ellipsoid> (p[0], p[1], p[2],
+                                                         p[3], p[4], p[5]));
+      }
+      catch (const std::domain_error &error) {
+        throw invalid(description, error.what());
+      }
+    }
+    if (name == "lambert93") {
+      if (!p.empty()) throw invalid(description, "no parameter expected.");
+      return std::make_shared<Projection::KernelProjection<
+        Projection::LambertConformalConic<Ellipsoid> > >
+        (description,
+         Projection::LambertConformalConic<Ellipsoid> (44., 49., 46.5, 3.,
+                                                       700000., 6600000.));
+    }
+    throw invalid(description, "unknown projection \"" + name + "\".");
+  }
+}
+
+/* -- Build a map projection from its description. ------------------------ */
+Projection::MapProjectionPointer
+Projection::makeProjection (const std::string &description) {
+  /* Description in lower case. */
+  std::string text = description;
+  std::transform(text.begin(), text.end(), text.begin(),
+                 [] (char c) {
+                   return static_cast<char>(std::tolower(
+                     static_cast<unsigned char>(c)));
+                 });
+  /* Position of the ellipsoid. */
+  const std::size_t at = text.find('@');
+  /* Name of the ellipsoid, empty for the default one. */
+  const std::string ellipsoid = at == std::string::npos? std::string ():
+    text.substr(at + 1);
+  /* Fields of the projection. */
+  const std::vector<std::string> fields = split(text.substr(0, at));
+  if (fields.empty() || fields[0].empty())
+    throw invalid(description, "no projection given.");
+
+  if (fields[0] == "geographic") {
+    if (fields.size() > 1 || at != std::string::npos)
+      throw invalid(description, "no parameter expected.");
+    return MapProjectionPointer ();
+  }
+  if (ellipsoid == "wgs84"
+      || (ellipsoid.empty() && fields[0] != "lambert93"))
+    return build<WGS84>(description, fields);
+  if (ellipsoid == "grs80" || ellipsoid.empty())
+    return build<GRS80>(description, fields);
+  if (ellipsoid == "clarke1866")
+    return build<Clarke1866>(description, fields);
+  if (ellipsoid == "international1924")
+    return build<International1924>(description, fields);
+  throw invalid(description, "unknown ellipsoid \"" + ellipsoid + "\".");
+}
@@ -0,0 +1,742 @@
+#ifndef MAPPROJECTION_HPP
+#define MAPPROJECTION_HPP
+
+/**
+ * \file mapprojection.hpp
+ * \brief Map projections, converting geographical coordinates into plane
+ * coordinates, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+#include "projection.hpp"
+
+/// \brief Namespace for projection computations.
+namespace Projection {
+  /// \brief WGS 84 ellipsoid, used by GPS.
+  struct WGS84 {
+    /// \brief Semi-major axis, in meters.
+    static constexpr double semiMajorAxis = 6378137.;
+
+    /// \brief Inverse of the flattening.
+    static constexpr double inverseFlattening = 298.257223563;
+  };
+
+  /// \brief GRS 80 ellipsoid, used by ETRS 89 and NAD 83.
+  struct GRS80 {
+    /// \brief Semi-major axis, in meters.
+    static constexpr double semiMajorAxis = 6378137.;
+
+    /// \brief Inverse of the flattening.
+    static constexpr double inverseFlattening = 298.257222101;
+  };
+
+  /// \brief Clarke 1866 ellipsoid, used by NAD 27.
+  struct Clarke1866 {
+    /// \brief Semi-major axis, in meters.
+    static constexpr double semiMajorAxis = 6378206.4;
+
+    /// \brief Inverse of the flattening.
+    static constexpr double inverseFlattening = 294.978698214;
+  };
+
+  /// \brief International 1924 ellipsoid, used by ED 50.
+  struct International1924 {
+    /// \brief Semi-major axis, in meters.
+    static constexpr double semiMajorAxis = 6378388.;
+
+    /// \brief Inverse of the flattening.
+    static constexpr double inverseFlattening = 297.;
+  };
+
+  /**
+   * \brief Constants derived from an ellipsoid, computed at compile time.
+   * \tparam Ellipsoid The ellipsoid, providing its semi-major axis and the
+   * inverse of its flattening.
+   */
+  template <class Ellipsoid>
+  struct EllipsoidConstants {
+    /// \brief Semi-major axis, in meters.
+    static constexpr double a = Ellipsoid::semiMajorAxis;
+
+    /// \brief Flattening.
+    static constexpr double f = 1. / Ellipsoid::inverseFlattening;
+
+    /// \brief Square of the eccentricity.
+    static constexpr double e2 = f * (2. - f);
+
+    /// \brief Third flattening.
+    static constexpr double n = f / (2. - f);
+  };
+
+  /**
+   * \brief Convert an angle from degrees to radians.
+   * \param angle The angle, in degrees.
+   */
+  inline double radians (double angle) {
+    return angle * (3.14159265358979323846 / 180.);
+  }
+
+  /**
+   * \brief Convert an angle from radians to degrees.
+   * \param angle The angle, in radians.
+   */
+  inline double degrees (double angle) {
+    return angle * (180. / 3.14159265358979323846);
+  }
+
+  /**
+   * \brief Tangent of the conformal latitude.
+   * \param tau Tangent of the latitude.
+   * \param e Eccentricity.
+   *
+   * The conformal latitude is the latitude on the sphere onto which the
+   * ellipsoid is mapped conformally, which all projections here rely on.
+   */
+  inline double conformalTangent (double tau, double e) {
+    /* Secant of the latitude. */
+    const double secant = std::sqrt(1. + tau * tau);
+    /* Hyperbolic sine of the eccentricity term. */
+    const double sigma = std::sinh(e * std::atanh(e * tau / secant));
+    return tau * std::sqrt(1. + sigma * sigma) - sigma * secant;
+  }
+
+  /**
+   * \brief Tangent of the latitude from the one of the conformal latitude.
+   * \param taup Tangent of the conformal latitude.
+   * \param e Eccentricity.
+   *
+   * Newton's method converges to the double precision in two or three
+   * iterations.
+   */
+  inline double geodeticTangent (double taup, double e) {
+    /* One minus the square of the eccentricity. */
+    const double e2m = 1. - e * e;
+    /* Current tangent of the latitude. */
+    double tau = taup / e2m;
+    for (int i = 0; i < 5; ++i) {
+      /* Conformal tangent of the current latitude. */
+      const double current = conformalTangent(tau, e);
+      /* Correction of the tangent. */
+      const double delta = (taup - current)
+        * (1. + e2m * tau * tau)
+        / (e2m * std::sqrt(1. + tau * tau)
+           * std::sqrt(1. + current * current));
+      tau += delta;
+      if (!(std::abs(delta) >= 1e-14 * std::max(1., std::abs(tau)))) break;
+    }
+    return tau;
+  }
+
+  /**
+   * \brief Mercator projection on an ellipsoid.
+   * \tparam Ellipsoid The ellipsoid.
+   */
+  template <class Ellipsoid>
+  class Mercator {
+    public:
+      /**
+       * \brief Construct the projection.
+       * \param latitudeOfTrueScale Latitude where the scale is true, in
+       * degrees.
+       * \param centralMeridian Longitude of the origin, in degrees.
+       */
+      Mercator (double latitudeOfTrueScale, double centralMeridian):
+        e (std::sqrt(C::e2)), lambda0 (radians(centralMeridian)) {
+        /* Sine of the latitude of true scale. */
+        const double s = std::sin(radians(latitudeOfTrueScale));
+        k = C::a * std::cos(radians(latitudeOfTrueScale))
+          / std::sqrt(1. - C::e2 * s * s);
+      }
+
+      /**
+       * \brief Project a point.
+       * \param longitude Longitude, in degrees.
+       * \param latitude Latitude, in degrees.
+       * \param x Where to store the easting, in meters.
+       * \param y Where to store the northing, in meters.
+       *
+       * Poles are at an infinite northing: both coordinates are then NaN.
+       */
+      void forward (double longitude, double latitude, double &x,
+                    double &y) const {
+        if (!(std::abs(latitude) < 90.)) {
+          x = y = std::numeric_limits<double>::quiet_NaN();
+          return;
+        }
+        x = k * (radians(longitude) - lambda0);
+        y = k * std::asinh(conformalTangent(std::tan(radians(latitude)), e));
+      }
+
+      /**
+       * \brief Convert a projected point back.
+       * \param x Easting, in meters.
+       * \param y Northing, in meters.
+       * \param longitude Where to store the longitude, in degrees.
+       * \param latitude Where to store the latitude, in degrees.
+       */
+      void inverse (double x, double y, double &longitude,
+                    double &latitude) const {
+        longitude = degrees(x / k + lambda0);
+        latitude = degrees(std::atan(geodeticTangent(std::sinh(y / k), e)));
+      }
+
+    private:
+      /// \brief Constants of the ellipsoid.
+      typedef EllipsoidConstants<Ellipsoid> C;
+
+      /// \brief Eccentricity.
+      double e;
+
+      /// \brief Longitude of the origin, in radians.
+      double lambda0;
+
+      /// \brief Radius of the parallel of true scale, in meters.
+      double k;
+  };
+
+  /**
+   * \brief Transverse Mercator projection on an ellipsoid, of which UTM is
+   * a particular case.
+   * \tparam Ellipsoid The ellipsoid.
+   *
+   * Krüger's series are used to sixth order in the third flattening, as
+   * given by Karney (2011), which is accurate to a few nanometers within
+   * 4000 km of the central meridian.
+   */
+  template <class Ellipsoid>
+  class TransverseMercator {
+    public:
+      /**
+       * \brief Construct the projection.
+       * \param centralMeridian Longitude of the central meridian, in
+       * degrees.
+       * \param scale Scale factor on the central meridian.
+       * \param falseEasting Easting of the central meridian, in meters.
+       * \param falseNorthing Northing of the equator, in meters.
+       */
+      TransverseMercator (double centralMeridian, double scale,
+                          double falseEasting, double falseNorthing):
+        e (std::sqrt(C::e2)), lambda0 (radians(centralMeridian)),
+        k (scale * rectifyingRadius), x0 (falseEasting), y0 (falseNorthing)
+      {}
+
+      /**
+       * \brief Project a point.
+       * \param longitude Longitude, in degrees.
+       * \param latitude Latitude, in degrees.
+       * \param x Where to store the easting, in meters.
+       * \param y Where to store the northing, in meters.
+       */
+      void forward (double longitude, double latitude, double &x,
+                    double &y) const {
+        /* Longitude from the central meridian. */
+        const double lambda = radians(longitude) - lambda0;
+        /* Tangent of the conformal latitude. */
+        const double taup = conformalTangent(std::tan(radians(latitude)), e);
+        /* Cosine of the longitude. */
+        const double c = std::cos(lambda);
+        /* Northing on the sphere. */
+        const double xip = std::atan2(taup, c);
+        /* Easting on the sphere. */
+        const double etap = std::asinh(std::sin(lambda)
+                                       / std::sqrt(taup * taup + c * c));
+        /* Northing on the ellipsoid. */
+        double xi;
+        /* Easting on the ellipsoid. */
+        double eta;
+        series(alpha, xip, etap, 1., xi, eta);
+        x = x0 + k * eta;
+        y = y0 + k * xi;
+      }
+
+      /**
+       * \brief Convert a projected point back.
+       * \param x Easting, in meters.
+       * \param y Northing, in meters.
+       * \param longitude Where to store the longitude, in degrees.
+       * \param latitude Where to store the latitude, in degrees.
+       */
+      void inverse (double x, double y, double &longitude,
+                    double &latitude) const {
+        /* Northing on the ellipsoid. */
+        const double xi = (y - y0) / k;
+        /* Easting on the ellipsoid. */
+        const double eta = (x - x0) / k;
+        /* Northing on the sphere. */
+        double xip;
+        /* Easting on the sphere. */
+        double etap;
+        series(beta, xi, eta, -1., xip, etap);
+        /* Hyperbolic sine of the spherical easting. */
+        const double s = std::sinh(etap);
+        /* Cosine of the spherical northing. */
+        const double c = std::cos(xip);
+        /* Tangent of the conformal latitude. */
+        const double taup = std::sin(xip) / std::sqrt(s * s + c * c);
+        longitude = degrees(lambda0 + std::atan2(s, c));
+        latitude = degrees(std::atan(geodeticTangent(taup, e)));
+      }
+
+    private:
+      /// \brief Constants of the ellipsoid.
+      typedef EllipsoidConstants<Ellipsoid> C;
+
+      /// \brief Order of the series.
+      static const int order = 6;
+
+      /// \brief Third flattening.
+      static constexpr double n = C::n;
+
+      /// \brief Radius of the sphere with the same meridian length.
+      static constexpr double rectifyingRadius =
+        C::a / (1. + n) * (1. + n * n / 4. + n * n * n * n / 64.
+                           + n * n * n * n * n * n / 256.);
+
+      /// \brief Coefficients of the forward series.
+      static constexpr double alpha [order] = {
+        n * (1. / 2. + n * (-2. / 3. + n * (5. / 16. + n * (41. / 180.
+          + n * (-127. / 288. + n * 7891. / 37800.))))),
+        n * n * (13. / 48. + n * (-3. / 5. + n * (557. / 1440.
+          + n * (281. / 630. - n * 1983433. / 1935360.)))),
+        n * n * n * (61. / 240. + n * (-103. / 140. + n * (15061. / 26880.
+          + n * 167603. / 181440.))),
+        n * n * n * n * (49561. / 161280. + n * (-179. / 168.
+          + n * 6601661. / 7257600.)),
+        n * n * n * n * n * (34729. / 80640. - n * 3418889. / 1995840.),
+        n * n * n * n * n * n * 212378941. / 319334400.
+      };
+
+      /// \brief Coefficients of the inverse series.
+      static constexpr double beta [order] = {
+        n * (1. / 2. + n * (-2. / 3. + n * (37. / 96. + n * (-1. / 360.
+          + n * (-81. / 512. + n * 96199. / 604800.))))),
+        n * n * (1. / 48. + n * (1. / 15. + n * (-437. / 1440.
+          + n * (46. / 105. - n * 1118711. / 3870720.)))),
+        n * n * n * (17. / 480. + n * (-37. / 840. + n * (-209. / 4480.
+          + n * 5569. / 90720.))),
+        n * n * n * n * (4397. / 161280. + n * (-11. / 504.
+          - n * 830251. / 7257600.)),
+        n * n * n * n * n * (4583. / 161280. - n * 108847. / 3991680.),
+        n * n * n * n * n * n * 20648693. / 638668800.
+      };
+
+      /**
+       * \brief Add a series of sines to a complex coordinate.
+       * \param c Coefficients of the series.
+       * \param xi Real part of the coordinate.
+       * \param eta Imaginary part of the coordinate.
+       * \param sign 1 to add the series, -1 to subtract it.
+       * \param u Where to store the real part of the result.
+       * \param v Where to store the imaginary part of the result.
+       *
+       * The sum of c[j] sin(2 (j + 1) (xi + i eta)) is computed with
+       * Clenshaw's recurrence, which needs a single evaluation of
+       * trigonometric and hyperbolic functions.
+       */
+      static void series (const double* c, double xi, double eta,
+                          double sign, double &u, double &v) {
+        /* Sine of twice the real part. */
+        const double s2 = std::sin(2. * xi);
+        /* Cosine of twice the real part. */
+        const double c2 = std::cos(2. * xi);
+        /* Hyperbolic sine of twice the imaginary part. */
+        const double sh2 = std::sinh(2. * eta);
+        /* Hyperbolic cosine of twice the imaginary part. */
+        const double ch2 = std::cosh(2. * eta);
+        /* Real part of twice the cosine of twice the coordinate. */
+        const double ar = 2. * c2 * ch2;
+        /* Imaginary part of twice the cosine of twice the coordinate. */
+        const double ai = -2. * s2 * sh2;
+        /* Real part of the current term of the recurrence. */
+        double yr1 = 0.;
+        /* Imaginary part of the current term of the recurrence. */
+        double yi1 = 0.;
+        /* Real part of the previous term of the recurrence. */
+        double yr2 = 0.;
+        /* Imaginary part of the previous term of the recurrence. */
+        double yi2 = 0.;
+        for (int j = order - 1; j >= 0; --j) {
+          /* Real part of the next term. */
+          const double yr0 = c[j] + ar * yr1 - ai * yi1 - yr2;
+          /* Imaginary part of the next term. */
+          const double yi0 = ar * yi1 + ai * yr1 - yi2;
+          yr2 = yr1;
+          yi2 = yi1;
+          yr1 = yr0;
+          yi1 = yi0;
+        }
+        /* Real part of the sine of twice the coordinate. */
+        const double sr = s2 * ch2;
+        /* Imaginary part of the sine of twice the coordinate. */
+        const double si = c2 * sh2;
+        u = xi + sign * (sr * yr1 - si * yi1);
+        v = eta + sign * (sr * yi1 + si * yr1);
+      }
+
+      /// \brief Eccentricity.
+      double e;
+
+      /// \brief Longitude of the central meridian, in radians.
+      double lambda0;
+
+      /// \brief Scale factor times the rectifying radius, in meters.
+      double k;
+
+      /// \brief False easting, in meters.
+      double x0;
+
+      /// \brief False northing, in meters.
+      double y0;
+  };
+
+  template <class Ellipsoid>
+  const int TransverseMercator<Ellipsoid>::order;
+
+  template <class Ellipsoid>
+  constexpr double TransverseMercator<Ellipsoid>::alpha [];
+
+  template <class Ellipsoid>
+  constexpr double TransverseMercator<Ellipsoid>::beta [];
+
+  /**
+   * \brief Lambert conformal conic projection on an ellipsoid, with two
+   * standard parallels, which may be the same.
+   * \tparam Ellipsoid The ellipsoid.
+   */
+  template <class Ellipsoid>
+  class LambertConformalConic {
+    public:
+      /**
+       * \brief Construct the projection.
+       * \param parallel1 First standard parallel, in degrees.
+       * \param parallel2 Second standard parallel, in degrees.
+       * \param originLatitude Latitude of the origin, in degrees.
+       * \param centralMeridian Longitude of the origin, in degrees.
+       * \param falseEasting Easting of the origin, in meters.
+       * \param falseNorthing Northing of the origin, in meters.
+       * \exception std::domain_error Standard parallels are opposite.
+       */
+      LambertConformalConic (double parallel1, double parallel2,
+                             double originLatitude, double centralMeridian,
+                             double falseEasting, double falseNorthing):
+        e (std::sqrt(C::e2)), lambda0 (radians(centralMeridian)),
+        x0 (falseEasting), y0 (falseNorthing) {
+        /* Isometric latitude of the first standard parallel. */
+        const double psi1 = isometric(parallel1);
+        /* Isometric latitude of the second standard parallel. */
+        const double psi2 = isometric(parallel2);
+        /* Logarithm of the radius of the first parallel. */
+        const double m1 = std::log(radius(parallel1));
+        if (std::abs(psi1 - psi2) > 1e-12)
+          cone = (m1 - std::log(radius(parallel2))) / (psi2 - psi1);
+        else
+          cone = std::sin(radians(parallel1));
+        if (!(std::abs(cone) > 1e-12))
+          throw std::domain_error("Standard parallels do not define a "
+                                  "cone.");
+        scale = std::exp(m1 + cone * psi1) / cone;
+        rho0 = scale * std::exp(-cone * isometric(originLatitude));
+      }
+
+      /**
+       * \brief Project a point.
+       * \param longitude Longitude, in degrees.
+       * \param latitude Latitude, in degrees.
+       * \param x Where to store the easting, in meters.
+       * \param y Where to store the northing, in meters.
+       */
+      void forward (double longitude, double latitude, double &x,
+                    double &y) const {
+        /* Distance to the apex of the cone. */
+        const double rho = scale * std::exp(-cone * isometric(latitude));
+        /* Angle around the apex. */
+        const double theta = cone * (radians(longitude) - lambda0);
+        x = x0 + rho * std::sin(theta);
+        y = y0 + rho0 - rho * std::cos(theta);
+      }
+
+      /**
+       * \brief Convert a projected point back.
+       * \param x Easting, in meters.
+       * \param y Northing, in meters.
+       * \param longitude Where to store the longitude, in degrees.
+       * \param latitude Where to store the latitude, in degrees.
+       */
+      void inverse (double x, double y, double &longitude,
+                    double &latitude) const {
+        /* Sign of the cone constant. */
+        const double sign = cone < 0.? -1.: 1.;
+        /* Abscissa from the apex. */
+        const double dx = sign * (x - x0);
+        /* Ordinate from the apex. */
+        const double dy = sign * (rho0 - (y - y0));
+        /* Distance to the apex. */
+        const double rho = std::sqrt(dx * dx + dy * dy);
+        /* Isometric latitude. */
+        const double psi = -std::log(rho / (sign * scale)) / cone;
+        longitude = degrees(std::atan2(dx, dy) / cone + lambda0);
+        latitude = degrees(std::atan(geodeticTangent(std::sinh(psi), e)));
+      }
+
+    private:
+      /// \brief Constants of the ellipsoid.
+      typedef EllipsoidConstants<Ellipsoid> C;
+
+      /// \brief Eccentricity.
+      double e;
+
+      /// \brief Longitude of the origin, in radians.
+      double lambda0;
+
+      /// \brief False easting, in meters.
+      double x0;
+
+      /// \brief False northing, in meters.
+      double y0;
+
+      /// \brief Cone constant.
+      double cone;
+
+      /// \brief Distance to the apex of the equator, in meters.
+      double scale;
+
+      /// \brief Distance to the apex of the origin, in meters.
+      double rho0;
+
+      /**
+       * \brief Isometric latitude.
+       * \param latitude Latitude, in degrees.
+       */
+      double isometric (double latitude) const {
+        return std::asinh(conformalTangent(std::tan(radians(latitude)), e));
+      }
+
+      /**
+       * \brief Radius of a parallel, in meters.
+       * \param latitude Latitude of the parallel, in degrees.
+       */
+      static double radius (double latitude) {
+        /* Sine of the latitude. */
+        const double s = std::sin(radians(latitude));
+        return C::a * std::cos(radians(latitude))
+          / std::sqrt(1. - C::e2 * s * s);
+      }
+  };
+
+  /**
+   * \brief Map projection chosen at run time.
+   *
+   * Points are converted by arrays, so that a single virtual call converts
+   * every point. Geographical coordinates are in decimal degrees, plane
+   * coordinates in meters.
+   */
+  class MapProjection {
+    public:
+      /**
+       * \brief Construct a projection.
+       * \param _name Description of the projection, as given to
+       * makeProjection().
+       */
+      explicit MapProjection (const std::string &_name): name_ (_name) {}
+
+      /// \brief Destructor.
+      virtual ~MapProjection () {}
+
+      /// \brief Description of the projection.
+      const std::string &name () const {return name_;}
+
+      /**
+       * \brief Project a set of points.
+       * \param longitude Longitudes of points to be projected.
+       * \param latitude Latitudes of points to be projected.
+       * \param x Where to store eastings.
+       * \param y Where to store northings.
+       * \param n Number of points.
+       *
+       * Output arrays may be the same as input arrays. Points which cannot
+       * be projected, such as poles in Mercator, get NaN coordinates.
+       */
+      virtual void forward (const double* longitude, const double* latitude,
+                            double* x, double* y, std::size_t n) const = 0;
+
+      /**
+       * \brief Convert a set of projected points back.
+       * \param x Eastings of points to be converted back.
+       * \param y Northings of points to be converted back.
+       * \param longitude Where to store longitudes.
+       * \param latitude Where to store latitudes.
+       * \param n Number of points.
+       *
+       * Output arrays may be the same as input arrays.
+       */
+      virtual void inverse (const double* x, const double* y,
+                            double* longitude, double* latitude,
+                            std::size_t n) const = 0;
+
+      /**
+       * \brief Project a single point.
+       * \param p Longitude and latitude.
+       * \return Easting and northing.
+       */
+      Point2D forwardPoint (const Point2D &p) const {
+        /* Longitude, then easting. */
+        double x = p.x();
+        /* Latitude, then northing. */
+        double y = p.y();
+        forward(&x, &y, &x, &y, 1);
+        return Point2D (x, y);
+      }
+
+      /**
+       * \brief Convert a single projected point back.
+       * \param p Easting and northing.
+       * \return Longitude and latitude.
+       */
+      Point2D inversePoint (const Point2D &p) const {
+        /* Easting, then longitude. */
+        double x = p.x();
+        /* Northing, then latitude. */
+        double y = p.y();
+        inverse(&x, &y, &x, &y, 1);
+        return Point2D (x, y);
+      }
+
+    private:
+      /// \brief Description of the projection.
+      std::string name_;
+
+      /**
+       * \brief Copy constructor, forbidden.
+       * \param p Projection to be copied.
+       */
+      MapProjection (const MapProjection &p);
+
+      /**
+       * \brief Copy operator, forbidden.
+       * \param p Projection to be copied.
+       */
+      MapProjection &operator = (const MapProjection &p);
+  };
+
+  /**
+   * \brief Map projection chosen at run time, implemented by a projection
+   * of this file.
+   * \tparam Kernel The projection, providing methods forward() and
+   * inverse() for a single point.
+   *
+   * The kernel is a template parameter, so that it is inlined in the loops.
+   */
+  template <class Kernel>
+  class KernelProjection: public MapProjection {
+    public:
+      /**
+       * \brief Construct the projection.
+       * \param _name Description of the projection.
+       * \param _kernel The projection of single points.
+       */
+      KernelProjection (const std::string &_name, const Kernel &_kernel):
+        MapProjection (_name), kernel (_kernel) {}
+
+      virtual void forward (const double* longitude, const double* latitude,
+                            double* x, double* y, std::size_t n) const {
+        for (std::size_t i = 0; i < n; ++i)
+          kernel.forward(longitude[i], latitude[i], x[i], y[i]);
+      }
+
+      virtual void inverse (const double* x, const double* y,
+                            double* longitude, double* latitude,
+                            std::size_t n) const {
+        for (std::size_t i = 0; i < n; ++i)
+          kernel.inverse(x[i], y[i], longitude[i], latitude[i]);
+      }
+
+    private:
+      /// \brief The projection of single points.
+      Kernel kernel;
+  };
+
+  /// \brief Pointer to a map projection, null for geographical coordinates.
+  typedef std::shared_ptr<const MapProjection> MapProjectionPointer;
+
+  /**
+   * \brief Build a map projection from its description.
+   * \param description The description, one of:
+   * - "geographic", no projection;
+   * - "mercator[:latitude of true scale[:central meridian]]";
+   * - "utm:zone" followed by "n" or "s", as "utm:31n";
+   * - "tm:central meridian:scale factor[:false easting:false northing]";
+   * - "lambert:parallel 1:parallel 2:origin latitude:central meridian"
+   *   optionally followed by ":false easting:false northing";
+   * - "lambert93", French Lambert 93;
+   * optionally followed by "@" and the ellipsoid, "wgs84" (the default
+   * except for Lambert 93), "grs80", "clarke1866" or "international1924".
+   * Angles are in decimal degrees, distances in meters.
+   * \return The projection, null for geographical coordinates.
+   * \exception std::runtime_error The description is invalid.
+   */
+  MapProjectionPointer makeProjection (const std::string &description);
+
+  /**
+   * \brief Convert image coordinates into geographical coordinates.
+   * \param change Matrix of referential change, from the image to the
+   * plane of the projection.
+   * \param projection The projection, null for geographical coordinates.
+   * \param x Abscissae of points in the image.
+   * \param y Ordinates of points in the image.
+   * \param longitude Where to store longitudes.
+   * \param latitude Where to store latitudes.
+   * \param n Number of points.
+   *
+   * Output arrays may be the same as input arrays.
+   */
+  inline void imageToGeographic (const ChangeMatrix &change,
+                                 const MapProjection* projection,
+                                 const double* x, const double* y,
+                                 double* longitude, double* latitude,
+                                 std::size_t n) {
+    transformPoints(change, x, y, longitude, latitude, n);
+    if (projection)
+      projection->inverse(longitude, latitude, longitude, latitude, n);
+  }
+
+  /**
+   * \brief Convert geographical coordinates into image coordinates.
+   * \param change Matrix of referential change, from the image to the
+   * plane of the projection.
+   * \param projection The projection, null for geographical coordinates.
+   * \param longitude Longitudes of points.
+   * \param latitude Latitudes of points.
+   * \param x Where to store abscissae in the image.
+   * \param y Where to store ordinates in the image.
+   * \param n Number of points.
+   * \exception std::domain_error The referential change is degenerated.
+   *
+   * Output arrays may be the same as input arrays.
+   */
+  inline void geographicToImage (const ChangeMatrix &change,
+                                 const MapProjection* projection,
+                                 const double* longitude,
+                                 const double* latitude,
+                                 double* x, double* y, std::size_t n) {
+    if (projection) {
+      projection->forward(longitude, latitude, x, y, n);
+      inverseTransformPoints(change, x, y, x, y, n);
+    }
+    else {
+      inverseTransformPoints(change, longitude, latitude, x, y, n);
+    }
+  }
+}
+
+#endif  // #ifndef MAPPROJECTION_HPP
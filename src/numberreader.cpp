@@ -0,0 +1,203 @@
+/**
+ * \file numberreader.cpp
+ * \brief Implementation of fast reading of numbers in text files.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "numberreader.hpp"
+
+namespace {
+  /// \brief Number of significant digits kept.
+  const int maximumDigits = 40;
+
+  /**
+   * \brief Greatest number of significant digits converted fast, those of
+   * integers exactly represented by a double.
+   */
+  const int exactDigits = 16;
+
+  /// \brief Greatest integer exactly represented by a double.
+  const std::uint64_t exactMantissa = static_cast<std::uint64_t>(1) << 53;
+
+  /// \brief Powers of ten exactly represented by a double.
+  const double powers [] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  /// \brief Greatest exact power of ten.
+  const int maximumPower = 22;
+
+  /**
+   * \brief Tell whether a character is a decimal digit.
+   * \param c The character.
+   */
+  inline bool isDigit (int c) {
+    return c >= '0' && c <= '9';
+  }
+}
+
+const std::size_t Text::NumberReader::chunkSize;
+
+/* -- Skip blanks and empty lines. ---------------------------------------- */
+bool Text::NumberReader::atEnd () {
+  for (;;) {
+    /* Next character. */
+    const int c = peek();
+    if (c == ' ' || c == '\t' || c == '\r') advance();
+    else if (c == '\n') newLine();
+    else return c == -1;
+  }
+}
+
+/* -- Read a number. ------------------------------------------------------ */
+double Text::NumberReader::number () {
+  skipBlanks();
+  /* Next character. */
+  int c = peek();
+  if (c == -1 || c == '\n') error("Number expected.");
+
+  /* Whether the number is negative. */
+  const bool negative = (c == '-');
+  if (c == '-' || c == '+') {
+    advance();
+    c = peek();
+  }
+
+  /* Significant digits, kept for numbers which cannot be converted fast. */
+  char text [maximumDigits + 24];
+  /* Number of significant digits kept. */
+  int digits = 0;
+  /* Value of the first significant digits. */
+  std::uint64_t mantissa = 0;
+  /* Whether non-zero digits have been dropped. */
+  bool dropped = false;
+  /* Power of ten the kept digits are multiplied by. */
+  long exponent = 0;
+  /* Whether at least one digit has been read. */
+  bool found = false;
+  for (; isDigit(c); c = peek()) {
+    found = true;
+    if (digits < maximumDigits) {
+      if (digits > 0 || c != '0') {
+        text[digits++] = static_cast<char>(c);
+        mantissa = 10 * mantissa + (c - '0');
+      }
+    }
+    else {
+      dropped = dropped || c != '0';
+      ++exponent;
+    }
+    advance();
+  }
+  if (c == '.') {
+    advance();
+    for (c = peek(); isDigit(c); c = peek()) {
+      found = true;
+      if (digits < maximumDigits) {
+        if (digits > 0 || c != '0') {
+          text[digits++] = static_cast<char>(c);
+          mantissa = 10 * mantissa + (c - '0');
+        }
+        --exponent;
+      }
+      else {
+        dropped = dropped || c != '0';
+      }
+      advance();
+    }
+  }
+  if (!found) error("Number expected.");
+
+  if (c == 'e' || c == 'E') {
+    advance();
+    c = peek();
+    /* Whether the exponent is negative. */
+    const bool negativeExponent = (c == '-');
+    if (c == '-' || c == '+') {
+      advance();
+      c = peek();
+    }
+    if (!isDigit(c)) error("Exponent expected.");
+    /* Exponent written. */
+    long written = 0;
+    for (; isDigit(c); c = peek()) {
+      if (written < 100000) written = 10 * written + (c - '0');
+      advance();
+    }
+    exponent += negativeExponent? -written: written;
+  }
+  if (c != -1 && c != ' ' && c != '\t' && c != '\r' && c != '\n')
+    error("Unexpected character in number.");
+
+  /* Absolute value of the number. */
+  double value;
+  if (digits == 0) {
+    value = 0.;
+  }
+  else if (digits <= exactDigits && mantissa <= exactMantissa
+           && exponent >= -maximumPower && exponent <= maximumPower) {
+    value = (exponent < 0)?
+      static_cast<double>(mantissa) / powers[-exponent]:
+      static_cast<double>(mantissa) * powers[exponent];
+  }
+  else {
+    /*
+     * Digits dropped are replaced by a single one, which gives the same
+     * rounding. The number is written without decimal separator, so that
+     * it is converted whatever the locale.
+     */
+    if (dropped) {
+      text[digits++] = '1';
+      --exponent;
+    }
+    std::snprintf(text + digits, sizeof(text) - digits, "e%ld", exponent);
+    value = std::strtod(text, 0);
+  }
+  return negative? -value: value;
+}
+
+/* -- Go to the next line. ------------------------------------------------ */
+bool Text::NumberReader::endLine () {
+  skipBlanks();
+  /* Next character. */
+  const int c = peek();
+  if (c == -1) return false;
+  if (c != '\n') error("End of line expected.");
+  newLine();
+  return true;
+}
+
+/* -- Go to the next line, ignoring the current one. ---------------------- */
+bool Text::NumberReader::skipLine () {
+  for (;;) {
+    if (current == end && !fill()) return false;
+    /* End of the line, if in the buffer. */
+    const char* const found =
+      static_cast<const char*>(std::memchr(current, '\n', end - current));
+    if (found) {
+      columnNumber += found - current;
+      current = found;
+      newLine();
+      return true;
+    }
+    columnNumber += end - current;
+    current = end;
+  }
+}
+
+/* -- Read the next chunk. ------------------------------------------------ */
+bool Text::NumberReader::fill () {
+  consumed += end - buffer;
+  stream.read(buffer, chunkSize);
+  current = buffer;
+  end = buffer + stream.gcount();
+  return current != end;
+}
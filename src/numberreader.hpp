@@ -0,0 +1,191 @@
+#ifndef NUMBERREADER_HPP
+#define NUMBERREADER_HPP
+
+/**
+ * \file numberreader.hpp
+ * \brief Fast reading of numbers in text files, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <stdexcept>
+
+/// \brief Namespace for reading text files.
+namespace Text {
+  /// \brief Error in a text file, located by line and column.
+  class ParseError: public std::runtime_error {
+    public:
+      /**
+       * \brief Construct the error.
+       * \param what Description of the error.
+       * \param _line Line of the error, from 1.
+       * \param _column Column of the error, from 1.
+       */
+      ParseError (const std::string &what, std::size_t _line,
+                  std::size_t _column):
+        std::runtime_error ("Line " + std::to_string(_line) + ", column "
+                            + std::to_string(_column) + ": " + what),
+        errorLine (_line), errorColumn (_column) {}
+
+      /// \brief Line of the error, from 1.
+      std::size_t line () const {return errorLine;}
+
+      /// \brief Column of the error, from 1.
+      std::size_t column () const {return errorColumn;}
+
+    private:
+      /// \brief Line of the error.
+      std::size_t errorLine;
+
+      /// \brief Column of the error.
+      std::size_t errorColumn;
+  };
+
+  /**
+   * \brief Reader of numbers separated by blanks, line by line.
+   *
+   * The stream is read by chunks in a fixed buffer and numbers are
+   * converted without allocation and whatever the locale, the decimal
+   * separator being always a point. Numbers with at most 16 significant
+   * digits forming an integer not greater than 2^53, scaled by a power of
+   * ten at most 22 in absolute value, which are the common case, are
+   * converted exactly by a single multiplication or division.
+   */
+  class NumberReader {
+    public:
+      /// \brief Size of chunks read from the stream.
+      static const std::size_t chunkSize = 1 << 14;
+
+      /**
+       * \brief Construct the reader.
+       * \param _stream Stream where numbers are read.
+       */
+      explicit NumberReader (std::istream &_stream):
+        stream (_stream), current (buffer), end (buffer), consumed (0),
+        lineNumber (1), columnNumber (1) {}
+
+      /**
+       * \brief Skip blanks and empty lines.
+       * \return Whether or not the end of the stream has been reached.
+       */
+      bool atEnd ();
+
+      /**
+       * \brief Read a number on the current line.
+       * \return The number.
+       * \exception ParseError There is no valid number before the end of
+       * the line.
+       */
+      double number ();
+
+      /**
+       * \brief Skip blanks and tell whether the current line is over.
+       * \return Whether or not there is no more number on the line.
+       */
+      bool lineEnd () {
+        skipBlanks();
+        /* Next character. */
+        const int c = peek();
+        return c == -1 || c == '\n';
+      }
+
+      /**
+       * \brief Go to the next line, which should contain nothing more.
+       * \return False if the end of the stream has been reached instead.
+       * \exception ParseError The line contains something else than blanks.
+       */
+      bool endLine ();
+
+      /**
+       * \brief Go to the next line, ignoring what remains on the current one.
+       * \return False if the end of the stream has been reached instead.
+       */
+      bool skipLine ();
+
+      /// \brief Current line, from 1.
+      std::size_t line () const {return lineNumber;}
+
+      /// \brief Current column, from 1.
+      std::size_t column () const {return columnNumber;}
+
+      /// \brief Number of characters read since the beginning.
+      std::size_t position () const {return consumed + (current - buffer);}
+
+    private:
+      /// \brief Stream where numbers are read.
+      std::istream &stream;
+
+      /// \brief Characters read from the stream.
+      char buffer [chunkSize];
+
+      /// \brief Next character to be used.
+      const char* current;
+
+      /// \brief End of characters read.
+      const char* end;
+
+      /// \brief Number of characters used before the buffer.
+      std::size_t consumed;
+
+      /// \brief Current line.
+      std::size_t lineNumber;
+
+      /// \brief Current column.
+      std::size_t columnNumber;
+
+      /**
+       * \brief Next character, without using it.
+       * \return The character, or -1 at end of stream.
+       */
+      int peek () {
+        if (current == end && !fill()) return -1;
+        return static_cast<unsigned char>(*current);
+      }
+
+      /// \brief Use the next character, which is not a new line.
+      void advance () {
+        ++current;
+        ++columnNumber;
+      }
+
+      /// \brief Use the next character, which is a new line.
+      void newLine () {
+        ++current;
+        ++lineNumber;
+        columnNumber = 1;
+      }
+
+      /// \brief Skip blanks on the current line.
+      void skipBlanks () {
+        for (int c = peek(); c == ' ' || c == '\t' || c == '\r'; c = peek())
+          advance();
+      }
+
+      /**
+       * \brief Read the next chunk of the stream.
+       * \return False if the end of the stream has been reached.
+       */
+      bool fill ();
+
+      /**
+       * \brief Report an error at the current position.
+       * \param what Description of the error.
+       */
+      void error (const std::string &what) const {
+        throw ParseError (what, lineNumber, columnNumber);
+      }
+
+      /// \brief Copy is forbidden.
+      NumberReader (const NumberReader &);
+
+      /// \brief Copy is forbidden.
+      NumberReader &operator = (const NumberReader &);
+  };
+}
+
+#endif  // #ifndef NUMBERREADER_HPP
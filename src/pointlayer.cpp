@@ -0,0 +1,120 @@
+/**
+ * \file pointlayer.cpp
+ * \brief Implementation of points drawn over an image.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include "pointlayer.hpp"
+
+const int GUI::PointLayer::minimumBucketSize;
+const int GUI::PointLayer::maximumBuckets;
+
+/* -- Remove every point. ------------------------------------------------- */
+void GUI::PointLayer::clear () {
+  buckets.clear();
+  columns = rows = 0;
+  count = 0;
+}
+
+/* -- Replace points. ----------------------------------------------------- */
+void GUI::PointLayer::assign (const double* x, const double* y,
+                              std::size_t n) {
+  clear();
+  /* Smallest abscissa. */
+  double xMin = 0.;
+  /* Greatest abscissa. */
+  double xMax = 0.;
+  /* Smallest ordinate. */
+  double yMin = 0.;
+  /* Greatest ordinate. */
+  double yMax = 0.;
+  /* Whether a finite point has been found. */
+  bool found = false;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!std::isfinite(x[i]) || !std::isfinite(y[i])) continue;
+    if (found) {
+      xMin = std::min(xMin, x[i]);
+      xMax = std::max(xMax, x[i]);
+      yMin = std::min(yMin, y[i]);
+      yMax = std::max(yMax, y[i]);
+    }
+    else {
+      xMin = xMax = x[i];
+      yMin = yMax = y[i];
+      found = true;
+    }
+  }
+  if (!found) return;
+
+  cover(xMin, yMin, xMax, yMax);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!std::isfinite(x[i]) || !std::isfinite(y[i])) continue;
+    /* Point in single precision. */
+    const Point point = {static_cast<float>(x[i]), static_cast<float>(y[i])};
+    buckets[row(y[i]) * columns + column(x[i])].push_back(point);
+    ++count;
+  }
+  for (std::size_t i = 0; i < buckets.size(); ++i)
+    std::shuffle(buckets[i].begin(), buckets[i].end(), random);
+}
+
+/* -- Add a point. -------------------------------------------------------- */
+void GUI::PointLayer::add (double x, double y) {
+  if (!std::isfinite(x) || !std::isfinite(y)) return;
+  /* The point in single precision. */
+  const Point point = {static_cast<float>(x), static_cast<float>(y)};
+  if (count == 0) {
+    cover(x, y, x, y);
+  }
+  else if (x < left || y < top || x > left + columns * bucketSize
+           || y > top + rows * bucketSize) {
+    /* Points already in the layer. */
+    std::vector<Point> points;
+    points.reserve(count);
+    for (std::size_t i = 0; i < buckets.size(); ++i)
+      points.insert(points.end(), buckets[i].begin(), buckets[i].end());
+    /* Width of the current area. */
+    const double width = columns * bucketSize;
+    /* Height of the current area. */
+    const double height = rows * bucketSize;
+    /*
+     * The area is doubled at least, so that adding points one after the
+     * other only redistributes them a few times.
+     */
+    cover(std::min(x, left - .5 * width), std::min(y, top - .5 * height),
+          std::max(x, left + 1.5 * width), std::max(y, top + 1.5 * height));
+    for (std::size_t i = 0; i < points.size(); ++i) insert(points[i]);
+  }
+  insert(point);
+  ++count;
+}
+
+/* -- Set buckets covering an area. --------------------------------------- */
+void GUI::PointLayer::cover (double xMin, double yMin, double xMax,
+                             double yMax) {
+  /* Greatest side of the area. */
+  const double extent = std::max(xMax - xMin, yMax - yMin);
+  bucketSize = std::max(static_cast<double>(minimumBucketSize),
+                        std::ceil(extent / maximumBuckets));
+  left = xMin;
+  top = yMin;
+  columns = static_cast<int>((xMax - xMin) / bucketSize) + 1;
+  rows = static_cast<int>((yMax - yMin) / bucketSize) + 1;
+  buckets.assign(static_cast<std::size_t>(columns) * rows,
+                 std::vector<Point> ());
+}
+
+/* -- Put a point in its bucket. ------------------------------------------ */
+void GUI::PointLayer::insert (const Point &point) {
+  /* Bucket of the point. */
+  std::vector<Point> &bucket = buckets[row(point.y) * columns
+                                       + column(point.x)];
+  bucket.push_back(point);
+  /* Place of the point, so that the order of the bucket stays random. */
+  const std::size_t place =
+    std::uniform_int_distribution<std::size_t> (0, bucket.size() - 1)
+      (random);
+  std::swap(bucket[place], bucket.back());
+}
@@ -0,0 +1,186 @@
+#ifndef POINTLAYER_HPP
+#define POINTLAYER_HPP
+
+/**
+ * \file pointlayer.hpp
+ * \brief Points drawn over an image, found by area and thinned when zoomed
+ * out, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <random>
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Points in image coordinates, sorted into square buckets.
+   *
+   * Buckets cover the bounding box of points, which grows as points are
+   * added. Points of a bucket are kept in random order, so that its first
+   * points are spread over the whole bucket: drawing only them thins the
+   * bucket evenly, and always the same way.
+   */
+  class PointLayer {
+    public:
+      /// \brief Smallest side of buckets, in image pixels.
+      static const int minimumBucketSize = 64;
+
+      /// \brief Greatest number of buckets along each axis.
+      static const int maximumBuckets = 256;
+
+      /// \brief Construct an empty layer.
+      PointLayer (): left (0.), top (0.), bucketSize (minimumBucketSize),
+                     columns (0), rows (0), count (0) {}
+
+      /// \brief Number of points.
+      std::size_t size () const {return count;}
+
+      /// \brief Remove every point.
+      void clear ();
+
+      /**
+       * \brief Replace points.
+       * \param x Abscissae of points.
+       * \param y Ordinates of points.
+       * \param n Number of points.
+       */
+      void assign (const double* x, const double* y, std::size_t n);
+
+      /**
+       * \brief Add a point.
+       * \param x Abscissa of the point.
+       * \param y Ordinate of the point.
+       */
+      void add (double x, double y);
+
+      /**
+       * \brief Visit points in an area, thinned to a given spacing.
+       * \param xMin Left side of the area.
+       * \param yMin Top side of the area.
+       * \param xMax Right side of the area.
+       * \param yMax Bottom side of the area.
+       * \param spacing Distance between points visited, 0 to visit every
+       * point of the area.
+       * \param visitor Called as visitor(x, y) on each point visited.
+       */
+      template <class Visitor>
+      void visit (double xMin, double yMin, double xMax, double yMax,
+                  double spacing, Visitor visitor) const {
+        if (count == 0) return;
+        /* Number of points visited by bucket. */
+        std::size_t limit = static_cast<std::size_t>(-1);
+        if (spacing > 0.) {
+          /* Ratio of the side of buckets to spacing. */
+          const double ratio = bucketSize / spacing;
+          if (ratio < maximumBuckets)
+            limit = static_cast<std::size_t>(std::ceil(ratio * ratio));
+        }
+        /* First column of buckets in the area. */
+        const int firstColumn = column(xMin);
+        /* Last column of buckets in the area. */
+        const int lastColumn = column(xMax);
+        /* First row of buckets in the area. */
+        const int firstRow = row(yMin);
+        /* Last row of buckets in the area. */
+        const int lastRow = row(yMax);
+        for (int j = firstRow; j <= lastRow; ++j)
+          for (int i = firstColumn; i <= lastColumn; ++i) {
+            /* The bucket. */
+            const std::vector<Point> &bucket = buckets[j * columns + i];
+            /* Number of points visited in the bucket. */
+            const std::size_t n = std::min(bucket.size(), limit);
+            for (std::size_t k = 0; k < n; ++k)
+              if (bucket[k].x >= xMin && bucket[k].x <= xMax
+                  && bucket[k].y >= yMin && bucket[k].y <= yMax)
+                visitor(bucket[k].x, bucket[k].y);
+          }
+      }
+
+    private:
+      /// \brief Point, in single precision which is enough to draw it.
+      struct Point {
+        /// \brief Abscissa.
+        float x;
+
+        /// \brief Ordinate.
+        float y;
+      };
+
+      /// \brief Abscissa of the left side of buckets.
+      double left;
+
+      /// \brief Ordinate of the top side of buckets.
+      double top;
+
+      /// \brief Side of buckets.
+      double bucketSize;
+
+      /// \brief Number of buckets along abscissae.
+      int columns;
+
+      /// \brief Number of buckets along ordinates.
+      int rows;
+
+      /// \brief Number of points.
+      std::size_t count;
+
+      /// \brief Buckets, row by row.
+      std::vector< std::vector<Point> > buckets;
+
+      /// \brief Generator of the order of points in buckets.
+      std::minstd_rand random;
+
+      /**
+       * \brief Column of buckets containing an abscissa, the nearest one
+       * outside buckets.
+       * \param x The abscissa.
+       */
+      int column (double x) const {
+        return clamp((x - left) / bucketSize, columns);
+      }
+
+      /**
+       * \brief Row of buckets containing an ordinate, the nearest one
+       * outside buckets.
+       * \param y The ordinate.
+       */
+      int row (double y) const {
+        return clamp((y - top) / bucketSize, rows);
+      }
+
+      /**
+       * \brief Index in [0, n - 1] nearest to a position.
+       * \param f Position, in buckets.
+       * \param n Number of buckets.
+       */
+      static int clamp (double f, int n) {
+        if (!(f > 0.)) return 0;
+        if (f >= n) return n - 1;
+        return static_cast<int>(f);
+      }
+
+      /**
+       * \brief Set buckets covering an area, emptied.
+       * \param xMin Left side of the area.
+       * \param yMin Top side of the area.
+       * \param xMax Right side of the area.
+       * \param yMax Bottom side of the area.
+       */
+      void cover (double xMin, double yMin, double xMax, double yMax);
+
+      /**
+       * \brief Put a point in its bucket, at a random place.
+       * \param point The point.
+       */
+      void insert (const Point &point);
+  };
+}
+
+#endif  // #ifndef POINTLAYER_HPP
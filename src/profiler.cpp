@@ -0,0 +1,152 @@
+/**
+ * \file profiler.cpp
+ * \brief Implementation of timers and counters on hot paths.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "profiler.hpp"
+
+const std::size_t Profile::Profiler::maximumEvents;
+
+namespace {
+  /**
+   * \brief Write a string in JSON, with quotes.
+   * \param stream Stream where to write.
+   * \param text The string.
+   */
+  void writeString (std::ostream &stream, const std::string &text) {
+    stream << '"';
+    for (std::size_t i = 0; i < text.size(); ++i) {
+      if (text[i] == '"' || text[i] == '\\') stream << '\\';
+      stream << text[i];
+    }
+    stream << '"';
+  }
+}
+
+/* -- The profiler of the program. ---------------------------------------- */
+Profile::Profiler &Profile::Profiler::instance () {
+  /* The profiler, built on first use. */
+  static Profiler profiler;
+  return profiler;
+}
+
+/* -- Record a timing. ---------------------------------------------------- */
+void Profile::Profiler::record (const char* name, Clock::time_point start,
+                                Clock::time_point end) {
+  /* Start in microseconds. */
+  const long long begin =
+    std::chrono::duration_cast<std::chrono::microseconds>(start - origin)
+      .count();
+  /* Duration in microseconds. */
+  const long long duration =
+    std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+      .count();
+
+  /* Lock on collected data. */
+  const std::lock_guard<std::mutex> lock (mutex);
+  /* Sums of the operation. */
+  Total &total = totals[name];
+  ++total.calls;
+  total.time += duration;
+  total.longest = std::max(total.longest, duration);
+  if (events.size() >= maximumEvents) {
+    ++dropped;
+    return;
+  }
+  /* Index of the thread. */
+  const int thread =
+    threads.insert(std::make_pair(std::this_thread::get_id(),
+                                  static_cast<int>(threads.size())))
+      .first->second;
+  const Event event = {name, begin, duration, thread};
+  events.push_back(event);
+}
+
+/* -- Add to a counter. --------------------------------------------------- */
+void Profile::Profiler::count (const char* name, long long amount) {
+  /* Lock on collected data. */
+  const std::lock_guard<std::mutex> lock (mutex);
+  counters[name] += amount;
+}
+
+/* -- Write a summary. ---------------------------------------------------- */
+void Profile::Profiler::writeSummary (std::ostream &stream) const {
+  /* Lock on collected data. */
+  const std::lock_guard<std::mutex> lock (mutex);
+  /* Operations, the longest in total first. */
+  std::vector< std::pair<long long, std::string> > order;
+  for (std::map<std::string, Total>::const_iterator i = totals.begin();
+       i != totals.end(); ++i)
+    order.push_back(std::make_pair(-i->second.time, i->first));
+  std::sort(order.begin(), order.end());
+
+  /* Previous flags of the stream. */
+  const std::ios_base::fmtflags flags = stream.flags();
+  /* Previous precision of the stream. */
+  const std::streamsize precision = stream.precision(3);
+  stream << std::fixed << std::left << std::setw(28) << "Operation"
+         << std::right << std::setw(10) << "Calls" << std::setw(14)
+         << "Total (ms)" << std::setw(12) << "Mean (ms)" << std::setw(12)
+         << "Max (ms)" << '\n';
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    /* Sums of the operation. */
+    const Total &total = totals.find(order[i].second)->second;
+    stream << std::left << std::setw(28) << order[i].second << std::right
+           << std::setw(10) << total.calls << std::setw(14)
+           << total.time * 1e-3 << std::setw(12)
+           << total.time * 1e-3 / total.calls << std::setw(12)
+           << total.longest * 1e-3 << '\n';
+  }
+  for (std::map<std::string, long long>::const_iterator i = counters.begin();
+       i != counters.end(); ++i)
+    stream << std::left << std::setw(28) << i->first << std::right
+           << std::setw(10) << i->second << '\n';
+  if (dropped > 0)
+    stream << dropped << " events not kept for the trace.\n";
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+/* -- Write events in Chrome trace format. -------------------------------- */
+void Profile::Profiler::writeTrace (const std::string &fileName) const {
+  /* The file. */
+  std::ofstream file (fileName.c_str(), std::ios_base::trunc);
+  if (!file)
+    throw std::runtime_error("Trace file \"" + fileName
+                             + "\" cannot be opened.");
+
+  /* Lock on collected data. */
+  const std::lock_guard<std::mutex> lock (mutex);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    file << (i == 0? "\n": ",\n") << "{\"name\":";
+    writeString(file, events[i].name);
+    file << ",\"cat\":\"geodesk\",\"ph\":\"X\",\"ts\":" << events[i].start
+         << ",\"dur\":" << events[i].duration << ",\"pid\":1,\"tid\":"
+         << events[i].thread << '}';
+  }
+  /* Time of the last event, where counters are shown. */
+  const long long last = events.empty()? 0:
+    events.back().start + events.back().duration;
+  for (std::map<std::string, long long>::const_iterator i = counters.begin();
+       i != counters.end(); ++i) {
+    file << (events.empty() && i == counters.begin()? "\n": ",\n")
+         << "{\"name\":";
+    writeString(file, i->first);
+    file << ",\"cat\":\"geodesk\",\"ph\":\"C\",\"ts\":" << last
+         << ",\"pid\":1,\"args\":{\"value\":" << i->second << "}}";
+  }
+  file << "\n]}\n";
+  file.close();
+  if (!file)
+    throw std::runtime_error("Trace file \"" + fileName
+                             + "\" cannot be written.");
+}
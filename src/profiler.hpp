@@ -0,0 +1,212 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+/**
+ * \file profiler.hpp
+ * \brief Timers and counters on hot paths, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/// \brief Namespace for instrumentation of hot paths.
+namespace Profile {
+  /// \brief Clock of timers.
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * \brief Collector of timings and counts, shared by the whole program.
+   *
+   * Nothing is collected until the profiler is enabled, a disabled timer
+   * only costing the test of a flag. Every timing is summed by name, and
+   * kept as an event for the trace up to a bounded number of events. The
+   * profiler can be used from several threads at once.
+   */
+  class Profiler {
+    public:
+      /// \brief Maximum number of events kept for the trace.
+      static const std::size_t maximumEvents = 1 << 20;
+
+      /// \brief The profiler of the program.
+      static Profiler &instance ();
+
+      /// \brief Whether or not timings are collected.
+      bool enabled () const {
+        return active.load(std::memory_order_relaxed);
+      }
+
+      /**
+       * \brief Start or stop collecting timings.
+       * \param enable Whether or not to collect.
+       */
+      void enable (bool enable) {
+        active.store(enable, std::memory_order_relaxed);
+      }
+
+      /**
+       * \brief Record a timing.
+       * \param name Name of the timed operation, a string literal.
+       * \param start When the operation started.
+       * \param end When the operation ended.
+       */
+      void record (const char* name, Clock::time_point start,
+                   Clock::time_point end);
+
+      /**
+       * \brief Add to a counter.
+       * \param name Name of the counter, a string literal.
+       * \param amount Amount added.
+       */
+      void count (const char* name, long long amount = 1);
+
+      /**
+       * \brief Write a summary: for each timed operation, number of calls,
+       * total, mean and maximum time, then counters.
+       * \param stream Stream where to write.
+       */
+      void writeSummary (std::ostream &stream) const;
+
+      /**
+       * \brief Write events in Chrome trace format, to be opened in
+       * "chrome://tracing" or Perfetto.
+       * \param fileName Name of the JSON file.
+       * \exception std::runtime_error The file cannot be written.
+       */
+      void writeTrace (const std::string &fileName) const;
+
+    private:
+      /// \brief Timing of an operation.
+      struct Event {
+        /// \brief Name of the operation.
+        const char* name;
+
+        /// \brief Start, in microseconds since the profiler was created.
+        long long start;
+
+        /// \brief Duration, in microseconds.
+        long long duration;
+
+        /// \brief Index of the thread.
+        int thread;
+      };
+
+      /// \brief Timings of an operation, summed.
+      struct Total {
+        /// \brief Number of calls.
+        long long calls;
+
+        /// \brief Total time, in microseconds.
+        long long time;
+
+        /// \brief Longest time, in microseconds.
+        long long longest;
+      };
+
+      /// \brief Whether or not timings are collected.
+      std::atomic<bool> active;
+
+      /// \brief When the profiler was created.
+      const Clock::time_point origin;
+
+      /// \brief Protects collected data.
+      mutable std::mutex mutex;
+
+      /// \brief Events kept for the trace.
+      std::vector<Event> events;
+
+      /// \brief Number of events not kept.
+      long long dropped;
+
+      /// \brief Timings summed by name.
+      std::map<std::string, Total> totals;
+
+      /// \brief Counters by name.
+      std::map<std::string, long long> counters;
+
+      /// \brief Index of each thread seen.
+      std::map<std::thread::id, int> threads;
+
+      /// \brief Construct a disabled profiler.
+      Profiler (): active (false), origin (Clock::now()), dropped (0) {}
+
+      /// \brief Copy is forbidden.
+      Profiler (const Profiler &);
+
+      /// \brief Copy is forbidden.
+      Profiler &operator = (const Profiler &);
+  };
+
+  /// \brief Timer recording the time spent in a scope.
+  class ScopedTimer {
+    public:
+      /**
+       * \brief Start the timer, if the profiler is enabled.
+       * \param _name Name of the timed operation, a string literal.
+       */
+      explicit ScopedTimer (const char* _name):
+        name (Profiler::instance().enabled()? _name: 0),
+        start (name? Clock::now(): Clock::time_point ()) {}
+
+      /// \brief Record the time spent.
+      ~ScopedTimer () {
+        if (name) Profiler::instance().record(name, start, Clock::now());
+      }
+
+    private:
+      /// \brief Name of the timed operation, null when not recording.
+      const char* name;
+
+      /// \brief When the timer started.
+      const Clock::time_point start;
+
+      /// \brief Copy is forbidden.
+      ScopedTimer (const ScopedTimer &);
+
+      /// \brief Copy is forbidden.
+      ScopedTimer &operator = (const ScopedTimer &);
+  };
+}
+
+/// \brief Name of a variable unique to a line.
+#define GEODESK_PROFILE_NAME(base, line) base ## line
+
+/// \brief Expand the line number before building a variable name.
+#define GEODESK_PROFILE_LINE(base, line) GEODESK_PROFILE_NAME(base, line)
+
+#ifdef GEODESK_PROFILE
+/**
+ * \brief Time the end of the current scope.
+ * \param name Name of the timed operation, a string literal.
+ */
+#define GEODESK_TIME(name) \
+  const Profile::ScopedTimer GEODESK_PROFILE_LINE(geodeskTimer, __LINE__) \
+    (name)
+
+/**
+ * \brief Add to a counter.
+ * \param name Name of the counter, a string literal.
+ * \param amount Amount added.
+ */
+#define GEODESK_COUNT(name, amount) \
+  do { \
+    if (Profile::Profiler::instance().enabled()) \
+      Profile::Profiler::instance().count(name, amount); \
+  } while (false)
+#else
+#define GEODESK_TIME(name) static_cast<void>(0)
+#define GEODESK_COUNT(name, amount) static_cast<void>(0)
+#endif
+
+#endif  // #ifndef PROFILER_HPP
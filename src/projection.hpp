@@ -10,13 +10,20 @@
  * \date 2013/06/27
  * \date 2013/06/28
  * \date 2014/03/06
+ * \date 2026/10/17
  */
 
 #include <boost/concept_check.hpp>
 #include <cassert>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
 #include <vector>
+#include <stdexcept>
 #include <eigen3/Eigen/Dense>
 
+#include "profiler.hpp"
+
 /// \brief Namespace for projection computations.
 namespace Projection {
   /// \brief Class for 2D points.
@@ -72,31 +79,317 @@ namespace Projection {
   /// \brief Type for projection coefficients.
   typedef Eigen::Matrix<double, 3, 2> Coefficients;
 
+  /**
+   * \brief Type for the matrix of referential change, from image coordinates
+   * to geographical coordinates.
+   *
+   * It is the transpose of the projection coefficients.
+   */
+  typedef Eigen::Matrix<double, 2, 3> ChangeMatrix;
+
+  /**
+   * \brief Least-squares fit of an affine transformation on reference
+   * points.
+   *
+   * Normal equations are accumulated while reference points are added or
+   * removed, so that updating the solution costs the same whatever the
+   * number of reference points. Sums are accumulated relatively to the first
+   * point given, which keeps them well conditioned.
+   */
+  class AffineFit {
+    public:
+      /// \brief Minimum number of reference points for a solution.
+      static const std::size_t minimumPoints = 3;
+
+      /// \brief Construct a fit without any reference point.
+      AffineFit () {clear();}
+
+      /// \brief Remove every reference point.
+      void clear () {
+        normal.setZero();
+        rightHandSide.setZero();
+        squares.setZero();
+        count = 0;
+      }
+
+      /**
+       * \brief Add a reference point.
+       * \param image Point coordinates in image referential.
+       * \param geographic Point coordinates in geographical referential.
+       */
+      void add (const Point2D &image, const Point2D &geographic) {
+        if (count == 0) {
+          imageOrigin = image;
+          geographicOrigin = geographic;
+        }
+        accumulate(image, geographic, 1.);
+        ++count;
+      }
+
+      /**
+       * \brief Remove a reference point previously added.
+       * \param image Point coordinates in image referential.
+       * \param geographic Point coordinates in geographical referential.
+       */
+      void remove (const Point2D &image, const Point2D &geographic) {
+        assert(count > 0);
+        accumulate(image, geographic, -1.);
+        --count;
+        if (count == 0) clear();
+      }
+
+      /// \brief Number of reference points.
+      std::size_t size () const {return count;}
+
+      /**
+       * \brief Whether or not enough reference points are given.
+       *
+       * Points may still be aligned, in which case coefficients() fails.
+       */
+      bool enough () const {return count >= minimumPoints;}
+
+      /**
+       * \brief Solve the normal equations.
+       * \return Projection coefficients.
+       * \exception std::domain_error Reference points do not define an
+       * affine transformation.
+       */
+      Coefficients coefficients () const {
+        GEODESK_TIME("AffineFit::coefficients");
+        /* Coefficients relative to origins. */
+        const Coefficients relative = solve();
+        /* Coefficients in absolute coordinates. */
+        Coefficients absolute = relative;
+        absolute(2, 0) += geographicOrigin.x()
+          - relative(0, 0) * imageOrigin.x()
+          - relative(1, 0) * imageOrigin.y();
+        absolute(2, 1) += geographicOrigin.y()
+          - relative(0, 1) * imageOrigin.x()
+          - relative(1, 1) * imageOrigin.y();
+        return absolute;
+      }
+
+      /**
+       * \brief Root mean square of residuals, computed from the sums.
+       * \return Root mean square of distances between reference points and
+       * their fitted position, in geographical units.
+       * \exception std::domain_error Reference points do not define an
+       * affine transformation.
+       */
+      double rms () const {
+        /* Coefficients relative to origins. */
+        const Coefficients relative = solve();
+        /* Sum of squared residuals. */
+        double sum = 0.;
+        for (int j = 0; j < 2; ++j)
+          sum += squares(j) - 2. * relative.col(j).dot(rightHandSide.col(j))
+                 + relative.col(j).dot(normal * relative.col(j));
+        return std::sqrt(std::max(sum, 0.) / static_cast<double>(count));
+      }
+
+    private:
+      /// \brief Normal matrix, sum of [x y 1]^T [x y 1].
+      Eigen::Matrix3d normal;
+
+      /// \brief Right hand side, sum of [x y 1]^T [longitude latitude].
+      Coefficients rightHandSide;
+
+      /// \brief Sums of squared longitudes and latitudes.
+      Eigen::Vector2d squares;
+
+      /// \brief First point given, in image referential.
+      Point2D imageOrigin;
+
+      /// \brief First point given, in geographical referential.
+      Point2D geographicOrigin;
+
+      /// \brief Number of reference points.
+      std::size_t count;
+
+      /**
+       * \brief Add a weighted reference point to the sums.
+       * \param image Point coordinates in image referential.
+       * \param geographic Point coordinates in geographical referential.
+       * \param weight 1 to add the point, -1 to remove it.
+       */
+      void accumulate (const Point2D &image, const Point2D &geographic,
+                       double weight) {
+        /* Image coordinates relative to origin. */
+        const Eigen::Vector3d a (image.x() - imageOrigin.x(),
+                                 image.y() - imageOrigin.y(), 1.);
+        /* Geographical coordinates relative to origin. */
+        const Eigen::RowVector2d b (geographic.x() - geographicOrigin.x(),
+                                    geographic.y() - geographicOrigin.y());
+        normal.noalias() += weight * a * a.transpose();
+        rightHandSide.noalias() += weight * a * b;
+        squares += weight * b.transpose().cwiseProduct(b.transpose());
+      }
+
+      /**
+       * \brief Solve the normal equations, relatively to origins.
+       * \return Projection coefficients relative to origins.
+       * \exception std::domain_error Reference points do not define an
+       * affine transformation.
+       */
+      Coefficients solve () const {
+        if (!enough())
+          throw std::domain_error("Not enough reference points.");
+        /* Decomposition of the normal matrix. */
+        const Eigen::FullPivLU<Eigen::Matrix3d> lu (normal);
+        if (!lu.isInvertible())
+          throw std::domain_error("Reference points are aligned.");
+        return lu.solve(rightHandSide);
+      }
+  };
+
   /**
    * \brief Compute the projection coefficients.
    * \param r1 Vector containing reference points in image coordinates.
    * \param r2 Vector containing reference points in geographical coordinates.
    * \return Vector containing projection coefficients.
+   * \exception std::domain_error Reference points do not define an affine
+   * transformation.
+   *
+   * At least three points are required. With more points, coefficients are
+   * fitted in the least-squares sense.
    *
    * Information on coefficients can be found at:
    * <http://en.wikipedia.org/wiki/World_file>
    */
   inline Coefficients computeCoefficients (const std::vector<Point2D> &r1,
                                            const std::vector<Point2D> &r2) {
-    assert(r1.size() == 3);
-    assert(r2.size() == 3);
-    /* Matrix to compute coefficients. */
-    Eigen::Matrix3d a;
-    a << r1[0].x(), r1[0].y(), 1.,
-         r1[1].x(), r1[1].y(), 1.,
-         r1[2].x(), r1[2].y(), 1.;
-    /* Matrix of points in geographical coordinates. */
-    Coefficients b;
-    b << r2[0].x(), r2[0].y(),
-         r2[1].x(), r2[1].y(),
-         r2[2].x(), r2[2].y();
-//     return a.fullPivLu().solve(b);
-    return a.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
+    GEODESK_TIME("computeCoefficients");
+    assert(r1.size() == r2.size());
+    /* Fit on given points. */
+    AffineFit fit;
+    for (std::size_t i = 0; i < r1.size(); ++i) fit.add(r1[i], r2[i]);
+    return fit.coefficients();
+  }
+
+  /**
+   * \brief Apply a referential change to a set of points.
+   * \param change Matrix of referential change.
+   * \param x Abscissae of points to be converted.
+   * \param y Ordinates of points to be converted.
+   * \param u Where to store abscissae of converted points.
+   * \param v Where to store ordinates of converted points.
+   * \param n Number of points.
+   *
+   * Coordinates are given as separated arrays, so that the loop can be
+   * vectorised by the compiler. Output arrays may be the same as input
+   * arrays, for conversion in place.
+   */
+  inline void transformPoints (const ChangeMatrix &change,
+                               const double* x, const double* y,
+                               double* u, double* v, std::size_t n) {
+    /* Coefficients of the referential change, kept in registers. */
+    const double a = change(0, 0);
+    const double b = change(0, 1);
+    const double c = change(0, 2);
+    const double d = change(1, 0);
+    const double e = change(1, 1);
+    const double f = change(1, 2);
+
+    for (std::size_t i = 0; i < n; ++i) {
+      /* Abscissa of the current point. */
+      const double xi = x[i];
+      /* Ordinate of the current point. */
+      const double yi = y[i];
+      u[i] = a * xi + b * yi + c;
+      v[i] = d * xi + e * yi + f;
+    }
+  }
+
+  /**
+   * \brief Apply a referential change to a single point.
+   * \param change Matrix of referential change.
+   * \param p Point to be converted.
+   * \return Converted point.
+   */
+  inline Point2D transformPoint (const ChangeMatrix &change,
+                                 const Point2D &p) {
+    return Point2D (change(0, 0) * p.x() + change(0, 1) * p.y() + change(0, 2),
+                    change(1, 0) * p.x() + change(1, 1) * p.y()
+                    + change(1, 2));
+  }
+
+  /**
+   * \brief Convert a position in a view of an image, at a given scale, to
+   * image coordinates.
+   * \param x Abscissa in the view.
+   * \param y Ordinate in the view.
+   * \param scale Scale factor of the view.
+   * \return Coordinates in the image at full resolution.
+   */
+  inline Point2D viewToImage (double x, double y, double scale) {
+    return Point2D (x / scale, y / scale);
+  }
+
+  /**
+   * \brief Compute residuals of reference points.
+   * \param change Matrix of referential change.
+   * \param r1 Vector containing reference points in image coordinates.
+   * \param r2 Vector containing reference points in geographical coordinates.
+   * \return Distance between each reference point and its converted
+   * position, in geographical units.
+   */
+  inline std::vector<double> residuals (const ChangeMatrix &change,
+                                        const std::vector<Point2D> &r1,
+                                        const std::vector<Point2D> &r2) {
+    assert(r1.size() == r2.size());
+    /* Residual of each point. */
+    std::vector<double> result (r1.size());
+    for (std::size_t i = 0; i < r1.size(); ++i) {
+      /* Reference point converted. */
+      const Point2D p = transformPoint(change, r1[i]);
+      result[i] = std::sqrt((p.x() - r2[i].x()) * (p.x() - r2[i].x())
+                            + (p.y() - r2[i].y()) * (p.y() - r2[i].y()));
+    }
+    return result;
+  }
+
+  /**
+   * \brief Compute the inverse of a referential change.
+   * \param change Matrix of referential change.
+   * \return Matrix of the inverse referential change.
+   * \exception std::domain_error The referential change is degenerated.
+   */
+  inline ChangeMatrix inverseChange (const ChangeMatrix &change) {
+    /* Determinant of the linear part. */
+    const double determinant =
+      change(0, 0) * change(1, 1) - change(0, 1) * change(1, 0);
+    if (determinant == 0.)
+      throw std::domain_error("Referential change cannot be inverted.");
+
+    /* Inverse referential change. */
+    ChangeMatrix inverse;
+    inverse(0, 0) = change(1, 1) / determinant;
+    inverse(0, 1) = -change(0, 1) / determinant;
+    inverse(1, 0) = -change(1, 0) / determinant;
+    inverse(1, 1) = change(0, 0) / determinant;
+    inverse(0, 2) = -(inverse(0, 0) * change(0, 2)
+                      + inverse(0, 1) * change(1, 2));
+    inverse(1, 2) = -(inverse(1, 0) * change(0, 2)
+                      + inverse(1, 1) * change(1, 2));
+    return inverse;
+  }
+
+  /**
+   * \brief Apply the inverse of a referential change to a set of points.
+   * \param change Matrix of referential change.
+   * \param u Abscissae of points to be converted back.
+   * \param v Ordinates of points to be converted back.
+   * \param x Where to store abscissae of converted points.
+   * \param y Where to store ordinates of converted points.
+   * \param n Number of points.
+   * \exception std::domain_error The referential change is degenerated.
+   *
+   * Typically converts geographical coordinates into image coordinates.
+   */
+  inline void inverseTransformPoints (const ChangeMatrix &change,
+                                      const double* u, const double* v,
+                                      double* x, double* y, std::size_t n) {
+    transformPoints(inverseChange(change), u, v, x, y, n);
   }
 }
 
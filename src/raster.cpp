@@ -0,0 +1,929 @@
+/**
+ * \file raster.cpp
+ * \brief Implementation of region access to raster images.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <QDir>
+#include <QTemporaryFile>
+#include <QImageReader>
+#include <QImageIOHandler>
+#include <QMutexLocker>
+
+#include "raster.hpp"
+#include "rasterdecoder.hpp"
+#include "tiff.hpp"
+#include "profiler.hpp"
+
+const int Raster::TiffImage::cacheBudget;
+
+namespace {
+  /**
+   * \brief Read a little endian integer.
+   * \param data Data containing the integer.
+   * \param bytes Number of bytes of the integer.
+   * \return The integer.
+   */
+  quint32 littleEndian (const uchar* data, int bytes) {
+    /* The integer. */
+    quint32 result = 0;
+    for (int i = bytes - 1; i >= 0; --i) result = (result << 8) | data[i];
+    return result;
+  }
+
+  /**
+   * \brief Number of bytes of a pixel.
+   * \param format Layout of pixels.
+   * \return Number of bytes.
+   */
+  int pixelBytes (Raster::PixelFormat format) {
+    switch (format) {
+      case Raster::gray8:
+      case Raster::inverseGray8:
+        return 1;
+      case Raster::rgb24:
+      case Raster::bgr24:
+        return 3;
+      default:
+        return 4;
+    }
+  }
+
+  /**
+   * \brief Convert pixels to format QImage::Format_RGB32.
+   * \param format Layout of pixels.
+   * \param s First pixel to be converted.
+   * \param line Where to store converted pixels.
+   * \param count Number of pixels to be converted.
+   * \param step Step between converted pixels.
+   */
+  void convertPixels (Raster::PixelFormat format, const uchar* s, QRgb* line,
+                      int count, int step) {
+    /* Number of bytes between two converted pixels. */
+    const int bytes = step * pixelBytes(format);
+
+    switch (format) {
+      case Raster::gray8:
+        for (int x = 0; x < count; ++x, s += bytes)
+          line[x] = qRgb(s[0], s[0], s[0]);
+        break;
+      case Raster::inverseGray8:
+        for (int x = 0; x < count; ++x, s += bytes)
+          line[x] = qRgb(255 - s[0], 255 - s[0], 255 - s[0]);
+        break;
+      case Raster::rgb24:
+      case Raster::rgbx32:
+        for (int x = 0; x < count; ++x, s += bytes)
+          line[x] = qRgb(s[0], s[1], s[2]);
+        break;
+      case Raster::bgr24:
+      case Raster::bgrx32:
+        for (int x = 0; x < count; ++x, s += bytes)
+          line[x] = qRgb(s[2], s[1], s[0]);
+        break;
+      case Raster::native32:
+        if (step == 1) {
+          std::memcpy(line, s, 4 * static_cast<std::size_t>(count));
+        }
+        else {
+          for (int x = 0; x < count; ++x, s += bytes)
+            std::memcpy(line + x, s, 4);
+        }
+        break;
+    }
+  }
+
+  /**
+   * \brief Layout of pixels of a TIFF image.
+   * \param photometric Colour space.
+   * \param samples Number of samples per pixel.
+   * \param format Where to store the layout.
+   * \return Whether or not the layout is supported.
+   */
+  bool tiffFormat (std::uint64_t photometric, std::uint64_t samples,
+                   Raster::PixelFormat &format) {
+    if ((photometric <= 1) && (samples == 1))
+      format = (photometric == 0)? Raster::inverseGray8: Raster::gray8;
+    else if ((photometric == 2) && (samples == 3))
+      format = Raster::rgb24;
+    else if ((photometric == 2) && (samples == 4))
+      format = Raster::rgbx32;
+    else
+      return false;
+    return true;
+  }
+
+  /**
+   * \brief Decode a block of a TIFF image.
+   * \param data Content of the file.
+   * \param image Layout of the image.
+   * \param format Layout of pixels.
+   * \param column Column of the block.
+   * \param row Row of the block.
+   * \return Pixels of the block inside the image, black if the block cannot
+   * be decoded.
+   */
+  QImage decodeBlock (const uchar* data, const Tiff::Image &image,
+                      Raster::PixelFormat format, int column, int row) {
+    GEODESK_TIME("TiffImage::decodeBlock");
+    /* Pixels of the block. */
+    QImage result (std::min(image.blockWidth(),
+                            image.width() - column * image.blockWidth()),
+                   std::min(image.blockHeight(),
+                            image.height() - row * image.blockHeight()),
+                   QImage::Format_RGB32);
+    /* Decoded samples. */
+    std::vector<unsigned char> pixels;
+    try {
+      image.decode(data, column, row, pixels);
+    }
+    catch (const std::runtime_error &) {
+      result.fill(qRgb(0, 0, 0));
+      return result;
+    }
+    /* Number of bytes of a row of the block. */
+    const std::size_t stride =
+      static_cast<std::size_t>(image.blockWidth()) * image.samples();
+    for (int y = 0; y < result.height(); ++y)
+      convertPixels(format, &pixels[y * stride],
+                    reinterpret_cast<QRgb*>(result.scanLine(y)),
+                    result.width(), 1);
+    return result;
+  }
+
+  /**
+   * \brief Map an uncompressed BMP file.
+   * \param file The opened file, whose ownership is taken on success.
+   * \param data Content of the file.
+   * \param size Size of the file.
+   * \return The source, or a null pointer if the file is not supported.
+   */
+  Raster::SourcePointer mapBmp (QFile* file, const uchar* data, qint64 size) {
+    if ((size < 54) || (data[0] != 'B') || (data[1] != 'M'))
+      return Raster::SourcePointer ();
+
+    /* Offset of pixels. */
+    const qint64 offset = littleEndian(data + 10, 4);
+    /* Width of the image. */
+    const qint32 width = static_cast<qint32>(littleEndian(data + 18, 4));
+    /* Height of the image, negative when rows are stored from the top. */
+    const qint32 height = static_cast<qint32>(littleEndian(data + 22, 4));
+    /* Number of bits per pixel. */
+    const quint32 bits = littleEndian(data + 28, 2);
+    /* Compression scheme. */
+    const quint32 compression = littleEndian(data + 30, 4);
+
+    if ((width <= 0) || (height == 0) || ((bits != 24) && (bits != 32))
+        || ((compression != 0) && !((compression == 3) && (bits == 32))))
+      return Raster::SourcePointer ();
+
+    /* Number of rows. */
+    const int rows = (height > 0)? height: -height;
+    /* Number of bytes of a row, padded to 4 bytes. */
+    const qint64 stride = ((static_cast<qint64>(width) * bits + 31) / 32) * 4;
+    if (offset + stride * rows > size) return Raster::SourcePointer ();
+
+    return Raster::SourcePointer (
+      new Raster::MappedImage (file, QSize (width, rows),
+                               (bits == 24)? Raster::bgr24: Raster::bgrx32,
+                               std::vector<qint64> (1, offset), rows, stride,
+                               height > 0));
+  }
+
+  /**
+   * \brief Read a decimal number in a PNM header.
+   * \param data Content of the file.
+   * \param size Size of the file.
+   * \param position Position in the header, updated.
+   * \return The number, or -1 if there is none.
+   */
+  qint64 pnmNumber (const uchar* data, qint64 size, qint64 &position) {
+    /* Skip spaces and comments. */
+    while (position < size) {
+      if (data[position] == '#') {
+        while ((position < size) && (data[position] != '\n')) ++position;
+      }
+      else if (std::isspace(data[position])) {
+        ++position;
+      }
+      else {
+        break;
+      }
+    }
+
+    if ((position >= size) || !std::isdigit(data[position])) return -1;
+    /* The number. */
+    qint64 result = 0;
+    while ((position < size) && std::isdigit(data[position])
+           && (result < (1 << 30)))
+      result = 10 * result + (data[position++] - '0');
+    return result;
+  }
+
+  /**
+   * \brief Map a binary PGM or PPM file.
+   * \param file The opened file, whose ownership is taken on success.
+   * \param data Content of the file.
+   * \param size Size of the file.
+   * \return The source, or a null pointer if the file is not supported.
+   */
+  Raster::SourcePointer mapPnm (QFile* file, const uchar* data, qint64 size) {
+    if ((size < 3) || (data[0] != 'P')
+        || ((data[1] != '5') && (data[1] != '6')))
+      return Raster::SourcePointer ();
+
+    /* Position in the header. */
+    qint64 position = 2;
+    /* Width of the image. */
+    const qint64 width = pnmNumber(data, size, position);
+    /* Height of the image. */
+    const qint64 height = pnmNumber(data, size, position);
+    /* Maximum value of a sample. */
+    const qint64 maximum = pnmNumber(data, size, position);
+    if ((width <= 0) || (height <= 0) || (maximum <= 0) || (maximum > 255))
+      return Raster::SourcePointer ();
+
+    /* Whether or not the image is in colour. */
+    const bool colour = (data[1] == '6');
+    /* Number of bytes of a row. */
+    const qint64 stride = width * (colour? 3: 1);
+    /* Offset of pixels, after a single white space. */
+    const qint64 offset = position + 1;
+    if (offset + stride * height > size) return Raster::SourcePointer ();
+
+    return Raster::SourcePointer (
+      new Raster::MappedImage (file, QSize (static_cast<int>(width),
+                                            static_cast<int>(height)),
+                               colour? Raster::rgb24: Raster::gray8,
+                               std::vector<qint64> (1, offset),
+                               static_cast<int>(height), stride));
+  }
+
+  /**
+   * \brief Map a TIFF file: uncompressed strips are read directly, other
+   * images are decoded block by block.
+   * \param file The opened file, whose ownership is taken on success.
+   * \param data Content of the file.
+   * \param size Size of the file.
+   * \return The source, or a null pointer if the file is not supported.
+   */
+  Raster::SourcePointer mapTiff (QFile* file, const uchar* data,
+                                 qint64 size) {
+    if (!Tiff::isTiff(data, static_cast<std::size_t>(size)))
+      return Raster::SourcePointer ();
+
+    try {
+      /* Directory of the first image. */
+      const Tiff::Directory directory (data, static_cast<std::size_t>(size));
+      /* Width of the image. */
+      const qint64 width =
+        static_cast<qint64>(directory.value(Tiff::imageWidth));
+      /* Height of the image. */
+      const qint64 height =
+        static_cast<qint64>(directory.value(Tiff::imageLength));
+      /* Number of samples per pixel. */
+      const std::uint64_t samples =
+        directory.value(Tiff::samplesPerPixel, 1);
+      /* Colour space. */
+      const std::uint64_t photometric =
+        directory.value(Tiff::photometricInterpretation);
+      /* Offsets of strips. */
+      const std::vector<std::uint64_t> &offsets =
+        directory.values(Tiff::stripOffsets);
+
+      if ((directory.value(Tiff::compression, 1) != Tiff::none)
+          || (directory.value(Tiff::predictor, 1) != 1) || offsets.empty())
+        return Raster::SourcePointer (
+          new Raster::TiffImage (file, Tiff::Image (
+            directory, static_cast<std::size_t>(size))));
+      if ((width <= 0) || (height <= 0)
+          || (directory.value(Tiff::planarConfiguration, 1) != 1))
+        return Raster::SourcePointer ();
+      /* Bits of each sample. */
+      const std::vector<std::uint64_t> &bits =
+        directory.values(Tiff::bitsPerSample);
+      for (std::size_t i = 0; i < bits.size(); ++i)
+        if (bits[i] != 8) return Raster::SourcePointer ();
+
+      /* Layout of pixels. */
+      Raster::PixelFormat format;
+      if (!tiffFormat(photometric, samples, format))
+        return Raster::SourcePointer ();
+
+      /* Number of bytes of a row. */
+      const qint64 stride = width * static_cast<qint64>(samples);
+      /* Number of rows of each strip. */
+      const qint64 rowsPerStrip =
+        std::min(static_cast<qint64>(directory.value(Tiff::rowsPerStrip,
+                                                     height)), height);
+      if ((rowsPerStrip <= 0)
+          || (static_cast<qint64>(offsets.size()) * rowsPerStrip < height))
+        return Raster::SourcePointer ();
+
+      /* Offsets of strips, checked against the size of the file. */
+      std::vector<qint64> strips (offsets.size());
+      for (std::size_t i = 0; i < offsets.size(); ++i) {
+        /* Number of rows of the strip. */
+        const qint64 rows =
+          std::min(rowsPerStrip, height - static_cast<qint64>(i)
+                                          * rowsPerStrip);
+        strips[i] = static_cast<qint64>(offsets[i]);
+        if ((rows > 0) && (strips[i] + rows * stride > size))
+          return Raster::SourcePointer ();
+      }
+
+      return Raster::SourcePointer (
+        new Raster::MappedImage (file, QSize (static_cast<int>(width),
+                                              static_cast<int>(height)),
+                                 format, strips,
+                                 static_cast<int>(rowsPerStrip), stride));
+    }
+    catch (const std::runtime_error &) {
+      return Raster::SourcePointer ();
+    }
+  }
+
+  /// \brief Magic number at the beginning of cache files.
+  const char cacheMagic [] = "GeoDesk1";
+
+  /**
+   * \brief Write the header of a cache file.
+   * \param file The cache file.
+   * \param size Size of the image.
+   * \return Whether or not the header has been written.
+   */
+  bool writeHeader (QFile &file, const QSize &size) {
+    /* The header. */
+    char header [Raster::cacheHeaderSize];
+    /* Width of the image. */
+    const qint32 width = size.width();
+    /* Height of the image. */
+    const qint32 height = size.height();
+    std::memcpy(header, cacheMagic, 8);
+    std::memcpy(header + 8, &width, 4);
+    std::memcpy(header + 12, &height, 4);
+    return file.seek(0) && (file.write(header, Raster::cacheHeaderSize)
+                            == Raster::cacheHeaderSize) && file.flush();
+  }
+
+  /// \brief Writer of decoded rows into a mapped cache file.
+  class CacheWriter: public Raster::RowWriter {
+    public:
+      /**
+       * \brief Construct the writer.
+       * \param _file The opened cache file.
+       * \param _progress Function informed of decoding progress.
+       */
+      CacheWriter (QFile &_file, const Raster::Progress &_progress):
+        file (_file), progressFunction (_progress), data (0), width (0),
+        height (0) {}
+
+      /// \brief Destructor, unmapping the file.
+      virtual ~CacheWriter () {
+        if (data) file.unmap(data);
+      }
+
+      virtual bool start (int _width, int _height) {
+        width = _width;
+        height = _height;
+        /* Size of the cache. */
+        const qint64 size = 4 * static_cast<qint64>(width) * height;
+        if ((size == 0) || !file.resize(Raster::cacheHeaderSize + size))
+          return false;
+        data = file.map(Raster::cacheHeaderSize, size);
+        return data != 0;
+      }
+
+      virtual std::uint32_t* row (int y) {
+        return reinterpret_cast<std::uint32_t*>(
+          data + 4 * static_cast<qint64>(width) * y);
+      }
+
+      virtual bool progress (int rows, int pass, int passes) {
+        return !progressFunction
+          || progressFunction(static_cast<qint64>(pass) * height + rows,
+                              static_cast<qint64>(passes) * height);
+      }
+
+      /// \brief Size of the decoded image.
+      QSize size () const {return QSize (width, height);}
+
+    private:
+      /// \brief The cache file.
+      QFile &file;
+
+      /// \brief Function informed of decoding progress.
+      Raster::Progress progressFunction;
+
+      /// \brief Content of the cache file.
+      uchar* data;
+
+      /// \brief Width of the image.
+      int width;
+
+      /// \brief Height of the image.
+      int height;
+  };
+
+  /// \brief Writer of decoded rows into an image in memory.
+  class ImageWriter: public Raster::RowWriter {
+    public:
+      virtual bool start (int width, int height) {
+        pixels = QImage (width, height, QImage::Format_RGB32);
+        return !pixels.isNull();
+      }
+
+      virtual void fullSize (int width, int height) {
+        full = QSize (width, height);
+      }
+
+      virtual std::uint32_t* row (int y) {
+        return reinterpret_cast<std::uint32_t*>(pixels.scanLine(y));
+      }
+
+      /// \brief The decoded image.
+      const QImage &image () const {return pixels;}
+
+      /// \brief Size of the image at full resolution.
+      const QSize &originalSize () const {return full;}
+
+    private:
+      /// \brief The decoded image.
+      QImage pixels;
+
+      /// \brief Size of the image at full resolution.
+      QSize full;
+  };
+}
+
+/* -- Default preview of an image. ---------------------------------------- */
+QImage Raster::Source::preview (const QSize &bound) const {
+  return read(QRect (QPoint (0, 0), size())).scaled(bound,
+                                                    Qt::KeepAspectRatio,
+                                                    Qt::SmoothTransformation);
+}
+
+/* -- Construct a source on a decoded image. ------------------------------ */
+Raster::MemoryImage::MemoryImage (const QImage &_image):
+  image ((_image.format() == QImage::Format_RGB32)?
+         _image: _image.convertToFormat(QImage::Format_RGB32)) {
+  imageSize = image.size();
+}
+
+/* -- Construct a source on a mapped file. -------------------------------- */
+Raster::MappedImage::MappedImage (QFile* _file, const QSize &size,
+                                  PixelFormat _format,
+                                  const std::vector<qint64> &_strips,
+                                  int _rowsPerStrip, qint64 _stride,
+                                  bool _bottomUp):
+  file (_file), data (0), format (_format), strips (_strips),
+  rowsPerStrip (_rowsPerStrip), stride (_stride), bottomUp (_bottomUp) {
+  imageSize = size;
+  data = file->map(0, file->size());
+  if (!data) {
+    /* Ownership is only taken on success. */
+    file.release();
+    throw std::runtime_error("File cannot be mapped.");
+  }
+}
+
+/* -- Unmap the file. ----------------------------------------------------- */
+Raster::MappedImage::~MappedImage () {
+  file->unmap(const_cast<uchar*>(data));
+}
+
+/* -- Convert pixels of a row. -------------------------------------------- */
+void Raster::MappedImage::convert (const uchar* s, QRgb* line, int count,
+                                   int step) const {
+  convertPixels(format, s, line, count, step);
+}
+
+/* -- Read a region of a mapped image. ------------------------------------ */
+QImage Raster::MappedImage::read (const QRect &area) const {
+  /* Pixels of the region. */
+  QImage result (area.size(), QImage::Format_RGB32);
+  for (int j = 0; j < area.height(); ++j)
+    convert(row(area.y() + j) + pixelBytes(format) * area.x(),
+            reinterpret_cast<QRgb*>(result.scanLine(j)), area.width(), 1);
+  return result;
+}
+
+/* -- Subsample a mapped image. ------------------------------------------- */
+QImage Raster::MappedImage::preview (const QSize &bound) const {
+  /* Step between sampled pixels. */
+  const int step =
+    std::max((imageSize.width() + bound.width() - 1) / bound.width(),
+             (imageSize.height() + bound.height() - 1) / bound.height());
+  if (step <= 1) return read(QRect (QPoint (0, 0), imageSize));
+
+  /* Subsampled image. */
+  QImage result ((imageSize.width() + step - 1) / step,
+                 (imageSize.height() + step - 1) / step,
+                 QImage::Format_RGB32);
+  for (int j = 0; j < result.height(); ++j)
+    convert(row(j * step), reinterpret_cast<QRgb*>(result.scanLine(j)),
+            result.width(), step);
+  return result;
+}
+
+/* -- Construct a source on a TIFF file. ---------------------------------- */
+Raster::TiffImage::TiffImage (QFile* _file, const Tiff::Image &_image):
+  file (_file), data (0), image (_image), blocks (cacheBudget) {
+  if (!tiffFormat(image.photometric(), image.samples(), format)) {
+    /* Ownership is only taken on success. */
+    file.release();
+    throw std::runtime_error("TIFF pixels are not supported.");
+  }
+  imageSize = QSize (image.width(), image.height());
+  /* Size of the file. */
+  const std::size_t size = static_cast<std::size_t>(file->size());
+  data = file->map(0, file->size());
+  if (!data) {
+    file.release();
+    throw std::runtime_error("File cannot be mapped.");
+  }
+
+  try {
+    /* Offset of the next directory. */
+    std::uint64_t next = Tiff::Directory (data, size).next();
+    /* Directories are bounded, in case they form a loop. */
+    for (int i = 0; (next != 0) && (i < 64); ++i) {
+      /* Directory of a following image. */
+      const Tiff::Directory directory (data, size, next);
+      next = directory.next();
+      if ((directory.value(Tiff::newSubfileType) & 1) == 0) continue;
+      /* The reduced-resolution image. */
+      const Tiff::Image overview (directory, size);
+      /* Layout of its pixels. */
+      PixelFormat overviewFormat;
+      if (tiffFormat(overview.photometric(), overview.samples(),
+                     overviewFormat) && (overviewFormat == format))
+        overviews.push_back(overview);
+    }
+  }
+  catch (const std::runtime_error &) {
+    /* Overviews are optional. */
+  }
+}
+
+/* -- Unmap the TIFF file. ------------------------------------------------ */
+Raster::TiffImage::~TiffImage () {
+  file->unmap(const_cast<uchar*>(data));
+}
+
+/* -- Get a decoded block. ------------------------------------------------ */
+QImage Raster::TiffImage::block (int column, int row) const {
+  /* Index of the block. */
+  const int index = row * image.columns() + column;
+  {
+    /* Lock on the cache. */
+    const QMutexLocker locker (&mutex);
+    /* Block already decoded. */
+    const QImage* found = blocks.object(index);
+    if (found) return *found;
+  }
+  /* The block, decoded out of the lock. */
+  const QImage result = decodeBlock(data, image, format, column, row);
+  /* Lock on the cache. */
+  const QMutexLocker locker (&mutex);
+  blocks.insert(index, new QImage (result),
+                std::max(result.byteCount() / 1024, 1));
+  return result;
+}
+
+/* -- Read a region of a TIFF image. -------------------------------------- */
+QImage Raster::TiffImage::read (const QRect &area) const {
+  /* Pixels of the region. */
+  QImage result (area.size(), QImage::Format_RGB32);
+  /* Width of blocks. */
+  const int width = image.blockWidth();
+  /* Height of blocks. */
+  const int height = image.blockHeight();
+  for (int r = area.top() / height; r <= area.bottom() / height; ++r)
+    for (int c = area.left() / width; c <= area.right() / width; ++c) {
+      /* The block. */
+      const QImage part = block(c, r);
+      /* Area of the block read. */
+      const QRect inside =
+        QRect (c * width, r * height, part.width(), part.height())
+          .intersected(area);
+      for (int y = inside.top(); y <= inside.bottom(); ++y) {
+        /* Row of the block. */
+        const QRgb* line =
+          reinterpret_cast<const QRgb*>(part.scanLine(y - r * height))
+          - c * width;
+        std::copy(line + inside.left(), line + inside.right() + 1,
+                  reinterpret_cast<QRgb*>(result.scanLine(y - area.top()))
+                  + (inside.left() - area.left()));
+      }
+    }
+  return result;
+}
+
+/* -- Get a TIFF image at low resolution. --------------------------------- */
+QImage Raster::TiffImage::preview (const QSize &bound) const {
+  /* Size of the preview. */
+  const QSize scaled = imageSize.scaled(bound, Qt::KeepAspectRatio)
+    .boundedTo(imageSize);
+  /* Smallest overview covering the preview. */
+  const Tiff::Image* best = 0;
+  for (std::size_t i = 0; i < overviews.size(); ++i)
+    if ((overviews[i].width() >= scaled.width())
+        && (overviews[i].height() >= scaled.height())
+        && (!best || (overviews[i].width() < best->width())))
+      best = &overviews[i];
+
+  if (best) {
+    /* The overview, decoded whole. */
+    QImage result (best->width(), best->height(), QImage::Format_RGB32);
+    for (int r = 0; r < best->rows(); ++r)
+      for (int c = 0; c < best->columns(); ++c) {
+        /* The block. */
+        const QImage part = decodeBlock(data, *best, format, c, r);
+        for (int y = 0; y < part.height(); ++y)
+          std::memcpy(reinterpret_cast<QRgb*>(
+                        result.scanLine(r * best->blockHeight() + y))
+                      + c * best->blockWidth(), part.scanLine(y),
+                      4 * static_cast<std::size_t>(part.width()));
+      }
+    return result.scaled(scaled, Qt::KeepAspectRatio,
+                         Qt::SmoothTransformation);
+  }
+
+  /* Step between sampled pixels. */
+  const int step =
+    std::max((imageSize.width() + bound.width() - 1) / bound.width(),
+             (imageSize.height() + bound.height() - 1) / bound.height());
+  if (step <= 1) return read(QRect (QPoint (0, 0), imageSize));
+  /* Subsampled image. */
+  QImage result ((imageSize.width() + step - 1) / step,
+                 (imageSize.height() + step - 1) / step,
+                 QImage::Format_RGB32);
+  /* Width of blocks. */
+  const int width = image.blockWidth();
+  /* Height of blocks. */
+  const int height = image.blockHeight();
+  for (int r = 0; r < image.rows(); ++r) {
+    /* First sampled row of the block. */
+    const int top = ((r * height + step - 1) / step) * step;
+    if (top >= std::min((r + 1) * height, imageSize.height())) continue;
+    for (int c = 0; c < image.columns(); ++c) {
+      /* First sampled column of the block. */
+      const int left = ((c * width + step - 1) / step) * step;
+      /* Last column of the block. */
+      const int right = std::min((c + 1) * width, imageSize.width());
+      if (left >= right) continue;
+      /* The block, not kept in the cache. */
+      const QImage part = decodeBlock(data, image, format, c, r);
+      for (int y = top; y - r * height < part.height(); y += step) {
+        /* Row of the block. */
+        const QRgb* in =
+          reinterpret_cast<const QRgb*>(part.scanLine(y - r * height))
+          - c * width;
+        /* Row of the result. */
+        QRgb* out = reinterpret_cast<QRgb*>(result.scanLine(y / step));
+        for (int x = left; x < right; x += step) out[x / step] = in[x];
+      }
+    }
+  }
+  return result;
+}
+
+/* -- Open an image file. ------------------------------------------------- */
+Raster::SourcePointer Raster::open (const QString &fileName,
+                                    const Progress &progress,
+                                    const QString &cacheName) {
+  /* The source. */
+  SourcePointer source = openMapped(fileName);
+  if (!source && !cacheName.isEmpty()) source = openCache(cacheName);
+  if (!source) {
+    /* Whether or not decoding has been interrupted. */
+    bool interrupted = false;
+    source = openCached(fileName, [&] (qint64 done, qint64 total) {
+      interrupted = progress && !progress(done, total);
+      return !interrupted;
+    }, cacheName);
+    if (interrupted) return SourcePointer ();
+  }
+  if (!source) {
+    /* Image decoded by Qt. */
+    const QImage image (fileName);
+    if (!image.isNull()) {
+      if (writeCache(cacheName, image)) source = openCache(cacheName);
+      if (!source) source.reset(new MemoryImage (image));
+    }
+  }
+  return source;
+}
+
+/* -- Map an uncompressed image file. ------------------------------------- */
+Raster::SourcePointer Raster::openMapped (const QString &fileName) {
+  /* The file itself. */
+  std::unique_ptr<QFile> file (new QFile (fileName));
+  if (!file->open(QIODevice::ReadOnly)) return SourcePointer ();
+
+  /* Size of the file. */
+  const qint64 size = file->size();
+  /* Content of the file, to read headers. */
+  uchar* data = file->map(0, size);
+  if (!data) return SourcePointer ();
+
+  /* The source. */
+  SourcePointer source;
+  try {
+    source = mapBmp(file.get(), data, size);
+    if (!source) source = mapPnm(file.get(), data, size);
+    if (!source) source = mapTiff(file.get(), data, size);
+  }
+  catch (const std::runtime_error &) {
+    source.reset();
+  }
+  file->unmap(data);
+
+  /* On success, the source owns the file. */
+  if (source) file.release();
+  return source;
+}
+
+/* -- Decode an image file into a cache file. ----------------------------- */
+Raster::SourcePointer Raster::openCached (const QString &fileName,
+                                          const Progress &progress,
+                                          const QString &cacheName) {
+  /* The cache file, removed when the source is destroyed if temporary. */
+  std::unique_ptr<QFile> cache;
+  if (cacheName.isEmpty())
+    cache.reset(new QTemporaryFile (QDir::tempPath()
+                                    + "/geodesk-XXXXXX.cache"));
+  else
+    cache.reset(new QFile (cacheName + ".part"));
+  if (!cache->open(QIODevice::ReadWrite | QIODevice::Truncate))
+    return SourcePointer ();
+
+  /* Size of the decoded image. */
+  QSize size;
+  {
+    /* Writer into the cache. */
+    CacheWriter writer (*cache, progress);
+    /* Name of the file, for decoders. */
+    const std::string name (QFile::encodeName(fileName).constData());
+    /* Result of the decoding. */
+    DecodeResult result = decodeJpeg(name, writer);
+    if (result == notSupported) result = decodePng(name, writer);
+    if (result == decoded) size = writer.size();
+  }
+  if (size.isEmpty() || !writeHeader(*cache, size)) {
+    if (!cacheName.isEmpty()) cache->remove();
+    return SourcePointer ();
+  }
+
+  if (!cacheName.isEmpty()) {
+    /* The cache file only gets its name once complete. */
+    cache->close();
+    QFile::remove(cacheName);
+    if (!cache->rename(cacheName)) {
+      cache->remove();
+      return SourcePointer ();
+    }
+    return openCache(cacheName);
+  }
+
+  try {
+    /* The source. */
+    const SourcePointer source (
+      new MappedImage (cache.get(), size, native32,
+                       std::vector<qint64> (1, cacheHeaderSize),
+                       size.height(), 4 * static_cast<qint64>(size.width())));
+    cache.release();
+    return source;
+  }
+  catch (const std::runtime_error &) {
+    return SourcePointer ();
+  }
+}
+
+/* -- Map a cache file. --------------------------------------------------- */
+Raster::SourcePointer Raster::openCache (const QString &cacheName) {
+  /* The cache file. */
+  std::unique_ptr<QFile> cache (new QFile (cacheName));
+  if (!cache->open(QIODevice::ReadOnly)) return SourcePointer ();
+
+  /* Header of the file. */
+  const QByteArray header = cache->read(cacheHeaderSize);
+  if ((header.size() != cacheHeaderSize)
+      || !header.startsWith(cacheMagic))
+    return SourcePointer ();
+  /* Width of the image. */
+  qint32 width;
+  /* Height of the image. */
+  qint32 height;
+  std::memcpy(&width, header.constData() + 8, 4);
+  std::memcpy(&height, header.constData() + 12, 4);
+  if ((width <= 0) || (height <= 0)
+      || (cache->size() != cacheHeaderSize
+                           + 4 * static_cast<qint64>(width) * height))
+    return SourcePointer ();
+
+  try {
+    /* The source. */
+    const SourcePointer source (
+      new MappedImage (cache.get(), QSize (width, height), native32,
+                       std::vector<qint64> (1, cacheHeaderSize), height,
+                       4 * static_cast<qint64>(width)));
+    cache.release();
+    return source;
+  }
+  catch (const std::runtime_error &) {
+    return SourcePointer ();
+  }
+}
+
+/* -- Write pixels into a cache file. ------------------------------------- */
+bool Raster::writeCache (const QString &cacheName, const QImage &image) {
+  if (cacheName.isEmpty()) return false;
+  /* Pixels in the layout of the cache. */
+  const QImage pixels = (image.format() == QImage::Format_RGB32)?
+    image: image.convertToFormat(QImage::Format_RGB32);
+  /* The cache file, named once complete. */
+  QFile cache (cacheName + ".part");
+  if (!cache.open(QIODevice::WriteOnly | QIODevice::Truncate)
+      || !cache.seek(cacheHeaderSize))
+    return false;
+  /* Number of bytes of a row. */
+  const qint64 bytes = 4 * static_cast<qint64>(pixels.width());
+  /* Whether or not writing has succeeded. */
+  bool good = true;
+  for (int y = 0; good && (y < pixels.height()); ++y)
+    good = cache.write(reinterpret_cast<const char*>(pixels.scanLine(y)),
+                       bytes) == bytes;
+  good = good && writeHeader(cache, pixels.size());
+  cache.close();
+  QFile::remove(cacheName);
+  if (!good || !cache.rename(cacheName)) {
+    cache.remove();
+    return false;
+  }
+  return true;
+}
+
+/* -- Decode an image file at reduced resolution. ------------------------- */
+QImage Raster::readReduced (const QString &fileName, int reduction,
+                            QSize &size, bool &averaged) {
+  /* Writer into the image. */
+  ImageWriter writer;
+  /* Name of the file, for decoders. */
+  const std::string name (QFile::encodeName(fileName).constData());
+  averaged = true;
+  /* Result of the decoding. */
+  DecodeResult result = decodeJpeg(name, writer, reduction);
+  if ((result == notSupported) && (reduction == maximumReduction)) {
+    averaged = false;
+    result = decodePng(name, writer, true);
+  }
+  if (result != decoded) return QImage ();
+  size = writer.originalSize();
+  return writer.image();
+}
+
+/* -- Decode an image file at low resolution. ----------------------------- */
+QImage Raster::readPreview (const QString &fileName, const QSize &bound,
+                            QSize &size) {
+  /* Whether or not pixels of the reduced image are averaged. */
+  bool averaged;
+  /* The image at the smallest scale. */
+  const QImage reduced =
+    readReduced(fileName, maximumReduction, size, averaged);
+  if (!reduced.isNull()) {
+    /* Size of the preview. */
+    const QSize scaled =
+      size.scaled(bound, Qt::KeepAspectRatio).boundedTo(size);
+    /* Denominator of the scale covering the preview. */
+    int reduction = maximumReduction;
+    while ((reduction > 1)
+           && ((size.width() + reduction - 1) / reduction < scaled.width()))
+      reduction /= 2;
+    /* Small images are decoded again, at a larger scale. */
+    const QImage covering = (reduction == maximumReduction)? reduced:
+      (reduction > 1 && averaged)?
+      readReduced(fileName, reduction, size, averaged): QImage ();
+    if (!covering.isNull())
+      return covering.scaled(scaled, Qt::KeepAspectRatio,
+                             Qt::SmoothTransformation);
+  }
+
+  /* Reader of the file. */
+  QImageReader reader (fileName);
+  if (!reader.supportsOption(QImageIOHandler::ScaledSize)) return QImage ();
+  size = reader.size();
+  if (!size.isValid()) return QImage ();
+
+  /* Size of the preview. */
+  const QSize scaled = size.scaled(bound, Qt::KeepAspectRatio);
+  reader.setScaledSize(scaled.boundedTo(size));
+  return reader.read().convertToFormat(QImage::Format_RGB32);
+}
@@ -0,0 +1,357 @@
+#ifndef RASTER_HPP
+#define RASTER_HPP
+
+/**
+ * \file raster.hpp
+ * \brief Access to regions of raster images, without loading them whole.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <QImage>
+#include <QString>
+#include <QSize>
+#include <QRect>
+#include <QFile>
+#include <QCache>
+#include <QMutex>
+
+#include "tiff.hpp"
+
+/// \brief Namespace for raster images access.
+namespace Raster {
+  /**
+   * \brief Image whose regions can be read independently.
+   *
+   * Regions are returned in format QImage::Format_RGB32. Reading must be
+   * safe from several threads at once.
+   */
+  class Source {
+    public:
+      /// \brief Destructor.
+      virtual ~Source () {}
+
+      /// \brief Size of the image.
+      QSize size () const {return imageSize;}
+
+      /**
+       * \brief Read a region of the image.
+       * \param area Region to be read, inside the image.
+       * \return Pixels of the region.
+       */
+      virtual QImage read (const QRect &area) const = 0;
+
+      /**
+       * \brief Quickly get the whole image at low resolution.
+       * \param bound Maximum size of the result.
+       * \return The image, fitting in bound with its aspect ratio kept.
+       */
+      virtual QImage preview (const QSize &bound) const;
+
+    protected:
+      /// \brief Size of the image.
+      QSize imageSize;
+  };
+
+  /// \brief Pointer to an image source, shared between threads.
+  typedef std::shared_ptr<const Source> SourcePointer;
+
+  /// \brief Image entirely decoded in memory.
+  class MemoryImage: public Source {
+    public:
+      /**
+       * \brief Construct the source on a decoded image.
+       * \param _image The image.
+       */
+      explicit MemoryImage (const QImage &_image);
+
+      virtual QImage read (const QRect &area) const {
+        return image.copy(area);
+      }
+
+    private:
+      /// \brief The image, in format QImage::Format_RGB32.
+      QImage image;
+  };
+
+  /// \brief Layout of pixels in a mapped file.
+  enum PixelFormat {
+    /// \brief One byte of grey level per pixel.
+    gray8,
+    /// \brief One byte of grey level per pixel, 0 being white.
+    inverseGray8,
+    /// \brief Bytes red, green and blue.
+    rgb24,
+    /// \brief Bytes blue, green and red.
+    bgr24,
+    /// \brief Bytes red, green, blue and an ignored byte.
+    rgbx32,
+    /// \brief Bytes blue, green, red and an ignored byte.
+    bgrx32,
+    /// \brief 32 bits words 0xffRRGGBB in the byte order of the machine.
+    native32
+  };
+
+  /**
+   * \brief Image whose uncompressed pixels are mapped in memory.
+   *
+   * Rows are grouped into strips, stored anywhere in the file. Pages are
+   * only loaded by the system when the corresponding rows are read.
+   */
+  class MappedImage: public Source {
+    public:
+      /**
+       * \brief Construct the source on an opened file.
+       * \param _file The opened file, whose ownership is taken on success.
+       * \param size Size of the image.
+       * \param _format Layout of pixels.
+       * \param _strips Offset of each strip in the file.
+       * \param _rowsPerStrip Number of rows in each strip.
+       * \param _stride Number of bytes between two rows of a strip.
+       * \param _bottomUp Whether or not rows are stored from the bottom.
+       * \exception std::runtime_error The file cannot be mapped.
+       */
+      MappedImage (QFile* _file, const QSize &size, PixelFormat _format,
+                   const std::vector<qint64> &_strips, int _rowsPerStrip,
+                   qint64 _stride, bool _bottomUp = false);
+
+      /// \brief Destructor, unmapping the file.
+      virtual ~MappedImage ();
+
+      virtual QImage read (const QRect &area) const;
+
+      /**
+       * \brief Subsample the image, only reading needed rows.
+       * \param bound Maximum size of the result.
+       * \return The image, fitting in bound with its aspect ratio kept.
+       */
+      virtual QImage preview (const QSize &bound) const;
+
+    private:
+      /// \brief The file.
+      std::unique_ptr<QFile> file;
+
+      /// \brief Content of the file.
+      const uchar* data;
+
+      /// \brief Layout of pixels.
+      PixelFormat format;
+
+      /// \brief Offset of each strip in the file.
+      std::vector<qint64> strips;
+
+      /// \brief Number of rows in each strip.
+      int rowsPerStrip;
+
+      /// \brief Number of bytes between two rows of a strip.
+      qint64 stride;
+
+      /// \brief Whether or not rows are stored from the bottom.
+      bool bottomUp;
+
+      /**
+       * \brief Convert pixels of a row to format QImage::Format_RGB32.
+       * \param s First pixel to be converted.
+       * \param line Where to store converted pixels.
+       * \param count Number of pixels to be converted.
+       * \param step Step between converted pixels.
+       */
+      void convert (const uchar* s, QRgb* line, int count, int step) const;
+
+      /**
+       * \brief Access to a row of the image.
+       * \param y Index of the row, from the top.
+       * \return First byte of the row.
+       */
+      const uchar* row (int y) const {
+        /* Index of the row in the file. */
+        const int stored = bottomUp? imageSize.height() - 1 - y: y;
+        return data + strips[static_cast<std::size_t>(stored / rowsPerStrip)]
+          + (stored % rowsPerStrip) * stride;
+      }
+  };
+
+  /**
+   * \brief TIFF image whose compressed blocks are decoded when read.
+   *
+   * The file is mapped in memory, and strips or tiles are decoded on demand
+   * by the native TIFF reader, then kept in a cache of bounded size. Blocks
+   * which cannot be decoded are black.
+   */
+  class TiffImage: public Source {
+    public:
+      /// \brief Memory budget for the cache of decoded blocks, in kilobytes.
+      static const int cacheBudget = 128 << 10;
+
+      /**
+       * \brief Construct the source on an opened file.
+       * \param _file The opened file, whose ownership is taken on success.
+       * \param _image Layout of the image in the file.
+       * \exception std::runtime_error Pixels are not supported or the file
+       * cannot be mapped.
+       */
+      TiffImage (QFile* _file, const Tiff::Image &_image);
+
+      /// \brief Destructor, unmapping the file.
+      virtual ~TiffImage ();
+
+      virtual QImage read (const QRect &area) const;
+
+      /**
+       * \brief Get the image at low resolution.
+       * \param bound Maximum size of the result.
+       * \return The image, fitting in bound with its aspect ratio kept.
+       *
+       * The smallest reduced-resolution image stored in the file which
+       * covers the bound is decoded, when there is one. Otherwise, blocks
+       * are decoded one after the other and subsampled.
+       */
+      virtual QImage preview (const QSize &bound) const;
+
+    private:
+      /// \brief The file.
+      std::unique_ptr<QFile> file;
+
+      /// \brief Content of the file.
+      const uchar* data;
+
+      /// \brief Layout of the image.
+      Tiff::Image image;
+
+      /// \brief Layout of pixels of blocks.
+      PixelFormat format;
+
+      /// \brief Reduced-resolution images stored in the file.
+      std::vector<Tiff::Image> overviews;
+
+      /// \brief Decoded blocks, by index.
+      mutable QCache<int, QImage> blocks;
+
+      /// \brief Protects the cache.
+      mutable QMutex mutex;
+
+      /**
+       * \brief Get a decoded block.
+       * \param column Column of the block.
+       * \param row Row of the block.
+       * \return Pixels of the block, inside the image.
+       */
+      QImage block (int column, int row) const;
+
+      /// \brief Copy is forbidden.
+      TiffImage (const TiffImage &);
+
+      /// \brief Copy is forbidden.
+      TiffImage &operator = (const TiffImage &);
+  };
+
+  /**
+   * \brief Function informed of the progress of a long operation.
+   *
+   * Arguments are the amount of work done and the total amount of work. The
+   * function returns false to interrupt the operation.
+   */
+  typedef std::function<bool (qint64, qint64)> Progress;
+
+  /**
+   * \brief Open an image file for region access.
+   * \param fileName Name of the file.
+   * \param progress Function informed of decoding progress.
+   * \param cacheName File where decoded pixels are kept between sessions,
+   * empty to decode into a temporary file.
+   * \return The source, or a null pointer if the file cannot be read or if
+   * decoding has been interrupted.
+   *
+   * Uncompressed BMP, PGM, PPM and TIFF files are mapped in memory, other
+   * TIFF files, including BigTIFF and tiled ones, are decoded block by block
+   * when read. Other files are mapped from the cache file when it exists.
+   * Otherwise, JPEG and PNG files are decoded row by row into the cache
+   * file, which is mapped in turn, and remaining files are entirely decoded
+   * in memory, then copied into the cache file if any.
+   */
+  SourcePointer open (const QString &fileName,
+                      const Progress &progress = Progress (),
+                      const QString &cacheName = QString ());
+
+  /**
+   * \brief Open an image file by mapping it in memory.
+   * \param fileName Name of the file.
+   * \return The source, or a null pointer if the file is neither an
+   * uncompressed BMP, PGM or PPM file nor a TIFF file supported by the
+   * native reader.
+   */
+  SourcePointer openMapped (const QString &fileName);
+
+  /// \brief Size of the header of cache files, before pixels.
+  const qint64 cacheHeaderSize = 16;
+
+  /**
+   * \brief Decode an image file row by row into a cache file.
+   * \param fileName Name of the file.
+   * \param progress Function informed of decoding progress.
+   * \param cacheName Cache file kept after the source is destroyed, empty
+   * for a temporary file.
+   * \return The source, mapping the cache file, or a null pointer if the
+   * file is not a JPEG or PNG file or if decoding has been interrupted.
+   */
+  SourcePointer openCached (const QString &fileName,
+                            const Progress &progress = Progress (),
+                            const QString &cacheName = QString ());
+
+  /**
+   * \brief Map a cache file written by a previous decoding.
+   * \param cacheName Name of the cache file.
+   * \return The source, or a null pointer if the file does not exist or is
+   * not a valid cache file.
+   */
+  SourcePointer openCache (const QString &cacheName);
+
+  /**
+   * \brief Write pixels of an image into a cache file.
+   * \param cacheName Name of the cache file.
+   * \param image The image.
+   * \return Whether or not the file has been written.
+   */
+  bool writeCache (const QString &cacheName, const QImage &image);
+
+  /**
+   * \brief Decode an image file directly at reduced resolution, when its
+   * format allows it.
+   * \param fileName Name of the file.
+   * \param reduction Denominator of the scale, 2, 4 or 8.
+   * \param size Where to store the size of the image at full resolution.
+   * \param averaged Where to store whether pixels are averages of the
+   * pixels they cover, rather than samples.
+   * \return The image, whose size is the one at full resolution divided by
+   * reduction and rounded up, or a null image if the format does not allow
+   * it.
+   *
+   * JPEG files are decoded by DCT scaling, with averaged pixels. Only the
+   * first pass of interlaced PNG files is decoded, when reduction is 8.
+   */
+  QImage readReduced (const QString &fileName, int reduction, QSize &size,
+                      bool &averaged);
+
+  /**
+   * \brief Decode an image file directly at low resolution, when its format
+   * allows it.
+   * \param fileName Name of the file.
+   * \param bound Maximum size of the result.
+   * \param size Where to store the size of the image at full resolution.
+   * \return The image fitting in bound, or a null image if the format does
+   * not support decoding at a reduced size.
+   *
+   * JPEG and interlaced PNG files are decoded by readReduced(), at the
+   * smallest scale still covering bound, other formats by the Qt plugin
+   * when it allows it.
+   */
+  QImage readPreview (const QString &fileName, const QSize &bound,
+                      QSize &size);
+}
+
+#endif  // #ifndef RASTER_HPP
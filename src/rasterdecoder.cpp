@@ -0,0 +1,419 @@
+/**
+ * \file rasterdecoder.cpp
+ * \brief Implementation of row by row image decoders.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ *
+ * Errors of libjpeg and libpng are reported through longjmp, hence objects
+ * living across setjmp are kept trivial.
+ */
+
+#include <config.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <csetjmp>
+#include <vector>
+
+#ifdef GEODESK_HAVE_JPEG
+#include <jpeglib.h>
+#endif  // #ifdef GEODESK_HAVE_JPEG
+
+#ifdef GEODESK_HAVE_PNG
+#include <png.h>
+#endif  // #ifdef GEODESK_HAVE_PNG
+
+#ifdef GEODESK_HAVE_ZLIB
+#include <zlib.h>
+#endif  // #ifdef GEODESK_HAVE_ZLIB
+
+#include "rasterdecoder.hpp"
+
+namespace {
+  /**
+   * \brief Build a pixel from its components.
+   * \param r Red component.
+   * \param g Green component.
+   * \param b Blue component.
+   * \return Pixel 0xffRRGGBB.
+   */
+  inline std::uint32_t rgb (unsigned r, unsigned g, unsigned b) {
+    return 0xff000000u | (r << 16) | (g << 8) | b;
+  }
+
+  /// \brief File closed when leaving scope.
+  class FileCloser {
+    public:
+      /**
+       * \brief Take the ownership of a file.
+       * \param _file The file, possibly null.
+       */
+      explicit FileCloser (std::FILE* _file): file (_file) {}
+
+      /// \brief Close the file.
+      ~FileCloser () {if (file) std::fclose(file);}
+
+      /// \brief Access to the file.
+      std::FILE* get () const {return file;}
+
+    private:
+      /// \brief The file.
+      std::FILE* file;
+
+      /// \brief Copy is forbidden.
+      FileCloser (const FileCloser &);
+
+      /// \brief Copy is forbidden.
+      FileCloser &operator = (const FileCloser &);
+  };
+
+#ifdef GEODESK_HAVE_JPEG
+  /// \brief Error manager of libjpeg jumping back to the decoder.
+  struct JpegError {
+    /// \brief Standard error manager.
+    jpeg_error_mgr manager;
+
+    /// \brief Where to jump on error.
+    std::jmp_buf jump;
+  };
+
+  /**
+   * \brief Handler of fatal libjpeg errors.
+   * \param info Decompression information.
+   */
+  void jpegErrorExit (j_common_ptr info) {
+    std::longjmp(reinterpret_cast<JpegError*>(info->err)->jump, 1);
+  }
+
+  /**
+   * \brief Decode an opened JPEG file.
+   * \param info Decompression information, with error manager set.
+   * \param writer Destination of decoded rows.
+   * \param reduction Denominator of the scale.
+   * \param buffer Buffer for a decoded row.
+   * \return Result of the decoding.
+   */
+  Raster::DecodeResult readJpeg (jpeg_decompress_struct &info,
+                                 Raster::RowWriter &writer, int reduction,
+                                 std::vector<JSAMPLE> &buffer) {
+    /* Number of components of the colour space. */
+    int components;
+    switch (info.jpeg_color_space) {
+      case JCS_GRAYSCALE:
+        info.out_color_space = JCS_GRAYSCALE;
+        components = 1;
+        break;
+      case JCS_CMYK:
+      case JCS_YCCK:
+        info.out_color_space = JCS_CMYK;
+        components = 4;
+        break;
+      default:
+        info.out_color_space = JCS_RGB;
+        components = 3;
+    }
+    if (reduction > 1) {
+      info.scale_num = 1;
+      info.scale_denom = static_cast<unsigned>(reduction);
+      writer.fullSize(static_cast<int>(info.image_width),
+                      static_cast<int>(info.image_height));
+    }
+    jpeg_start_decompress(&info);
+
+    if (!writer.start(static_cast<int>(info.output_width),
+                      static_cast<int>(info.output_height)))
+      return Raster::interrupted;
+
+    buffer.resize(static_cast<std::size_t>(info.output_width) * components);
+    while (info.output_scanline < info.output_height) {
+      /* Index of the row being decoded. */
+      const int y = static_cast<int>(info.output_scanline);
+      /* Pointer on the buffer, as expected by libjpeg. */
+      JSAMPROW samples = &buffer[0];
+      jpeg_read_scanlines(&info, &samples, 1);
+
+      /* Destination row. */
+      std::uint32_t* line = writer.row(y);
+      /* Current sample. */
+      const JSAMPLE* s = &buffer[0];
+      for (JDIMENSION x = 0; x < info.output_width; ++x, s += components) {
+        switch (components) {
+          case 1:
+            line[x] = rgb(s[0], s[0], s[0]);
+            break;
+          case 3:
+            line[x] = rgb(s[0], s[1], s[2]);
+            break;
+          default:
+            /* Adobe writes inverted CMYK. */
+            line[x] = rgb(s[0] * s[3] / 255u, s[1] * s[3] / 255u,
+                          s[2] * s[3] / 255u);
+        }
+      }
+
+      if (!writer.progress(y + 1, 0, 1)) return Raster::interrupted;
+    }
+
+    jpeg_finish_decompress(&info);
+    return Raster::decoded;
+  }
+#endif  // #ifdef GEODESK_HAVE_JPEG
+
+#ifdef GEODESK_HAVE_PNG
+  /**
+   * \brief Decode an opened PNG file.
+   * \param png Reading structure, with file set.
+   * \param pngInfo Information structure.
+   * \param writer Destination of decoded rows.
+   * \param firstPass Whether or not to only decode the first pass.
+   * \param buffer Buffer for a row of the first pass, which libpng writes
+   * as wide as a row of the image.
+   * \return Result of the decoding.
+   */
+  Raster::DecodeResult readPng (png_structp png, png_infop pngInfo,
+                                Raster::RowWriter &writer, bool firstPass,
+                                std::vector<png_byte> &buffer) {
+    png_read_info(png, pngInfo);
+
+    /* Width of the image. */
+    png_uint_32 width = png_get_image_width(png, pngInfo);
+    /* Height of the image. */
+    png_uint_32 height = png_get_image_height(png, pngInfo);
+    /* Colour type of the image. */
+    const int colourType = png_get_color_type(png, pngInfo);
+    if (firstPass
+        && (png_get_interlace_type(png, pngInfo) != PNG_INTERLACE_ADAM7))
+      return Raster::notSupported;
+
+    /* Everything is converted to 8 bits RGB, with alpha set to 0xff. */
+    png_set_expand(png);
+    png_set_strip_16(png);
+    if (colourType & PNG_COLOR_MASK_ALPHA) png_set_strip_alpha(png);
+    if ((colourType == PNG_COLOR_TYPE_GRAY)
+        || (colourType == PNG_COLOR_TYPE_GRAY_ALPHA))
+      png_set_gray_to_rgb(png);
+    /* Test of the byte order of the machine. */
+    const std::uint32_t one = 1;
+    if (*reinterpret_cast<const unsigned char*>(&one) == 1) {
+      png_set_bgr(png);
+      png_set_filler(png, 0xff, PNG_FILLER_AFTER);
+    }
+    else {
+      png_set_filler(png, 0xff, PNG_FILLER_BEFORE);
+    }
+    /*
+     * Without interlace handling, rows of the first pass come first, as a
+     * reduced image.
+     */
+    const int passes = firstPass? 1: png_set_interlace_handling(png);
+    png_read_update_info(png, pngInfo);
+    if (firstPass) {
+      buffer.resize(png_get_rowbytes(png, pngInfo));
+      writer.fullSize(static_cast<int>(width), static_cast<int>(height));
+      width = (width + 7) / 8;
+      height = (height + 7) / 8;
+    }
+
+    if (!writer.start(static_cast<int>(width), static_cast<int>(height)))
+      return Raster::interrupted;
+
+    for (int pass = 0; pass < passes; ++pass) {
+      for (png_uint_32 y = 0; y < height; ++y) {
+        /* Destination row. */
+        std::uint32_t* line = writer.row(static_cast<int>(y));
+        png_read_row(png, firstPass? &buffer[0]:
+                     reinterpret_cast<png_bytep>(line), 0);
+        if (firstPass) std::memcpy(line, &buffer[0], 4 * width);
+        if (!writer.progress(static_cast<int>(y) + 1, pass, passes))
+          return Raster::interrupted;
+      }
+    }
+
+    if (!firstPass) png_read_end(png, 0);
+    return Raster::decoded;
+  }
+#endif  // #ifdef GEODESK_HAVE_PNG
+}
+
+/* -- Decode a JPEG file. ------------------------------------------------- */
+Raster::DecodeResult Raster::decodeJpeg (const std::string &fileName,
+                                         RowWriter &writer, int reduction) {
+#ifdef GEODESK_HAVE_JPEG
+  /* The file itself. */
+  const FileCloser file (std::fopen(fileName.c_str(), "rb"));
+  if (!file.get()) return failed;
+
+  /* Signature of the file. */
+  unsigned char signature [3];
+  if ((std::fread(signature, 1, 3, file.get()) != 3)
+      || (signature[0] != 0xff) || (signature[1] != 0xd8)
+      || (signature[2] != 0xff))
+    return notSupported;
+  std::rewind(file.get());
+
+  /* Buffer for a decoded row. */
+  std::vector<JSAMPLE> buffer;
+  /* Decompression information. */
+  jpeg_decompress_struct info;
+  /* Error manager. */
+  JpegError error;
+  info.err = jpeg_std_error(&error.manager);
+  error.manager.error_exit = jpegErrorExit;
+  if (setjmp(error.jump)) {
+    jpeg_destroy_decompress(&info);
+    return failed;
+  }
+
+  jpeg_create_decompress(&info);
+  jpeg_stdio_src(&info, file.get());
+  jpeg_read_header(&info, TRUE);
+  /* Result of the decoding. */
+  const DecodeResult result = readJpeg(info, writer, reduction, buffer);
+  jpeg_destroy_decompress(&info);
+  return result;
+#else
+  (void) fileName;
+  (void) writer;
+  (void) reduction;
+  return notSupported;
+#endif  // #ifdef GEODESK_HAVE_JPEG
+}
+
+/* -- Decode a PNG file. -------------------------------------------------- */
+Raster::DecodeResult Raster::decodePng (const std::string &fileName,
+                                        RowWriter &writer, bool firstPass) {
+#ifdef GEODESK_HAVE_PNG
+  /* The file itself. */
+  const FileCloser file (std::fopen(fileName.c_str(), "rb"));
+  if (!file.get()) return failed;
+
+  /* Signature of the file. */
+  png_byte signature [8];
+  if ((std::fread(signature, 1, 8, file.get()) != 8)
+      || png_sig_cmp(signature, 0, 8))
+    return notSupported;
+
+  /* Buffer for a row of the first pass. */
+  std::vector<png_byte> buffer;
+  /* Reading structure. */
+  png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
+  if (!png) return failed;
+  /* Information structure. */
+  png_infop pngInfo = png_create_info_struct(png);
+  if (!pngInfo) {
+    png_destroy_read_struct(&png, 0, 0);
+    return failed;
+  }
+  if (setjmp(png_jmpbuf(png))) {
+    png_destroy_read_struct(&png, &pngInfo, 0);
+    return failed;
+  }
+
+  png_init_io(png, file.get());
+  png_set_sig_bytes(png, 8);
+  /* Result of the decoding. */
+  const DecodeResult result =
+    readPng(png, pngInfo, writer, firstPass, buffer);
+  png_destroy_read_struct(&png, &pngInfo, 0);
+  return result;
+#else
+  (void) fileName;
+  (void) writer;
+  (void) firstPass;
+  return notSupported;
+#endif  // #ifdef GEODESK_HAVE_PNG
+}
+
+/* -- Decode a JPEG stream held in memory. -------------------------------- */
+Raster::DecodeResult Raster::decodeJpegStream (const unsigned char* data,
+                                               std::size_t size,
+                                               const unsigned char* tables,
+                                               std::size_t tablesSize,
+                                               bool rgbStored,
+                                               int components, int width,
+                                               int height,
+                                               unsigned char* pixels) {
+#ifdef GEODESK_HAVE_JPEG
+  /* Decompression information. */
+  jpeg_decompress_struct info;
+  /* Error manager. */
+  JpegError error;
+  info.err = jpeg_std_error(&error.manager);
+  error.manager.error_exit = jpegErrorExit;
+  if (setjmp(error.jump)) {
+    jpeg_destroy_decompress(&info);
+    return failed;
+  }
+
+  jpeg_create_decompress(&info);
+  /* Tables shared by every stream are read first. */
+  if (tables && (tablesSize > 0)) {
+    jpeg_mem_src(&info, const_cast<unsigned char*>(tables),
+                 static_cast<unsigned long>(tablesSize));
+    jpeg_read_header(&info, FALSE);
+  }
+  jpeg_mem_src(&info, const_cast<unsigned char*>(data),
+               static_cast<unsigned long>(size));
+  jpeg_read_header(&info, TRUE);
+  if (rgbStored) info.jpeg_color_space = JCS_RGB;
+  info.out_color_space = (components == 1)? JCS_GRAYSCALE: JCS_RGB;
+  jpeg_start_decompress(&info);
+  if ((info.output_components != components)
+      || (info.output_width > static_cast<JDIMENSION>(width))) {
+    jpeg_destroy_decompress(&info);
+    return failed;
+  }
+
+  while ((info.output_scanline < info.output_height)
+         && (info.output_scanline < static_cast<JDIMENSION>(height))) {
+    /* Row where samples are decoded. */
+    JSAMPROW samples = pixels + static_cast<std::size_t>(info.output_scanline)
+      * width * components;
+    jpeg_read_scanlines(&info, &samples, 1);
+  }
+  jpeg_destroy_decompress(&info);
+  return decoded;
+#else
+  (void) data;
+  (void) size;
+  (void) tables;
+  (void) tablesSize;
+  (void) rgbStored;
+  (void) components;
+  (void) width;
+  (void) height;
+  (void) pixels;
+  return notSupported;
+#endif  // #ifdef GEODESK_HAVE_JPEG
+}
+
+/* -- Inflate data compressed by zlib. ------------------------------------ */
+Raster::DecodeResult Raster::decodeDeflate (const unsigned char* data,
+                                            std::size_t size,
+                                            unsigned char* pixels,
+                                            std::size_t expected) {
+#ifdef GEODESK_HAVE_ZLIB
+  /* State of the decompression. */
+  z_stream stream;
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+  stream.next_in = const_cast<Bytef*>(data);
+  stream.avail_in = static_cast<uInt>(size);
+  if (inflateInit(&stream) != Z_OK) return failed;
+  stream.next_out = pixels;
+  stream.avail_out = static_cast<uInt>(expected);
+  /* Status of the decompression. */
+  const int status = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+  return ((status == Z_STREAM_END) || (stream.avail_out == 0))?
+    decoded: failed;
+#else
+  (void) data;
+  (void) size;
+  (void) pixels;
+  (void) expected;
+  return notSupported;
+#endif  // #ifdef GEODESK_HAVE_ZLIB
+}
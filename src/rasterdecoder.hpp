@@ -0,0 +1,152 @@
+#ifndef RASTERDECODER_HPP
+#define RASTERDECODER_HPP
+
+/**
+ * \file rasterdecoder.hpp
+ * \brief Decoding compressed images row by row, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// \brief Namespace for raster images access.
+namespace Raster {
+  /**
+   * \brief Destination of decoded rows.
+   *
+   * Pixels are 32 bits values 0xffRRGGBB, in the byte order of the machine,
+   * which is the layout of QImage::Format_RGB32.
+   */
+  class RowWriter {
+    public:
+      /// \brief Destructor.
+      virtual ~RowWriter () {}
+
+      /**
+       * \brief Called once the size of the image is known.
+       * \param width Width of the image.
+       * \param height Height of the image.
+       * \return Whether or not decoding should go on.
+       */
+      virtual bool start (int width, int height) = 0;
+
+      /**
+       * \brief Called before start() when the image is decoded at reduced
+       * resolution.
+       * \param width Width of the image at full resolution.
+       * \param height Height of the image at full resolution.
+       */
+      virtual void fullSize (int width, int height) {
+        (void) width;
+        (void) height;
+      }
+
+      /**
+       * \brief Access to a row of the destination.
+       * \param y Index of the row.
+       * \return Storage of the row, which keeps its content when accessed
+       * again, for images decoded in several passes.
+       */
+      virtual std::uint32_t* row (int y) = 0;
+
+      /**
+       * \brief Called when rows have been decoded.
+       * \param rows Number of rows decoded so far, in the current pass.
+       * \param pass Index of the current pass.
+       * \param passes Number of passes.
+       * \return Whether or not decoding should go on.
+       */
+      virtual bool progress (int rows, int pass, int passes) {
+        (void) rows;
+        (void) pass;
+        (void) passes;
+        return true;
+      }
+  };
+
+  /// \brief Result of a decoding.
+  enum DecodeResult {
+    /// \brief The image has been decoded.
+    decoded,
+    /// \brief The file is not in the format of the decoder.
+    notSupported,
+    /// \brief The file is corrupted or cannot be read.
+    failed,
+    /// \brief Decoding has been interrupted by the row writer.
+    interrupted
+  };
+
+  /// \brief Largest reduction of the resolution at decoding.
+  const int maximumReduction = 8;
+
+  /**
+   * \brief Decode a JPEG file row by row.
+   * \param fileName Name of the file.
+   * \param writer Destination of decoded rows.
+   * \param reduction Denominator of the scale, 1, 2, 4 or 8: the image is
+   * decoded at its size divided by reduction, rounded up.
+   * \return Result of the decoding.
+   *
+   * Reduction is done by DCT scaling: each pixel is the average of the
+   * pixels it covers, and most of the inverse transform is skipped.
+   */
+  DecodeResult decodeJpeg (const std::string &fileName, RowWriter &writer,
+                           int reduction = 1);
+
+  /**
+   * \brief Decode a PNG file row by row.
+   * \param fileName Name of the file.
+   * \param writer Destination of decoded rows.
+   * \param firstPass Whether or not to only decode the first pass of an
+   * interlaced image, which holds one pixel out of 8 in each direction.
+   * \return Result of the decoding, notSupported if only the first pass is
+   * asked for an image which is not interlaced.
+   *
+   * Interlaced images are decoded pass after pass into the same rows. Their
+   * first pass is the first 64th of the data, and gives the image at its
+   * size divided by 8, rounded up.
+   */
+  DecodeResult decodePng (const std::string &fileName, RowWriter &writer,
+                          bool firstPass = false);
+
+  /**
+   * \brief Decode a JPEG stream held in memory, such as a tile of a TIFF
+   * file.
+   * \param data The stream.
+   * \param size Size of the stream.
+   * \param tables Tables shared by several streams, null if none.
+   * \param tablesSize Size of tables.
+   * \param rgbStored Whether components are stored as RGB rather than
+   * YCbCr.
+   * \param components Number of components decoded, 1 or 3.
+   * \param width Number of pixels of a row of the destination.
+   * \param height Number of rows of the destination.
+   * \param pixels Destination of samples, rows after rows; rows beyond the
+   * stream are left as they are.
+   * \return Result of the decoding, notSupported without libjpeg.
+   */
+  DecodeResult decodeJpegStream (const unsigned char* data,
+                                 std::size_t size,
+                                 const unsigned char* tables,
+                                 std::size_t tablesSize, bool rgbStored,
+                                 int components, int width, int height,
+                                 unsigned char* pixels);
+
+  /**
+   * \brief Inflate data compressed by zlib ("Deflate").
+   * \param data Compressed data.
+   * \param size Size of compressed data.
+   * \param pixels Destination of inflated data.
+   * \param expected Size of the destination.
+   * \return Result of the decoding, notSupported without zlib.
+   */
+  DecodeResult decodeDeflate (const unsigned char* data, std::size_t size,
+                              unsigned char* pixels, std::size_t expected);
+}
+
+#endif  // #ifndef RASTERDECODER_HPP
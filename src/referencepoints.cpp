@@ -0,0 +1,92 @@
+/**
+ * \file referencepoints.cpp
+ * \brief Implementation of reference points.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <stdexcept>
+
+#include "referencepoints.hpp"
+#include "numberreader.hpp"
+
+/* -- Change the map projection. ------------------------------------------ */
+void Projection::ReferencePoints::setProjection (const MapProjectionPointer
+                                                   &_projection) {
+  projection_ = _projection;
+  affineFit.clear();
+  for (std::size_t i = 0; i < list.size(); ++i)
+    affineFit.add(list[i].first, plane(list[i].second));
+}
+
+/* -- Residual of each reference point. ----------------------------------- */
+std::vector<double>
+Projection::ReferencePoints::residuals (const ChangeMatrix &change) const {
+  /* Residual of each point. */
+  std::vector<double> result (list.size());
+  for (std::size_t i = 0; i < list.size(); ++i) {
+    /* Reference point converted. */
+    const Point2D p = transformPoint(change, list[i].first);
+    /* Expected position. */
+    const Point2D q = plane(list[i].second);
+    result[i] = std::sqrt((p.x() - q.x()) * (p.x() - q.x())
+                          + (p.y() - q.y()) * (p.y() - q.y()));
+  }
+  return result;
+}
+
+/* -- Replace reference points by the ones of a file. --------------------- */
+void Projection::ReferencePoints::read (const std::string &fileName) {
+  /* The file itself. */
+  std::ifstream file (fileName.c_str());
+  if (!file)
+    throw std::runtime_error("Reference point file \"" + fileName
+                             + "\" cannot be opened.");
+
+  /* Reference points in the file. */
+  ReferencePoints points;
+  points.setProjection(projection_);
+  /* Reader of numbers in the file. */
+  Text::NumberReader reader (file);
+  try {
+    while (!reader.atEnd()) {
+      /* Point coordinates in image referential. */
+      Point2D image;
+      /* Point coordinates in geographical referential. */
+      Point2D geographic;
+      image.x() = reader.number();
+      image.y() = reader.number();
+      geographic.x() = reader.number();
+      geographic.y() = reader.number();
+      reader.endLine();
+      points.add(image, geographic);
+    }
+  }
+  catch (const Text::ParseError &error) {
+    throw std::runtime_error("Reference point file \"" + fileName + "\": "
+                             + error.what());
+  }
+  *this = points;
+}
+
+/* -- Write reference points in a file. ----------------------------------- */
+void Projection::ReferencePoints::write (const std::string &fileName) const {
+  /* The file itself. */
+  std::ofstream file (fileName.c_str(),
+                      std::ios_base::out | std::ios_base::trunc);
+  if (!file)
+    throw std::runtime_error("Reference point file \"" + fileName
+                             + "\" cannot be opened.");
+  file.precision(std::numeric_limits<double>::max_digits10);
+  for (std::size_t i = 0; i < list.size(); ++i)
+    file << list[i].first.x() << ' ' << list[i].first.y() << ' '
+         << list[i].second.x() << ' ' << list[i].second.y() << '\n';
+  file.close();
+  if (!file)
+    throw std::runtime_error("Reference point file \"" + fileName
+                             + "\" cannot be written.");
+}
@@ -0,0 +1,143 @@
+#ifndef REFERENCEPOINTS_HPP
+#define REFERENCEPOINTS_HPP
+
+/**
+ * \file referencepoints.hpp
+ * \brief Reference points used to geo-reference an image, independently
+ * from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "projection.hpp"
+#include "mapprojection.hpp"
+
+/// \brief Namespace for projection computations.
+namespace Projection {
+  /**
+   * \brief Reference points, each one given both in image and geographical
+   * coordinates, with the least-squares fit of the affine transformation
+   * they define.
+   *
+   * When a map projection is set, the affine transformation is fitted from
+   * the image to the plane of the projection, geographical coordinates of
+   * reference points being projected.
+   *
+   * Reference point files contain one point by line, as
+   * "x y longitude latitude".
+   */
+  class ReferencePoints {
+    public:
+      /// \brief Type for a reference point, image then geographical.
+      typedef std::pair<Point2D, Point2D> Point;
+
+      /// \brief Construct an empty set of reference points.
+      ReferencePoints () {}
+
+      /// \brief Reference points, in the order they were given.
+      const std::vector<Point> &points () const {return list;}
+
+      /// \brief Number of reference points.
+      std::size_t size () const {return list.size();}
+
+      /// \brief Whether or not there is no reference point.
+      bool empty () const {return list.empty();}
+
+      /// \brief Least-squares fit on reference points.
+      const AffineFit &fit () const {return affineFit;}
+
+      /**
+       * \brief Add a reference point.
+       * \param image Point coordinates in image referential.
+       * \param geographic Point coordinates in geographical referential.
+       */
+      void add (const Point2D &image, const Point2D &geographic) {
+        list.push_back(std::make_pair(image, geographic));
+        affineFit.add(image, plane(geographic));
+      }
+
+      /// \brief Remove the last reference point, if any.
+      void removeLast () {
+        if (list.empty()) return;
+        affineFit.remove(list.back().first, plane(list.back().second));
+        list.pop_back();
+      }
+
+      /// \brief Remove every reference point.
+      void clear () {
+        list.clear();
+        affineFit.clear();
+      }
+
+      /// \brief Map projection, null for geographical coordinates.
+      const MapProjectionPointer &projection () const {return projection_;}
+
+      /**
+       * \brief Change the map projection, fitting reference points again.
+       * \param _projection The projection, null for geographical
+       * coordinates.
+       */
+      void setProjection (const MapProjectionPointer &_projection);
+
+      /**
+       * \brief Matrix of referential change fitted on reference points,
+       * to the plane of the map projection.
+       * \exception std::domain_error Reference points do not define an
+       * affine transformation.
+       */
+      ChangeMatrix change () const {
+        return affineFit.coefficients().transpose();
+      }
+
+      /**
+       * \brief Residual of each reference point.
+       * \param change Matrix of referential change.
+       * \return Distance between each reference point and its converted
+       * position, in units of the plane of the map projection.
+       */
+      std::vector<double> residuals (const ChangeMatrix &change) const;
+
+      /**
+       * \brief Replace reference points by the ones of a file.
+       * \param fileName Name of the reference point file.
+       * \exception std::runtime_error The file cannot be opened or is
+       * invalid, in which case reference points are left unchanged.
+       */
+      void read (const std::string &fileName);
+
+      /**
+       * \brief Write reference points in a file.
+       * \param fileName Name of the reference point file.
+       * \exception std::runtime_error The file cannot be written.
+       */
+      void write (const std::string &fileName) const;
+
+    private:
+      /// \brief Reference points.
+      std::vector<Point> list;
+
+      /// \brief Least-squares fit on reference points.
+      AffineFit affineFit;
+
+      /// \brief Map projection, null for geographical coordinates.
+      MapProjectionPointer projection_;
+
+      /**
+       * \brief Position of a point in the plane of the map projection.
+       * \param geographic Geographical coordinates of the point.
+       */
+      Point2D plane (const Point2D &geographic) const {
+        return projection_? projection_->forwardPoint(geographic):
+          geographic;
+      }
+  };
+}
+
+#endif  // #ifndef REFERENCEPOINTS_HPP
@@ -0,0 +1,68 @@
+#ifndef SAMPLE_HPP
+#define SAMPLE_HPP
+
+/**
+ * \file sample.hpp
+ * \brief Geo-referenced data set by the user, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <ostream>
+#include <limits>
+
+#include "numberreader.hpp"
+
+/// \brief Namespace for geo-referenced data.
+namespace Data {
+  /// \brief A value given at a location of the image.
+  struct Sample {
+    /// \brief Abscissa in the image.
+    double x;
+
+    /// \brief Ordinate in the image.
+    double y;
+
+    /// \brief Longitude in decimal degrees east.
+    double longitude;
+
+    /// \brief Latitude in decimal degrees north.
+    double latitude;
+
+    /// \brief Value at the location, in meters.
+    double value;
+  };
+
+  /**
+   * \brief Write a sample as a line "x y longitude latitude value".
+   * \param stream Stream where the sample is written.
+   * \param sample The sample.
+   */
+  inline void writeSample (std::ostream &stream, const Sample &sample) {
+    /* Previous precision of the stream. */
+    const std::streamsize precision =
+      stream.precision(std::numeric_limits<double>::max_digits10);
+    stream << sample.x << ' ' << sample.y << ' ' << sample.longitude << ' '
+           << sample.latitude << ' ' << sample.value << '\n';
+    stream.precision(precision);
+  }
+
+  /**
+   * \brief Read a sample written by writeSample(), without going to the
+   * next line.
+   * \param reader Reader of the text file.
+   * \param sample Where to put the sample.
+   * \exception Text::ParseError The line does not begin with five numbers.
+   */
+  inline void readSample (Text::NumberReader &reader, Sample &sample) {
+    sample.x = reader.number();
+    sample.y = reader.number();
+    sample.longitude = reader.number();
+    sample.latitude = reader.number();
+    sample.value = reader.number();
+  }
+}
+
+#endif  // #ifndef SAMPLE_HPP
@@ -0,0 +1,283 @@
+/**
+ * \file sampleindex.cpp
+ * \brief Implementation of the spatial index over geo-referenced data.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "sampleindex.hpp"
+
+const std::size_t Data::SampleIndex::none;
+const int Data::SampleIndex::Grid::maximumBuckets;
+
+namespace {
+  /**
+   * \brief Compare indices of samples by value.
+   */
+  class ByValue {
+    public:
+      /**
+       * \brief Construct the comparison.
+       * \param _values Value of each sample.
+       */
+      explicit ByValue (const std::vector<double> &_values):
+        values (_values) {}
+
+      /// \brief Whether the first sample comes before the second one.
+      bool operator () (std::size_t a, std::size_t b) const {
+        return values[a] < values[b] || (values[a] == values[b] && a < b);
+      }
+
+    private:
+      /// \brief Value of each sample.
+      const std::vector<double> &values;
+  };
+}
+
+/* -- Set buckets covering samples. --------------------------------------- */
+void Data::SampleIndex::coverSamples (Grid &grid,
+                                      const std::vector<Sample> &samples,
+                                      double Sample::*x, double Sample::*y) {
+  /* Smallest abscissa. */
+  double xMin = 0.;
+  /* Greatest abscissa. */
+  double xMax = 0.;
+  /* Smallest ordinate. */
+  double yMin = 0.;
+  /* Greatest ordinate. */
+  double yMax = 0.;
+  /* Whether a finite position has been found. */
+  bool found = false;
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    /* Abscissa of the sample. */
+    const double sx = samples[i].*x;
+    /* Ordinate of the sample. */
+    const double sy = samples[i].*y;
+    if (!std::isfinite(sx) || !std::isfinite(sy)) continue;
+    if (found) {
+      xMin = std::min(xMin, sx);
+      xMax = std::max(xMax, sx);
+      yMin = std::min(yMin, sy);
+      yMax = std::max(yMax, sy);
+    }
+    else {
+      xMin = xMax = sx;
+      yMin = yMax = sy;
+      found = true;
+    }
+  }
+  if (found) grid.cover(xMin, yMin, xMax, yMax);
+}
+
+/* -- Index samples. ------------------------------------------------------ */
+void Data::SampleIndex::assign (const std::vector<Sample> &samples) {
+  image.clear();
+  geographic.clear();
+  values.clear();
+  byValue.clear();
+  sorted = true;
+  if (samples.empty()) return;
+
+  coverSamples(image, samples, &Sample::x, &Sample::y);
+  coverSamples(geographic, samples, &Sample::longitude, &Sample::latitude);
+  values.reserve(samples.size());
+  for (std::size_t i = 0; i < samples.size(); ++i) add(samples[i]);
+}
+
+/* -- Add a sample. ------------------------------------------------------- */
+void Data::SampleIndex::add (const Sample &sample) {
+  /* Index of the sample. */
+  const std::size_t index = values.size();
+  image.add(sample.x, sample.y, index);
+  geographic.add(sample.longitude, sample.latitude, index);
+  values.push_back(sample.value);
+  if (sorted) {
+    if (byValue.empty() || !ByValue (values)(index, byValue.back()))
+      byValue.push_back(index);
+    else
+      sorted = false;
+  }
+}
+
+/* -- Update a sample. ---------------------------------------------------- */
+void Data::SampleIndex::replace (std::size_t index, const Sample &previous,
+                                 const Sample &sample) {
+  image.remove(previous.x, previous.y, index);
+  image.add(sample.x, sample.y, index);
+  geographic.remove(previous.longitude, previous.latitude, index);
+  geographic.add(sample.longitude, sample.latitude, index);
+  if (values[index] != sample.value) {
+    values[index] = sample.value;
+    sorted = false;
+  }
+}
+
+/* -- Find the sample nearest to a position. ------------------------------ */
+std::size_t Data::SampleIndex::nearest (Space space, double x, double y,
+                                        double distance) const {
+  return (space == imageSpace? image: geographic).nearest(x, y, distance);
+}
+
+/* -- Find samples in a box. ---------------------------------------------- */
+std::vector<std::size_t> Data::SampleIndex::inBox (Space space, double xMin,
+                                                   double yMin, double xMax,
+                                                   double yMax) const {
+  /* Indices of samples found. */
+  std::vector<std::size_t> result;
+  (space == imageSpace? image: geographic).inBox(xMin, yMin, xMax, yMax,
+                                                 result);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+/* -- Find samples whose value is in a range. ----------------------------- */
+std::vector<std::size_t> Data::SampleIndex::inRange (double minimum,
+                                                     double maximum) const {
+  if (!sorted) {
+    byValue.resize(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) byValue[i] = i;
+    std::sort(byValue.begin(), byValue.end(), ByValue (values));
+    sorted = true;
+  }
+  /* Indices of samples found. */
+  std::vector<std::size_t> result;
+  /* First sample whose value is not below the minimum. */
+  std::vector<std::size_t>::const_iterator i = byValue.begin();
+  /* Number of samples left to search. */
+  std::ptrdiff_t count = byValue.end() - i;
+  while (count > 0) {
+    /* Half of the samples left. */
+    const std::ptrdiff_t half = count / 2;
+    if (values[i[half]] < minimum) {
+      i += half + 1;
+      count -= half + 1;
+    }
+    else count = half;
+  }
+  for (; i != byValue.end() && values[*i] <= maximum; ++i)
+    result.push_back(*i);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+/* -- Set buckets covering an area. --------------------------------------- */
+void Data::SampleIndex::Grid::cover (double xMin, double yMin, double xMax,
+                                     double yMax) {
+  /* Greatest side of the area. */
+  const double extent = std::max(xMax - xMin, yMax - yMin);
+  size = std::max(minimumSize, extent / maximumBuckets);
+  left = xMin;
+  top = yMin;
+  columns = static_cast<int>((xMax - xMin) / size) + 1;
+  rows = static_cast<int>((yMax - yMin) / size) + 1;
+  buckets.assign(static_cast<std::size_t>(columns) * rows,
+                 std::vector<Entry> ());
+}
+
+/* -- Add a position. ----------------------------------------------------- */
+void Data::SampleIndex::Grid::add (double x, double y, std::size_t index) {
+  if (!std::isfinite(x) || !std::isfinite(y)) return;
+  if (buckets.empty()) {
+    cover(x, y, x, y);
+  }
+  else if (x < left || y < top || x > left + columns * size
+           || y > top + rows * size) {
+    /* Positions already in the grid. */
+    std::vector<Entry> entries;
+    for (std::size_t i = 0; i < buckets.size(); ++i)
+      entries.insert(entries.end(), buckets[i].begin(), buckets[i].end());
+    /* Width of the current area. */
+    const double width = columns * size;
+    /* Height of the current area. */
+    const double height = rows * size;
+    /*
+     * The area is doubled at least, so that adding positions one after the
+     * other only redistributes them a few times.
+     */
+    cover(std::min(x, left - .5 * width), std::min(y, top - .5 * height),
+          std::max(x, left + 1.5 * width), std::max(y, top + 1.5 * height));
+    for (std::size_t i = 0; i < entries.size(); ++i)
+      buckets[row(entries[i].y) * columns
+              + column(entries[i].x)].push_back(entries[i]);
+  }
+  /* The new position. */
+  const Entry entry = {x, y, index};
+  buckets[row(y) * columns + column(x)].push_back(entry);
+}
+
+/* -- Remove a position. -------------------------------------------------- */
+void Data::SampleIndex::Grid::remove (double x, double y, std::size_t index) {
+  if (buckets.empty() || !std::isfinite(x) || !std::isfinite(y)) return;
+  /* Bucket of the position. */
+  std::vector<Entry> &bucket = buckets[row(y) * columns + column(x)];
+  for (std::size_t k = 0; k < bucket.size(); ++k)
+    if (bucket[k].index == index) {
+      bucket[k] = bucket.back();
+      bucket.pop_back();
+      return;
+    }
+}
+
+/* -- Find the position nearest to another one. --------------------------- */
+std::size_t Data::SampleIndex::Grid::nearest (double x, double y,
+                                              double distance) const {
+  /* Index of the nearest sample found. */
+  std::size_t result = none;
+  if (buckets.empty() || !(distance >= 0.)) return result;
+  /* Square of the distance of the nearest sample found. */
+  double best = distance * distance;
+  /* First column of buckets searched. */
+  const int firstColumn = column(x - distance);
+  /* Last column of buckets searched. */
+  const int lastColumn = column(x + distance);
+  /* First row of buckets searched. */
+  const int firstRow = row(y - distance);
+  /* Last row of buckets searched. */
+  const int lastRow = row(y + distance);
+  for (int j = firstRow; j <= lastRow; ++j)
+    for (int i = firstColumn; i <= lastColumn; ++i) {
+      /* The bucket. */
+      const std::vector<Entry> &bucket = buckets[j * columns + i];
+      for (std::size_t k = 0; k < bucket.size(); ++k) {
+        /* Difference of abscissae. */
+        const double dx = bucket[k].x - x;
+        /* Difference of ordinates. */
+        const double dy = bucket[k].y - y;
+        /* Square of the distance. */
+        const double d2 = dx * dx + dy * dy;
+        if (d2 < best || (d2 == best && bucket[k].index < result)) {
+          best = d2;
+          result = bucket[k].index;
+        }
+      }
+    }
+  return result;
+}
+
+/* -- Find positions in a box. -------------------------------------------- */
+void Data::SampleIndex::Grid::inBox (double xMin, double yMin, double xMax,
+                                     double yMax,
+                                     std::vector<std::size_t> &result) const {
+  if (buckets.empty()) return;
+  /* First column of buckets in the box. */
+  const int firstColumn = column(xMin);
+  /* Last column of buckets in the box. */
+  const int lastColumn = column(xMax);
+  /* First row of buckets in the box. */
+  const int firstRow = row(yMin);
+  /* Last row of buckets in the box. */
+  const int lastRow = row(yMax);
+  for (int j = firstRow; j <= lastRow; ++j)
+    for (int i = firstColumn; i <= lastColumn; ++i) {
+      /* The bucket. */
+      const std::vector<Entry> &bucket = buckets[j * columns + i];
+      for (std::size_t k = 0; k < bucket.size(); ++k)
+        if (bucket[k].x >= xMin && bucket[k].x <= xMax
+            && bucket[k].y >= yMin && bucket[k].y <= yMax)
+          result.push_back(bucket[k].index);
+    }
+}
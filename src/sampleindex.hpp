@@ -0,0 +1,257 @@
+#ifndef SAMPLEINDEX_HPP
+#define SAMPLEINDEX_HPP
+
+/**
+ * \file sampleindex.hpp
+ * \brief Spatial index over geo-referenced data, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "sample.hpp"
+
+/// \brief Namespace for geo-referenced data.
+namespace Data {
+  /**
+   * \brief Index of samples by position, both in the image and
+   * geographical, and by value.
+   *
+   * Positions are sorted into uniform grids of buckets, which cover the
+   * bounding box of samples and grow as samples are added. Samples are
+   * identified by their index in the vector given.
+   */
+  class SampleIndex {
+    public:
+      /// \brief Coordinates queries are given in.
+      enum Space {
+        /// \brief Image coordinates, in pixels.
+        imageSpace,
+
+        /// \brief Geographical coordinates, in decimal degrees.
+        geographicSpace
+      };
+
+      /// \brief Index returned when no sample is found.
+      static const std::size_t none = static_cast<std::size_t>(-1);
+
+      /// \brief Construct an empty index.
+      SampleIndex (): image (16.), geographic (1e-6), sorted (true) {}
+
+      /// \brief Number of samples.
+      std::size_t size () const {return values.size();}
+
+      /**
+       * \brief Index samples.
+       * \param samples The samples.
+       */
+      void assign (const std::vector<Sample> &samples);
+
+      /**
+       * \brief Add a sample, whose index is the number of samples before.
+       * \param sample The sample.
+       */
+      void add (const Sample &sample);
+
+      /**
+       * \brief Update a sample which has been moved or changed.
+       * \param index Index of the sample.
+       * \param previous The sample as it was indexed.
+       * \param sample The sample as it is now.
+       */
+      void replace (std::size_t index, const Sample &previous,
+                    const Sample &sample);
+
+      /**
+       * \brief Find the sample nearest to a position.
+       * \param space Coordinates of the position.
+       * \param x Abscissa or longitude.
+       * \param y Ordinate or latitude.
+       * \param distance Greatest distance of the sample.
+       * \return Index of the sample, none if no sample is close enough.
+       */
+      std::size_t nearest (Space space, double x, double y,
+                           double distance) const;
+
+      /**
+       * \brief Find samples in a box.
+       * \param space Coordinates of the box.
+       * \param xMin Smallest abscissa or longitude.
+       * \param yMin Smallest ordinate or latitude.
+       * \param xMax Greatest abscissa or longitude.
+       * \param yMax Greatest ordinate or latitude.
+       * \return Indices of samples, in increasing order.
+       */
+      std::vector<std::size_t> inBox (Space space, double xMin, double yMin,
+                                      double xMax, double yMax) const;
+
+      /**
+       * \brief Find samples whose value is in a range.
+       * \param minimum Smallest value.
+       * \param maximum Greatest value.
+       * \return Indices of samples, in increasing order.
+       */
+      std::vector<std::size_t> inRange (double minimum,
+                                        double maximum) const;
+
+    private:
+      /// \brief Uniform grid of buckets of positions.
+      class Grid {
+        public:
+          /// \brief Greatest number of buckets along each axis.
+          static const int maximumBuckets = 256;
+
+          /**
+           * \brief Construct an empty grid.
+           * \param _minimumSize Smallest side of buckets.
+           */
+          explicit Grid (double _minimumSize):
+            minimumSize (_minimumSize), left (0.), top (0.), size (1.),
+            columns (0), rows (0) {}
+
+          /// \brief Remove every position.
+          void clear () {
+            buckets.clear();
+            columns = rows = 0;
+          }
+
+          /**
+           * \brief Set buckets covering an area, emptied.
+           * \param xMin Left side of the area.
+           * \param yMin Top side of the area.
+           * \param xMax Right side of the area.
+           * \param yMax Bottom side of the area.
+           */
+          void cover (double xMin, double yMin, double xMax, double yMax);
+
+          /**
+           * \brief Add a position, growing the grid if needed.
+           * \param x Abscissa.
+           * \param y Ordinate.
+           * \param index Index of the sample.
+           */
+          void add (double x, double y, std::size_t index);
+
+          /**
+           * \brief Remove a position.
+           * \param x Abscissa.
+           * \param y Ordinate.
+           * \param index Index of the sample.
+           */
+          void remove (double x, double y, std::size_t index);
+
+          /**
+           * \brief Find the position nearest to another one.
+           * \param x Abscissa.
+           * \param y Ordinate.
+           * \param distance Greatest distance.
+           * \return Index of the sample, none if no sample is close
+           * enough.
+           */
+          std::size_t nearest (double x, double y, double distance) const;
+
+          /**
+           * \brief Find positions in a box.
+           * \param xMin Smallest abscissa.
+           * \param yMin Smallest ordinate.
+           * \param xMax Greatest abscissa.
+           * \param yMax Greatest ordinate.
+           * \param result Where indices of samples are added.
+           */
+          void inBox (double xMin, double yMin, double xMax, double yMax,
+                      std::vector<std::size_t> &result) const;
+
+        private:
+          /// \brief Position of a sample.
+          struct Entry {
+            /// \brief Abscissa.
+            double x;
+
+            /// \brief Ordinate.
+            double y;
+
+            /// \brief Index of the sample.
+            std::size_t index;
+          };
+
+          /// \brief Smallest side of buckets.
+          double minimumSize;
+
+          /// \brief Abscissa of the left side of buckets.
+          double left;
+
+          /// \brief Ordinate of the top side of buckets.
+          double top;
+
+          /// \brief Side of buckets.
+          double size;
+
+          /// \brief Number of buckets along abscissae.
+          int columns;
+
+          /// \brief Number of buckets along ordinates.
+          int rows;
+
+          /// \brief Buckets, row by row.
+          std::vector< std::vector<Entry> > buckets;
+
+          /**
+           * \brief Column of buckets containing an abscissa, the nearest
+           * one outside buckets.
+           * \param x The abscissa.
+           */
+          int column (double x) const {return clamp((x - left) / size,
+                                                    columns);}
+
+          /**
+           * \brief Row of buckets containing an ordinate, the nearest one
+           * outside buckets.
+           * \param y The ordinate.
+           */
+          int row (double y) const {return clamp((y - top) / size, rows);}
+
+          /**
+           * \brief Index in [0, n - 1] nearest to a position.
+           * \param f Position, in buckets.
+           * \param n Number of buckets.
+           */
+          static int clamp (double f, int n) {
+            if (!(f > 0.)) return 0;
+            if (f >= n) return n - 1;
+            return static_cast<int>(f);
+          }
+      };
+
+      /// \brief Positions in the image.
+      Grid image;
+
+      /// \brief Geographical positions.
+      Grid geographic;
+
+      /// \brief Value of each sample.
+      std::vector<double> values;
+
+      /// \brief Indices of samples sorted by value, when up to date.
+      mutable std::vector<std::size_t> byValue;
+
+      /// \brief Whether indices sorted by value are up to date.
+      mutable bool sorted;
+
+      /**
+       * \brief Set buckets of a grid covering samples, emptied.
+       * \param grid The grid.
+       * \param samples The samples.
+       * \param x Member holding abscissae.
+       * \param y Member holding ordinates.
+       */
+      static void coverSamples (Grid &grid,
+                                const std::vector<Sample> &samples,
+                                double Sample::*x, double Sample::*y);
+  };
+}
+
+#endif  // #ifndef SAMPLEINDEX_HPP
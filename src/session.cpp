@@ -0,0 +1,229 @@
+/**
+ * \file session.cpp
+ * \brief Implementation of the work on an image kept between sessions.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSettings>
+#include <QStringList>
+#include <QMap>
+#include <QCryptographicHash>
+
+#include "session.hpp"
+#include "numberreader.hpp"
+
+namespace {
+  /// \brief Number of blocks of content in the key of an image.
+  const int blockCount = 64;
+
+  /// \brief Size of blocks of content in the key of an image, in bytes.
+  const qint64 blockSize = 64 << 10;
+
+  /**
+   * \brief Compute the key of an image.
+   * \param fileName Name of the image file.
+   * \return The key, empty if the file cannot be read.
+   */
+  QString imageKey (const QString &fileName) {
+    /* The file. */
+    QFile file (fileName);
+    if (!file.open(QIODevice::ReadOnly)) return QString ();
+    /* Size of the file. */
+    const qint64 size = file.size();
+    /* Hash of the size, the modification time and the content. */
+    QCryptographicHash hash (QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(size) + ' '
+                 + QByteArray::number(QFileInfo (file).lastModified()
+                                      .toTime_t()));
+    if (size <= blockCount * blockSize) {
+      hash.addData(file.readAll());
+    }
+    else {
+      for (int i = 0; i < blockCount; ++i) {
+        if (!file.seek((size - blockSize) * i / (blockCount - 1)))
+          return QString ();
+        hash.addData(file.read(blockSize));
+      }
+    }
+    return QString::fromLatin1(hash.result().toHex());
+  }
+
+  /**
+   * \brief Name of a file, as known by the system.
+   * \param fileName Name of the file.
+   */
+  std::string systemName (const QString &fileName) {
+    return QFile::encodeName(fileName).constData();
+  }
+}
+
+/* -- Construct the session of an image. ---------------------------------- */
+GUI::Session::Session (const QString &imageName) {
+  /* Key of the image. */
+  const QString key = imageKey(imageName);
+  if (!key.isEmpty()) base = directory() + '/' + key;
+}
+
+/* -- Directory of files kept. -------------------------------------------- */
+QString GUI::Session::directory () {
+  return QDir::homePath() + "/.geodesk.cache";
+}
+
+/* -- Whether a state has been saved. ------------------------------------- */
+bool GUI::Session::exists () const {
+  return !isNull() && QFile::exists(stateFile());
+}
+
+/* -- Save the state. ----------------------------------------------------- */
+void GUI::Session::save (const State &state,
+                         const Projection::ReferencePoints &points,
+                         const std::vector<Data::Sample> &samples) const {
+  if (isNull()) return;
+  if (!QDir ().mkpath(directory()))
+    throw std::runtime_error("Directory \"" + systemName(directory())
+                             + "\" cannot be created.");
+
+  if (points.empty())
+    QFile::remove(referencePointsFile());
+  else
+    points.write(systemName(referencePointsFile()));
+
+  {
+    /* The data file. */
+    std::ofstream file (systemName(dataFile()).c_str(),
+                        std::ios_base::binary | std::ios_base::trunc);
+    for (std::size_t i = 0; i < samples.size(); ++i)
+      Data::writeSample(file, samples[i]);
+    file.close();
+    if (!file)
+      throw std::runtime_error("Data file \"" + systemName(dataFile())
+                               + "\" cannot be written.");
+  }
+
+  /* Coefficients of the referential change. */
+  QStringList change;
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 3; ++j)
+      change << QString::number(state.change(i, j), 'g', 17);
+  /* The state file. */
+  QSettings settings (stateFile(), QSettings::IniFormat);
+  settings.clear();
+  settings.setValue("projection", state.projection);
+  if (state.changeKnown) settings.setValue("change", change);
+  settings.setValue("scale", state.scale);
+  settings.setValue("scroll", state.scroll);
+  settings.setValue("dataFile", state.dataFileName);
+  settings.setValue("referencePointFile", state.referencePointFileName);
+  settings.setValue("unsaved", state.unsaved);
+  settings.sync();
+  if (settings.status() != QSettings::NoError)
+    throw std::runtime_error("Session file \"" + systemName(stateFile())
+                             + "\" cannot be written.");
+}
+
+/* -- Restore the state. -------------------------------------------------- */
+void GUI::Session::restore (State &state,
+                            Projection::ReferencePoints &points,
+                            std::vector<Data::Sample> &samples) const {
+  /* The state file. */
+  const QSettings settings (stateFile(), QSettings::IniFormat);
+  if (settings.status() != QSettings::NoError)
+    throw std::runtime_error("Session file \"" + systemName(stateFile())
+                             + "\" cannot be read.");
+  state.projection = settings.value("projection", "geographic").toString();
+  /* Coefficients of the referential change. */
+  const QStringList change = settings.value("change").toStringList();
+  state.changeKnown = change.size() == 6;
+  for (int i = 0; state.changeKnown && (i < 6); ++i)
+    state.change(i / 3, i % 3) = change[i].toDouble(&state.changeKnown);
+  state.scale = settings.value("scale", 1.).toDouble();
+  state.scroll = settings.value("scroll").toPoint();
+  state.dataFileName = settings.value("dataFile").toString();
+  state.referencePointFileName =
+    settings.value("referencePointFile").toString();
+  state.unsaved = settings.value("unsaved", 0).toInt();
+
+  /* Reference points read. */
+  Projection::ReferencePoints restored;
+  restored.setProjection(
+    Projection::makeProjection(systemName(state.projection)));
+  if (QFile::exists(referencePointsFile()))
+    restored.read(systemName(referencePointsFile()));
+
+  /* The data file. */
+  std::ifstream file (systemName(dataFile()).c_str());
+  /* Data read. */
+  std::vector<Data::Sample> list;
+  if (file) {
+    /* Reader of the file. */
+    Text::NumberReader reader (file);
+    try {
+      while (!reader.atEnd()) {
+        /* Sample on the line. */
+        Data::Sample sample;
+        Data::readSample(reader, sample);
+        reader.endLine();
+        list.push_back(sample);
+      }
+    }
+    catch (const Text::ParseError &error) {
+      throw std::runtime_error("Data file \"" + systemName(dataFile())
+                               + "\": " + error.what());
+    }
+  }
+
+  points = restored;
+  samples.swap(list);
+  state.unsaved = std::min(std::max(state.unsaved, 0),
+                           static_cast<int>(samples.size()));
+}
+
+/* -- Trim the cache. ----------------------------------------------------- */
+void GUI::Session::trim (const Session &keep) {
+  /* Files which can be rebuilt. */
+  const QFileInfoList files =
+    QDir (directory()).entryInfoList(QStringList () << "*.pixels"
+                                                    << "*.levels",
+                                     QDir::Files);
+  /* Size of files of each image, by key. */
+  QMap<QString, qint64> sizes;
+  /* Last time each image has been used, by key. */
+  QMap<QString, QDateTime> used;
+  /* Total size of files. */
+  qint64 total = 0;
+  for (int i = 0; i < files.size(); ++i) {
+    /* Key of the image. */
+    const QString key = files[i].completeBaseName();
+    /* The state is saved each time the image is left. */
+    const QFileInfo state (directory() + '/' + key + ".session");
+    sizes[key] += files[i].size();
+    used[key] = std::max(used.value(key, files[i].lastModified()),
+                         state.exists()? state.lastModified():
+                         files[i].lastModified());
+    total += files[i].size();
+  }
+
+  /* Images, from the one used least recently. */
+  QList< QPair<QDateTime, QString> > order;
+  for (QMap<QString, QDateTime>::const_iterator i = used.constBegin();
+       i != used.constEnd(); ++i)
+    order << qMakePair(i.value(), i.key());
+  qSort(order);
+  /* Key of the image kept anyway. */
+  const QString kept = QFileInfo (keep.base).fileName();
+  for (int i = 0; (i < order.size()) && (total > cacheBudget); ++i) {
+    if (order[i].second == kept) continue;
+    QFile::remove(directory() + '/' + order[i].second + ".pixels");
+    QFile::remove(directory() + '/' + order[i].second + ".levels");
+    total -= sizes[order[i].second];
+  }
+}
@@ -0,0 +1,140 @@
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+/**
+ * \file session.hpp
+ * \brief Work on an image kept between sessions, with its decoded pixels.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <vector>
+#include <QString>
+#include <QPoint>
+
+#include "projection.hpp"
+#include "referencepoints.hpp"
+#include "sample.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Files kept for an image between sessions.
+   *
+   * Files are stored in directory "~/.geodesk.cache," named after a key
+   * computed from the size, the modification time and the content of the
+   * image, so that a modified image is never confused with its previous
+   * version. The content is sampled by blocks spread over the whole file,
+   * which keeps computing the key immediate for images of several
+   * gigabytes.
+   *
+   * Decoded pixels and levels of the pyramid kept in memory are cached, so
+   * that an image is opened again without being decoded. Both can be
+   * rebuilt, and are removed when the cache exceeds its budget, oldest
+   * images first. The state of the work on the image, with its reference
+   * points and data, is kept as long as the image exists.
+   */
+  class Session {
+    public:
+      /// \brief Budget for decoded pixels and levels, in bytes.
+      static const qint64 cacheBudget = Q_INT64_C(8) << 30;
+
+      /// \brief State of the work on an image.
+      struct State {
+        /// \brief Description of the map projection, as in makeProjection().
+        QString projection;
+
+        /// \brief Whether or not the referential change is known.
+        bool changeKnown;
+
+        /// \brief Referential change of the image.
+        Projection::ChangeMatrix change;
+
+        /// \brief Scale factor of the display.
+        double scale;
+
+        /// \brief Position of scroll bars.
+        QPoint scroll;
+
+        /// \brief Name of the file where data are saved.
+        QString dataFileName;
+
+        /// \brief Name of the file where reference points are saved.
+        QString referencePointFileName;
+
+        /// \brief Number of data not saved in their file, given last.
+        int unsaved;
+      };
+
+      /// \brief Construct a null session, keeping nothing.
+      Session () {}
+
+      /**
+       * \brief Construct the session of an image.
+       * \param imageName Name of the image file.
+       *
+       * The session is null if the image cannot be read.
+       */
+      explicit Session (const QString &imageName);
+
+      /// \brief Whether or not nothing is kept.
+      bool isNull () const {return base.isEmpty();}
+
+      /// \brief Directory where files are kept.
+      static QString directory ();
+
+      /// \brief File of decoded pixels.
+      QString pixelsFile () const {return base + ".pixels";}
+
+      /// \brief File of levels of the pyramid kept in memory.
+      QString levelsFile () const {return base + ".levels";}
+
+      /// \brief Whether or not a state has been saved.
+      bool exists () const;
+
+      /**
+       * \brief Save the state of the work on the image.
+       * \param state The state.
+       * \param points Reference points.
+       * \param samples Data set on the image.
+       * \exception std::runtime_error Files cannot be written.
+       */
+      void save (const State &state,
+                 const Projection::ReferencePoints &points,
+                 const std::vector<Data::Sample> &samples) const;
+
+      /**
+       * \brief Restore the state of the work on the image.
+       * \param state Where to put the state.
+       * \param points Where to put reference points.
+       * \param samples Where to put data set on the image.
+       * \exception std::runtime_error Files cannot be read.
+       */
+      void restore (State &state, Projection::ReferencePoints &points,
+                    std::vector<Data::Sample> &samples) const;
+
+      /**
+       * \brief Remove decoded pixels and levels of images opened least
+       * recently, until the cache fits in its budget.
+       * \param keep Session whose files are kept anyway.
+       */
+      static void trim (const Session &keep);
+
+    private:
+      /// \brief Path of files kept, without extension.
+      QString base;
+
+      /// \brief File of the state.
+      QString stateFile () const {return base + ".session";}
+
+      /// \brief File of reference points.
+      QString referencePointsFile () const {return base + ".ref";}
+
+      /// \brief File of data.
+      QString dataFile () const {return base + ".txt";}
+  };
+}
+
+#endif  // #ifndef SESSION_HPP
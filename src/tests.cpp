@@ -0,0 +1,491 @@
+/**
+ * \file tests.cpp
+ * \brief Regression tests of core functions, run by "ctest".
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ *
+ * Each test checks a case which once failed. The program writes the name
+ * of tests failing on the standard error.
+ *
+ * Command:
+ *
+ *      geodesk_tests
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "projection.hpp"
+#include "mapprojection.hpp"
+#include "batch.hpp"
+#include "tiff.hpp"
+#include "journal.hpp"
+#include "datafile.hpp"
+#include "numberreader.hpp"
+#include "vectorexport.hpp"
+
+namespace {
+  /// \brief A test: its name and the function running it.
+  typedef std::pair<std::string, std::function<void ()> > Test;
+
+  /**
+   * \brief Fail a test if a condition does not hold.
+   * \param condition The condition.
+   * \param message What is wrong otherwise.
+   * \exception std::runtime_error The condition does not hold.
+   */
+  void check (bool condition, const std::string &message) {
+    if (!condition) throw std::runtime_error(message);
+  }
+
+  /// \brief Directory of temporary files, removed with them.
+  class TemporaryDirectory {
+    public:
+      /// \brief Create the directory.
+      TemporaryDirectory ():
+        path (boost::filesystem::temp_directory_path()
+              / boost::filesystem::unique_path("geodesk-%%%%-%%%%-%%%%")) {
+        boost::filesystem::create_directory(path);
+      }
+
+      /// \brief Remove the directory and its files.
+      ~TemporaryDirectory () {
+        boost::system::error_code error;
+        boost::filesystem::remove_all(path, error);
+      }
+
+      /**
+       * \brief Name of a file in the directory.
+       * \param name Name of the file in the directory.
+       */
+      std::string file (const std::string &name) const {
+        return (path / name).string();
+      }
+
+    private:
+      /// \brief Path of the directory.
+      const boost::filesystem::path path;
+  };
+
+  /**
+   * \brief Sample whose coordinates follow from a number.
+   * \param i The number.
+   */
+  Data::Sample sample (double i) {
+    /* The sample. */
+    const Data::Sample result = {i, 2. * i, -4. + 1e-4 * i, 48. - 1e-4 * i,
+                                 0.5 * i};
+    return result;
+  }
+
+  /**
+   * \brief Whether two lists of samples are the same.
+   * \param first First list.
+   * \param second Second list.
+   * \param tolerance Greatest difference between coordinates.
+   */
+  bool same (const std::vector<Data::Sample> &first,
+             const std::vector<Data::Sample> &second, double tolerance) {
+    if (first.size() != second.size()) return false;
+    for (std::size_t i = 0; i < first.size(); ++i)
+      if (!(std::abs(first[i].x - second[i].x) <= tolerance
+            && std::abs(first[i].y - second[i].y) <= tolerance
+            && std::abs(first[i].longitude - second[i].longitude)
+               <= tolerance
+            && std::abs(first[i].latitude - second[i].latitude) <= tolerance
+            && std::abs(first[i].value - second[i].value) <= tolerance))
+        return false;
+    return true;
+  }
+
+  /**
+   * \brief Put a number in a file, in little-endian order.
+   * \param file Content of the file.
+   * \param position Where to put the number.
+   * \param value The number.
+   * \param size Number of bytes.
+   */
+  void putLittle (std::vector<unsigned char> &file, std::size_t position,
+                  std::uint64_t value, int size) {
+    for (int i = 0; i < size; ++i)
+      file[position + i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+
+  /**
+   * \brief Uncompressed tiled TIFF file, of 40 by 30 pixels in tiles of 16
+   * by 16 pixels, each pixel being the sum of its coordinates.
+   * \param samples Value of tag SamplesPerPixel, pixels having one sample.
+   * \param byteCounts Number of tiles whose byte count is given.
+   * \return Content of the file.
+   */
+  std::vector<unsigned char> tiledTiff (int samples, int byteCounts) {
+    /* Number of tiles. */
+    const int tiles = 3 * 2;
+    /* Number of tags. */
+    const int tags = (byteCounts > 0)? 10: 9;
+    /* Offset of the directory. */
+    const std::size_t directory = 8;
+    /* Offset of tile offsets. */
+    const std::size_t offsets = directory + 2 + 12 * tags + 4;
+    /* Offset of byte counts. */
+    const std::size_t counts = offsets + 4 * tiles;
+    /* Offset of the first tile. */
+    const std::size_t first = counts + 4 * tiles;
+    /* Content of the file. */
+    std::vector<unsigned char> file (first + 256 * tiles);
+    file[0] = file[1] = 'I';
+    putLittle(file, 2, 42, 2);
+    putLittle(file, 4, directory, 4);
+    putLittle(file, directory, tags, 2);
+    /* Tags: identifier, type, count and value or offset. */
+    const std::uint64_t entries [10][4] = {
+      {256, 3, 1, 40}, {257, 3, 1, 30}, {258, 3, 1, 8}, {259, 3, 1, 1},
+      {262, 3, 1, 1}, {277, 3, 1, static_cast<std::uint64_t>(samples)},
+      {322, 3, 1, 16}, {323, 3, 1, 16}, {324, 4, tiles, offsets},
+      {325, 4, static_cast<std::uint64_t>(byteCounts),
+       (byteCounts == 1)? 256: counts}
+    };
+    for (int i = 0; i < tags; ++i) {
+      /* Offset of the entry. */
+      const std::size_t entry = directory + 2 + 12 * i;
+      putLittle(file, entry, entries[i][0], 2);
+      putLittle(file, entry + 2, entries[i][1], 2);
+      putLittle(file, entry + 4, entries[i][2], 4);
+      putLittle(file, entry + 8, entries[i][3], 4);
+    }
+    for (int tile = 0; tile < tiles; ++tile) {
+      putLittle(file, offsets + 4 * tile, first + 256 * tile, 4);
+      putLittle(file, counts + 4 * tile, 256, 4);
+      for (int y = 0; y < 16; ++y)
+        for (int x = 0; x < 16; ++x)
+          file[first + 256 * tile + 16 * y + x] =
+            static_cast<unsigned char>(16 * (tile % 3) + x
+                                       + 16 * (tile / 3) + y);
+    }
+    return file;
+  }
+
+  /**
+   * \brief Whether reading the layout of a TIFF image fails.
+   * \param file Content of the file.
+   */
+  bool isRejected (const std::vector<unsigned char> &file) {
+    try {
+      const Tiff::Directory directory (file.data(), file.size());
+      const Tiff::Image image (directory, file.size());
+    }
+    catch (const std::runtime_error &) {
+      return true;
+    }
+    return false;
+  }
+
+  /// \brief Uncompressed tiles must lie in the file, byte counts or not.
+  void tiffMissingTiles () {
+    /* A valid file, without byte counts. */
+    const std::vector<unsigned char> file = tiledTiff(1, 0);
+    /* Directory of the file. */
+    const Tiff::Directory directory (file.data(), file.size());
+    /* The image. */
+    const Tiff::Image image (directory, file.size());
+    /* Samples of the last tile. */
+    std::vector<unsigned char> pixels;
+    image.decode(file.data(), 2, 1, pixels);
+    check(pixels.size() == 256 && pixels[16 * 5 + 3] == 32 + 3 + 16 + 5,
+          "an uncompressed tile is not read.");
+
+    /* Files whose last tile is cut, without or with few byte counts. */
+    for (int byteCounts: {0, 1}) {
+      /* The file, cut. */
+      std::vector<unsigned char> cut = tiledTiff(1, byteCounts);
+      cut.resize(cut.size() - 100);
+      check(isRejected(cut), "a truncated tiled image is read.");
+    }
+    check(isRejected(tiledTiff(0, 6)),
+          "an image without samples per pixel is read.");
+  }
+
+  /// \brief Samples journaled are recovered, a damaged tail being cut.
+  void journalRecovery () {
+    /* Directory of files. */
+    const TemporaryDirectory directory;
+    /* Name of the journal. */
+    const std::string journalName = directory.file("test.journal");
+    /* Name of the data file. */
+    const std::string dataName = directory.file("test.txt");
+    /* Samples expected. */
+    std::vector<Data::Sample> expected;
+    {
+      /* The journal, left without being cleared as after a crash. */
+      Data::Journal journal (journalName);
+      for (int i = 0; i < 3; ++i) {
+        journal.append(sample(i));
+        expected.push_back(sample(i));
+      }
+    }
+    {
+      /* The journal, whose last record is partially written. */
+      std::ofstream file (journalName.c_str(), std::ios_base::app);
+      file << "1.5 2.5 3";
+    }
+    {
+      /* The journal, recovered. */
+      Data::Journal journal (journalName);
+      check(same(journal.samples(), expected, 0.) && journal.unsaved() == 3,
+            "samples before a damaged record are not recovered.");
+      /* Appended after the damaged record, which should have been cut. */
+      journal.append(sample(3));
+      expected.push_back(sample(3));
+    }
+    {
+      /* The journal, recovered again. */
+      Data::Journal journal (journalName);
+      check(same(journal.samples(), expected, 0.),
+            "samples appended after a damaged record are not recovered.");
+      journal.save(dataName);
+      check(journal.unsaved() == 0, "samples saved are still unsaved.");
+      /* Edits of samples saved, which are not in the journal any more. */
+      journal.replace(0, sample(10));
+      journal.remove(1);
+      journal.append(sample(11));
+      expected[0] = sample(10);
+      expected.erase(expected.begin() + 1);
+      expected.push_back(sample(11));
+    }
+    /* The journal, recovered with samples of the data file. */
+    Data::Journal journal (journalName);
+    check(same(journal.samples(), expected, 0.) && journal.unsaved() == 3,
+          "edits of samples saved are not recovered.");
+    journal.save(dataName);
+    journal.clear();
+    journal.load(dataName);
+    check(same(journal.samples(), expected, 0.),
+          "samples recovered are not saved with samples of the file.");
+  }
+
+  /// \brief Binary data files give back samples, whatever the encoding.
+  void binaryRoundTrip () {
+    /* Directory of files. */
+    const TemporaryDirectory directory;
+    /* Name of the data file. */
+    const std::string name = directory.file("test.gdd");
+    /* Samples, spanning several blocks of differences. */
+    std::vector<Data::Sample> samples;
+    for (std::size_t i = 0; i < 2 * Data::blockSize + 100; ++i) {
+      /* Sample whose ordinates jump too far for differences. */
+      Data::Sample jumping = sample(0.25 * i);
+      jumping.y = (i % 2 == 0)? 0.: 1e5;
+      jumping.longitude = std::sin(1. * i);
+      samples.push_back(jumping);
+    }
+    /* Quantization steps, none for longitudes. */
+    const Data::Steps steps = {{1e-3, 1e-3, 0., 1e-7, 1e-3}};
+    /* Referential change. */
+    Projection::ChangeMatrix change;
+    change << 1e-4, 0., -4.,
+              0., -1e-4, 48.;
+    Data::writeBinaryFile(name, samples, steps, &change);
+
+    /* The file. */
+    const Data::BinaryFile file (name);
+    check(file.encoding(Data::xColumn) == Data::delta16
+          && file.encoding(Data::yColumn) == Data::quantized32
+          && file.encoding(Data::longitudeColumn) == Data::float64
+          && file.encoding(Data::latitudeColumn) == Data::delta16
+          && file.encoding(Data::valueColumn) == Data::delta16,
+          "columns are not encoded as expected.");
+    check(file.hasChange() && file.change() == change,
+          "the referential change is not kept.");
+    /* Samples read. */
+    std::vector<Data::Sample> read;
+    file.read(read);
+    check(same(read, samples, 0.5e-3),
+          "samples are not read back within their steps.");
+    for (std::size_t i = 0; i < samples.size(); ++i)
+      check(read[i].longitude == samples[i].longitude,
+            "doubles are not read back exactly.");
+    /* Abscissae read from the middle of a block. */
+    double abscissae [10];
+    file.read(Data::xColumn, Data::blockSize + 5, 10, abscissae);
+    for (std::size_t i = 0; i < 10; ++i)
+      check(std::abs(abscissae[i] - samples[Data::blockSize + 5 + i].x)
+            <= 0.5e-3, "a range of samples is not read back.");
+  }
+
+  /// \brief Numbers are read as by the standard library, fast or not.
+  void numberReader () {
+    /* Numbers written. */
+    std::vector<std::string> numbers = {
+      "0", "-0.0", "0.1", "123.456", "-7e-3", "+2.5E+2", "9007199254740992",
+      "9007199254740993", "1234567890123456789", "0.12345678901234567",
+      "1e22", "1e23", "4.9e-324", "1.7976931348623157e308",
+      "123456789012345678901234567890123456789012345e-30", "1e-400"
+    };
+    /* Generator of random doubles. */
+    std::mt19937_64 generator (42);
+    /* Distribution of exponents. */
+    std::uniform_real_distribution<double> exponents (-30., 30.);
+    for (int i = 0; i < 10000; ++i) {
+      /* Text of the number. */
+      char text [40];
+      std::snprintf(text, sizeof(text), "%.*g", 1 + i % 17,
+                    std::pow(10., exponents(generator)));
+      numbers.push_back(text);
+    }
+
+    /* Text of numbers, one per line. */
+    std::string lines;
+    for (const std::string &number: numbers) lines += number + '\n';
+    /* Stream on the text. */
+    std::istringstream stream (lines);
+    /* The reader. */
+    Text::NumberReader reader (stream);
+    for (const std::string &number: numbers) {
+      /* Number read. */
+      const double value = reader.number();
+      reader.endLine();
+      /* Number converted by the standard library. */
+      const double expected = std::strtod(number.c_str(), 0);
+      check(value == expected && std::signbit(value) ==
+            std::signbit(expected), "number " + number + " is misread.");
+    }
+    check(reader.atEnd(), "numbers remain to be read.");
+  }
+
+  /// \brief The least-squares fit finds an affine transformation exactly.
+  void affineFit () {
+    /* Referential change. */
+    Projection::ChangeMatrix change;
+    change << 2e-4, 1e-5, -4.5,
+              -1e-5, -2e-4, 48.4;
+    /* The fit. */
+    Projection::AffineFit fit;
+    /* Images of reference points. */
+    const double points [6][2] = {
+      {10., 20.}, {5000., 30.}, {4800., 3900.}, {15., 4100.}, {2500., 2000.},
+      {1200., 3300.}
+    };
+    for (const double* point: points) {
+      /* Geographical coordinates. */
+      const Eigen::Vector2d geographic =
+        change * Eigen::Vector3d (point[0], point[1], 1.);
+      fit.add(Projection::Point2D (point[0], point[1]),
+              Projection::Point2D (geographic.x(), geographic.y()));
+    }
+    check(fit.coefficients().transpose().isApprox(change, 1e-9)
+          && fit.rms() < 1e-9, "reference points are not fitted exactly.");
+
+    /* A point shifted, which leaves residuals. */
+    fit.add(Projection::Point2D (3000., 1000.),
+            Projection::Point2D (-4.5 + 0.1, 48.));
+    check(fit.rms() > 1e-3, "residuals are not measured.");
+    fit.remove(Projection::Point2D (3000., 1000.),
+               Projection::Point2D (-4.5 + 0.1, 48.));
+    check(fit.size() == 6
+          && fit.coefficients().transpose().isApprox(change, 1e-9),
+          "a point removed still changes the fit.");
+  }
+
+  /// \brief Exported lines are cut where values change and at gaps.
+  void exportGaps () {
+    /* Directory of files. */
+    const TemporaryDirectory directory;
+    /* Name of the exported file. */
+    const std::string name = directory.file("test.csv");
+    /* Samples: a line of value 5, a sample far away, then value 7. */
+    std::vector<Data::Sample> samples;
+    for (int i = 0; i < 3; ++i) samples.push_back(sample(i));
+    samples.push_back(sample(100.));
+    for (int i = 0; i < 2; ++i) samples.push_back(sample(101. + i));
+    for (Data::Sample &current: samples)
+      current.value = (current.x < 101.)? 5.: 7.;
+    /* Function letting exporting carry on. */
+    const std::function<bool (int)> carryOn = [] (int) {return true;};
+    check(Data::VectorExporter (samples, 0.).write(name, Data::csvFormat,
+                                                   carryOn) == 2,
+          "lines are not only cut where values change without gap.");
+    check(Data::VectorExporter (samples, 10.).write(name, Data::csvFormat,
+                                                    carryOn) == 3,
+          "lines are not cut at gaps.");
+  }
+
+  /// \brief Mercator cannot project poles, which are at infinity.
+  void mercatorPoles () {
+    /* The projection. */
+    const Projection::MapProjectionPointer mercator =
+      Projection::makeProjection("mercator");
+    for (double latitude: {90., -90.}) {
+      /* The pole, projected. */
+      const Projection::Point2D pole =
+        mercator->forwardPoint(Projection::Point2D (0., latitude));
+      check(std::isnan(pole.x()) && std::isnan(pole.y()),
+            "a pole is projected to a finite point.");
+    }
+    /* A point near a pole, which can still be projected. */
+    const Projection::Point2D north =
+      mercator->forwardPoint(Projection::Point2D (0., 89.9));
+    check(std::isfinite(north.y()) && north.y() > 0.,
+          "a point near a pole is not projected.");
+
+    /* Referential change, from the image to the plane. */
+    Projection::ChangeMatrix change;
+    change << 1., 0., 0.,
+              0., -1., 0.;
+    /* Points converted to the image, the second one being a pole. */
+    std::istringstream in ("-4.5 48.4\n0 90\n");
+    /* Points converted. */
+    std::ostringstream out;
+    try {
+      Batch::transform(change, in, out, true, mercator.get());
+    }
+    catch (const std::runtime_error &) {
+      return;
+    }
+    check(false, "command transform converts a pole.");
+  }
+}
+
+/**
+ * \brief Main function of tests.
+ * \return 0 if every test passes, 1 otherwise.
+ */
+int main () {
+  /* Tests run. */
+  const std::vector<Test> tests = {
+    Test ("journal_recovery", journalRecovery),
+    Test ("binary_round_trip", binaryRoundTrip),
+    Test ("number_reader", numberReader),
+    Test ("affine_fit", affineFit),
+    Test ("export_gaps", exportGaps),
+    Test ("mercator_poles", mercatorPoles),
+    Test ("tiff_missing_tiles", tiffMissingTiles)
+  };
+  /* Number of tests failing. */
+  int failures = 0;
+  for (const Test &test: tests) {
+    try {
+      test.second();
+    }
+    catch (const std::exception &error) {
+      std::cerr << test.first << ": " << error.what() << std::endl;
+      ++failures;
+    }
+  }
+  std::clog << tests.size() - failures << " of " << tests.size()
+            << " tests passed." << std::endl;
+  return (failures == 0)? 0: 1;
+}
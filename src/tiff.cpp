@@ -0,0 +1,553 @@
+/**
+ * \file tiff.cpp
+ * \brief Implementation of TIFF structure reading.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include "tiff.hpp"
+#include "rasterdecoder.hpp"
+
+namespace {
+  /// \brief Reader of integers in a given byte order.
+  class ByteReader {
+    public:
+      /**
+       * \brief Construct the reader.
+       * \param _data Data to be read.
+       * \param _size Size of data.
+       * \param _big Whether or not data are big endian.
+       */
+      ByteReader (const unsigned char* _data, std::size_t _size, bool _big):
+        data (_data), size (_size), big (_big) {}
+
+      /**
+       * \brief Read an unsigned integer.
+       * \param offset Offset of the integer.
+       * \param bytes Number of bytes of the integer.
+       * \return The integer.
+       * \exception std::runtime_error Offset is outside data.
+       */
+      std::uint64_t read (std::uint64_t offset, unsigned bytes) const {
+        if ((offset > size) || (size - offset < bytes))
+          throw std::runtime_error("TIFF file is truncated.");
+        /* The integer. */
+        std::uint64_t result = 0;
+        for (unsigned i = 0; i < bytes; ++i) {
+          /* Index of the byte, most significant first. */
+          const unsigned index = big? i: bytes - 1 - i;
+          result = (result << 8) | data[offset + index];
+        }
+        return result;
+      }
+
+    private:
+      /// \brief Data to be read.
+      const unsigned char* data;
+
+      /// \brief Size of data.
+      std::size_t size;
+
+      /// \brief Whether or not data are big endian.
+      bool big;
+  };
+
+  /**
+   * \brief Size of a value of a TIFF type.
+   * \param type Number of the type.
+   * \return Size in bytes, 0 for unknown types.
+   */
+  unsigned typeSize (unsigned type) {
+    switch (type) {
+      case 1: case 2: case 6: case 7: return 1;
+      case 3: case 8: return 2;
+      case 4: case 9: case 11: return 4;
+      case 5: case 10: case 12: case 16: case 17: case 18: return 8;
+      default: return 0;
+    }
+  }
+
+  /**
+   * \brief Decompress PackBits data.
+   * \param data Compressed data.
+   * \param size Size of compressed data.
+   * \param pixels Destination, whose size is the one expected.
+   */
+  void unpackBits (const unsigned char* data, std::size_t size,
+                   std::vector<unsigned char> &pixels) {
+    /* Position in compressed data. */
+    std::size_t i = 0;
+    /* Position in the destination. */
+    std::size_t o = 0;
+    while ((i < size) && (o < pixels.size())) {
+      /* Header of the run. */
+      const int n = static_cast<signed char>(data[i++]);
+      if (n >= 0) {
+        /* Number of bytes copied. */
+        const std::size_t count =
+          std::min(static_cast<std::size_t>(n) + 1,
+                   std::min(size - i, pixels.size() - o));
+        std::memcpy(&pixels[o], data + i, count);
+        i += count;
+        o += count;
+      }
+      else if ((n != -128) && (i < size)) {
+        /* Number of bytes repeated. */
+        const std::size_t count =
+          std::min(static_cast<std::size_t>(1 - n), pixels.size() - o);
+        std::memset(&pixels[o], data[i++], count);
+        o += count;
+      }
+    }
+  }
+
+  /**
+   * \brief Decompress LZW data, as written in TIFF files.
+   * \param data Compressed data.
+   * \param size Size of compressed data.
+   * \param pixels Destination, whose size is the one expected.
+   * \exception std::runtime_error Data are corrupted.
+   *
+   * Each string of the table is a copy of bytes already written, it is
+   * therefore kept as its position and length in the destination.
+   */
+  void unpackLzw (const unsigned char* data, std::size_t size,
+                  std::vector<unsigned char> &pixels) {
+    /// \brief Code clearing the table.
+    const unsigned clear = 256;
+    /// \brief Code ending data.
+    const unsigned end = 257;
+    /* Position of each string of the table in the destination. */
+    std::vector<std::size_t> start (4096);
+    /* Length of each string of the table. */
+    std::vector<std::size_t> length (4096);
+    /* Bytes written. */
+    std::vector<unsigned char> out;
+    out.reserve(pixels.size());
+    /* Number of bits of codes. */
+    unsigned bits = 9;
+    /* Next code added to the table. */
+    unsigned next = 258;
+    /* Whether or not a string has been written since the table was cleared. */
+    bool previous = false;
+    /* Position of the last string written. */
+    std::size_t lastStart = 0;
+    /* Length of the last string written. */
+    std::size_t lastLength = 0;
+    /* Bits read, not yet used. */
+    std::uint32_t buffer = 0;
+    /* Number of bits in the buffer. */
+    unsigned buffered = 0;
+    /* Position in compressed data. */
+    std::size_t i = 0;
+
+    while (out.size() < pixels.size()) {
+      while ((buffered < bits) && (i < size)) {
+        buffer = (buffer << 8) | data[i++];
+        buffered += 8;
+      }
+      if (buffered < bits) break;
+      /* The code read. */
+      const unsigned code = (buffer >> (buffered - bits)) & ((1u << bits) - 1);
+      buffered -= bits;
+      if (code == end) break;
+      if (code == clear) {
+        bits = 9;
+        next = 258;
+        previous = false;
+        continue;
+      }
+      /* Position of the string written. */
+      const std::size_t position = out.size();
+      if (code < 256) {
+        out.push_back(static_cast<unsigned char>(code));
+      }
+      else if (previous && (code < next)) {
+        for (std::size_t k = 0; k < length[code]; ++k)
+          out.push_back(out[start[code] + k]);
+      }
+      else if (previous && (code == next)) {
+        for (std::size_t k = 0; k < lastLength; ++k)
+          out.push_back(out[lastStart + k]);
+        out.push_back(out[lastStart]);
+      }
+      else {
+        throw std::runtime_error("LZW data of TIFF file are corrupted.");
+      }
+
+      if (previous && (next < 4096)) {
+        start[next] = lastStart;
+        length[next] = lastLength + 1;
+        ++next;
+        if ((next + 1 >= (1u << bits)) && (bits < 12)) ++bits;
+      }
+      previous = true;
+      lastStart = position;
+      lastLength = out.size() - position;
+    }
+    std::copy(out.begin(), out.begin() + std::min(out.size(), pixels.size()),
+              pixels.begin());
+  }
+
+  /// \brief Keys of GeoTIFF used by GeoDesk.
+  enum GeoKey {
+    /// \brief Kind of model coordinates.
+    modelType = 1024,
+    /// \brief Whether tie points refer to corners or centres of pixels.
+    rasterType = 1025,
+    /// \brief Geographical coordinate system.
+    geographicType = 2048,
+    /// \brief Projected coordinate system.
+    projectedType = 3072
+  };
+
+  /**
+   * \brief Describe a coordinate system known by its EPSG code.
+   * \param epsg The code.
+   * \return Description as given to makeProjection(), empty if the code is
+   * not known.
+   */
+  std::string describe (int epsg) {
+    /* The description. */
+    std::ostringstream description;
+    if ((epsg == 4326) || (epsg == 4258) || (epsg == 4269))
+      description << "geographic";
+    else if ((epsg > 32600) && (epsg <= 32660))
+      description << "utm:" << epsg - 32600 << 'n';
+    else if ((epsg > 32700) && (epsg <= 32760))
+      description << "utm:" << epsg - 32700 << 's';
+    else if ((epsg >= 25828) && (epsg <= 25838))
+      description << "utm:" << epsg - 25800 << "n@grs80";
+    else if ((epsg >= 26901) && (epsg <= 26923))
+      description << "utm:" << epsg - 26900 << "n@grs80";
+    else if (epsg == 2154)
+      description << "lambert93";
+    else if (epsg == 3395)
+      description << "mercator";
+    return description.str();
+  }
+}
+
+/* -- Test TIFF header. --------------------------------------------------- */
+bool Tiff::isTiff (const unsigned char* data, std::size_t size) {
+  return (size >= 8)
+    && (((data[0] == 'I') && (data[1] == 'I')
+         && ((data[2] == 42) || (data[2] == 43)) && (data[3] == 0))
+        || ((data[0] == 'M') && (data[1] == 'M') && (data[2] == 0)
+            && ((data[3] == 42) || (data[3] == 43))));
+}
+
+/* -- Parse a directory. -------------------------------------------------- */
+Tiff::Directory::Directory (const unsigned char* data, std::size_t size,
+                            std::uint64_t offset) {
+  if (!isTiff(data, size))
+    throw std::runtime_error("File is not a TIFF file.");
+  big = (data[0] == 'M');
+
+  /* Reader of the file. */
+  const ByteReader reader (data, size, big);
+  /* Whether or not offsets have 64 bits. */
+  const bool bigTiff = reader.read(2, 2) == 43;
+  /* Number of bytes of offsets and counts. */
+  const unsigned word = bigTiff? 8: 4;
+  /* Offset of the directory. */
+  const std::uint64_t directory =
+    (offset != 0)? offset: reader.read(bigTiff? 8: 4, word);
+  /* Number of entries of the directory. */
+  const std::uint64_t entries = reader.read(directory, bigTiff? 8: 2);
+  /* Number of bytes of an entry. */
+  const unsigned entrySize = bigTiff? 20: 12;
+  /* Offset of the first entry. */
+  const std::uint64_t first = directory + (bigTiff? 8: 2);
+  if (entries > size / entrySize)
+    throw std::runtime_error("TIFF file is truncated.");
+
+  for (std::uint64_t e = 0; e < entries; ++e) {
+    /* Offset of the entry. */
+    const std::uint64_t entry = first + entrySize * e;
+    /* Tag of the entry. */
+    const int tag = static_cast<int>(reader.read(entry, 2));
+    /* Type of values. */
+    const unsigned type = static_cast<unsigned>(reader.read(entry + 2, 2));
+    /* Number of values. */
+    const std::uint64_t count = reader.read(entry + 4, word);
+    /* Size of a value. */
+    const unsigned bytes = typeSize(type);
+    if (bytes == 0) continue;
+    if (count > size / bytes)
+      throw std::runtime_error("TIFF file is truncated.");
+    /* Offset of values, which are in the entry when they fit. */
+    const std::uint64_t offset =
+      (count * bytes <= word)? entry + 4 + word:
+      reader.read(entry + 4 + word, word);
+
+    for (std::uint64_t i = 0; i < count; ++i) {
+      /* Offset of the current value. */
+      const std::uint64_t position = offset + i * bytes;
+      switch (type) {
+        case 5: case 10: {
+          /* Numerator of the rational. */
+          const std::uint64_t numerator = reader.read(position, 4);
+          /* Denominator of the rational. */
+          const std::uint64_t denominator = reader.read(position + 4, 4);
+          if (type == 5)
+            reals[tag].push_back(static_cast<double>(numerator)
+                                 / static_cast<double>(denominator));
+          else
+            reals[tag].push_back(
+              static_cast<double>(static_cast<std::int32_t>(numerator))
+              / static_cast<double>(static_cast<std::int32_t>(denominator)));
+          break;
+        }
+        case 11: {
+          /* Bits of the float. */
+          const std::uint32_t bits =
+            static_cast<std::uint32_t>(reader.read(position, 4));
+          /* The float itself. */
+          float real;
+          std::memcpy(&real, &bits, sizeof real);
+          reals[tag].push_back(real);
+          break;
+        }
+        case 12: {
+          /* Bits of the double. */
+          const std::uint64_t bits = reader.read(position, 8);
+          /* The double itself. */
+          double real;
+          std::memcpy(&real, &bits, sizeof real);
+          reals[tag].push_back(real);
+          break;
+        }
+        default:
+          integers[tag].push_back(reader.read(position, bytes));
+      }
+    }
+  }
+  nextOffset = reader.read(first + entrySize * entries, word);
+}
+
+/* -- Integer values of a tag. -------------------------------------------- */
+const std::vector<std::uint64_t> &Tiff::Directory::values (int tag) const {
+  /* Values returned for missing tags. */
+  static const std::vector<std::uint64_t> none;
+  /* Position of the tag. */
+  const IntegerMap::const_iterator i = integers.find(tag);
+  return (i == integers.end())? none: i->second;
+}
+
+/* -- Real values of a tag. ----------------------------------------------- */
+const std::vector<double> &Tiff::Directory::realValues (int tag) const {
+  /* Values returned for missing tags. */
+  static const std::vector<double> none;
+  /* Position of the tag. */
+  const RealMap::const_iterator i = reals.find(tag);
+  return (i == reals.end())? none: i->second;
+}
+
+/* -- Read the layout of an image. ---------------------------------------- */
+Tiff::Image::Image (const Directory &directory, std::size_t size) {
+  imageWidth_ = static_cast<int>(std::min<std::uint64_t>(
+    directory.value(imageWidth), 1 << 30));
+  imageHeight_ = static_cast<int>(std::min<std::uint64_t>(
+    directory.value(imageLength), 1 << 30));
+  samples_ = static_cast<int>(std::min<std::uint64_t>(
+    directory.value(samplesPerPixel, 1), 8));
+  stored = static_cast<int>(directory.value(photometricInterpretation));
+  compression = static_cast<int>(directory.value(Tag::compression, none));
+  differences = directory.value(Tag::predictor, 1) == 2;
+  /* Whether or not blocks are tiles. */
+  const bool tiled = directory.has(tileOffsets);
+  if (tiled) {
+    blockWidth_ = static_cast<int>(directory.value(tileWidth));
+    blockHeight_ = static_cast<int>(directory.value(tileLength));
+    offsets = directory.values(tileOffsets);
+    byteCounts = directory.values(tileByteCounts);
+  }
+  else {
+    blockWidth_ = imageWidth_;
+    blockHeight_ = static_cast<int>(std::min<std::uint64_t>(
+      directory.value(rowsPerStrip, imageHeight_), imageHeight_));
+    offsets = directory.values(stripOffsets);
+    byteCounts = directory.values(stripByteCounts);
+  }
+
+  /* Bits of each sample. */
+  const std::vector<std::uint64_t> &bits = directory.values(bitsPerSample);
+  for (std::size_t i = 0; i < bits.size(); ++i)
+    if (bits[i] != 8)
+      throw std::runtime_error("TIFF image has samples of other than 8 "
+                               "bits.");
+  if ((imageWidth_ <= 0) || (imageHeight_ <= 0) || (blockWidth_ <= 0)
+      || (blockHeight_ <= 0) || (blockWidth_ > (1 << 16))
+      || (static_cast<std::uint64_t>(blockWidth_) * blockHeight_ > (1 << 26)))
+    throw std::runtime_error("TIFF image has an invalid size.");
+  if (samples_ <= 0)
+    throw std::runtime_error("TIFF image has no sample per pixel.");
+  if (directory.value(planarConfiguration, 1) != 1)
+    throw std::runtime_error("TIFF image has separate planes.");
+  if ((compression != none) && (compression != lzw) && (compression != jpeg)
+      && (compression != deflate) && (compression != adobeDeflate)
+      && (compression != packBits))
+    throw std::runtime_error("TIFF image compression is not supported.");
+  /* Number of blocks. */
+  const std::size_t blocks = static_cast<std::size_t>(columns()) * rows();
+  if ((offsets.size() < blocks)
+      || ((compression != none) && (byteCounts.size() < blocks)))
+    throw std::runtime_error("TIFF image has missing blocks.");
+  for (std::size_t i = 0; i < blocks; ++i)
+    if ((offsets[i] > size)
+        || ((i < byteCounts.size()) && (byteCounts[i] > size - offsets[i])))
+      throw std::runtime_error("TIFF file is truncated.");
+  /* Number of bytes of a row of a block. */
+  const std::uint64_t stride =
+    static_cast<std::uint64_t>(blockWidth_) * samples_;
+  /* Uncompressed blocks without byte count are read over their rows. */
+  for (std::size_t i = byteCounts.size(); i < blocks; ++i) {
+    /* Row of blocks of the block. */
+    const int row = static_cast<int>(i / columns());
+    /* Number of rows of the block read. */
+    const int height = std::min(blockHeight_,
+                                imageHeight_ - row * blockHeight_);
+    if (stride * height > size - offsets[i])
+      throw std::runtime_error("TIFF image has missing blocks.");
+  }
+
+  /* JPEG blocks stored as YCbCr are decoded to RGB. */
+  photometric_ = ((compression == jpeg) && (stored == 6))? 2: stored;
+  if (compression == jpeg) {
+    /* Tables, stored as bytes. */
+    const std::vector<std::uint64_t> &shared = directory.values(jpegTables);
+    tables.assign(shared.begin(), shared.end());
+  }
+}
+
+/* -- Decode a block. ----------------------------------------------------- */
+void Tiff::Image::decode (const unsigned char* data, int column, int row,
+                          std::vector<unsigned char> &pixels) const {
+  /* Index of the block. */
+  const std::size_t index =
+    static_cast<std::size_t>(row) * columns() + column;
+  /* Number of bytes of a row of the block. */
+  const std::size_t stride = static_cast<std::size_t>(blockWidth_) * samples_;
+  /* Number of rows of the block. */
+  const int height = std::min(blockHeight_,
+                              imageHeight_ - row * blockHeight_);
+  pixels.assign(stride * blockHeight_, 0);
+  /* Stored block. */
+  const unsigned char* block = data + offsets[index];
+  /* Number of bytes stored. */
+  const std::size_t size = (index < byteCounts.size())?
+    static_cast<std::size_t>(byteCounts[index]): stride * height;
+
+  switch (compression) {
+    case none:
+      std::memcpy(&pixels[0], block, std::min(size, pixels.size()));
+      break;
+    case packBits:
+      unpackBits(block, size, pixels);
+      break;
+    case lzw:
+      unpackLzw(block, size, pixels);
+      break;
+    case deflate:
+    case adobeDeflate:
+      if (Raster::decodeDeflate(block, size, &pixels[0], pixels.size())
+          != Raster::decoded)
+        throw std::runtime_error("Deflate data of TIFF file cannot be "
+                                 "decoded.");
+      break;
+    case jpeg:
+      if (((samples_ != 1) && (samples_ != 3))
+          || (Raster::decodeJpegStream(block, size,
+                                       tables.empty()? 0: &tables[0],
+                                       tables.size(), stored == 2,
+                                       samples_, blockWidth_, blockHeight_,
+                                       &pixels[0]) != Raster::decoded))
+        throw std::runtime_error("JPEG data of TIFF file cannot be "
+                                 "decoded.");
+      break;
+  }
+
+  if (differences && (compression != jpeg)) {
+    for (int y = 0; y < height; ++y) {
+      /* Row of the block. */
+      unsigned char* line = &pixels[y * stride];
+      for (std::size_t x = samples_; x < stride; ++x)
+        line[x] = static_cast<unsigned char>(line[x] + line[x - samples_]);
+    }
+  }
+}
+
+/* -- Read the geo-reference. --------------------------------------------- */
+bool Tiff::readGeoReference (const Directory &directory,
+                             GeoReference &reference) {
+  /* Matrix from the image to model coordinates. */
+  const std::vector<double> &matrix =
+    directory.realValues(modelTransformation);
+  /* Tie points, six values each. */
+  const std::vector<double> &ties = directory.realValues(modelTiepoint);
+  /* Size of pixels. */
+  const std::vector<double> &scale = directory.realValues(modelPixelScale);
+  /* Referential change, tie points referring to corners of pixels. */
+  Projection::ChangeMatrix change;
+  if (matrix.size() >= 8) {
+    change << matrix[0], matrix[1], matrix[3],
+              matrix[4], matrix[5], matrix[7];
+  }
+  else if ((ties.size() >= 6) && (scale.size() >= 2)) {
+    change << scale[0], 0., ties[3] - ties[0] * scale[0],
+              0., -scale[1], ties[4] + ties[1] * scale[1];
+  }
+  else if (ties.size() >= 18) {
+    /* Points of the image. */
+    std::vector<Projection::Point2D> image;
+    /* Points of the model. */
+    std::vector<Projection::Point2D> model;
+    for (std::size_t i = 0; i + 5 < ties.size(); i += 6) {
+      image.push_back(Projection::Point2D (ties[i], ties[i + 1]));
+      model.push_back(Projection::Point2D (ties[i + 3], ties[i + 4]));
+    }
+    try {
+      change = Projection::computeCoefficients(image, model).transpose();
+    }
+    catch (const std::domain_error &) {
+      return false;
+    }
+  }
+  else {
+    return false;
+  }
+
+  /* Keys, four values each after a header of four values. */
+  const std::vector<std::uint64_t> &keys = directory.values(geoKeyDirectory);
+  /* Whether tie points refer to centres of pixels. */
+  bool point = false;
+  reference.epsg = 0;
+  reference.projected = true;
+  for (std::size_t i = 4; i + 3 < keys.size(); i += 4) {
+    /* Value of the key, when stored in the directory itself. */
+    const int value = (keys[i + 1] == 0)? static_cast<int>(keys[i + 3]): 0;
+    switch (keys[i]) {
+      case modelType: reference.projected = value != 2; break;
+      case rasterType: point = value == 2; break;
+      case geographicType:
+        if (!reference.projected) reference.epsg = value;
+        break;
+      case projectedType:
+        if (reference.projected) reference.epsg = value;
+        break;
+    }
+  }
+  /* Images coordinates of world files are those of centres of pixels. */
+  if (!point) change.col(2) += .5 * (change.col(0) + change.col(1));
+  reference.change = change;
+  reference.projection = (!reference.projected && reference.epsg == 0)?
+    std::string ("geographic"): describe(reference.epsg);
+  return true;
+}
@@ -0,0 +1,316 @@
+#ifndef TIFF_HPP
+#define TIFF_HPP
+
+/**
+ * \file tiff.hpp
+ * \brief Reading the structure, the pixels and the geo-reference of TIFF
+ * files, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ *
+ * Specification of the format can be found at:
+ * <http://partners.adobe.com/public/developer/en/tiff/TIFF6.pdf>
+ *
+ * Specification of GeoTIFF can be found at:
+ * <http://docs.opengeospatial.org/is/19-008r4/19-008r4.html>
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "projection.hpp"
+
+/// \brief Namespace for TIFF files.
+namespace Tiff {
+  /// \brief Tags used by GeoDesk.
+  enum Tag {
+    /// \brief Kind of image, reduced resolution ones having bit 0 set.
+    newSubfileType = 254,
+    /// \brief Number of columns.
+    imageWidth = 256,
+    /// \brief Number of rows.
+    imageLength = 257,
+    /// \brief Number of bits of each sample.
+    bitsPerSample = 258,
+    /// \brief Compression scheme.
+    compression = 259,
+    /// \brief Colour space.
+    photometricInterpretation = 262,
+    /// \brief Offset of each strip.
+    stripOffsets = 273,
+    /// \brief Number of samples of each pixel.
+    samplesPerPixel = 277,
+    /// \brief Number of rows of each strip.
+    rowsPerStrip = 278,
+    /// \brief Number of bytes of each strip.
+    stripByteCounts = 279,
+    /// \brief Whether samples of a pixel are stored together.
+    planarConfiguration = 284,
+    /// \brief Transformation applied before compression.
+    predictor = 317,
+    /// \brief Number of columns of each tile.
+    tileWidth = 322,
+    /// \brief Number of rows of each tile.
+    tileLength = 323,
+    /// \brief Offset of each tile.
+    tileOffsets = 324,
+    /// \brief Number of bytes of each tile.
+    tileByteCounts = 325,
+    /// \brief Tables shared by tiles compressed with JPEG.
+    jpegTables = 347,
+    /// \brief Size of a pixel in model coordinates (GeoTIFF).
+    modelPixelScale = 33550,
+    /// \brief Points of the image and their model coordinates (GeoTIFF).
+    modelTiepoint = 33922,
+    /// \brief Matrix from image to model coordinates (GeoTIFF).
+    modelTransformation = 34264,
+    /// \brief Keys describing the coordinate system (GeoTIFF).
+    geoKeyDirectory = 34735
+  };
+
+  /// \brief Compression schemes supported.
+  enum Compression {
+    /// \brief No compression.
+    none = 1,
+    /// \brief Lempel-Ziv-Welch.
+    lzw = 5,
+    /// \brief JPEG, with tables possibly shared.
+    jpeg = 7,
+    /// \brief Deflate, as in zlib.
+    deflate = 8,
+    /// \brief Deflate, with the code first used by Adobe.
+    adobeDeflate = 32946,
+    /// \brief Runs of bytes, as in Macintosh PackBits.
+    packBits = 32773
+  };
+
+  /**
+   * \brief Test whether some data begin with a TIFF header.
+   * \param data Data to be tested.
+   * \param size Size of data.
+   * \return True if data begin with a TIFF or BigTIFF header.
+   */
+  bool isTiff (const unsigned char* data, std::size_t size);
+
+  /**
+   * \brief Image file directory of a TIFF file.
+   *
+   * BigTIFF files, whose offsets have 64 bits, are read as well.
+   */
+  class Directory {
+    public:
+      /**
+       * \brief Parse a directory.
+       * \param data Content of the whole file.
+       * \param size Size of the file.
+       * \param offset Offset of the directory, 0 for the first one.
+       * \exception std::runtime_error Data are not a valid TIFF file.
+       */
+      Directory (const unsigned char* data, std::size_t size,
+                 std::uint64_t offset = 0);
+
+      /**
+       * \brief Whether a tag is present.
+       * \param tag Number of the tag.
+       * \return True if the tag is in the directory.
+       */
+      bool has (int tag) const {
+        return (integers.count(tag) > 0) || (reals.count(tag) > 0);
+      }
+
+      /**
+       * \brief First integer value of a tag.
+       * \param tag Number of the tag.
+       * \param defaultValue Value returned if the tag is missing.
+       * \return The value.
+       */
+      std::uint64_t value (int tag, std::uint64_t defaultValue = 0) const {
+        /* Position of the tag. */
+        const IntegerMap::const_iterator i = integers.find(tag);
+        return ((i == integers.end()) || i->second.empty())?
+          defaultValue: i->second.front();
+      }
+
+      /**
+       * \brief Integer values of a tag.
+       * \param tag Number of the tag.
+       * \return The values, empty if the tag is missing.
+       */
+      const std::vector<std::uint64_t> &values (int tag) const;
+
+      /**
+       * \brief Real values of a tag, of type float, double or rational.
+       * \param tag Number of the tag.
+       * \return The values, empty if the tag is missing.
+       */
+      const std::vector<double> &realValues (int tag) const;
+
+      /// \brief Whether or not the file is big endian.
+      bool bigEndian () const {return big;}
+
+      /// \brief Offset of the next directory, 0 if there is none.
+      std::uint64_t next () const {return nextOffset;}
+
+    private:
+      /// \brief Type for integer values of each tag.
+      typedef std::map< int, std::vector<std::uint64_t> > IntegerMap;
+
+      /// \brief Type for real values of each tag.
+      typedef std::map< int, std::vector<double> > RealMap;
+
+      /// \brief Integer values of each tag.
+      IntegerMap integers;
+
+      /// \brief Real values of each tag.
+      RealMap reals;
+
+      /// \brief Whether or not the file is big endian.
+      bool big;
+
+      /// \brief Offset of the next directory.
+      std::uint64_t nextOffset;
+  };
+
+  /**
+   * \brief Pixels of an image of a TIFF file, stored by tiles or by strips.
+   *
+   * Tiles and strips, called blocks here, are decoded one at a time, so
+   * that reading a region only decodes the blocks covering it. Samples
+   * have 8 bits and are stored together for each pixel. Strips are
+   * handled as tiles as wide as the image.
+   */
+  class Image {
+    public:
+      /**
+       * \brief Read the layout of the image.
+       * \param directory Directory of the image.
+       * \param size Size of the file.
+       * \exception std::runtime_error The image is not supported.
+       */
+      Image (const Directory &directory, std::size_t size);
+
+      /// \brief Width of the image.
+      int width () const {return imageWidth_;}
+
+      /// \brief Height of the image.
+      int height () const {return imageHeight_;}
+
+      /// \brief Width of blocks.
+      int blockWidth () const {return blockWidth_;}
+
+      /// \brief Height of blocks.
+      int blockHeight () const {return blockHeight_;}
+
+      /// \brief Number of columns of blocks.
+      int columns () const {
+        return (imageWidth_ + blockWidth_ - 1) / blockWidth_;
+      }
+
+      /// \brief Number of rows of blocks.
+      int rows () const {
+        return (imageHeight_ + blockHeight_ - 1) / blockHeight_;
+      }
+
+      /// \brief Number of samples of each pixel.
+      int samples () const {return samples_;}
+
+      /**
+       * \brief Colour space of decoded samples, as tag
+       * photometricInterpretation: JPEG blocks stored as YCbCr are decoded
+       * to RGB.
+       */
+      int photometric () const {return photometric_;}
+
+      /**
+       * \brief Decode a block.
+       * \param data Content of the whole file.
+       * \param column Column of the block.
+       * \param row Row of the block.
+       * \param pixels Where to put samples, rows after rows, each row
+       * having blockWidth() pixels.
+       * \exception std::runtime_error The block cannot be decoded.
+       */
+      void decode (const unsigned char* data, int column, int row,
+                   std::vector<unsigned char> &pixels) const;
+
+    private:
+      /// \brief Width of the image.
+      int imageWidth_;
+
+      /// \brief Height of the image.
+      int imageHeight_;
+
+      /// \brief Width of blocks.
+      int blockWidth_;
+
+      /// \brief Height of blocks.
+      int blockHeight_;
+
+      /// \brief Number of samples of each pixel.
+      int samples_;
+
+      /// \brief Colour space of decoded samples.
+      int photometric_;
+
+      /// \brief Colour space of stored samples.
+      int stored;
+
+      /// \brief Compression scheme.
+      int compression;
+
+      /// \brief Whether or not differences between pixels are stored.
+      bool differences;
+
+      /// \brief Offset of each block, rows after rows.
+      std::vector<std::uint64_t> offsets;
+
+      /// \brief Number of bytes of each block.
+      std::vector<std::uint64_t> byteCounts;
+
+      /// \brief Tables shared by JPEG blocks.
+      std::vector<unsigned char> tables;
+  };
+
+  /// \brief Geo-reference of a GeoTIFF file.
+  struct GeoReference {
+    /**
+     * \brief Referential change from the image to model coordinates, with
+     * the convention of world files: coordinates of a pixel are those of
+     * its centre.
+     */
+    Projection::ChangeMatrix change;
+
+    /**
+     * \brief EPSG code of the coordinate system of the model, 0 if not
+     * given.
+     */
+    int epsg;
+
+    /// \brief Whether or not model coordinates are projected.
+    bool projected;
+
+    /**
+     * \brief Description of the map projection, as given to
+     * makeProjection(), empty if the coordinate system is not known.
+     */
+    std::string projection;
+  };
+
+  /**
+   * \brief Read the geo-reference of a GeoTIFF file.
+   * \param directory Directory of the image.
+   * \param reference Where to put the geo-reference.
+   * \return Whether or not the image is geo-referenced: by a
+   * transformation matrix, by a tie point and the size of pixels, or by at
+   * least three tie points.
+   */
+  bool readGeoReference (const Directory &directory,
+                         GeoReference &reference);
+}
+
+#endif  // #ifndef TIFF_HPP
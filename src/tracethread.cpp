@@ -0,0 +1,67 @@
+/**
+ * \file tracethread.cpp
+ * \brief Implementation of line following in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cstdint>
+#include <utility>
+#include <QImage>
+
+#include "tracethread.hpp"
+
+const int GUI::TraceThread::cachedTiles;
+
+/* -- Follow the line. ---------------------------------------------------- */
+void GUI::TraceThread::run () {
+  /* Side of tiles. */
+  const int side = ImagePyramid::tileSize;
+  /* Tiles at hand, the last one used first. */
+  QImage tiles [cachedTiles];
+  /* Column of each tile at hand, negative when there is none. */
+  int columns [cachedTiles];
+  /* Row of each tile at hand. */
+  int rows [cachedTiles];
+  for (int i = 0; i < cachedTiles; ++i) columns[i] = rows[i] = -1;
+
+  /*
+   * Pixels are read from tiles at full resolution: lines are mostly
+   * followed inside a single tile, the few last tiles used are kept.
+   */
+  const LineTracer::PixelReader reader =
+    [this, side, &tiles, &columns, &rows] (int x, int y) -> std::uint32_t {
+      /* Column of the tile. */
+      const int column = x / side;
+      /* Row of the tile. */
+      const int row = y / side;
+      /* Place of the tile among those at hand. */
+      int i = 0;
+      while (i < cachedTiles && (columns[i] != column || rows[i] != row))
+        ++i;
+      if (i == cachedTiles) {
+        i = cachedTiles - 1;
+        tiles[i] = pyramid->tile(0, column, row);
+        columns[i] = column;
+        rows[i] = row;
+      }
+      for (; i > 0; --i) {
+        std::swap(tiles[i], tiles[i - 1]);
+        std::swap(columns[i], columns[i - 1]);
+        std::swap(rows[i], rows[i - 1]);
+      }
+      if (tiles[0].isNull()) return 0xffffffffu;
+      return reinterpret_cast<const QRgb*>(tiles[0].constScanLine(y - row
+                                                                  * side))
+        [x - column * side];
+    };
+  /* Size of the image. */
+  const QSize size = pyramid->size();
+  /* The tracer. */
+  LineTracer tracer (reader, size.width(), size.height(), spacing,
+                     tolerance);
+  result = tracer.trace(click.x(), click.y(),
+                        [this] () {return !isCancelled();});
+  if (!isCancelled()) emit traced();
+}
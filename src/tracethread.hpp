@@ -0,0 +1,92 @@
+#ifndef TRACETHREAD_HPP
+#define TRACETHREAD_HPP
+
+/**
+ * \file tracethread.hpp
+ * \brief Following lines of an image in a background thread.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <memory>
+#include <QThread>
+#include <QAtomicInt>
+
+#include "imagepyramid.hpp"
+#include "linetracer.hpp"
+#include "projection.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Thread following the line clicked on an image.
+   *
+   * The line is followed on tiles of the pyramid at full resolution. The
+   * thread can be cancelled at any time, it then stops as soon as possible
+   * without giving any result.
+   */
+  class TraceThread: public QThread {
+      Q_OBJECT
+
+    public:
+      /**
+       * \brief Construct the thread, which should then be started.
+       * \param _pyramid Pyramid of the image, whose levels are set.
+       * \param _click Position clicked, in image coordinates.
+       * \param _spacing Distance between points of the line, in pixels.
+       * \param _tolerance Greatest difference of a colour component between
+       * the line and its pixels.
+       * \param parent Parent object.
+       */
+      TraceThread (const std::shared_ptr<ImagePyramid> &_pyramid,
+                   const Projection::Point2D &_click, double _spacing,
+                   int _tolerance, QObject* parent = 0):
+        QThread (parent), pyramid (_pyramid), click (_click),
+        spacing (_spacing), tolerance (_tolerance), cancelled (0) {}
+
+      /// \brief Ask the thread to stop.
+      void cancel () {cancelled.fetchAndStoreOrdered(1);}
+
+      /// \brief Whether or not the thread has been cancelled.
+      bool isCancelled () const {
+        return cancelled.fetchAndAddOrdered(0) != 0;
+      }
+
+      /// \brief The line, once signal traced() has been emitted.
+      const LineTracer::Line &line () const {return result;}
+
+    signals:
+      /// \brief Emitted when the line has been followed.
+      void traced ();
+
+    protected:
+      /// \brief Follow the line.
+      virtual void run ();
+
+    private:
+      /// \brief Number of tiles kept at hand while following.
+      static const int cachedTiles = 4;
+
+      /// \brief Pyramid of the image.
+      const std::shared_ptr<ImagePyramid> pyramid;
+
+      /// \brief Position clicked.
+      const Projection::Point2D click;
+
+      /// \brief Distance between points of the line.
+      const double spacing;
+
+      /// \brief Greatest difference of a colour component.
+      const int tolerance;
+
+      /// \brief Non-zero when the thread has been cancelled.
+      mutable QAtomicInt cancelled;
+
+      /// \brief The line followed.
+      LineTracer::Line result;
+  };
+}
+
+#endif  // #ifndef TRACETHREAD_HPP
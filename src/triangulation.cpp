@@ -0,0 +1,303 @@
+/**
+ * \file triangulation.cpp
+ * \brief Implementation of the Delaunay triangulation of scattered values.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "triangulation.hpp"
+#include "profiler.hpp"
+
+const Data::Triangulation::Index Data::Triangulation::none;
+const std::size_t Data::Triangulation::progressStep;
+
+namespace {
+  /// \brief A point and its value.
+  typedef Data::Triangulation::Vertex Vertex;
+
+  /**
+   * \brief Tell on which side of a line a position is.
+   * \param a First point of the line.
+   * \param b Second point of the line.
+   * \param x Abscissa of the position.
+   * \param y Ordinate of the position.
+   * \return Twice the area of triangle (a, b, position), positive when it is
+   * counterclockwise.
+   */
+  double orient (const Vertex &a, const Vertex &b, double x, double y) {
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+  }
+
+  /**
+   * \brief Tell whether a point is inside the circle through the vertices
+   * of a triangle.
+   * \param a First vertex of the triangle.
+   * \param b Second vertex, counterclockwise.
+   * \param c Third vertex, counterclockwise.
+   * \param d The point.
+   * \return True if the point is strictly inside the circle.
+   */
+  bool inCircle (const Vertex &a, const Vertex &b, const Vertex &c,
+                 const Vertex &d) {
+    /* Vertices relative to the point. */
+    const double adx = a.x - d.x, ady = a.y - d.y;
+    const double bdx = b.x - d.x, bdy = b.y - d.y;
+    const double cdx = c.x - d.x, cdy = c.y - d.y;
+    return (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy)
+      + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy)
+      + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady) > 0.;
+  }
+}
+
+/* -- Triangulate points. ------------------------------------------------- */
+bool Data::Triangulation::build (const std::vector<Vertex> &_vertices,
+                                 const std::function<bool (int)> &carryOn) {
+  GEODESK_TIME("Triangulation::build");
+  if (_vertices.size() >= static_cast<std::size_t>(none) / 2 - 3)
+    throw std::runtime_error("There are too many points to be "
+                             "triangulated.");
+  vertices = _vertices.data();
+  count = _vertices.size();
+  triangles.clear();
+  if (count == 0) return true;
+
+  /* Smallest abscissa. */
+  double xMin = vertices[0].x;
+  /* Greatest abscissa. */
+  double xMax = xMin;
+  /* Smallest ordinate. */
+  double yMin = vertices[0].y;
+  /* Greatest ordinate. */
+  double yMax = yMin;
+  for (std::size_t i = 1; i < count; ++i) {
+    xMin = std::min(xMin, vertices[i].x);
+    xMax = std::max(xMax, vertices[i].x);
+    yMin = std::min(yMin, vertices[i].y);
+    yMax = std::max(yMax, vertices[i].y);
+  }
+  /* Centre of points. */
+  const double x = .5 * (xMin + xMax), y = .5 * (yMin + yMax);
+  /* Side of the square enclosing points. */
+  double side = std::max(xMax - xMin, yMax - yMin);
+  if (!(side > 0.)) side = 1.;
+  const Vertex corners [3] = {{x - 20. * side, y - 10. * side, 0.},
+                              {x + 20. * side, y - 10. * side, 0.},
+                              {x, y + 20. * side, 0.}};
+  std::copy(corners, corners + 3, enclosing);
+
+  /* Every point adds two triangles. */
+  triangles.reserve(2 * count + 1);
+  /* Index of the first vertex of the enclosing triangle. */
+  const Index first = static_cast<Index>(count);
+  const Triangle all = {{first, first + 1, first + 2}, {none, none, none}};
+  triangles.push_back(all);
+
+  /* Triangle next to the last point inserted. */
+  Index hint = 0;
+  /* Triangles to be checked after an insertion. */
+  std::vector<Index> stack;
+  for (std::size_t i = 0; i < count; ++i) {
+    insert(static_cast<Index>(i), hint, stack);
+    if ((i + 1) % progressStep == 0
+        && !carryOn(static_cast<int>(100. * (i + 1) / count)))
+      return false;
+  }
+  GEODESK_COUNT("triangles", static_cast<long long>(triangles.size()));
+  return true;
+}
+
+/* -- Interpolate the value at a position. -------------------------------- */
+bool Data::Triangulation::interpolate (double x, double y, Index &hint,
+                                       double &value) const {
+  /* Where the position is. */
+  const Location where = locate(x, y, hint);
+  if (where.triangle == none) return false;
+  hint = where.triangle;
+  /* Triangle containing the position. */
+  const Triangle &triangle = triangles[hint];
+  for (int i = 0; i < 3; ++i)
+    if (triangle.vertex[i] >= count) return false;
+  /* Vertices of the triangle. */
+  const Vertex &a = at(triangle.vertex[0]);
+  const Vertex &b = at(triangle.vertex[1]);
+  const Vertex &c = at(triangle.vertex[2]);
+  /* Twice the area of the triangle. */
+  const double area = orient(a, b, c.x, c.y);
+  if (!(area > 0.)) return false;
+  /* Weight of the first vertex. */
+  const double wa = orient(b, c, x, y) / area;
+  /* Weight of the second vertex. */
+  const double wb = orient(c, a, x, y) / area;
+  value = wa * a.value + wb * b.value + (1. - wa - wb) * c.value;
+  return true;
+}
+
+/* -- Find the triangle containing a position. ---------------------------- */
+Data::Triangulation::Location
+Data::Triangulation::locate (double x, double y, Index start) const {
+  /* Where the position is, not found yet. */
+  Location found = {none, -1};
+  if (triangles.empty()) return found;
+
+  /*
+   * Test a triangle: put the edge the position is on in "edge," and return
+   * an edge the position is beyond, -1 if the triangle contains it. Edges
+   * are tested from the one given, so that walks do not loop.
+   */
+  const auto test = [this, x, y] (const Triangle &triangle, int from,
+                                  int &edge) {
+    edge = -1;
+    for (int j = 0; j < 3; ++j) {
+      /* Vertex opposite the edge. */
+      const int i = (j + from) % 3;
+      /* Side of the edge the position is on. */
+      const double side = orient(at(triangle.vertex[(i + 1) % 3]),
+                                 at(triangle.vertex[(i + 2) % 3]), x, y);
+      if (side < 0.) return i;
+      if (side == 0.) edge = (edge < 0)? i: 3;
+    }
+    return -1;
+  };
+
+  /* Current triangle. */
+  Index current = (start < triangles.size())? start: 0;
+  /* State of the generator choosing the first edge tested. */
+  std::uint32_t random = current;
+  for (std::size_t steps = 0; steps <= triangles.size(); ++steps) {
+    random = random * 1103515245u + 12345u;
+    /* Edge the position is beyond, if any. */
+    const int beyond = test(triangles[current], (random >> 16) % 3,
+                            found.edge);
+    if (beyond < 0) {
+      found.triangle = current;
+      return found;
+    }
+    current = triangles[current].neighbour[beyond];
+    if (current == none) return found;
+  }
+
+  /* The walk has not ended, rounding errors make it loop. */
+  for (Index i = 0; i < triangles.size(); ++i)
+    if (test(triangles[i], 0, found.edge) < 0) {
+      found.triangle = i;
+      return found;
+    }
+  found.edge = -1;
+  return found;
+}
+
+/* -- Insert a point. ----------------------------------------------------- */
+void Data::Triangulation::insert (Index index, Index &hint,
+                                  std::vector<Index> &stack) {
+  /* The point. */
+  const Vertex &point = vertices[index];
+  /* Where the point is. */
+  const Location where = locate(point.x, point.y, hint);
+  if (where.triangle == none || where.edge == 3) return;
+  /* Triangle containing the point. */
+  const Index t = where.triangle;
+  /* The triangle, before it is split. */
+  const Triangle old = triangles[t];
+  /* Index of the next triangle. */
+  const Index next = static_cast<Index>(triangles.size());
+
+  if (where.edge < 0) {
+    /* The triangle is split in three. */
+    const Index a = old.vertex[0], b = old.vertex[1], c = old.vertex[2];
+    const Triangle first = {{index, b, c}, {old.neighbour[0], next,
+                                            next + 1}};
+    const Triangle second = {{index, c, a}, {old.neighbour[1], next + 1,
+                                             t}};
+    const Triangle third = {{index, a, b}, {old.neighbour[2], t, next}};
+    triangles[t] = first;
+    triangles.push_back(second);
+    triangles.push_back(third);
+    relink(old.neighbour[1], t, next);
+    relink(old.neighbour[2], t, next + 1);
+    stack.push_back(t);
+    stack.push_back(next);
+    stack.push_back(next + 1);
+  }
+  else {
+    /* The point is on edge (b, c), both triangles along it are split. */
+    const int i = where.edge;
+    const Index a = old.vertex[i], b = old.vertex[(i + 1) % 3],
+      c = old.vertex[(i + 2) % 3];
+    /* Triangle on the other side of the edge. */
+    const Index o = old.neighbour[i];
+    if (o == none) return;
+    /* The other triangle, before it is split. */
+    const Triangle other = triangles[o];
+    /* Index of the edge in the other triangle. */
+    int k = 0;
+    while (k < 3 && other.neighbour[k] != t) ++k;
+    if (k == 3) return;
+    /* Vertex of the other triangle opposite the edge. */
+    const Index d = other.vertex[k];
+    const Triangle first = {{index, c, a}, {old.neighbour[(i + 1) % 3],
+                                            next, next + 1}};
+    const Triangle second = {{index, b, d}, {other.neighbour[(k + 1) % 3],
+                                             next + 1, next}};
+    const Triangle third = {{index, a, b}, {old.neighbour[(i + 2) % 3], o,
+                                            t}};
+    const Triangle fourth = {{index, d, c}, {other.neighbour[(k + 2) % 3],
+                                             t, o}};
+    triangles[t] = first;
+    triangles[o] = second;
+    triangles.push_back(third);
+    triangles.push_back(fourth);
+    relink(old.neighbour[(i + 2) % 3], t, next);
+    relink(other.neighbour[(k + 2) % 3], o, next + 1);
+    stack.push_back(t);
+    stack.push_back(o);
+    stack.push_back(next);
+    stack.push_back(next + 1);
+  }
+  hint = t;
+  legalize(stack);
+}
+
+/* -- Flip edges until triangles are Delaunay. ---------------------------- */
+void Data::Triangulation::legalize (std::vector<Index> &stack) {
+  while (!stack.empty()) {
+    /* Triangle whose first vertex is the new point. */
+    const Index t = stack.back();
+    stack.pop_back();
+    /* Triangle across the edge opposite the new point. */
+    const Index o = triangles[t].neighbour[0];
+    if (o == none) continue;
+    /* The triangle. */
+    Triangle &triangle = triangles[t];
+    /* The triangle across. */
+    Triangle &other = triangles[o];
+    /* Index of the edge in the triangle across. */
+    int k = 0;
+    while (k < 3 && other.neighbour[k] != t) ++k;
+    if (k == 3) continue;
+    /* Vertices of both triangles. */
+    const Index p = triangle.vertex[0], b = triangle.vertex[1],
+      c = triangle.vertex[2], d = other.vertex[k];
+    if (!inCircle(at(p), at(b), at(c), at(d))) continue;
+    /* Edge (p, d) should be inside the quadrilateral to be flipped. */
+    if (!(orient(at(p), at(b), at(d).x, at(d).y) > 0.)
+        || !(orient(at(p), at(d), at(c).x, at(c).y) > 0.))
+      continue;
+
+    /* Neighbours around the quadrilateral. */
+    const Index bd = other.neighbour[(k + 1) % 3],
+      dc = other.neighbour[(k + 2) % 3], cp = triangle.neighbour[1],
+      pb = triangle.neighbour[2];
+    const Triangle first = {{p, b, d}, {bd, o, pb}};
+    const Triangle second = {{p, d, c}, {dc, cp, t}};
+    triangle = first;
+    other = second;
+    relink(bd, o, t);
+    relink(cp, t, o);
+    stack.push_back(t);
+    stack.push_back(o);
+  }
+}
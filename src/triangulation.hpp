@@ -0,0 +1,178 @@
+#ifndef TRIANGULATION_HPP
+#define TRIANGULATION_HPP
+
+/**
+ * \file triangulation.hpp
+ * \brief Delaunay triangulation of scattered values, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/// \brief Namespace for geo-referenced data.
+namespace Data {
+  /**
+   * \brief Delaunay triangulation of points bearing values, interpolated
+   * linearly in triangles.
+   *
+   * Points are inserted one after the other in a triangle enclosing them
+   * all, locating each one by walking from the triangle of the previous
+   * one, then restoring the Delaunay property by flipping edges (Lawson's
+   * algorithm). Points given in a spatially coherent order, such as the one
+   * of a kd-tree, are thus located in a few steps. Points at the position of
+   * a point already inserted are ignored.
+   *
+   * Triangles take about 48 bytes per point. Vertices are referred to by
+   * their index, so that at most about two billion points can be
+   * triangulated.
+   */
+  class Triangulation {
+    public:
+      /// \brief Index of vertices and triangles.
+      typedef std::uint32_t Index;
+
+      /// \brief Index of no triangle.
+      static const Index none = static_cast<Index>(-1);
+
+      /// \brief Number of points inserted between two calls of progress.
+      static const std::size_t progressStep = 1 << 16;
+
+      /// \brief A point and its value.
+      struct Vertex {
+        /// \brief Abscissa.
+        double x;
+
+        /// \brief Ordinate.
+        double y;
+
+        /// \brief Value at the point.
+        double value;
+      };
+
+      /// \brief Construct an empty triangulation.
+      Triangulation (): vertices (0), count (0) {}
+
+      /**
+       * \brief Triangulate points.
+       * \param _vertices Points, which should not change while the
+       * triangulation is used.
+       * \param carryOn Function called as points are inserted with the
+       * percentage of points inserted, which interrupts triangulating when
+       * returning false.
+       * \return Whether or not every point has been inserted.
+       * \exception std::runtime_error There are too many points.
+       */
+      bool build (const std::vector<Vertex> &_vertices,
+                  const std::function<bool (int)> &carryOn);
+
+      /// \brief Number of triangles, including those of the enclosing one.
+      std::size_t size () const {return triangles.size();}
+
+      /**
+       * \brief Interpolate the value at a position.
+       * \param x Abscissa.
+       * \param y Ordinate.
+       * \param hint Triangle the search starts from, set to the triangle
+       * found, none to start anywhere.
+       * \param value Where to put the value.
+       * \return Whether or not the position is inside the convex hull of
+       * points.
+       */
+      bool interpolate (double x, double y, Index &hint, double &value)
+        const;
+
+    private:
+      /// \brief A triangle, whose vertices are counterclockwise.
+      struct Triangle {
+        /// \brief Vertices.
+        Index vertex [3];
+
+        /// \brief Triangle across the edge opposite each vertex, if any.
+        Index neighbour [3];
+      };
+
+      /// \brief Where a point has been located.
+      struct Location {
+        /// \brief Triangle containing the point, none if not found.
+        Index triangle;
+
+        /**
+         * \brief Vertex opposite the edge the point is on, -1 if inside
+         * the triangle, 3 if the point is a vertex.
+         */
+        int edge;
+      };
+
+      /// \brief Points triangulated.
+      const Vertex* vertices;
+
+      /// \brief Number of points triangulated.
+      std::size_t count;
+
+      /// \brief Vertices of the triangle enclosing every point.
+      Vertex enclosing [3];
+
+      /// \brief Triangles.
+      std::vector<Triangle> triangles;
+
+      /**
+       * \brief Position of a vertex.
+       * \param index Index of the vertex, those following points being the
+       * ones of the enclosing triangle.
+       */
+      const Vertex &at (Index index) const {
+        return (index < count)? vertices[index]: enclosing[index - count];
+      }
+
+      /**
+       * \brief Find the triangle containing a position, by walking from
+       * triangle to triangle.
+       * \param x Abscissa.
+       * \param y Ordinate.
+       * \param start Triangle the walk starts from.
+       * \return Where the position is.
+       */
+      Location locate (double x, double y, Index start) const;
+
+      /**
+       * \brief Insert a point.
+       * \param index Index of the point.
+       * \param hint Triangle the search starts from, set to a triangle
+       * next to the point.
+       * \param stack Triangles to be checked, empty, left empty.
+       */
+      void insert (Index index, Index &hint, std::vector<Index> &stack);
+
+      /**
+       * \brief Flip edges opposite to a new point until triangles are
+       * Delaunay again.
+       * \param stack Triangles whose first vertex is the new point, and
+       * whose edge opposite to it is to be checked, emptied.
+       */
+      void legalize (std::vector<Index> &stack);
+
+      /**
+       * \brief Make a triangle refer to a new neighbour instead of an old
+       * one.
+       * \param triangle The triangle, possibly none.
+       * \param previous The old neighbour.
+       * \param next The new neighbour.
+       */
+      void relink (Index triangle, Index previous, Index next) {
+        if (triangle == none) return;
+        for (int i = 0; i < 3; ++i)
+          if (triangles[triangle].neighbour[i] == previous) {
+            triangles[triangle].neighbour[i] = next;
+            return;
+          }
+      }
+  };
+}
+
+#endif  // #ifndef TRIANGULATION_HPP
@@ -0,0 +1,704 @@
+/**
+ * \file vectorexport.cpp
+ * \brief Implementation of isobaths exported as polylines.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <fstream>
+#include <stdexcept>
+
+#include "vectorexport.hpp"
+#include "profiler.hpp"
+
+const std::size_t Data::VectorExporter::chunkSize;
+const std::size_t Data::VectorExporter::bufferSize;
+
+namespace {
+  /// \brief Function reading samples.
+  typedef Data::VectorExporter::SampleReader SampleReader;
+
+  /// \brief Size of headers of Shapefiles and their index, in bytes.
+  const std::size_t shapeHeaderSize = 100;
+
+  /// \brief Shape type of polylines.
+  const std::uint32_t polyLineType = 3;
+
+  /// \brief Fields of the attributes of Shapefiles.
+  struct Field {
+    /// \brief Name of the field.
+    const char* name;
+
+    /// \brief Number of characters.
+    int width;
+
+    /// \brief Number of decimals.
+    int decimals;
+  };
+
+  /// \brief Line number, value and number of points of each line.
+  const Field fields [] = {{"LINE", 10, 0}, {"VALUE", 18, 3},
+                           {"POINTS", 10, 0}};
+
+  /// \brief Number of fields of attributes.
+  const std::size_t fieldCount = sizeof(fields) / sizeof(fields[0]);
+
+  /// \brief Size of the header of attribute files, in bytes.
+  const std::size_t attributeHeaderSize = 32 + 32 * fieldCount + 1;
+
+  /// \brief Samples read one after the other, by chunks.
+  class Cursor {
+    public:
+      /**
+       * \brief Construct a cursor on the first sample.
+       * \param _reader Function reading samples.
+       * \param _count Number of samples.
+       */
+      Cursor (const SampleReader &_reader, std::size_t _count):
+        reader (_reader), count (_count), first (0), loaded (0),
+        position (0), buffer (Data::VectorExporter::chunkSize) {}
+
+      /// \brief Whether every sample has been read.
+      bool atEnd () const {return position == count;}
+
+      /// \brief Index of the current sample.
+      std::size_t index () const {return position;}
+
+      /// \brief The current sample, which should exist.
+      const Data::Sample &current () {
+        if (position == first + loaded) {
+          first = position;
+          loaded = std::min(buffer.size(), count - first);
+          reader(first, loaded, &buffer[0]);
+        }
+        return buffer[position - first];
+      }
+
+      /// \brief Go to the next sample.
+      void advance () {++position;}
+
+    private:
+      /// \brief Function reading samples.
+      const SampleReader &reader;
+
+      /// \brief Number of samples.
+      const std::size_t count;
+
+      /// \brief Index of the first sample in the buffer.
+      std::size_t first;
+
+      /// \brief Number of samples in the buffer.
+      std::size_t loaded;
+
+      /// \brief Index of the current sample.
+      std::size_t position;
+
+      /// \brief Samples read.
+      std::vector<Data::Sample> buffer;
+  };
+
+  /// \brief A line: successive samples of the same value.
+  struct Line {
+    /// \brief Number of the line, starting from 1.
+    std::size_t number;
+
+    /// \brief Number of samples.
+    std::size_t size;
+
+    /// \brief Value of samples.
+    double value;
+
+    /// \brief Smallest longitude.
+    double west;
+
+    /// \brief Smallest latitude.
+    double south;
+
+    /// \brief Greatest longitude.
+    double east;
+
+    /// \brief Greatest latitude.
+    double north;
+  };
+
+  /**
+   * \brief Read a line.
+   * \param samples Cursor on the first sample of the line, left after it.
+   * \param gap Greatest distance between two samples of a line.
+   * \return The line, without its number.
+   */
+  Line scan (Cursor &samples, double gap) {
+    /* Previous sample of the line. */
+    Data::Sample previous = samples.current();
+    /* The line. */
+    Line line = {0, 0, previous.value, previous.longitude, previous.latitude,
+                 previous.longitude, previous.latitude};
+    for (;;) {
+      line.west = std::min(line.west, previous.longitude);
+      line.south = std::min(line.south, previous.latitude);
+      line.east = std::max(line.east, previous.longitude);
+      line.north = std::max(line.north, previous.latitude);
+      ++line.size;
+      samples.advance();
+      if (samples.atEnd()) break;
+      /* Next sample. */
+      const Data::Sample &next = samples.current();
+      if (next.value != line.value
+          || (gap > 0. && std::hypot(next.x - previous.x, next.y - previous.y)
+                          > gap))
+        break;
+      previous = next;
+    }
+    return line;
+  }
+
+  /**
+   * \brief Put a 32-bit number in big-endian order.
+   * \param out Where to put the number.
+   * \param value The number.
+   */
+  void putBig32 (char* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+      out[i] = static_cast<char>((value >> (8 * (3 - i))) & 0xff);
+  }
+
+  /**
+   * \brief Put a 32-bit number in little-endian order.
+   * \param out Where to put the number.
+   * \param value The number.
+   */
+  void putLittle32 (char* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+      out[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+
+  /**
+   * \brief Put a double in little-endian order.
+   * \param out Where to put the number.
+   * \param value The number.
+   */
+  void putLittleDouble (char* out, double value) {
+    /* Bits of the number. */
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+      out[i] = static_cast<char>((bits >> (8 * i)) & 0xff);
+  }
+
+  /**
+   * \brief Write a number in JSON, null when not finite.
+   * \param stream Stream where to write.
+   * \param value The number.
+   */
+  void writeJsonNumber (std::ostream &stream, double value) {
+    if (std::isfinite(value))
+      stream << value;
+    else
+      stream << "null";
+  }
+
+  /// \brief File written through a buffer of fixed size.
+  class OutputFile {
+    public:
+      /**
+       * \brief Open the file.
+       * \param _name Name of the file.
+       * \exception std::runtime_error The file cannot be opened.
+       */
+      explicit OutputFile (const std::string &_name):
+        name (_name), buffer (Data::VectorExporter::bufferSize) {
+        stream.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+        stream.open(name.c_str(), std::ios_base::binary
+                                  | std::ios_base::trunc);
+        if (!stream)
+          throw std::runtime_error("File \"" + name
+                                   + "\" cannot be opened.");
+        stream.precision(std::numeric_limits<double>::digits10);
+      }
+
+      /**
+       * \brief Close the file.
+       * \exception std::runtime_error The file cannot be written.
+       */
+      void close () {
+        stream.close();
+        if (!stream)
+          throw std::runtime_error("File \"" + name
+                                   + "\" cannot be written.");
+      }
+
+      /// \brief Stream on the file.
+      std::ostream &out () {return stream;}
+
+      /// \brief Name of the file.
+      const std::string name;
+
+    private:
+      /// \brief Buffer of the stream, which should outlive it.
+      std::vector<char> buffer;
+
+      /// \brief Stream on the file.
+      std::ofstream stream;
+  };
+
+  /// \brief Writer of GeoJSON feature collections.
+  class GeoJsonWriter {
+    public:
+      /**
+       * \brief Begin the file.
+       * \param fileName Name of the file.
+       */
+      explicit GeoJsonWriter (const std::string &fileName): file (fileName) {
+        file.out() << "{\"type\":\"FeatureCollection\",\"features\":[";
+      }
+
+      /**
+       * \brief Write a line as a feature.
+       * \param line The line.
+       * \param samples Cursor on its first sample, left after it.
+       */
+      void line (const Line &line, Cursor &samples) {
+        /* Stream on the file. */
+        std::ostream &out = file.out();
+        out << (line.number == 1? "\n": ",\n")
+            << "{\"type\":\"Feature\",\"properties\":{\"line\":"
+            << line.number << ",\"value\":";
+        writeJsonNumber(out, line.value);
+        out << "},\"geometry\":{\"type\":\""
+            << (line.size == 1? "Point": "LineString")
+            << "\",\"coordinates\":";
+        if (line.size > 1) out << '[';
+        for (std::size_t i = 0; i < line.size; ++i, samples.advance()) {
+          /* Sample of the line. */
+          const Data::Sample &sample = samples.current();
+          out << (i == 0? "[": ",[");
+          writeJsonNumber(out, sample.longitude);
+          out << ',';
+          writeJsonNumber(out, sample.latitude);
+          out << ']';
+        }
+        if (line.size > 1) out << ']';
+        out << "}}";
+      }
+
+      /// \brief End the file.
+      void finish () {
+        file.out() << "\n]}\n";
+        file.close();
+      }
+
+    private:
+      /// \brief The file.
+      OutputFile file;
+  };
+
+  /// \brief Writer of comma-separated values.
+  class CsvWriter {
+    public:
+      /**
+       * \brief Begin the file with its header.
+       * \param fileName Name of the file.
+       */
+      explicit CsvWriter (const std::string &fileName): file (fileName) {
+        file.out() << "line,x,y,longitude,latitude,value\n";
+      }
+
+      /**
+       * \brief Write samples of a line.
+       * \param line The line.
+       * \param samples Cursor on its first sample, left after it.
+       */
+      void line (const Line &line, Cursor &samples) {
+        for (std::size_t i = 0; i < line.size; ++i, samples.advance()) {
+          /* Sample of the line. */
+          const Data::Sample &sample = samples.current();
+          file.out() << line.number << ',' << sample.x << ',' << sample.y
+                      << ',' << sample.longitude << ',' << sample.latitude
+                      << ',' << sample.value << '\n';
+        }
+      }
+
+      /// \brief End the file.
+      void finish () {file.close();}
+
+    private:
+      /// \brief The file.
+      OutputFile file;
+  };
+
+  /**
+   * \brief Writer of Shapefiles of polylines.
+   *
+   * Headers are written first with nothing counted, then rewritten once
+   * every line is written.
+   */
+  class ShapefileWriter {
+    public:
+      /**
+       * \brief Begin the files.
+       * \param shapeName Name of the file of shapes.
+       * \param indexName Name of the index.
+       * \param attributeName Name of the file of attributes.
+       */
+      ShapefileWriter (const std::string &shapeName,
+                       const std::string &indexName,
+                       const std::string &attributeName):
+        shapes (shapeName), index (indexName), attributes (attributeName),
+        shapeWords (shapeHeaderSize / 2), records (0), west (0.),
+        south (0.), east (0.), north (0.) {
+        writeHeaders();
+      }
+
+      /**
+       * \brief Write a line as a shape and its attributes.
+       * \param line The line.
+       * \param samples Cursor on its first sample, left after it.
+       * \exception std::runtime_error The file of shapes would be too
+       * large.
+       */
+      void line (const Line &line, Cursor &samples) {
+        /* Number of points, a line having at least two. */
+        const std::size_t points = std::max<std::size_t>(line.size, 2);
+        /* Length of the shape, in 16-bit words. */
+        const std::uint64_t words = 24 + 8 * static_cast<std::uint64_t>(
+                                                points);
+        if (shapeWords + 4 + words
+            > static_cast<std::uint64_t>(
+                std::numeric_limits<std::int32_t>::max()))
+          throw std::runtime_error("File \"" + shapes.name + "\" would be "
+                                   "too large for a Shapefile.");
+        if (records == 0) {
+          west = line.west;
+          south = line.south;
+          east = line.east;
+          north = line.north;
+        }
+        else {
+          west = std::min(west, line.west);
+          south = std::min(south, line.south);
+          east = std::max(east, line.east);
+          north = std::max(north, line.north);
+        }
+        ++records;
+
+        /* Record in the index. */
+        char entry [8];
+        putBig32(entry, static_cast<std::uint32_t>(shapeWords));
+        putBig32(entry + 4, static_cast<std::uint32_t>(words));
+        index.out().write(entry, sizeof(entry));
+
+        /* Header of the record and of the shape. */
+        char header [56];
+        putBig32(header, static_cast<std::uint32_t>(records));
+        putBig32(header + 4, static_cast<std::uint32_t>(words));
+        putLittle32(header + 8, polyLineType);
+        putLittleDouble(header + 12, line.west);
+        putLittleDouble(header + 20, line.south);
+        putLittleDouble(header + 28, line.east);
+        putLittleDouble(header + 36, line.north);
+        putLittle32(header + 44, 1);
+        putLittle32(header + 48, static_cast<std::uint32_t>(points));
+        putLittle32(header + 52, 0);
+        shapes.out().write(header, sizeof(header));
+        /* Coordinates of a point. */
+        char point [16];
+        for (std::size_t i = 0; i < line.size; ++i, samples.advance()) {
+          /* Sample of the line. */
+          const Data::Sample &sample = samples.current();
+          putLittleDouble(point, sample.longitude);
+          putLittleDouble(point + 8, sample.latitude);
+          shapes.out().write(point, sizeof(point));
+        }
+        if (line.size == 1) shapes.out().write(point, sizeof(point));
+        shapeWords += 4 + words;
+
+        /* Values of fields. */
+        const double values [fieldCount] = {
+          static_cast<double>(line.number), line.value,
+          static_cast<double>(line.size)
+        };
+        attributes.out().put(' ');
+        for (std::size_t i = 0; i < fieldCount; ++i)
+          writeField(fields[i], values[i]);
+      }
+
+      /// \brief Write headers and close the files.
+      void finish () {
+        attributes.out().put(0x1a);
+        writeHeaders();
+        shapes.close();
+        index.close();
+        attributes.close();
+      }
+
+    private:
+      /// \brief File of shapes.
+      OutputFile shapes;
+
+      /// \brief Index of shapes.
+      OutputFile index;
+
+      /// \brief File of attributes.
+      OutputFile attributes;
+
+      /// \brief Length of the file of shapes, in 16-bit words.
+      std::uint64_t shapeWords;
+
+      /// \brief Number of lines written.
+      std::size_t records;
+
+      /// \brief Smallest longitude of lines written.
+      double west;
+
+      /// \brief Smallest latitude of lines written.
+      double south;
+
+      /// \brief Greatest longitude of lines written.
+      double east;
+
+      /// \brief Greatest latitude of lines written.
+      double north;
+
+      /// \brief Write headers at the beginning of files.
+      void writeHeaders () {
+        /* Header of the file of shapes, then of the index. */
+        char header [shapeHeaderSize] = {};
+        putBig32(header, 9994);
+        putLittle32(header + 28, 1000);
+        putLittle32(header + 32, polyLineType);
+        putLittleDouble(header + 36, west);
+        putLittleDouble(header + 44, south);
+        putLittleDouble(header + 52, east);
+        putLittleDouble(header + 60, north);
+        putBig32(header + 24, static_cast<std::uint32_t>(shapeWords));
+        shapes.out().seekp(0);
+        shapes.out().write(header, sizeof(header));
+        putBig32(header + 24,
+                 static_cast<std::uint32_t>(shapeHeaderSize / 2
+                                            + 4 * records));
+        index.out().seekp(0);
+        index.out().write(header, sizeof(header));
+
+        /* Header of the file of attributes. */
+        char attributeHeader [attributeHeaderSize] = {};
+        /* Current time. */
+        const std::time_t now = std::time(0);
+        /* Current date. */
+        const std::tm* date = std::localtime(&now);
+        attributeHeader[0] = 0x03;
+        if (date) {
+          attributeHeader[1] = static_cast<char>(date->tm_year % 256);
+          attributeHeader[2] = static_cast<char>(date->tm_mon + 1);
+          attributeHeader[3] = static_cast<char>(date->tm_mday);
+        }
+        putLittle32(attributeHeader + 4, static_cast<std::uint32_t>(records));
+        /* Size of a record. */
+        int recordSize = 1;
+        for (std::size_t i = 0; i < fieldCount; ++i) {
+          /* Description of the field. */
+          char* field = attributeHeader + 32 + 32 * i;
+          std::strncpy(field, fields[i].name, 10);
+          field[11] = 'N';
+          field[16] = static_cast<char>(fields[i].width);
+          field[17] = static_cast<char>(fields[i].decimals);
+          recordSize += fields[i].width;
+        }
+        attributeHeader[8] = static_cast<char>(attributeHeaderSize & 0xff);
+        attributeHeader[9] = static_cast<char>(attributeHeaderSize >> 8);
+        attributeHeader[10] = static_cast<char>(recordSize & 0xff);
+        attributeHeader[11] = static_cast<char>(recordSize >> 8);
+        attributeHeader[attributeHeaderSize - 1] = 0x0d;
+        attributes.out().seekp(0);
+        attributes.out().write(attributeHeader, sizeof(attributeHeader));
+      }
+
+      /**
+       * \brief Write the value of a numeric field, right-aligned, blank
+       * when not finite and made of stars when too wide.
+       * \param field The field.
+       * \param value The value.
+       */
+      void writeField (const Field &field, double value) {
+        /* Text of the value. */
+        char text [64];
+        /* Number of characters of the value. */
+        int length = std::isfinite(value)?
+          std::snprintf(text, sizeof(text), "%*.*f", field.width,
+                        field.decimals, value): 0;
+        if (!std::isfinite(value) || length > field.width) {
+          std::memset(text, std::isfinite(value)? '*': ' ', field.width);
+          length = field.width;
+        }
+        attributes.out().write(text, length);
+      }
+
+      /// \brief Copy is forbidden.
+      ShapefileWriter (const ShapefileWriter &);
+
+      /// \brief Copy is forbidden.
+      ShapefileWriter &operator = (const ShapefileWriter &);
+  };
+
+  /**
+   * \brief Write every line.
+   * \param reader Function reading samples.
+   * \param count Number of samples.
+   * \param gap Greatest distance between two samples of a line.
+   * \param writer Writer of the file.
+   * \param carryOn Function called with the percentage of samples written.
+   * \param lines Where to put the number of lines written.
+   * \return Whether or not every line has been written.
+   */
+  template <class Writer>
+  bool writeLines (const SampleReader &reader, std::size_t count, double gap,
+                   Writer &writer, const std::function<bool (int)> &carryOn,
+                   std::size_t &lines) {
+    /* Cursor finding ends of lines. */
+    Cursor scanned (reader, count);
+    /* Cursor on samples written. */
+    Cursor written (reader, count);
+    /* Percentage last reported. */
+    int reported = -1;
+    for (lines = 0; !scanned.atEnd();) {
+      /* The line. */
+      Line line = scan(scanned, gap);
+      line.number = ++lines;
+      writer.line(line, written);
+      /* Percentage of samples written. */
+      const int percent = static_cast<int>(100 * written.index() / count);
+      if (percent != reported) {
+        reported = percent;
+        if (!carryOn(percent)) return false;
+      }
+    }
+    writer.finish();
+    return true;
+  }
+
+  /**
+   * \brief Name of a file next to a Shapefile.
+   * \param fileName Name of the Shapefile.
+   * \param extension Extension of the file.
+   * \return Name of the file.
+   */
+  std::string sideFile (const std::string &fileName,
+                        const std::string &extension) {
+    return fileName.substr(0, fileName.size() - 4) + extension;
+  }
+}
+
+/* -- Format of an exported file. ----------------------------------------- */
+Data::VectorFormat Data::vectorFormat (const std::string &fileName) {
+  /* Name of the file, in lower case. */
+  std::string name = fileName;
+  std::transform(name.begin(), name.end(), name.begin(),
+                 [] (char c) {
+                   return static_cast<char>(std::tolower(
+                     static_cast<unsigned char>(c)));
+                 });
+  /* Whether the name ends with an extension. */
+  const auto endsWith = [&name] (const std::string &extension) {
+    return name.size() > extension.size()
+      && name.compare(name.size() - extension.size(), extension.size(),
+                      extension) == 0;
+  };
+  if (endsWith(".geojson") || endsWith(".json")) return geoJsonFormat;
+  if (endsWith(".csv")) return csvFormat;
+  if (endsWith(".shp")) return shapefileFormat;
+  throw std::runtime_error("Format of file \"" + fileName + "\" is not "
+                           "known, it should end with \".geojson\", "
+                           "\".csv\" or \".shp\".");
+}
+
+/* -- Export samples of a list. ------------------------------------------- */
+Data::VectorExporter::VectorExporter (const std::vector<Sample> &samples,
+                                      double _gap):
+  reader ([&samples] (std::size_t first, std::size_t number,
+                      Sample* destination) {
+            std::copy(samples.begin() + first,
+                      samples.begin() + first + number, destination);
+          }),
+  count (samples.size()), gap (_gap) {}
+
+/* -- Export samples of a binary data file. ------------------------------- */
+Data::VectorExporter::VectorExporter (const BinaryFile &file, double _gap):
+  reader ([&file] (std::size_t first, std::size_t number,
+                   Sample* destination) {
+            /* Member of samples corresponding to each column. */
+            static double Sample::* const members [columnCount] = {
+              &Sample::x, &Sample::y, &Sample::longitude, &Sample::latitude,
+              &Sample::value
+            };
+            /* Values of a column. */
+            std::vector<double> values (number);
+            for (int column = 0; column < columnCount; ++column) {
+              file.read(static_cast<Column>(column), first, number,
+                        values.data());
+              for (std::size_t i = 0; i < number; ++i)
+                destination[i].*members[column] = values[i];
+            }
+          }),
+  count (file.size()), gap (_gap) {}
+
+/* -- Write lines in a file. ---------------------------------------------- */
+std::size_t Data::VectorExporter::write (const std::string &fileName,
+                                         VectorFormat format,
+                                         const std::function<bool (int)>
+                                           &carryOn) const {
+  GEODESK_TIME("VectorExporter::write");
+  /* Names of files written. */
+  std::vector<std::string> names (1, fileName);
+  if (format == shapefileFormat) {
+    names.push_back(sideFile(fileName, ".shx"));
+    names.push_back(sideFile(fileName, ".dbf"));
+  }
+  /* Number of lines written. */
+  std::size_t lines = 0;
+  /* Whether every line has been written. */
+  bool complete = false;
+  try {
+    switch (format) {
+      case geoJsonFormat: {
+        /* Writer of the file. */
+        GeoJsonWriter writer (fileName);
+        complete = writeLines(reader, count, gap, writer, carryOn, lines);
+        break;
+      }
+
+      case csvFormat: {
+        /* Writer of the file. */
+        CsvWriter writer (fileName);
+        complete = writeLines(reader, count, gap, writer, carryOn, lines);
+        break;
+      }
+
+      case shapefileFormat: {
+        /* Writer of the files. */
+        ShapefileWriter writer (names[0], names[1], names[2]);
+        complete = writeLines(reader, count, gap, writer, carryOn, lines);
+        break;
+      }
+    }
+  }
+  catch (const std::runtime_error &) {
+    for (std::size_t i = 0; i < names.size(); ++i)
+      std::remove(names[i].c_str());
+    throw;
+  }
+  if (!complete) {
+    for (std::size_t i = 0; i < names.size(); ++i)
+      std::remove(names[i].c_str());
+    return 0;
+  }
+  GEODESK_COUNT("lines exported", static_cast<long long>(lines));
+  return lines;
+}
@@ -0,0 +1,129 @@
+#ifndef VECTOREXPORT_HPP
+#define VECTOREXPORT_HPP
+
+/**
+ * \file vectorexport.hpp
+ * \brief Exporting isobaths as polylines to GeoJSON, CSV and ESRI
+ * Shapefile, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "sample.hpp"
+#include "datafile.hpp"
+
+/// \brief Namespace for geo-referenced data.
+namespace Data {
+  /// \brief Formats of exported files.
+  enum VectorFormat {
+    /// \brief GeoJSON feature collection, one feature per line.
+    geoJsonFormat,
+    /// \brief Comma-separated values with a header, one row per sample.
+    csvFormat,
+    /// \brief ESRI Shapefile of polylines, with its index and attributes.
+    shapefileFormat
+  };
+
+  /**
+   * \brief Format of an exported file, from its extension: ".geojson" or
+   * ".json", ".csv" or ".shp", in any case.
+   * \param fileName Name of the file.
+   * \return The format.
+   * \exception std::runtime_error The extension is not known.
+   */
+  VectorFormat vectorFormat (const std::string &fileName);
+
+  /**
+   * \brief Export samples as polylines, written as they are read.
+   *
+   * Successive samples of the same value form a line, which is cut where
+   * two samples are further apart in the image than a given gap, so that
+   * isobaths traced or extracted one after the other stay apart. Samples
+   * are read by chunks, and files are written through buffers of fixed
+   * size: memory used does not depend on the number of samples.
+   *
+   * Lines are given in longitude and latitude, with their value and their
+   * number, starting from 1, as attributes. Lines of one sample are
+   * written as points in GeoJSON, and as lines of two identical points in
+   * Shapefiles, which only hold one type of shapes.
+   */
+  class VectorExporter {
+    public:
+      /**
+       * \brief Function reading samples: given the index of the first
+       * sample and the number of samples, it puts them in order.
+       */
+      typedef std::function<void (std::size_t, std::size_t, Sample*)>
+        SampleReader;
+
+      /// \brief Number of samples read at once.
+      static const std::size_t chunkSize = 4096;
+
+      /// \brief Size of the buffer of each file written.
+      static const std::size_t bufferSize = 1 << 16;
+
+      /**
+       * \brief Construct an exporter.
+       * \param _reader Function reading samples.
+       * \param _count Number of samples.
+       * \param _gap Greatest distance between two successive samples of a
+       * line, in pixels of the image, lines being only cut where values
+       * change when not positive.
+       */
+      VectorExporter (const SampleReader &_reader, std::size_t _count,
+                      double _gap):
+        reader (_reader), count (_count), gap (_gap) {}
+
+      /**
+       * \brief Export samples of a list.
+       * \param samples The samples, which should not change while
+       * exporting.
+       * \param _gap Greatest distance between two successive samples of a
+       * line, in pixels.
+       */
+      VectorExporter (const std::vector<Sample> &samples, double _gap);
+
+      /**
+       * \brief Export samples of a binary data file, read in place.
+       * \param file The file, which should be kept open while exporting.
+       * \param _gap Greatest distance between two successive samples of a
+       * line, in pixels.
+       */
+      VectorExporter (const BinaryFile &file, double _gap);
+
+      /**
+       * \brief Write lines in a file.
+       * \param fileName Name of the file, the one of the main file for
+       * Shapefiles, whose index ".shx" and attributes ".dbf" are written
+       * next to it.
+       * \param format Format of the file.
+       * \param carryOn Function called as samples are written with the
+       * percentage of samples written, which interrupts exporting when
+       * returning false.
+       * \return Number of lines written, 0 if exporting has been
+       * interrupted, files being then removed.
+       * \exception std::runtime_error A file cannot be written.
+       */
+      std::size_t write (const std::string &fileName, VectorFormat format,
+                         const std::function<bool (int)> &carryOn) const;
+
+    private:
+      /// \brief Function reading samples.
+      const SampleReader reader;
+
+      /// \brief Number of samples.
+      const std::size_t count;
+
+      /// \brief Greatest distance between two samples of a line.
+      const double gap;
+  };
+}
+
+#endif  // #ifndef VECTOREXPORT_HPP
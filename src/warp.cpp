@@ -0,0 +1,209 @@
+/**
+ * \file warp.cpp
+ * \brief Implementation of non-affine conversions.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <limits>
+
+#include "warp.hpp"
+
+namespace {
+  /// \brief Greatest number of Newton iterations for a node.
+  const int maximumIterations = 32;
+}
+
+const std::size_t Projection::ThinPlateSpline::minimumPoints;
+
+/* -- Normalisation of a set of points. ----------------------------------- */
+Projection::Normalisation::Normalisation (const std::vector<Point2D> &points):
+  centreX (0.), centreY (0.), scale (1.) {
+  if (points.empty()) return;
+  /* Smallest abscissa. */
+  double xMin = points[0].x();
+  /* Greatest abscissa. */
+  double xMax = xMin;
+  /* Smallest ordinate. */
+  double yMin = points[0].y();
+  /* Greatest ordinate. */
+  double yMax = yMin;
+  for (std::size_t i = 1; i < points.size(); ++i) {
+    xMin = std::min(xMin, points[i].x());
+    xMax = std::max(xMax, points[i].x());
+    yMin = std::min(yMin, points[i].y());
+    yMax = std::max(yMax, points[i].y());
+  }
+  centreX = .5 * (xMin + xMax);
+  centreY = .5 * (yMin + yMax);
+  /* Half of the greatest extent. */
+  const double extent = .5 * std::max(xMax - xMin, yMax - yMin);
+  if (extent > 0.) scale = 1. / extent;
+}
+
+/* -- Fit a thin-plate spline. -------------------------------------------- */
+Projection::ThinPlateSpline::ThinPlateSpline (const std::vector<Point2D> &r1,
+                                              const std::vector<Point2D> &r2,
+                                              double smoothing):
+  normalisation (r1), nodeX (r1.size()), nodeY (r1.size()),
+  weightU (r1.size()), weightV (r1.size()) {
+  assert(r1.size() == r2.size());
+  if (r1.size() < minimumPoints)
+    throw std::domain_error("Not enough reference points.");
+
+  /* Number of reference points. */
+  const std::size_t n = r1.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    nodeX[i] = r1[i].x();
+    nodeY[i] = r1[i].y();
+    normalisation.apply(nodeX[i], nodeY[i]);
+  }
+
+  /* Matrix of the linear system, kernel block then affine block. */
+  Eigen::MatrixXd system = Eigen::MatrixXd::Zero(n + 3, n + 3);
+  /* Right hand side, geographical coordinates then zeros. */
+  Eigen::MatrixXd rightHandSide = Eigen::MatrixXd::Zero(n + 3, 2);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < i; ++j)
+      system(i, j) = system(j, i) =
+        kernel(nodeX[i] - nodeX[j], nodeY[i] - nodeY[j]);
+    system(i, i) = smoothing;
+    system(i, n) = system(n, i) = 1.;
+    system(i, n + 1) = system(n + 1, i) = nodeX[i];
+    system(i, n + 2) = system(n + 2, i) = nodeY[i];
+    rightHandSide(i, 0) = r2[i].x();
+    rightHandSide(i, 1) = r2[i].y();
+  }
+
+  /* Decomposition of the system. */
+  const Eigen::FullPivLU<Eigen::MatrixXd> lu (system);
+  if (!lu.isInvertible())
+    throw std::domain_error("Reference points do not define a thin-plate "
+                            "spline: they are aligned or repeated.");
+  /* Weights then affine part. */
+  const Eigen::MatrixXd solution = lu.solve(rightHandSide);
+  for (std::size_t i = 0; i < n; ++i) {
+    weightU[i] = solution(i, 0);
+    weightV[i] = solution(i, 1);
+  }
+  affine = solution.bottomRows(3);
+}
+
+/* -- Sample the inverse conversion. -------------------------------------- */
+Projection::WarpGrid Projection::WarpGrid::inverse (std::size_t _columns,
+                                                    std::size_t _rows) const {
+  /* Affine approximation of the inverse, to start from. */
+  AffineFit fit;
+  /* Smallest converted abscissa. */
+  double uMin = std::numeric_limits<double>::max();
+  /* Greatest converted abscissa. */
+  double uMax = -uMin;
+  /* Smallest converted ordinate. */
+  double vMin = uMin;
+  /* Greatest converted ordinate. */
+  double vMax = -uMin;
+  for (std::size_t row = 0; row <= rows; ++row)
+    for (std::size_t column = 0; column <= columns; ++column) {
+      /* Index of the node. */
+      const std::size_t node = row * (columns + 1) + column;
+      uMin = std::min(uMin, nodeU[node]);
+      uMax = std::max(uMax, nodeU[node]);
+      vMin = std::min(vMin, nodeV[node]);
+      vMax = std::max(vMax, nodeV[node]);
+      fit.add(Point2D (nodeU[node], nodeV[node]),
+              Point2D (originX + column * stepX, originY + row * stepY));
+    }
+  /* Affine approximation of the inverse. */
+  const ChangeMatrix guess = fit.coefficients().transpose();
+  /* Tolerance on converted coordinates. */
+  const double tolerance =
+    1e-12 * std::max(std::max(std::abs(uMax), std::abs(uMin)),
+                     std::max(std::abs(vMax), std::abs(vMin)));
+
+  /* The inverse grid. */
+  WarpGrid result;
+  result.setGeometry(uMin, vMin, uMax, vMax, _columns, _rows);
+  for (std::size_t row = 0; row <= result.rows; ++row) {
+    /* Current estimation of the solution. */
+    Point2D p;
+    for (std::size_t column = 0; column <= result.columns; ++column) {
+      /* Converted point whose antecedent is searched. */
+      const Point2D target (result.originX + column * result.stepX,
+                            result.originY + row * result.stepY);
+      /* Start from the previous node, or from the affine approximation. */
+      if (column == 0) p = transformPoint(guess, target);
+      for (int iteration = 0; iteration < maximumIterations; ++iteration) {
+        /* Position in cells along abscissae. */
+        const double fx = (p.x() - originX) * inverseStepX;
+        /* Position in cells along ordinates. */
+        const double fy = (p.y() - originY) * inverseStepY;
+        /* Column of the cell used. */
+        const std::size_t i = cell(fx, columns);
+        /* Row of the cell used. */
+        const std::size_t j = cell(fy, rows);
+        /* Position in the cell along abscissae. */
+        const double tx = fx - static_cast<double>(i);
+        /* Position in the cell along ordinates. */
+        const double ty = fy - static_cast<double>(j);
+        /* First node of the cell. */
+        const std::size_t node = j * (columns + 1) + i;
+        /* Last node of the cell. */
+        const std::size_t next = node + columns + 1;
+        /* Current conversion. */
+        double u, v;
+        apply(p.x(), p.y(), u, v);
+        /* Residual along abscissae. */
+        const double du = u - target.x();
+        /* Residual along ordinates. */
+        const double dv = v - target.y();
+        if (std::abs(du) <= tolerance && std::abs(dv) <= tolerance) break;
+        /* Derivative of the converted abscissa along abscissae. */
+        const double dudx = inverseStepX
+          * ((1. - ty) * (nodeU[node + 1] - nodeU[node])
+             + ty * (nodeU[next + 1] - nodeU[next]));
+        /* Derivative of the converted abscissa along ordinates. */
+        const double dudy = inverseStepY
+          * ((1. - tx) * (nodeU[next] - nodeU[node])
+             + tx * (nodeU[next + 1] - nodeU[node + 1]));
+        /* Derivative of the converted ordinate along abscissae. */
+        const double dvdx = inverseStepX
+          * ((1. - ty) * (nodeV[node + 1] - nodeV[node])
+             + ty * (nodeV[next + 1] - nodeV[next]));
+        /* Derivative of the converted ordinate along ordinates. */
+        const double dvdy = inverseStepY
+          * ((1. - tx) * (nodeV[next] - nodeV[node])
+             + tx * (nodeV[next + 1] - nodeV[node + 1]));
+        /* Determinant of the Jacobian matrix. */
+        const double determinant = dudx * dvdy - dudy * dvdx;
+        if (determinant == 0.) break;
+        p.x() -= (dvdy * du - dudy * dv) / determinant;
+        p.y() -= (dudx * dv - dvdx * du) / determinant;
+      }
+      /* Index of the node. */
+      const std::size_t node = row * (result.columns + 1) + column;
+      result.nodeU[node] = p.x();
+      result.nodeV[node] = p.y();
+    }
+  }
+  return result;
+}
+
+/* -- Set the geometry of a grid. ----------------------------------------- */
+void Projection::WarpGrid::setGeometry (double xMin, double yMin,
+                                        double xMax, double yMax,
+                                        std::size_t _columns,
+                                        std::size_t _rows) {
+  if (_columns == 0 || _rows == 0 || !(xMax > xMin) || !(yMax > yMin))
+    throw std::domain_error("Warp grid is empty.");
+  originX = xMin;
+  originY = yMin;
+  columns = _columns;
+  rows = _rows;
+  stepX = (xMax - xMin) / static_cast<double>(columns);
+  stepY = (yMax - yMin) / static_cast<double>(rows);
+  inverseStepX = 1. / stepX;
+  inverseStepY = 1. / stepY;
+  nodeU.resize((columns + 1) * (rows + 1));
+  nodeV.resize((columns + 1) * (rows + 1));
+}
@@ -0,0 +1,456 @@
+#ifndef WARP_HPP
+#define WARP_HPP
+
+/**
+ * \file warp.hpp
+ * \brief Non-affine conversions from image coordinates to geographical
+ * coordinates, for distorted images, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include <eigen3/Eigen/Dense>
+
+#include "projection.hpp"
+
+/// \brief Namespace for projection computations.
+namespace Projection {
+  /**
+   * \brief Apply a transformation to a set of points.
+   * \param transform The transformation, providing a method
+   * apply(x, y, u, v).
+   * \param x Abscissae of points to be converted.
+   * \param y Ordinates of points to be converted.
+   * \param u Where to store abscissae of converted points.
+   * \param v Where to store ordinates of converted points.
+   * \param n Number of points.
+   *
+   * The transformation is a template parameter, so that it is inlined in
+   * the loop. The affine referential change keeps its own overload. Output
+   * arrays may be the same as input arrays.
+   */
+  template <class Transform>
+  inline void transformPoints (const Transform &transform,
+                               const double* x, const double* y,
+                               double* u, double* v, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+      transform.apply(x[i], y[i], u[i], v[i]);
+  }
+
+  /**
+   * \brief Affine normalisation of image coordinates, so that reference
+   * points lie roughly in [-1, 1], which keeps fits well conditioned.
+   */
+  class Normalisation {
+    public:
+      /// \brief Identity normalisation.
+      Normalisation (): centreX (0.), centreY (0.), scale (1.) {}
+
+      /**
+       * \brief Normalisation of a set of points.
+       * \param points The points.
+       */
+      explicit Normalisation (const std::vector<Point2D> &points);
+
+      /**
+       * \brief Normalise a point.
+       * \param x Abscissa, replaced by the normalised one.
+       * \param y Ordinate, replaced by the normalised one.
+       */
+      void apply (double &x, double &y) const {
+        x = (x - centreX) * scale;
+        y = (y - centreY) * scale;
+      }
+
+    private:
+      /// \brief Abscissa of the centre.
+      double centreX;
+
+      /// \brief Ordinate of the centre.
+      double centreY;
+
+      /// \brief Inverse of the half extent.
+      double scale;
+  };
+
+  /**
+   * \brief Polynomial conversion from image coordinates to geographical
+   * coordinates, fitted in the least-squares sense on reference points.
+   * \tparam Order Degree of the polynomials, 1 being affine.
+   *
+   * Each geographical coordinate is a polynomial of both image coordinates,
+   * containing every monomial x^i y^j with i + j <= Order.
+   */
+  template <int Order>
+  class PolynomialTransform {
+    public:
+      /// \brief Number of monomials.
+      static const int terms = (Order + 1) * (Order + 2) / 2;
+
+      /// \brief Minimum number of reference points for a solution.
+      static const std::size_t minimumPoints = terms;
+
+      /**
+       * \brief Fit the polynomials on reference points.
+       * \param r1 Reference points in image coordinates.
+       * \param r2 Reference points in geographical coordinates.
+       * \exception std::domain_error Reference points do not define the
+       * polynomials.
+       */
+      PolynomialTransform (const std::vector<Point2D> &r1,
+                           const std::vector<Point2D> &r2):
+        normalisation (r1) {
+        assert(r1.size() == r2.size());
+        if (r1.size() < minimumPoints)
+          throw std::domain_error("Not enough reference points.");
+        /* Monomials at each reference point. */
+        Eigen::MatrixXd design (r1.size(), terms);
+        /* Geographical coordinates of reference points. */
+        Eigen::MatrixXd target (r1.size(), 2);
+        for (std::size_t i = 0; i < r1.size(); ++i) {
+          /* Monomials at the current point. */
+          double row [terms];
+          monomials(r1[i].x(), r1[i].y(), row);
+          for (int k = 0; k < terms; ++k) design(i, k) = row[k];
+          target(i, 0) = r2[i].x();
+          target(i, 1) = r2[i].y();
+        }
+        /* Decomposition of the design matrix. */
+        const Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr (design);
+        if (qr.rank() < terms)
+          throw std::domain_error("Reference points do not define a "
+                                  "polynomial transformation.");
+        coefficients = qr.solve(target);
+      }
+
+      /**
+       * \brief Convert a point.
+       * \param x Abscissa in the image.
+       * \param y Ordinate in the image.
+       * \param u Where to store the longitude.
+       * \param v Where to store the latitude.
+       */
+      void apply (double x, double y, double &u, double &v) const {
+        /* Monomials at the point. */
+        double row [terms];
+        monomials(x, y, row);
+        /* Longitude. */
+        double su = 0.;
+        /* Latitude. */
+        double sv = 0.;
+        for (int k = 0; k < terms; ++k) {
+          su += coefficients(k, 0) * row[k];
+          sv += coefficients(k, 1) * row[k];
+        }
+        u = su;
+        v = sv;
+      }
+
+    private:
+      /// \brief Normalisation of image coordinates.
+      Normalisation normalisation;
+
+      /**
+       * \brief Coefficients of monomials for both coordinates, not aligned
+       * so that the class can be allocated anywhere.
+       */
+      Eigen::Matrix<double, terms, 2, Eigen::DontAlign> coefficients;
+
+      /**
+       * \brief Compute monomials at a point.
+       * \param x Abscissa in the image.
+       * \param y Ordinate in the image.
+       * \param row Where to store monomials, by increasing degree.
+       */
+      void monomials (double x, double y, double* row) const {
+        normalisation.apply(x, y);
+        /* Powers of the abscissa. */
+        double px [Order + 1];
+        /* Powers of the ordinate. */
+        double py [Order + 1];
+        px[0] = py[0] = 1.;
+        for (int i = 1; i <= Order; ++i) {
+          px[i] = px[i - 1] * x;
+          py[i] = py[i - 1] * y;
+        }
+        /* Index of the current monomial. */
+        int k = 0;
+        for (int degree = 0; degree <= Order; ++degree)
+          for (int j = 0; j <= degree; ++j)
+            row[k++] = px[degree - j] * py[j];
+      }
+  };
+
+  template <int Order>
+  const int PolynomialTransform<Order>::terms;
+
+  template <int Order>
+  const std::size_t PolynomialTransform<Order>::minimumPoints;
+
+  /**
+   * \brief Thin-plate spline conversion from image coordinates to
+   * geographical coordinates.
+   *
+   * The spline goes through every reference point, unless it is smoothed.
+   * Evaluating it costs a term by reference point: converting many points
+   * should go through a WarpGrid.
+   */
+  class ThinPlateSpline {
+    public:
+      /// \brief Minimum number of reference points for a solution.
+      static const std::size_t minimumPoints = 3;
+
+      /**
+       * \brief Fit the spline on reference points.
+       * \param r1 Reference points in image coordinates.
+       * \param r2 Reference points in geographical coordinates.
+       * \param smoothing Regularisation, 0 for an interpolating spline.
+       * \exception std::domain_error Reference points do not define a
+       * spline, for instance when they are aligned.
+       */
+      ThinPlateSpline (const std::vector<Point2D> &r1,
+                       const std::vector<Point2D> &r2,
+                       double smoothing = 0.);
+
+      /**
+       * \brief Convert a point.
+       * \param x Abscissa in the image.
+       * \param y Ordinate in the image.
+       * \param u Where to store the longitude.
+       * \param v Where to store the latitude.
+       */
+      void apply (double x, double y, double &u, double &v) const {
+        normalisation.apply(x, y);
+        /* Longitude. */
+        double su = affine(0, 0) + affine(1, 0) * x + affine(2, 0) * y;
+        /* Latitude. */
+        double sv = affine(0, 1) + affine(1, 1) * x + affine(2, 1) * y;
+        for (std::size_t i = 0; i < nodeX.size(); ++i) {
+          /* Kernel between the point and the current node. */
+          const double k = kernel(x - nodeX[i], y - nodeY[i]);
+          su += weightU[i] * k;
+          sv += weightV[i] * k;
+        }
+        u = su;
+        v = sv;
+      }
+
+      /**
+       * \brief Radial kernel of thin-plate splines, r^2 log r^2.
+       * \param dx Difference of abscissae.
+       * \param dy Difference of ordinates.
+       */
+      static double kernel (double dx, double dy) {
+        /* Squared distance. */
+        const double r2 = dx * dx + dy * dy;
+        return (r2 > 0.)? r2 * std::log(r2): 0.;
+      }
+
+    private:
+      /// \brief Normalisation of image coordinates.
+      Normalisation normalisation;
+
+      /// \brief Normalised abscissae of reference points.
+      std::vector<double> nodeX;
+
+      /// \brief Normalised ordinates of reference points.
+      std::vector<double> nodeY;
+
+      /// \brief Weights of reference points for longitudes.
+      std::vector<double> weightU;
+
+      /// \brief Weights of reference points for latitudes.
+      std::vector<double> weightV;
+
+      /// \brief Affine part, constant then x and y terms.
+      Eigen::Matrix<double, 3, 2, Eigen::DontAlign> affine;
+  };
+
+  /**
+   * \brief Conversion sampled on a regular grid of the image and
+   * interpolated bilinearly between nodes.
+   *
+   * Converting a point costs the same whatever the sampled transformation.
+   * Points outside the grid are extrapolated from the nearest cell.
+   */
+  class WarpGrid {
+    public:
+      /**
+       * \brief Sample a transformation.
+       * \param transform The transformation, providing a method
+       * apply(x, y, u, v).
+       * \param xMin Abscissa of the first column of nodes.
+       * \param yMin Ordinate of the first row of nodes.
+       * \param xMax Abscissa of the last column of nodes.
+       * \param yMax Ordinate of the last row of nodes.
+       * \param _columns Number of cells along abscissae.
+       * \param _rows Number of cells along ordinates.
+       */
+      template <class Transform>
+      WarpGrid (const Transform &transform, double xMin, double yMin,
+                double xMax, double yMax, std::size_t _columns,
+                std::size_t _rows) {
+        setGeometry(xMin, yMin, xMax, yMax, _columns, _rows);
+        for (std::size_t row = 0; row <= rows; ++row)
+          for (std::size_t column = 0; column <= columns; ++column) {
+            /* Index of the node. */
+            const std::size_t node = row * (columns + 1) + column;
+            transform.apply(originX + column * stepX, originY + row * stepY,
+                            nodeU[node], nodeV[node]);
+          }
+      }
+
+      /**
+       * \brief Convert a point.
+       * \param x Abscissa of the point.
+       * \param y Ordinate of the point.
+       * \param u Where to store the converted abscissa.
+       * \param v Where to store the converted ordinate.
+       */
+      void apply (double x, double y, double &u, double &v) const {
+        /* Position in cells along abscissae. */
+        const double fx = (x - originX) * inverseStepX;
+        /* Position in cells along ordinates. */
+        const double fy = (y - originY) * inverseStepY;
+        /* Column of the cell used. */
+        const std::size_t column = cell(fx, columns);
+        /* Row of the cell used. */
+        const std::size_t row = cell(fy, rows);
+        /* Position in the cell along abscissae. */
+        const double tx = fx - static_cast<double>(column);
+        /* Position in the cell along ordinates. */
+        const double ty = fy - static_cast<double>(row);
+        /* First node of the cell. */
+        const std::size_t node = row * (columns + 1) + column;
+        /* Last node of the cell. */
+        const std::size_t next = node + columns + 1;
+        u = (1. - ty) * ((1. - tx) * nodeU[node] + tx * nodeU[node + 1])
+            + ty * ((1. - tx) * nodeU[next] + tx * nodeU[next + 1]);
+        v = (1. - ty) * ((1. - tx) * nodeV[node] + tx * nodeV[node + 1])
+            + ty * ((1. - tx) * nodeV[next] + tx * nodeV[next + 1]);
+      }
+
+      /**
+       * \brief Whether or not a point is inside the grid, where it is
+       * interpolated instead of extrapolated.
+       * \param x Abscissa of the point.
+       * \param y Ordinate of the point.
+       */
+      bool contains (double x, double y) const {
+        /* Position in cells along abscissae. */
+        const double fx = (x - originX) * inverseStepX;
+        /* Position in cells along ordinates. */
+        const double fy = (y - originY) * inverseStepY;
+        return fx >= 0. && fx <= static_cast<double>(columns) && fy >= 0.
+          && fy <= static_cast<double>(rows);
+      }
+
+      /**
+       * \brief Sample the inverse conversion on a regular grid covering the
+       * converted grid.
+       * \param _columns Number of cells along abscissae.
+       * \param _rows Number of cells along ordinates.
+       * \return Grid of the inverse conversion.
+       *
+       * Each node is found by Newton's method on the bilinear interpolation,
+       * starting from the neighbouring node.
+       */
+      WarpGrid inverse (std::size_t _columns, std::size_t _rows) const;
+
+      /**
+       * \brief Greatest distance between a transformation and the grid, at
+       * the centre of cells.
+       * \param transform The transformation, providing a method
+       * apply(x, y, u, v).
+       */
+      template <class Transform>
+      double error (const Transform &transform) const {
+        /* Greatest distance found. */
+        double result = 0.;
+        for (std::size_t row = 0; row < rows; ++row)
+          for (std::size_t column = 0; column < columns; ++column) {
+            /* Abscissa of the centre of the cell. */
+            const double x = originX + (column + .5) * stepX;
+            /* Ordinate of the centre of the cell. */
+            const double y = originY + (row + .5) * stepY;
+            /* Exact conversion. */
+            double u1, v1;
+            transform.apply(x, y, u1, v1);
+            /* Interpolated conversion. */
+            double u2, v2;
+            apply(x, y, u2, v2);
+            result = std::max(result, std::sqrt((u1 - u2) * (u1 - u2)
+                                                + (v1 - v2) * (v1 - v2)));
+          }
+        return result;
+      }
+
+    private:
+      /// \brief Abscissa of the first column of nodes.
+      double originX;
+
+      /// \brief Ordinate of the first row of nodes.
+      double originY;
+
+      /// \brief Width of cells.
+      double stepX;
+
+      /// \brief Height of cells.
+      double stepY;
+
+      /// \brief Inverse of the width of cells.
+      double inverseStepX;
+
+      /// \brief Inverse of the height of cells.
+      double inverseStepY;
+
+      /// \brief Number of cells along abscissae.
+      std::size_t columns;
+
+      /// \brief Number of cells along ordinates.
+      std::size_t rows;
+
+      /// \brief Converted abscissae of nodes, row by row.
+      std::vector<double> nodeU;
+
+      /// \brief Converted ordinates of nodes, row by row.
+      std::vector<double> nodeV;
+
+      /// \brief Construct an empty grid, filled by inverse().
+      WarpGrid () {}
+
+      /**
+       * \brief Set the geometry of the grid and allocate nodes.
+       * \param xMin Abscissa of the first column of nodes.
+       * \param yMin Ordinate of the first row of nodes.
+       * \param xMax Abscissa of the last column of nodes.
+       * \param yMax Ordinate of the last row of nodes.
+       * \param _columns Number of cells along abscissae.
+       * \param _rows Number of cells along ordinates.
+       * \exception std::domain_error The grid is empty.
+       */
+      void setGeometry (double xMin, double yMin, double xMax, double yMax,
+                        std::size_t _columns, std::size_t _rows);
+
+      /**
+       * \brief Cell containing a position, the nearest one outside the grid.
+       * \param f Position in cells.
+       * \param count Number of cells.
+       */
+      static std::size_t cell (double f, std::size_t count) {
+        if (!(f > 0.)) return 0;
+        if (f >= static_cast<double>(count)) return count - 1;
+        return static_cast<std::size_t>(f);
+      }
+  };
+}
+
+#endif  // #ifndef WARP_HPP
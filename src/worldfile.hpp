@@ -0,0 +1,127 @@
+#ifndef WORLDFILE_HPP
+#define WORLDFILE_HPP
+
+/**
+ * \file worldfile.hpp
+ * \brief Reading and writing world files, independently from Qt.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ *
+ * Information about world file format can be found at:
+ * <http://en.wikipedia.org/wiki/World_file>
+ */
+
+#include <boost/concept_check.hpp>
+#include <istream>
+#include <ostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <limits>
+
+#include "projection.hpp"
+#include "numberreader.hpp"
+
+/// \brief Namespace for projection computations.
+namespace Projection {
+  /**
+   * \brief Read a world file from a stream.
+   * \param stream Stream on the world file.
+   * \return Matrix of referential change described by the world file.
+   * \exception std::runtime_error The stream does not begin with six
+   * numbers.
+   */
+  inline ChangeMatrix readWorldFile (std::istream &stream) {
+    /* Reader of numbers in the file. */
+    Text::NumberReader reader (stream);
+    /* Matrix read in the file. */
+    ChangeMatrix change;
+    for (int column = 0; column < 3; ++column) {
+      for (int row = 0; row < 2; ++row) {
+        if (reader.atEnd())
+          throw std::runtime_error("World file should contain six "
+                                   "numbers.");
+        change(row, column) = reader.number();
+      }
+    }
+    return change;
+  }
+
+  /**
+   * \brief Read a world file.
+   * \param fileName Name of the world file.
+   * \return Matrix of referential change described by the world file.
+   * \exception std::runtime_error The file cannot be opened or is invalid.
+   */
+  inline ChangeMatrix readWorldFile (const std::string &fileName) {
+    /* The world file itself. */
+    std::ifstream worldFile (fileName.c_str());
+    if (!worldFile)
+      throw std::runtime_error("World file \"" + fileName
+                               + "\" cannot be opened.");
+    return readWorldFile(worldFile);
+  }
+
+  /**
+   * \brief Write a world file in a stream.
+   * \param stream Stream on the world file.
+   * \param change Matrix of referential change to be written.
+   */
+  inline void writeWorldFile (std::ostream &stream,
+                              const ChangeMatrix &change) {
+    /* Previous precision of the stream. */
+    const std::streamsize precision =
+      stream.precision(std::numeric_limits<double>::max_digits10);
+    stream << change(0, 0) << '\n'
+           << change(1, 0) << '\n'
+           << change(0, 1) << '\n'
+           << change(1, 1) << '\n'
+           << change(0, 2) << '\n'
+           << change(1, 2) << '\n';
+    stream.precision(precision);
+  }
+
+  /**
+   * \brief Write a world file.
+   * \param fileName Name of the world file.
+   * \param change Matrix of referential change to be written.
+   * \exception std::runtime_error The file cannot be written.
+   */
+  inline void writeWorldFile (const std::string &fileName,
+                              const ChangeMatrix &change) {
+    /* The world file itself. */
+    std::ofstream worldFile (fileName.c_str(),
+                             std::ios_base::out | std::ios_base::trunc);
+    if (!worldFile)
+      throw std::runtime_error("World file \"" + fileName
+                               + "\" cannot be opened.");
+    writeWorldFile(worldFile, change);
+    worldFile.close();
+    if (!worldFile)
+      throw std::runtime_error("World file \"" + fileName
+                               + "\" cannot be written.");
+  }
+
+  /**
+   * \brief Name of the world file associated to an image.
+   * \param imageName Name of the image file.
+   * \return Name of the image file whose extension is replaced by its first
+   * and last letters followed by 'w', such as "map.jgw" for "map.jpg".
+   * \exception std::domain_error The name of the image has no extension.
+   */
+  inline std::string worldFileName (const std::string &imageName) {
+    /* Position of the separator of the extension. */
+    const std::string::size_type dot = imageName.rfind('.');
+    /* Position of the last directory separator. */
+    const std::string::size_type slash = imageName.find_last_of("/\\");
+    if (dot == std::string::npos || dot + 1 == imageName.size()
+        || (slash != std::string::npos && dot < slash))
+      throw std::domain_error("Image file \"" + imageName
+                              + "\" has no extension.");
+    return imageName.substr(0, dot + 1) + imageName[dot + 1]
+      + imageName[imageName.size() - 1] + 'w';
+  }
+}
+
+#endif  // #ifndef WORLDFILE_HPP
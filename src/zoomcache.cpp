@@ -0,0 +1,279 @@
+/**
+ * \file zoomcache.cpp
+ * \brief Implementation of tiles resampled at zoom levels.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <QRunnable>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "zoomcache.hpp"
+#include "profiler.hpp"
+
+const int GUI::ZoomCache::tileSize;
+const int GUI::ZoomCache::cacheBudget;
+
+namespace {
+  /**
+   * \brief Pixels of the source averaged into each pixel of the result,
+   * along an axis.
+   */
+  struct Filter {
+    /// \brief First pixel of the source, for each pixel of the result.
+    std::vector<int> first;
+
+    /// \brief Number of pixels of the source, for each pixel of the result.
+    std::vector<int> count;
+
+    /// \brief Position of the first weight, for each pixel of the result.
+    std::vector<std::size_t> offset;
+
+    /// \brief Weights of pixels of the source, summing to one per pixel.
+    std::vector<float> weight;
+
+    /**
+     * \brief Compute pixels of the source covered by pixels of the result.
+     * \param start First pixel of the result.
+     * \param size Number of pixels of the result.
+     * \param ratio Size of a pixel of the source in pixels of the result,
+     * at most one.
+     * \param limit Number of pixels of the source.
+     */
+    Filter (int start, int size, double ratio, int limit) {
+      for (int i = 0; i < size; ++i) {
+        /* Start of the pixel, in pixels of the source. */
+        const double a = std::min((start + i) / ratio, limit - 1.);
+        /* End of the pixel, in pixels of the source. */
+        const double b = std::min((start + i + 1) / ratio,
+                                  static_cast<double>(limit));
+        first.push_back(static_cast<int>(a));
+        offset.push_back(weight.size());
+        for (int k = first.back(); k < b; ++k)
+          weight.push_back(static_cast<float>((std::min(b, k + 1.)
+                                               - std::max(a, 1. * k))
+                                              / (b - a)));
+        count.push_back(static_cast<int>(weight.size() - offset.back()));
+      }
+    }
+
+    /// \brief First pixel of the source read.
+    int begin () const {return first.front();}
+
+    /// \brief Number of pixels of the source read.
+    int extent () const {return first.back() + count.back() - begin();}
+  };
+}
+
+/// \brief Rendering of a tile, run by the pool of threads.
+class GUI::ZoomCache::Job: public QRunnable {
+  public:
+    /**
+     * \brief Construct the job.
+     * \param _owner Cache the tile is rendered for.
+     * \param _scale Scale factor.
+     * \param _column Column of the tile.
+     * \param _row Row of the tile.
+     */
+    Job (ZoomCache* _owner, double _scale, int _column, int _row):
+      owner (_owner), scale (_scale), column (_column), row (_row) {}
+
+    /// \brief Render the tile.
+    virtual void run () {owner->run(scale, column, row);}
+
+  private:
+    /// \brief Cache the tile is rendered for.
+    ZoomCache* owner;
+
+    /// \brief Scale factor.
+    double scale;
+
+    /// \brief Column of the tile.
+    int column;
+
+    /// \brief Row of the tile.
+    int row;
+};
+
+/* -- Construct the cache. ------------------------------------------------ */
+GUI::ZoomCache::ZoomCache (const std::shared_ptr<ImagePyramid> &_pyramid,
+                           QObject* parent):
+  QObject (parent), pyramid (_pyramid), cache (cacheBudget), cancelled (0) {
+  /* Rendering gives way to loading and tracing. */
+  pool.setMaxThreadCount(std::max(QThread::idealThreadCount() - 1, 1));
+}
+
+/* -- Wait for rendering threads. ----------------------------------------- */
+GUI::ZoomCache::~ZoomCache () {
+  cancelled.fetchAndStoreOrdered(1);
+  pool.waitForDone();
+}
+
+/* -- Set scales worth rendering. ----------------------------------------- */
+void GUI::ZoomCache::setWanted (const QList<double> &scales) {
+  /* Lock on the sets of keys. */
+  const QMutexLocker locker (&mutex);
+  wanted.clear();
+  for (int i = 0; i < scales.size(); ++i)
+    if (resamples(scales[i])) wanted.insert(scaleKey(scales[i]));
+}
+
+/* -- Get a tile. --------------------------------------------------------- */
+QImage GUI::ZoomCache::tile (double scale, int column, int row,
+                             bool urgent) {
+  /* Key of the tile. */
+  const quint64 key = tileKey(scale, column, row);
+  {
+    /* Lock on the cache. */
+    const QMutexLocker locker (&mutex);
+    /* Tile already rendered. */
+    const QImage* found = cache.object(key);
+    if (found) return *found;
+    if (pending.contains(key)) return QImage ();
+    pending.insert(key);
+  }
+  pool.start(new Job (this, scale, column, row), urgent? 1: 0);
+  return QImage ();
+}
+
+/* -- Ask for rendering in advance. --------------------------------------- */
+void GUI::ZoomCache::prefetch (double scale, const QRect &area) {
+  if (!resamples(scale)) return;
+  /* Area of the widget at this scale, within the image. */
+  const QRect inside = area.intersected(QRect (QPoint (0, 0),
+                                               pyramid->size() * scale));
+  if (inside.isEmpty()) return;
+  for (int row = inside.top() / tileSize; row <= inside.bottom() / tileSize;
+       ++row)
+    for (int column = inside.left() / tileSize;
+         column <= inside.right() / tileSize; ++column)
+      tile(scale, column, row, false);
+}
+
+/* -- Render a tile. ------------------------------------------------------ */
+void GUI::ZoomCache::run (double scale, int column, int row) {
+  /* Key of the tile. */
+  const quint64 key = tileKey(scale, column, row);
+  /* Whether the tile is still worth rendering. */
+  bool worth;
+  {
+    /* Lock on the sets of keys. */
+    const QMutexLocker locker (&mutex);
+    worth = wanted.contains(scaleKey(scale));
+  }
+  /* The tile. */
+  const QImage result = worth && !cancelled.fetchAndAddOrdered(0)?
+    render(scale, column, row): QImage ();
+
+  /* Lock on the cache. */
+  const QMutexLocker locker (&mutex);
+  pending.remove(key);
+  if (result.isNull()) return;
+  cache.insert(key, new QImage (result),
+               std::max(result.byteCount() / 1024, 1));
+  emit rendered(scale, tileRect(scale, column, row));
+}
+
+/* -- Resample a tile. ---------------------------------------------------- */
+QImage GUI::ZoomCache::render (double scale, int column, int row) const {
+  GEODESK_TIME("ZoomCache::render");
+  /* Area of the tile in the widget. */
+  const QRect target = tileRect(scale, column, row);
+  if (target.isEmpty()) return QImage ();
+  /* Level resampled, the coarsest one not coarser than the display. */
+  const int level = pyramid->levelForScale(scale);
+  /* Size of a pixel of the level, in screen pixels. */
+  const double ratio = scale * static_cast<double>(1 << level);
+  /* Size of the level. */
+  const QSize size = pyramid->levelSize(level);
+  /* Pixels of the level averaged into each column of the tile. */
+  const Filter across (target.left(), target.width(), ratio, size.width());
+  /* Pixels of the level averaged into each row of the tile. */
+  const Filter down (target.top(), target.height(), ratio, size.height());
+  /* Area of the level read. */
+  const QRect area (across.begin(), down.begin(), across.extent(),
+                    down.extent());
+
+  /* Pixels of the level read, assembled from its tiles. */
+  QImage source (area.size(), QImage::Format_RGB32);
+  /* Tile size of the pyramid. */
+  const int step = ImagePyramid::tileSize;
+  for (int r = area.top() / step; r <= area.bottom() / step; ++r)
+    for (int c = area.left() / step; c <= area.right() / step; ++c) {
+      if (cancelled.fetchAndAddOrdered(0)) return QImage ();
+      /* Tile of the level. */
+      const QImage part = pyramid->tile(level, c, r);
+      if (part.isNull()) return QImage ();
+      /* Area of the tile read. */
+      const QRect read = pyramid->tileRect(level, c, r).intersected(area);
+      for (int y = read.top(); y <= read.bottom(); ++y) {
+        /* Row of the tile. */
+        const quint32* line =
+          reinterpret_cast<const quint32*>(part.scanLine(y - r * step))
+          - c * step;
+        std::copy(line + read.left(), line + read.right() + 1,
+                  reinterpret_cast<quint32*>(source.scanLine(y - area.top()))
+                  + (read.left() - area.left()));
+      }
+    }
+
+  /* Width of the tile. */
+  const std::size_t width = static_cast<std::size_t>(target.width());
+  /* Rows of the source averaged horizontally, three channels per pixel. */
+  std::vector<float> horizontal (static_cast<std::size_t>(area.height())
+                                 * width * 3);
+  for (int y = 0; y < area.height(); ++y) {
+    /* Row of the source. */
+    const quint32* line =
+      reinterpret_cast<const quint32*>(source.scanLine(y)) - area.left();
+    /* Row averaged. */
+    float* out = &horizontal[static_cast<std::size_t>(y) * width * 3];
+    for (std::size_t x = 0; x < width; ++x) {
+      /* Weights of pixels averaged. */
+      const float* weight = &across.weight[across.offset[x]];
+      /* Channels of the average. */
+      float sum [3] = {0.f, 0.f, 0.f};
+      for (int k = 0; k < across.count[x]; ++k) {
+        /* Pixel of the source. */
+        const quint32 pixel = line[across.first[x] + k];
+        for (int channel = 0; channel < 3; ++channel)
+          sum[channel] += weight[k] * ((pixel >> (8 * channel)) & 0xff);
+      }
+      for (int channel = 0; channel < 3; ++channel)
+        out[3 * x + channel] = sum[channel];
+    }
+  }
+
+  /* The tile. */
+  QImage result (target.size(), QImage::Format_RGB32);
+  for (std::size_t y = 0; y < static_cast<std::size_t>(target.height());
+       ++y) {
+    /* Weights of rows averaged. */
+    const float* weight = &down.weight[down.offset[y]];
+    /* First row averaged. */
+    const float* in = &horizontal[static_cast<std::size_t>(down.first[y]
+                                                           - area.top())
+                                  * width * 3];
+    /* Row of the tile. */
+    quint32* line =
+      reinterpret_cast<quint32*>(result.scanLine(static_cast<int>(y)));
+    for (std::size_t x = 0; x < width; ++x) {
+      /* Pixel of the tile. */
+      quint32 pixel = 0xff000000u;
+      for (int channel = 0; channel < 3; ++channel) {
+        /* Channel of the average, rounded. */
+        float sum = .5f;
+        for (int k = 0; k < down.count[y]; ++k)
+          sum += weight[k] * in[(k * width + x) * 3 + channel];
+        pixel |= static_cast<quint32>(std::min(sum, 255.f)) << (8 * channel);
+      }
+      line[x] = pixel;
+    }
+  }
+  return result;
+}
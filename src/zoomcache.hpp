@@ -0,0 +1,186 @@
+#ifndef ZOOMCACHE_HPP
+#define ZOOMCACHE_HPP
+
+/**
+ * \file zoomcache.hpp
+ * \brief Tiles of an image resampled at zoom levels, rendered in the
+ * background.
+ * \author Le Bars, Yoann
+ * \version 1.0
+ * \date 2026/10/17
+ */
+
+#include <boost/concept_check.hpp>
+#include <memory>
+#include <QObject>
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QCache>
+#include <QSet>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+#include "imagepyramid.hpp"
+
+/// \brief Namespace for GUI definition.
+namespace GUI {
+  /**
+   * \brief Tiles of an image at reduced scales, resampled by area
+   * averaging.
+   *
+   * Pyramid levels are powers of two apart; between them, drawing a level
+   * scaled down loses thin lines. Tiles asked for are rather rendered at
+   * the exact scale by a pool of threads, each screen pixel averaging the
+   * pixels of the finer level it covers, and kept in a cache of bounded
+   * size. Tiles are cut in the widget displaying the image, so that they
+   * are drawn without any scaling.
+   *
+   * Only scales wanted, the displayed one and those the user may zoom to
+   * next, are rendered; other requests are dropped when their turn comes.
+   */
+  class ZoomCache: public QObject {
+      Q_OBJECT
+
+    public:
+      /// \brief Width and height of tiles, in screen pixels.
+      static const int tileSize = 256;
+
+      /// \brief Memory budget for the cache of tiles, in kilobytes.
+      static const int cacheBudget = 128 << 10;
+
+      /**
+       * \brief Construct an empty cache.
+       * \param _pyramid Pyramid of the image.
+       * \param parent Parent object.
+       */
+      explicit ZoomCache (const std::shared_ptr<ImagePyramid> &_pyramid,
+                          QObject* parent = 0);
+
+      /// \brief Destructor, waiting for rendering threads.
+      virtual ~ZoomCache ();
+
+      /**
+       * \brief Whether tiles are resampled at a scale, which is done when
+       * reducing.
+       * \param scale Scale factor of the display.
+       */
+      static bool resamples (double scale) {return scale < 1.;}
+
+      /**
+       * \brief Set scales worth rendering, other requests being dropped.
+       * \param scales Scale factors.
+       */
+      void setWanted (const QList<double> &scales);
+
+      /**
+       * \brief Area covered by a tile in the widget.
+       * \param scale Scale factor of the display.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       */
+      QRect tileRect (double scale, int column, int row) const {
+        return QRect (column * tileSize, row * tileSize, tileSize,
+                      tileSize).intersected(QRect (QPoint (0, 0),
+                                                   pyramid->size()
+                                                   * scale));
+      }
+
+      /**
+       * \brief Get a tile, asking for its rendering if needed.
+       * \param scale Scale factor of the display.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       * \param urgent Whether the tile is visible, rather than prefetched.
+       * \return The tile, or a null image until it is rendered.
+       */
+      QImage tile (double scale, int column, int row, bool urgent = true);
+
+      /**
+       * \brief Ask for rendering of tiles covering an area, in advance.
+       * \param scale Scale factor of the display.
+       * \param area Area of the widget at this scale.
+       */
+      void prefetch (double scale, const QRect &area);
+
+    signals:
+      /**
+       * \brief Emitted when a tile has been rendered.
+       * \param scale Scale factor of the tile.
+       * \param area Area covered by the tile in the widget.
+       */
+      void rendered (double scale, const QRect &area);
+
+    private:
+      /// \brief Rendering of a tile, run by the pool of threads.
+      class Job;
+
+      /// \brief Pyramid of the image.
+      std::shared_ptr<ImagePyramid> pyramid;
+
+      /// \brief Threads rendering tiles.
+      QThreadPool pool;
+
+      /// \brief Protects the cache and the sets of keys.
+      mutable QMutex mutex;
+
+      /// \brief Tiles rendered.
+      QCache<quint64, QImage> cache;
+
+      /// \brief Keys of tiles being rendered or waiting to be.
+      QSet<quint64> pending;
+
+      /// \brief Keys of scales worth rendering.
+      QSet<quint64> wanted;
+
+      /// \brief Non-zero when the cache is being destroyed.
+      QAtomicInt cancelled;
+
+      /**
+       * \brief Key of a scale.
+       * \param scale Scale factor, rounded to a millionth.
+       */
+      static quint64 scaleKey (double scale) {
+        return static_cast<quint64>(qRound64(scale * 1e6));
+      }
+
+      /**
+       * \brief Key of a tile.
+       * \param scale Scale factor.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       */
+      static quint64 tileKey (double scale, int column, int row) {
+        return (scaleKey(scale) << 40) | (static_cast<quint64>(row) << 20)
+          | static_cast<quint64>(column);
+      }
+
+      /**
+       * \brief Render a tile, in a thread of the pool.
+       * \param scale Scale factor.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       */
+      void run (double scale, int column, int row);
+
+      /**
+       * \brief Resample a tile from the pyramid.
+       * \param scale Scale factor.
+       * \param column Column of the tile.
+       * \param row Row of the tile.
+       * \return The tile, null if tiles of the pyramid are not available
+       * yet or rendering has been cancelled.
+       */
+      QImage render (double scale, int column, int row) const;
+
+      /// \brief Copy is forbidden.
+      ZoomCache (const ZoomCache &);
+
+      /// \brief Copy is forbidden.
+      ZoomCache &operator = (const ZoomCache &);
+  };
+}
+
+#endif  // #ifndef ZOOMCACHE_HPP